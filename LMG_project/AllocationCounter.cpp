@@ -0,0 +1,54 @@
+#include "AllocationCounter.h"
+
+
+std::atomic<size_t> AllocationCounter::allocations(0);
+std::atomic<size_t> AllocationCounter::bytes(0);
+
+
+// =======
+// Methods
+
+AllocationStatistics AllocationCounter::getStatistics()
+{
+    AllocationStatistics statistics;
+
+    statistics.allocations = allocations.load(std::memory_order_relaxed);
+    statistics.bytes = bytes.load(std::memory_order_relaxed);
+
+    return statistics;
+}
+
+
+void AllocationCounter::countAllocation(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+
+// =========================
+// Global allocation operators
+
+#if ALLOCATION_COUNTING
+
+// The array and nothrow versions call these ones
+void* operator new(size_t size)
+{
+    void* pointer = std::malloc(size > 0 ? size : 1);
+
+    if(pointer == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    AllocationCounter::countAllocation(size);
+
+    return pointer;
+}
+
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+#endif
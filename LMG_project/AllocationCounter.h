@@ -0,0 +1,61 @@
+#ifndef __ALLOCATIONCOUNTER_H
+#define __ALLOCATIONCOUNTER_H
+
+// Includes
+
+// STL
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+
+// Replace the global operator new to count the heap allocations of the application (0 to keep the default one),
+// set by the LMG_IMPORT_BENCHMARK option of CMake
+#ifndef ALLOCATION_COUNTING
+#define ALLOCATION_COUNTING 0
+#endif
+
+
+/**
+ * @brief The AllocationStatistics struct count the heap allocations made since the start of the application
+ */
+struct AllocationStatistics
+{
+    /// Number of calls to operator new
+    size_t allocations;
+    /// Size of the allocations, in bytes
+    size_t bytes;
+};
+
+
+/**
+ * @brief The AllocationCounter class count the heap allocations of the application, from every thread.
+ *        The difference between two snapshots gives the allocations of the code between them.
+ */
+class AllocationCounter
+{
+// Attributes
+private:
+    static std::atomic<size_t> allocations;
+    static std::atomic<size_t> bytes;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getStatistics return the allocations made since the start (always 0 when ALLOCATION_COUNTING is 0)
+     */
+    static AllocationStatistics getStatistics();
+
+
+    /**
+     * @brief countAllocation count an allocation (called by operator new)
+     * @param size size of the allocation, in bytes
+     */
+    static void countAllocation(size_t size);
+};
+
+
+#endif
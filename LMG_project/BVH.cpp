@@ -0,0 +1,274 @@
+#include "BVH.h"
+
+
+// =======
+// Methods
+
+void BVH::build(const std::vector<BVHBounds>& primitiveBounds)
+{
+    std::vector<BuildNode> buildNodes;
+    std::vector<glm::vec3> centroids(primitiveBounds.size());
+
+    this->nodes.clear();
+    this->primitiveIndices.resize(primitiveBounds.size());
+
+    if(primitiveBounds.empty())
+    {
+        return;
+    }
+
+    for(unsigned int i=0; i<primitiveBounds.size(); i++)
+    {
+        this->primitiveIndices[i] = i;
+        centroids[i] = (primitiveBounds[i].min + primitiveBounds[i].max) * 0.5f;
+    }
+
+    // Binary tree first, then each 4-wide node takes the 4 largest nodes below a binary node
+    buildNodes.reserve(2 * primitiveBounds.size());
+    this->buildBinary(buildNodes, primitiveBounds, centroids, 0, static_cast<unsigned int>(primitiveBounds.size()));
+    this->nodes.reserve(buildNodes.size() / 2 + 1);
+    this->collapse(buildNodes, 0);
+}
+
+
+const std::vector<unsigned int>& BVH::getPrimitiveIndices() const
+{
+    return this->primitiveIndices;
+}
+
+
+size_t BVH::getNodeCount() const
+{
+    return this->nodes.size();
+}
+
+
+float BVH::surfaceArea(const BVHBounds& bounds)
+{
+    glm::vec3 size = glm::max(bounds.max - bounds.min, glm::vec3(0.0f));
+
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+
+BVHBounds BVH::emptyBounds()
+{
+    BVHBounds bounds;
+
+    bounds.min = glm::vec3(std::numeric_limits<float>::max());
+    bounds.max = glm::vec3(-std::numeric_limits<float>::max());
+
+    return bounds;
+}
+
+
+void BVH::growBounds(BVHBounds& bounds, const BVHBounds& other)
+{
+    bounds.min = glm::min(bounds.min, other.min);
+    bounds.max = glm::max(bounds.max, other.max);
+}
+
+
+// =================
+// Auxiliary methods
+
+int BVH::buildBinary(std::vector<BuildNode>& buildNodes, const std::vector<BVHBounds>& primitiveBounds, const std::vector<glm::vec3>& centroids, unsigned int first, unsigned int count)
+{
+    BuildNode node;
+    BVHBounds centroidBounds = emptyBounds();
+    int nodeIndex = static_cast<int>(buildNodes.size());
+    unsigned int* begin = this->primitiveIndices.data() + first;
+    unsigned int* end = begin + count;
+    unsigned int* middle = NULL;
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestBin = 0;
+
+    node.bounds = emptyBounds();
+    node.left = -1;
+    node.right = -1;
+    node.first = first;
+    node.count = count;
+    for(unsigned int* it=begin; it!=end; it++)
+    {
+        BVHBounds centroid;
+        centroid.min = centroid.max = centroids[*it];
+        growBounds(node.bounds, primitiveBounds[*it]);
+        growBounds(centroidBounds, centroid);
+    }
+    buildNodes.push_back(node);
+
+    if(count == 1)
+    {
+        return nodeIndex;
+    }
+
+    // Binned surface area heuristic along each axis
+    for(int axis=0; axis<3; axis++)
+    {
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        BVHBounds binBounds[BVH_SAH_BIN_COUNT];
+        unsigned int binCounts[BVH_SAH_BIN_COUNT] = { 0 };
+        float rightArea[BVH_SAH_BIN_COUNT];
+        unsigned int rightCount[BVH_SAH_BIN_COUNT];
+        BVHBounds leftBounds = emptyBounds();
+        BVHBounds rightBounds = emptyBounds();
+        unsigned int leftCount = 0;
+        unsigned int rightSum = 0;
+
+        if(extent <= 0.0f)
+        {
+            continue;
+        }
+
+        for(int b=0; b<BVH_SAH_BIN_COUNT; b++)
+        {
+            binBounds[b] = emptyBounds();
+        }
+        for(unsigned int* it=begin; it!=end; it++)
+        {
+            int b = std::min(static_cast<int>((centroids[*it][axis] - centroidBounds.min[axis]) / extent * BVH_SAH_BIN_COUNT), BVH_SAH_BIN_COUNT - 1);
+            binCounts[b]++;
+            growBounds(binBounds[b], primitiveBounds[*it]);
+        }
+
+        // Sweep from the right to know the right side of each split, then from the left
+        for(int b=BVH_SAH_BIN_COUNT-1; b>0; b--)
+        {
+            rightSum += binCounts[b];
+            growBounds(rightBounds, binBounds[b]);
+            rightCount[b] = rightSum;
+            rightArea[b] = surfaceArea(rightBounds);
+        }
+        for(int b=0; b<BVH_SAH_BIN_COUNT-1; b++)
+        {
+            float cost = 0.0f;
+
+            leftCount += binCounts[b];
+            growBounds(leftBounds, binBounds[b]);
+            if(leftCount == 0 || rightCount[b + 1] == 0)
+            {
+                continue;
+            }
+
+            cost = surfaceArea(leftBounds) * leftCount + rightArea[b + 1] * rightCount[b + 1];
+            if(cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // Costs relative to the intersection of one primitive
+    bestCost = BVH_TRAVERSAL_COST + bestCost / std::max(surfaceArea(node.bounds), 1e-30f);
+    if(count <= BVH_MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= static_cast<float>(count)))
+    {
+        return nodeIndex;
+    }
+
+    if(bestAxis >= 0)
+    {
+        float extent = centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis];
+        middle = std::partition(begin, end, [&](unsigned int primitive)
+        {
+            int b = std::min(static_cast<int>((centroids[primitive][bestAxis] - centroidBounds.min[bestAxis]) / extent * BVH_SAH_BIN_COUNT), BVH_SAH_BIN_COUNT - 1);
+            return b <= bestBin;
+        });
+    }
+    else
+    {
+        // Every centroid at the same place : split in the middle of the list
+        middle = begin + count / 2;
+    }
+
+    buildNodes[nodeIndex].left = this->buildBinary(buildNodes, primitiveBounds, centroids, first, static_cast<unsigned int>(middle - begin));
+    buildNodes[nodeIndex].right = this->buildBinary(buildNodes, primitiveBounds, centroids, first + static_cast<unsigned int>(middle - begin), static_cast<unsigned int>(end - middle));
+
+    return nodeIndex;
+}
+
+
+int BVH::collapse(const std::vector<BuildNode>& buildNodes, int buildNodeIndex)
+{
+    std::vector<int> children;
+    int nodeIndex = static_cast<int>(this->nodes.size());
+    const BuildNode& buildNode = buildNodes[buildNodeIndex];
+
+    this->nodes.push_back(BVHNode());
+
+    // A leaf root becomes a node with a single leaf child
+    if(buildNode.left < 0)
+    {
+        children.push_back(buildNodeIndex);
+    }
+    else
+    {
+        children.push_back(buildNode.left);
+        children.push_back(buildNode.right);
+    }
+
+    // Open the largest inner child until there are 4 children
+    while(children.size() < 4)
+    {
+        int largest = -1;
+        float largestArea = -1.0f;
+
+        for(unsigned int i=0; i<children.size(); i++)
+        {
+            const BuildNode& child = buildNodes[children[i]];
+            if(child.left >= 0 && surfaceArea(child.bounds) > largestArea)
+            {
+                largest = static_cast<int>(i);
+                largestArea = surfaceArea(child.bounds);
+            }
+        }
+        if(largest < 0)
+        {
+            break;
+        }
+
+        int opened = children[largest];
+        children[largest] = buildNodes[opened].left;
+        children.push_back(buildNodes[opened].right);
+    }
+
+    for(unsigned int i=0; i<4; i++)
+    {
+        BVHNode& node = this->nodes[nodeIndex];
+
+        if(i >= children.size())
+        {
+            // Unused child, skipped by the traversal
+            node.minX[i] = node.minY[i] = node.minZ[i] = 0.0f;
+            node.maxX[i] = node.maxY[i] = node.maxZ[i] = 0.0f;
+            node.child[i] = -1;
+            node.count[i] = 0;
+            continue;
+        }
+
+        const BuildNode& child = buildNodes[children[i]];
+        node.minX[i] = child.bounds.min.x;
+        node.minY[i] = child.bounds.min.y;
+        node.minZ[i] = child.bounds.min.z;
+        node.maxX[i] = child.bounds.max.x;
+        node.maxY[i] = child.bounds.max.y;
+        node.maxZ[i] = child.bounds.max.z;
+
+        if(child.left < 0)
+        {
+            node.child[i] = static_cast<int>(child.first);
+            node.count[i] = child.count;
+        }
+        else
+        {
+            // The node vector may be reallocated by the recursion
+            int childIndex = this->collapse(buildNodes, children[i]);
+            this->nodes[nodeIndex].child[i] = childIndex;
+            this->nodes[nodeIndex].count[i] = 0;
+        }
+    }
+
+    return nodeIndex;
+}
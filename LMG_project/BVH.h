@@ -0,0 +1,303 @@
+#ifndef __BVH_H
+#define __BVH_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+// SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BVH_TRAVERSAL_SSE
+#include <xmmintrin.h>
+#endif
+
+// glm
+#include <glm/glm.hpp>
+
+
+// Number of bins used to evaluate the surface area heuristic along each axis
+#define BVH_SAH_BIN_COUNT 16
+// Maximal number of primitives in a leaf
+#define BVH_MAX_LEAF_SIZE 4
+// Cost of visiting a node compared to the cost of intersecting a primitive
+#define BVH_TRAVERSAL_COST 1.0f
+// Size of the traversal stack (enough for any tree built from 2^32 primitives)
+#define BVH_STACK_SIZE 128
+
+
+/**
+ * @brief The Ray struct describe a ray, the direction does not need to be normalized (distances are in direction units)
+ */
+struct Ray
+{
+    /// Origin of the ray
+    glm::vec3 origin;
+    /// Direction of the ray
+    glm::vec3 direction;
+    /// Largest distance tested along the ray
+    float tMax;
+};
+
+
+/**
+ * @brief The RayHit struct describe the closest intersection found along a ray
+ */
+struct RayHit
+{
+    /// Distance of the hit along the ray (infinite when nothing was hit)
+    float t;
+    /// Barycentric coordinates of the hit in the triangle
+    float u;
+    float v;
+    /// Index of the hit instance (-1 when nothing was hit)
+    int instance;
+    /// Index of the hit mesh in the instance
+    unsigned int mesh;
+    /// Index of the hit triangle in the mesh
+    unsigned int triangle;
+};
+
+
+/**
+ * @brief The BVHBounds struct is an axis aligned bounding box
+ */
+struct BVHBounds
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+
+/**
+ * @brief The BVHNode struct is a node of the 4-wide tree, its four child boxes are stored one array per component for SIMD tests
+ */
+struct BVHNode
+{
+    float minX[4];
+    float minY[4];
+    float minZ[4];
+    float maxX[4];
+    float maxY[4];
+    float maxZ[4];
+    /// Index of the child node, or first primitive of the leaf (-1 for an unused child)
+    int child[4];
+    /// Number of primitives of the leaf (0 for an inner node)
+    unsigned int count[4];
+};
+
+
+/**
+ * @brief The BVH class build a 4-wide bounding volume hierarchy over primitive bounds with the surface area heuristic
+ *        and traverse it with rays, four child boxes at a time
+ */
+class BVH
+{
+// Attributes
+private:
+
+    /**
+     * @brief The BuildNode struct is a node of the binary tree built before being collapsed into the 4-wide tree
+     */
+    struct BuildNode
+    {
+        BVHBounds bounds;
+        int left;
+        int right;
+        unsigned int first;
+        unsigned int count;
+    };
+
+    /// Nodes of the 4-wide tree (the root is the first one)
+    std::vector<BVHNode> nodes;
+    /// Primitive indices in the order of the leaves
+    std::vector<unsigned int> primitiveIndices;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief build build the tree over the given primitives
+     * @param primitiveBounds bounding box of each primitive
+     */
+    void build(const std::vector<BVHBounds>& primitiveBounds);
+
+
+    /**
+     * @brief getPrimitiveIndices return the primitive indices in the order of the leaves (leaves reference ranges of this array)
+     */
+    const std::vector<unsigned int>& getPrimitiveIndices() const;
+
+
+    /**
+     * @brief getNodeCount return the number of 4-wide nodes
+     */
+    size_t getNodeCount() const;
+
+
+    /**
+     * @brief traverse visit the leaves hit by the ray, from the nearest to the farthest
+     * @param ray ray to trace, ray.tMax is not modified
+     * @param tMax largest distance of interest, lowered by the intersector when it finds a closer hit
+     * @param intersector callable bool(unsigned int first, unsigned int count, float& tMax) intersecting the primitives
+     *        [first, first + count) of the leaf order and lowering tMax on hit
+     * @return true when the intersector found a hit
+     */
+    template<typename LeafIntersector>
+    bool traverse(const Ray& ray, float& tMax, LeafIntersector& intersector) const;
+
+
+    /**
+     * @brief surfaceArea return the surface area of a box
+     */
+    static float surfaceArea(const BVHBounds& bounds);
+
+
+    /**
+     * @brief emptyBounds return a box which contains nothing (ready to be grown)
+     */
+    static BVHBounds emptyBounds();
+
+
+    /**
+     * @brief growBounds grow a box to contain another one
+     */
+    static void growBounds(BVHBounds& bounds, const BVHBounds& other);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief buildBinary split the primitives [first, first + count) of primitiveIndices with the binned surface area heuristic
+     * @return the index of the created node in buildNodes
+     */
+    int buildBinary(std::vector<BuildNode>& buildNodes, const std::vector<BVHBounds>& primitiveBounds, const std::vector<glm::vec3>& centroids, unsigned int first, unsigned int count);
+
+
+    /**
+     * @brief collapse create the 4-wide node of a binary node by opening its largest inner descendants
+     * @return the index of the created node in nodes
+     */
+    int collapse(const std::vector<BuildNode>& buildNodes, int buildNodeIndex);
+};
+
+
+// ========
+// Template
+
+template<typename LeafIntersector>
+bool BVH::traverse(const Ray& ray, float& tMax, LeafIntersector& intersector) const
+{
+    int stack[BVH_STACK_SIZE];
+    int stackSize = 0;
+    bool hit = false;
+    glm::vec3 inverseDirection;
+
+    if(this->nodes.empty())
+    {
+        return false;
+    }
+
+    // Avoid infinities in the slab test when the direction is parallel to an axis
+    for(int i=0; i<3; i++)
+    {
+        float direction = (std::fabs(ray.direction[i]) > 1e-20f) ? ray.direction[i] : std::copysign(1e-20f, ray.direction[i]);
+        inverseDirection[i] = 1.0f / direction;
+    }
+
+#ifdef BVH_TRAVERSAL_SSE
+    const __m128 originX = _mm_set1_ps(ray.origin.x);
+    const __m128 originY = _mm_set1_ps(ray.origin.y);
+    const __m128 originZ = _mm_set1_ps(ray.origin.z);
+    const __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+    const __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+    const __m128 inverseZ = _mm_set1_ps(inverseDirection.z);
+#endif
+
+    stack[stackSize++] = 0;
+    while(stackSize > 0)
+    {
+        const BVHNode& node = this->nodes[stack[--stackSize]];
+        float childDistance[4];
+        int order[4];
+        int hitCount = 0;
+        int hitMask = 0;
+
+#ifdef BVH_TRAVERSAL_SSE
+        // Slab test of the four child boxes at once
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), originX), inverseX);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), originX), inverseX);
+        __m128 tNear = _mm_min_ps(t0, t1);
+        __m128 tFar = _mm_max_ps(t0, t1);
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), originY), inverseY);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), originY), inverseY);
+        tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+        tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), originZ), inverseZ);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), originZ), inverseZ);
+        tNear = _mm_max_ps(_mm_max_ps(tNear, _mm_min_ps(t0, t1)), _mm_setzero_ps());
+        tFar = _mm_min_ps(_mm_min_ps(tFar, _mm_max_ps(t0, t1)), _mm_set1_ps(tMax));
+        hitMask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+        _mm_storeu_ps(childDistance, tNear);
+#else
+        for(int i=0; i<4; i++)
+        {
+            float tx0 = (node.minX[i] - ray.origin.x) * inverseDirection.x;
+            float tx1 = (node.maxX[i] - ray.origin.x) * inverseDirection.x;
+            float ty0 = (node.minY[i] - ray.origin.y) * inverseDirection.y;
+            float ty1 = (node.maxY[i] - ray.origin.y) * inverseDirection.y;
+            float tz0 = (node.minZ[i] - ray.origin.z) * inverseDirection.z;
+            float tz1 = (node.maxZ[i] - ray.origin.z) * inverseDirection.z;
+            float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+            float tFar = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+            hitMask |= (tNear <= tFar) ? (1 << i) : 0;
+            childDistance[i] = tNear;
+        }
+#endif
+
+        // Hit children sorted from the nearest to the farthest
+        for(int i=0; i<4; i++)
+        {
+            if(((hitMask >> i) & 1) && node.child[i] >= 0)
+            {
+                int j = hitCount++;
+                while(j > 0 && childDistance[order[j - 1]] > childDistance[i])
+                {
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                order[j] = i;
+            }
+        }
+
+        // Leaves are intersected now, inner nodes are pushed so that the nearest one is popped first
+        for(int i=0; i<hitCount; i++)
+        {
+            int child = order[i];
+            if(node.count[child] > 0 && childDistance[child] <= tMax)
+            {
+                hit = intersector(static_cast<unsigned int>(node.child[child]), node.count[child], tMax) || hit;
+            }
+        }
+        for(int i=hitCount-1; i>=0; i--)
+        {
+            int child = order[i];
+            if(node.count[child] == 0 && stackSize < BVH_STACK_SIZE)
+            {
+                stack[stackSize++] = node.child[child];
+            }
+        }
+    }
+
+    return hit;
+}
+
+
+#endif
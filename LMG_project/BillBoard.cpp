@@ -11,6 +11,7 @@ BillBoard::BillBoard(std::string texturePath)
 
     // Generate billboard's vertices positon
     this->generateVerticesPosition();
+    this->center = (this->vertices[0] + this->vertices[1] + this->vertices[2] + this->vertices[3]) * 0.25f;
 
     // Set up billboard
     this->setUpBillBoard();
@@ -31,6 +32,7 @@ BillBoard::BillBoard(GLuint textureID, int textWidth, int textHeight, glm::vec3
     this->vertices.push_back(topRightVertex);
     this->vertices.push_back(botRightVertex);
     this->vertices.push_back(botLeftVertex);
+    this->center = (topLeftVertex + topRightVertex + botRightVertex + botLeftVertex) * 0.25f;
 
     // Set up billboard
     this->setUpBillBoard();
@@ -40,31 +42,28 @@ BillBoard::BillBoard(GLuint textureID, int textWidth, int textHeight, glm::vec3
 
 void BillBoard::loadTexture(std::string texturePath)
 {
-    // Texture's data
-    unsigned char* textureData;
+    // Cut out sprite : the foliage keeps its coverage at a distance
+    MipGenerationSettings mipSettings;
+    mipSettings.wrap = false;
+    mipSettings.alphaCoverageThreshold = BILLBOARD_ALPHA_REFERENCE;
 
 
     // Generate the texture in OpenGL
     glGenTextures(1, &this->textureID);
 
-    // Retrieve texture data
-    textureData = SOIL_load_image(texturePath.c_str(), &this->textureWidth, &this->textureHeight, 0, SOIL_LOAD_RGBA);
-    //std::cerr << "SOIL_LOADING error : " << SOIL_last_result() << std::endl;
+    // Bind the texture in OpenGL
+    RenderState::bindTexture(GL_TEXTURE_2D, this->textureID);
 
-    if(textureData != NULL)
+    // Compressed or cached version of the texture with its mip levels, computed from the source image the first time
+    if(CompressedTexture::loadTexture(texturePath, GL_TEXTURE_2D, &this->textureWidth, &this->textureHeight)
+    || CompressedTexture::createTexture(texturePath, GL_TEXTURE_2D, mipSettings, &this->textureWidth, &this->textureHeight))
     {
-        // Bind the texture in OpenGL
-        glBindTexture(GL_TEXTURE_2D, this->textureID);
-        glCheckError();
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->textureWidth, this->textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
-        glCheckError();
-        glGenerateMipmap(GL_TEXTURE_2D);
         glCheckError();
 
         // Set texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
     else
@@ -72,8 +71,6 @@ void BillBoard::loadTexture(std::string texturePath)
         std::cerr << "[WARNING] in BillBoard, could not load texture at path : " << texturePath.c_str() << std::endl;
 
     }
-
-    SOIL_free_image_data(textureData);
 }
 
 
@@ -114,39 +111,17 @@ void BillBoard::generateVerticesPosition()
      this->indices.push_back(0); // Bot left
      this->indices.push_back(2); // Top left
 
-     // Declare VAO, VBO and EBO
-     glGenVertexArrays(1, &this->VAO);
-     glCheckError();
-     glGenBuffers(1, &this->VBO);
-     glCheckError();
-     glGenBuffers(1, &this->EBO);
-     glCheckError();
-
-     // Memory allocation for VBO and EBO linked with the VAO
-     glBindVertexArray(this->VAO);
-     glCheckError();
-
-     // Link the VBO with the vertices vector
-     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-     glCheckError();
-     glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(glm::vec3), this->vertices.data(), GL_STATIC_DRAW);
-     glCheckError();
-
-     // Link the EBO with the indices vector
-     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
-     glCheckError();
-     glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), this->indices.data(), GL_STATIC_DRAW);
-     glCheckError();
-
-     // Tell how to read position of each vertex in the VBO
-     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-     glCheckError();
-     glEnableVertexAttribArray(0);
-     glCheckError();
-
-
-     glBindVertexArray(0);
-     glCheckError();
+     // Copy the vertices and indices in the geometry arena
+     this->geometryHandle = GeometryArena::getArena(POSITION_VERTEX_FORMAT).allocate(this->vertices.data(), static_cast<GLuint>(this->vertices.size()), this->indices.data(), static_cast<GLuint>(this->indices.size()));
+
+     // The vertices are only positions, so KEEP_POSITIONS keeps them all
+     size_t releasedBytes = 0;
+     if(GeometryRetention::getPolicy(BILLBOARD_GEOMETRY) == DISCARD_GEOMETRY)
+     {
+         releasedBytes += GeometryRetention::release(this->vertices);
+         releasedBytes += GeometryRetention::release(this->indices);
+     }
+     GeometryRetention::addResource(BILLBOARD_GEOMETRY, GeometryRetention::getBytes(this->vertices) + GeometryRetention::getBytes(this->indices), releasedBytes);
  }
 
 
@@ -154,20 +129,15 @@ void BillBoard::draw(Shader shader, std::string UniformaNameInShader)
 {
     GLint uniformColorTextureID;
 
-     // Add the map texture
-    glActiveTexture(GL_TEXTURE0);
-
     // Retrieve the uniform
-    uniformColorTextureID = glGetUniformLocation(shader._shaderId, UniformaNameInShader.c_str());
-    glCheckError();
+    uniformColorTextureID = shader.getUniform(UniformaNameInShader);
     // If the uniform eists in the shader
-    if(uniformColorTextureID != -1)
+    if(uniformColorTextureID != SHADER_INVALID_UNIFORM)
     {
         // Bind the texture
-        glUniform1i(uniformColorTextureID, 0);
-        glCheckError();
-        glBindTexture(GL_TEXTURE_2D, this->textureID);
+        shader.setInt(uniformColorTextureID, 0);
         glCheckError();
+        RenderState::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, this->textureID);
     }
     else if(!this->messageAlreadySpread) // If not
     {
@@ -181,24 +151,20 @@ void BillBoard::draw(Shader shader, std::string UniformaNameInShader)
     glCheckError();
 
     // draw mesh
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glBindVertexArray(this->VAO);
-    glCheckError();
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, (void*)0);
-    glCheckError();
-    glBindVertexArray(0);
-    glDisable(GL_BLEND);
-
-    glActiveTexture(GL_TEXTURE0);
+    GeometryArena& arena = GeometryArena::getArena(POSITION_VERTEX_FORMAT);
+    const GeometryRange& range = arena.getRange(this->geometryHandle);
+    arena.commandBuffer.addCommand(range.indexCount, range.firstIndex, range.baseVertex);
+    arena.submit();
 }
 
 
+GLuint BillBoard::getTextureID() const
+{
+    return this->textureID;
+}
 
 
-
-
-
-
-
+glm::vec3 BillBoard::getCenter() const
+{
+    return this->center;
+}
@@ -34,14 +34,25 @@
 // Shader
 #include "Shader.h"
 
+// Geometry storage
+#include "GeometryArena.h"
+
+// Compressed textures
+#include "CompressedTexture.h"
+
+// Geometry retention
+#include "GeometryRetention.h"
+
+
+// Alpha reference of the cut out billboards, whose coverage is kept by the mip levels of their textures
+#define BILLBOARD_ALPHA_REFERENCE 0.5f
+
 
 class BillBoard
 {
 // Attributes
 private:
-    GLuint VAO;
-    GLuint VBO;
-    GLuint EBO;
+    GLuint geometryHandle;
 
     // Texture
     GLuint textureID;
@@ -51,6 +62,8 @@ private:
     // BillBoard data
     std::vector<glm::vec3> vertices;
     std::vector<GLuint> indices;
+    /// Center of the 4 vertices, kept when the vertices are released
+    glm::vec3 center;
 
     // Debug
     bool messageAlreadySpread;
@@ -106,9 +119,21 @@ public:
 
 
     /**
-     * @brief draw draw the billboard
+     * @brief draw draw the billboard, with the blending set by the transparent pass of the render queue
      */
     void draw(Shader shader, std::string UniformaNameInShader);
+
+
+    /**
+     * @brief getTextureID return the id in OpenGL of the texture of the billboard
+     */
+    GLuint getTextureID() const;
+
+
+    /**
+     * @brief getCenter return the center of the billboard, in model space
+     */
+    glm::vec3 getCenter() const;
 };
 
 
@@ -54,29 +54,26 @@ BillBoardCloud::BillBoardCloud(std::vector<std::string> texturesPath)
 
 GLuint BillBoardCloud::loadTexture(std::string texturePath, int* height, int* width)
 {
-    // Texture's data
-    unsigned char* textureData;
     GLuint textureID = 0;
+    // Cut out sprite : the foliage keeps its coverage at a distance
+    MipGenerationSettings mipSettings;
+    mipSettings.wrap = false;
+    mipSettings.alphaCoverageThreshold = BILLBOARD_ALPHA_REFERENCE;
 
 
     // Generate the texture in OpenGL
     glGenTextures(1, &textureID);
 
-    // Retrieve texture data
-    textureData = SOIL_load_image(texturePath.c_str(), width, height, 0, SOIL_LOAD_RGBA);
-    //std::cerr << "SOIL_LOADING error : " << SOIL_last_result() << std::endl;
+    // Bind the texture in OpenGL
+    RenderState::bindTexture(GL_TEXTURE_2D, textureID);
 
-    if(textureData != NULL)
+    // Compressed or cached version of the texture with its mip levels, computed from the source image the first time
+    if(CompressedTexture::loadTexture(texturePath, GL_TEXTURE_2D, width, height) || CompressedTexture::createTexture(texturePath, GL_TEXTURE_2D, mipSettings, width, height))
     {
-        // Bind the texture in OpenGL
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, *width, *height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
         // Set texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
     else
@@ -85,8 +82,6 @@ GLuint BillBoardCloud::loadTexture(std::string texturePath, int* height, int* wi
 
     }
 
-    SOIL_free_image_data(textureData);
-
     return textureID;
 }
 
@@ -98,3 +93,9 @@ void BillBoardCloud::draw(Shader shader, std::string uniformNameInShader)
         billBoards[i].draw(shader, uniformNameInShader);
     }
 }
+
+
+std::vector<BillBoard>& BillBoardCloud::getBillBoards()
+{
+    return this->billBoards;
+}
@@ -82,6 +82,12 @@ public:
      * @param uniformNameInShader
      */
     void draw(Shader shader, std::string uniformNameInShader);
+
+
+    /**
+     * @brief getBillBoards return the billboards of the cloud, to draw them one by one
+     */
+    std::vector<BillBoard>& getBillBoards();
 };
 
 
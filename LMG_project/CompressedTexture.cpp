@@ -0,0 +1,662 @@
+#include "CompressedTexture.h"
+
+
+// DDS header codes
+#define DDS_FOURCC(a, b, c, d) (static_cast<unsigned int>(a) | (static_cast<unsigned int>(b) << 8) | (static_cast<unsigned int>(c) << 16) | (static_cast<unsigned int>(d) << 24))
+#define DDS_FLAGS_TEXTURE 0x00021007u
+#define DDS_FLAGS_PITCH 0x8u
+#define DDS_FLAGS_LINEAR_SIZE 0x80000u
+#define DDS_PIXEL_FORMAT_FOURCC 0x4u
+#define DDS_PIXEL_FORMAT_RGBA 0x41u
+#define DDS_CAPS_MIPMAP_TEXTURE 0x00401008u
+#define DDS_CAPS2_CUBEMAP 0x200u
+#define DDS_CAPS2_VOLUME 0x200000u
+#define DDS_DIMENSION_TEXTURE2D 3u
+
+// DXGI formats of the DX10 header and their OpenGL format
+static const unsigned int DDS_DXGI_FORMAT_COUNT = 11;
+static const unsigned int DDS_DXGI_FORMATS[DDS_DXGI_FORMAT_COUNT][2] =
+{
+    { 28, GL_RGBA8 },
+    { 71, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },
+    { 72, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT },
+    { 74, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT },
+    { 75, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT },
+    { 77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+    { 78, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT },
+    { 80, GL_COMPRESSED_RED_RGTC1 },
+    { 83, GL_COMPRESSED_RG_RGTC2 },
+    { 98, GL_COMPRESSED_RGBA_BPTC_UNORM },
+    { 99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM }
+};
+
+// KTX constants
+#define KTX_ENDIANNESS 0x04030201u
+
+
+TextureMemoryStatistics CompressedTexture::statistics = { 0, 0, 0, 0, 0 };
+
+
+// ==============
+// Constructor(s)
+
+CompressedTexture::CompressedTexture() :
+    internalFormat(0),
+    width(0),
+    height(0)
+{
+}
+
+
+// =======
+// Methods
+
+bool CompressedTexture::load(const std::string& path)
+{
+    return this->read(path, true);
+}
+
+
+bool CompressedTexture::loadHeader(const std::string& path)
+{
+    return this->read(path, false);
+}
+
+
+bool CompressedTexture::isSupported() const
+{
+    switch(this->internalFormat)
+    {
+    case GL_RGBA8:
+        return true;
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return GLEW_EXT_texture_compression_s3tc;
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+        return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+    default:
+        return false;
+    }
+}
+
+
+void CompressedTexture::upload(GLenum target) const
+{
+    // The levels of a face are limited on the cube map itself
+    GLenum parameterTarget = (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) ? GL_TEXTURE_CUBE_MAP : target;
+
+    for(unsigned int i=0; i<this->levels.size(); i++)
+    {
+        uploadLevel(target, i, this->internalFormat, this->levels[i], this->data.data() + this->levels[i].offset);
+    }
+
+    // A file without its full mip chain is still complete with the mipmap filters
+    glTexParameteri(parameterTarget, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(this->levels.size()) - 1);
+    glCheckError();
+}
+
+
+bool CompressedTexture::save(const std::string& path) const
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    unsigned int magic = DDS_MAGIC;
+    unsigned int header[31] = { 0 };
+    // format, dimension, flags, array size, flags
+    unsigned int extendedHeader[5] = { 0, DDS_DIMENSION_TEXTURE2D, 0, 1, 0 };
+
+    if(!file.is_open() || this->levels.empty())
+    {
+        return false;
+    }
+
+    header[0] = sizeof(header);
+    header[2] = static_cast<unsigned int>(this->height);
+    header[3] = static_cast<unsigned int>(this->width);
+    header[6] = static_cast<unsigned int>(this->levels.size());
+    header[18] = 32;
+    header[26] = DDS_CAPS_MIPMAP_TEXTURE;
+
+    if(this->internalFormat == GL_RGBA8)
+    {
+        // Pitch of a row, and masks of the channels
+        header[1] = DDS_FLAGS_TEXTURE | DDS_FLAGS_PITCH;
+        header[4] = static_cast<unsigned int>(this->width) * 4;
+        header[19] = DDS_PIXEL_FORMAT_RGBA;
+        header[21] = 32;
+        header[22] = 0x000000FFu;
+        header[23] = 0x0000FF00u;
+        header[24] = 0x00FF0000u;
+        header[25] = 0xFF000000u;
+    }
+    else
+    {
+        // The formats of BC1 to BC3 have their own code, the others need the DX10 header
+        header[1] = DDS_FLAGS_TEXTURE | DDS_FLAGS_LINEAR_SIZE;
+        header[4] = static_cast<unsigned int>(this->levels[0].size);
+        header[19] = DDS_PIXEL_FORMAT_FOURCC;
+        switch(this->internalFormat)
+        {
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: header[20] = DDS_FOURCC('D', 'X', 'T', '1'); break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: header[20] = DDS_FOURCC('D', 'X', 'T', '3'); break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: header[20] = DDS_FOURCC('D', 'X', 'T', '5'); break;
+        default:
+            header[20] = DDS_FOURCC('D', 'X', '1', '0');
+            for(unsigned int i=0; i<DDS_DXGI_FORMAT_COUNT; i++)
+            {
+                if(DDS_DXGI_FORMATS[i][1] == this->internalFormat)
+                {
+                    extendedHeader[0] = DDS_DXGI_FORMATS[i][0];
+                }
+            }
+            if(extendedHeader[0] == 0)
+            {
+                return false;
+            }
+            break;
+        }
+    }
+
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if(header[20] == DDS_FOURCC('D', 'X', '1', '0'))
+    {
+        file.write(reinterpret_cast<const char*>(extendedHeader), sizeof(extendedHeader));
+    }
+    file.write(reinterpret_cast<const char*>(this->data.data()), this->data.size());
+
+    return static_cast<bool>(file);
+}
+
+
+size_t CompressedTexture::computeLevels(unsigned int levelCount)
+{
+    GLsizei levelWidth = this->width;
+    GLsizei levelHeight = this->height;
+    size_t offset = 0;
+
+    this->levels.clear();
+    if(getLevelSize(this->internalFormat, 1, 1) == 0 || this->width <= 0 || this->height <= 0)
+    {
+        return 0;
+    }
+
+    for(unsigned int i=0; i<levelCount; i++)
+    {
+        CompressedTextureLevel level;
+
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.offset = offset;
+        level.size = getLevelSize(this->internalFormat, levelWidth, levelHeight);
+        level.fileOffset = 0;
+        this->levels.push_back(level);
+
+        offset += level.size;
+        if(levelWidth == 1 && levelHeight == 1)
+        {
+            break;
+        }
+        levelWidth = std::max(levelWidth / 2, 1);
+        levelHeight = std::max(levelHeight / 2, 1);
+    }
+
+    return offset;
+}
+
+
+std::string CompressedTexture::findFile(const std::string& sourcePath)
+{
+    size_t slash = sourcePath.find_last_of("/\\");
+    size_t dot = sourcePath.find_last_of('.');
+    std::string basePath = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? sourcePath.substr(0, dot) : sourcePath;
+    std::string paths[3] = { basePath + COMPRESSED_TEXTURE_DDS_EXTENSION, basePath + COMPRESSED_TEXTURE_KTX_EXTENSION, sourcePath + TEXTURE_CACHE_EXTENSION };
+    struct stat sourceStatus;
+    bool sourceExists = (stat(sourcePath.c_str(), &sourceStatus) == 0);
+
+    for(int i=0; i<3; i++)
+    {
+        const std::string& path = paths[i];
+        struct stat status;
+
+        if(path == sourcePath)
+        {
+            return path;
+        }
+        if(stat(path.c_str(), &status) != 0)
+        {
+            continue;
+        }
+
+        // The source image has been modified since it was compressed
+        if(sourceExists && sourceStatus.st_mtime > status.st_mtime)
+        {
+            std::cerr << "[WARNING] in CompressedTexture, " << path << " is older than its source image and is not used" << std::endl;
+            continue;
+        }
+
+        return path;
+    }
+
+    return std::string();
+}
+
+
+bool CompressedTexture::loadTexture(const std::string& sourcePath, GLenum target, int* width, int* height)
+{
+    std::string path = findFile(sourcePath);
+    CompressedTexture texture;
+
+    if(path.empty())
+    {
+        return false;
+    }
+
+    if(!texture.load(path))
+    {
+        std::cerr << "[WARNING] in CompressedTexture, could not read the block compressed texture : " << path << std::endl;
+        return false;
+    }
+    if(!texture.isSupported())
+    {
+        std::cerr << "[WARNING] in CompressedTexture, the format of " << path << " is not supported by the OpenGL context" << std::endl;
+        return false;
+    }
+
+    texture.upload(target);
+    *width = texture.width;
+    *height = texture.height;
+    addStatistics(texture);
+
+    return true;
+}
+
+
+bool CompressedTexture::createTexture(const std::string& sourcePath, GLenum target, const MipGenerationSettings& settings, int* width, int* height)
+{
+    CompressedTexture texture;
+
+    if(!generateTexture(sourcePath, settings, texture))
+    {
+        return false;
+    }
+
+    // Every level is uploaded, so the driver does not generate them
+    texture.upload(target);
+    *width = texture.width;
+    *height = texture.height;
+    addStatistics(texture);
+
+    if(!texture.save(sourcePath + TEXTURE_CACHE_EXTENSION))
+    {
+        std::cerr << "[WARNING] in CompressedTexture, could not write the mip levels of : " << sourcePath << std::endl;
+    }
+
+    return true;
+}
+
+
+bool CompressedTexture::readTexture(const std::string& sourcePath, const MipGenerationSettings& settings, CompressedTexture& texture)
+{
+    std::string path = findFile(sourcePath);
+
+    // Prepared version, when the context supports its format
+    if(!path.empty() && texture.load(path) && texture.isSupported())
+    {
+        return true;
+    }
+
+    if(!generateTexture(sourcePath, settings, texture))
+    {
+        return false;
+    }
+    if(!texture.save(sourcePath + TEXTURE_CACHE_EXTENSION))
+    {
+        std::cerr << "[WARNING] in CompressedTexture, could not write the mip levels of : " << sourcePath << std::endl;
+    }
+
+    return true;
+}
+
+
+void CompressedTexture::uploadTexture(const CompressedTexture& texture, GLenum target)
+{
+    texture.upload(target);
+    addStatistics(texture);
+}
+
+
+std::string CompressedTexture::prepareFile(const std::string& sourcePath, const MipGenerationSettings& settings)
+{
+    std::string path = findFile(sourcePath);
+    CompressedTexture texture;
+
+    if(!path.empty())
+    {
+        return path;
+    }
+
+    if(!generateTexture(sourcePath, settings, texture) || !texture.save(sourcePath + TEXTURE_CACHE_EXTENSION))
+    {
+        return std::string();
+    }
+
+    return sourcePath + TEXTURE_CACHE_EXTENSION;
+}
+
+
+bool CompressedTexture::readLevel(const std::string& path, const CompressedTextureLevel& level, std::vector<unsigned char>& result)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    result.resize(level.size);
+    file.seekg(static_cast<std::streamoff>(level.fileOffset), std::ios::beg);
+    file.read(reinterpret_cast<char*>(result.data()), level.size);
+
+    return static_cast<bool>(file);
+}
+
+
+void CompressedTexture::uploadLevel(GLenum target, GLint index, GLenum internalFormat, const CompressedTextureLevel& level, const unsigned char* data)
+{
+    if(internalFormat == GL_RGBA8)
+    {
+        glTexImage2D(target, index, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+    else
+    {
+        glCompressedTexImage2D(target, index, internalFormat, level.width, level.height, 0, static_cast<GLsizei>(level.size), data);
+    }
+}
+
+
+void CompressedTexture::printStatistics()
+{
+    std::cout << "Textures : " << statistics.compressedTextures << " block compressed (" << statistics.compressedBytes / 1024 << " KB instead of "
+              << statistics.compressedSourceBytes / 1024 << " KB, " << static_cast<double>(statistics.compressedSourceBytes) / std::max<size_t>(statistics.compressedBytes, 1)
+              << "x smaller), " << statistics.uncompressedTextures << " RGBA8 (" << statistics.uncompressedBytes / 1024 << " KB)" << std::endl;
+}
+
+
+size_t CompressedTexture::getBlockSize(GLenum internalFormat)
+{
+    switch(internalFormat)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1:
+        return 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+
+size_t CompressedTexture::getLevelSize(GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    // A compressed level is made of whole blocks
+    if(internalFormat == GL_RGBA8)
+    {
+        return static_cast<size_t>(width) * height * 4;
+    }
+
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(internalFormat);
+}
+
+
+// =================
+// Auxiliary methods
+
+bool CompressedTexture::read(const std::string& path, bool readData)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    unsigned char identifier[4] = { 0, 0, 0, 0 };
+
+    this->levels.clear();
+    this->data.clear();
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(identifier), sizeof(identifier));
+    if(!file)
+    {
+        return false;
+    }
+
+    // "DDS " or the beginning of the KTX identifier (0xAB, "KTX")
+    if(identifier[0] == 'D' && identifier[1] == 'D' && identifier[2] == 'S' && identifier[3] == ' ')
+    {
+        return this->loadDDS(file, readData);
+    }
+    if(identifier[0] == 0xAB && identifier[1] == 'K' && identifier[2] == 'T' && identifier[3] == 'X')
+    {
+        return this->loadKTX(file, readData);
+    }
+
+    return false;
+}
+
+
+bool CompressedTexture::loadDDS(std::ifstream& file, bool readData)
+{
+    // DDS_HEADER as 31 unsigned int (pixel format from 18 to 25)
+    unsigned int header[31];
+    unsigned int fourCC = 0;
+    size_t size = 0;
+
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if(!file || header[0] != sizeof(header))
+    {
+        return false;
+    }
+
+    this->height = static_cast<GLsizei>(header[2]);
+    this->width = static_cast<GLsizei>(header[3]);
+    fourCC = header[20];
+    if(header[27] & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME))
+    {
+        // Cube maps and volumes are not handled (the cube maps are loaded one face per file)
+        return false;
+    }
+
+    if(!(header[19] & DDS_PIXEL_FORMAT_FOURCC))
+    {
+        // Uncompressed pixels : only 32-bit RGBA in this order
+        if(header[19] != DDS_PIXEL_FORMAT_RGBA || header[21] != 32 || header[22] != 0x000000FFu || header[23] != 0x0000FF00u || header[24] != 0x00FF0000u || header[25] != 0xFF000000u)
+        {
+            return false;
+        }
+        this->internalFormat = GL_RGBA8;
+    }
+    else if(fourCC == DDS_FOURCC('D', 'X', '1', '0'))
+    {
+        // DDS_HEADER_DXT10 : format, dimension, flags, array size, flags
+        unsigned int extendedHeader[5];
+
+        file.read(reinterpret_cast<char*>(extendedHeader), sizeof(extendedHeader));
+        if(!file || extendedHeader[1] != DDS_DIMENSION_TEXTURE2D || extendedHeader[3] > 1)
+        {
+            return false;
+        }
+
+        this->internalFormat = 0;
+        for(unsigned int i=0; i<DDS_DXGI_FORMAT_COUNT; i++)
+        {
+            if(DDS_DXGI_FORMATS[i][0] == extendedHeader[0])
+            {
+                this->internalFormat = static_cast<GLenum>(DDS_DXGI_FORMATS[i][1]);
+            }
+        }
+    }
+    else if(fourCC == DDS_FOURCC('D', 'X', 'T', '1'))
+    {
+        this->internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    }
+    else if(fourCC == DDS_FOURCC('D', 'X', 'T', '3'))
+    {
+        this->internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    }
+    else if(fourCC == DDS_FOURCC('D', 'X', 'T', '5'))
+    {
+        this->internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+    else if(fourCC == DDS_FOURCC('A', 'T', 'I', '1') || fourCC == DDS_FOURCC('B', 'C', '4', 'U'))
+    {
+        this->internalFormat = GL_COMPRESSED_RED_RGTC1;
+    }
+    else if(fourCC == DDS_FOURCC('A', 'T', 'I', '2') || fourCC == DDS_FOURCC('B', 'C', '5', 'U'))
+    {
+        this->internalFormat = GL_COMPRESSED_RG_RGTC2;
+    }
+    else
+    {
+        return false;
+    }
+
+    // Every level follows the previous one
+    size = this->computeLevels(std::max(header[6], 1u));
+    if(size == 0)
+    {
+        return false;
+    }
+    for(unsigned int i=0; i<this->levels.size(); i++)
+    {
+        this->levels[i].fileOffset = static_cast<size_t>(file.tellg()) + this->levels[i].offset;
+    }
+    if(!readData)
+    {
+        return true;
+    }
+    this->data.resize(size);
+    file.read(reinterpret_cast<char*>(this->data.data()), size);
+
+    return static_cast<bool>(file);
+}
+
+
+bool CompressedTexture::loadKTX(std::ifstream& file, bool readData)
+{
+    static const unsigned char identifierEnd[8] = { 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    unsigned char identifier[8];
+    // endianness, type, type size, format, internal format, base internal format, width, height, depth, array elements, faces, levels, key/value bytes
+    unsigned int header[13];
+    size_t offset = 0;
+
+    file.read(reinterpret_cast<char*>(identifier), sizeof(identifier));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if(!file || std::memcmp(identifier, identifierEnd, sizeof(identifier)) != 0 || header[0] != KTX_ENDIANNESS)
+    {
+        return false;
+    }
+
+    // Only single 2D block compressed images (type 0)
+    this->internalFormat = static_cast<GLenum>(header[4]);
+    this->width = static_cast<GLsizei>(header[6]);
+    this->height = static_cast<GLsizei>(header[7]);
+    if(header[1] != 0 || header[8] > 1 || header[9] > 1 || header[10] != 1)
+    {
+        return false;
+    }
+    if(this->computeLevels(std::max(header[11], 1u)) == 0)
+    {
+        return false;
+    }
+
+    file.seekg(header[12], std::ios::cur);
+    for(unsigned int i=0; i<this->levels.size(); i++)
+    {
+        unsigned int imageSize = 0;
+
+        file.read(reinterpret_cast<char*>(&imageSize), sizeof(imageSize));
+        if(!file || imageSize != this->levels[i].size)
+        {
+            return false;
+        }
+
+        // Compressed levels are multiple of 4 bytes, so there is no padding
+        this->levels[i].offset = offset;
+        this->levels[i].fileOffset = static_cast<size_t>(file.tellg());
+        offset += imageSize;
+        if(!readData)
+        {
+            file.seekg(imageSize, std::ios::cur);
+            continue;
+        }
+        this->data.resize(offset);
+        file.read(reinterpret_cast<char*>(this->data.data() + this->levels[i].offset), imageSize);
+    }
+
+    return static_cast<bool>(file);
+}
+
+
+bool CompressedTexture::generateTexture(const std::string& sourcePath, const MipGenerationSettings& settings, CompressedTexture& texture)
+{
+    std::vector<MipLevel> mipLevels;
+    int width = 0;
+    int height = 0;
+    unsigned char* texels = SOIL_load_image(sourcePath.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
+
+    if(texels == NULL)
+    {
+        return false;
+    }
+    MipGenerator::generateMipChain(texels, width, height, settings, mipLevels);
+    SOIL_free_image_data(texels);
+
+    texture.internalFormat = GL_RGBA8;
+    texture.width = width;
+    texture.height = height;
+    texture.data.resize(texture.computeLevels(static_cast<unsigned int>(mipLevels.size())));
+    for(unsigned int i=0; i<mipLevels.size(); i++)
+    {
+        std::copy(mipLevels[i].texels.begin(), mipLevels[i].texels.end(), texture.data.begin() + texture.levels[i].offset);
+    }
+
+    return true;
+}
+
+
+void CompressedTexture::addStatistics(const CompressedTexture& texture)
+{
+    if(texture.internalFormat == GL_RGBA8)
+    {
+        statistics.uncompressedTextures++;
+        statistics.uncompressedBytes += texture.data.size();
+        return;
+    }
+
+    // Size of the same levels in RGBA8
+    statistics.compressedTextures++;
+    statistics.compressedBytes += texture.data.size();
+    for(unsigned int i=0; i<texture.levels.size(); i++)
+    {
+        statistics.compressedSourceBytes += getLevelSize(GL_RGBA8, texture.levels[i].width, texture.levels[i].height);
+    }
+}
@@ -0,0 +1,289 @@
+#ifndef __COMPRESSEDTEXTURE_H
+#define __COMPRESSEDTEXTURE_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+// System
+#include <sys/stat.h>
+
+// SOIL
+#include <SOIL/SOIL.h>
+
+// Mip levels
+#include "MipGenerator.h"
+
+
+// Magic number of the DDS files ("DDS ")
+#define DDS_MAGIC 0x20534444u
+// Extensions searched next to a source image, in this order
+#define COMPRESSED_TEXTURE_DDS_EXTENSION ".dds"
+#define COMPRESSED_TEXTURE_KTX_EXTENSION ".ktx"
+// Extension added to the source image path to get the RGBA8 mip chain computed when there is no compressed file
+#define TEXTURE_CACHE_EXTENSION ".lmgtex"
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+
+/**
+ * @brief The CompressedTextureLevel struct describe a mip level in the data of a compressed texture
+ */
+struct CompressedTextureLevel
+{
+    /// Size of the level in texels
+    GLsizei width;
+    GLsizei height;
+    /// Position of the level in the data, in bytes
+    size_t offset;
+    /// Size of the level, in bytes
+    size_t size;
+    /// Position of the level in the file it was read from, in bytes
+    size_t fileOffset;
+};
+
+
+/**
+ * @brief The TextureMemoryStatistics struct count the video memory used by the textures loaded since the start
+ */
+struct TextureMemoryStatistics
+{
+    /// Number of textures uploaded block compressed
+    unsigned int compressedTextures;
+    /// Number of textures uploaded as RGBA8
+    unsigned int uncompressedTextures;
+    /// Video memory of the block compressed textures, in bytes
+    size_t compressedBytes;
+    /// Video memory the block compressed textures would use uncompressed (RGBA8 with mips), in bytes
+    size_t compressedSourceBytes;
+    /// Video memory of the RGBA8 textures, in bytes
+    size_t uncompressedBytes;
+};
+
+
+/**
+ * @brief The CompressedTexture class load textures with their mip chain from DDS or KTX files and upload them without decoding,
+ *        block compressed (BC1 to BC7) or RGBA8. The loaders look for a .dds or .ktx file next to each source image (written by TextureCompressor),
+ *        then for the RGBA8 mip chain cached by createTexture, and compute this one from the source image when there is none.
+ */
+class CompressedTexture
+{
+// Attributes
+public:
+    /// OpenGL format of the texture (GL_RGBA8 or a compressed format)
+    GLenum internalFormat;
+    /// Size of the first level in texels
+    GLsizei width;
+    GLsizei height;
+    /// Mip levels, from the largest
+    std::vector<CompressedTextureLevel> levels;
+    /// Blocks of every level
+    std::vector<unsigned char> data;
+
+    /// Memory used by the textures loaded since the start
+    static TextureMemoryStatistics statistics;
+
+
+// Constructor(s)
+public:
+    CompressedTexture();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief load read a DDS or KTX file (the format is found with the magic number)
+     * @param path path of the file
+     * @return false when the file could not be read or its format is neither block compressed nor RGBA8
+     */
+    bool load(const std::string& path);
+
+
+    /**
+     * @brief loadHeader read the format and the levels of a DDS or KTX file without their data (the levels can be read later with readLevel)
+     * @param path path of the file
+     * @return false when the file could not be read or its format is neither block compressed nor RGBA8
+     */
+    bool loadHeader(const std::string& path);
+
+
+    /**
+     * @brief save write the texture in a DDS file
+     * @param path path of the file
+     * @return false when the file could not be written
+     */
+    bool save(const std::string& path) const;
+
+
+    /**
+     * @brief isSupported check that the format of the texture can be sampled by the OpenGL context
+     */
+    bool isSupported() const;
+
+
+    /**
+     * @brief upload send every level to the texture bound to the target, and limit its levels to the ones present in the file
+     * @param target GL_TEXTURE_2D or a face of the bound cube map
+     */
+    void upload(GLenum target) const;
+
+
+    /**
+     * @brief computeLevels fill the levels of a texture stored level after level without padding, from its format and size
+     * @param levelCount number of levels (stops at 1x1)
+     * @return the total size of the levels in bytes (0 when the format is unknown)
+     */
+    size_t computeLevels(unsigned int levelCount);
+
+
+    /**
+     * @brief findFile find the prepared version of a source image (same path with the .dds or .ktx extension, or the cached mip chain)
+     * @param sourcePath path of the source image
+     * @return the path of the file, or an empty string when there is none or when the source image is newer
+     */
+    static std::string findFile(const std::string& sourcePath);
+
+
+    /**
+     * @brief prepareFile find the prepared version of a source image, or compute its mip chain and cache it next to the image
+     * @param sourcePath path of the source image
+     * @param settings filter, color space, addressing and alpha coverage of the texture (when the mip chain is computed)
+     * @return the path of the file, or an empty string when the source image could not be loaded or the cache written
+     */
+    static std::string prepareFile(const std::string& sourcePath, const MipGenerationSettings& settings);
+
+
+    /**
+     * @brief readLevel read the data of one level from the file its header was loaded from
+     * @param path path of the file
+     * @param level level described by loadHeader
+     * @param result filled with the data of the level
+     * @return false when the file could not be read
+     */
+    static bool readLevel(const std::string& path, const CompressedTextureLevel& level, std::vector<unsigned char>& result);
+
+
+    /**
+     * @brief uploadLevel send one level to the texture bound to the target
+     * @param target GL_TEXTURE_2D or a face of the bound cube map
+     * @param index index of the level
+     * @param internalFormat OpenGL format of the texture
+     * @param level size of the level
+     * @param data data of the level
+     */
+    static void uploadLevel(GLenum target, GLint index, GLenum internalFormat, const CompressedTextureLevel& level, const unsigned char* data);
+
+
+    /**
+     * @brief loadTexture upload the compressed version of a source image in the texture bound to the target when there is one
+     * @param sourcePath path of the source image
+     * @param target GL_TEXTURE_2D or a face of the bound cube map
+     * @param width filled with the width of the texture
+     * @param height filled with the height of the texture
+     * @return false when the source image has to be loaded instead
+     */
+    static bool loadTexture(const std::string& sourcePath, GLenum target, int* width, int* height);
+
+
+    /**
+     * @brief createTexture compute the mip chain of a source image on the CPU, upload it in the texture bound to the target
+     *        and cache it next to the image for the next loadings
+     * @param sourcePath path of the source image
+     * @param target GL_TEXTURE_2D or a face of the bound cube map
+     * @param settings filter, color space, addressing and alpha coverage of the texture
+     * @param width filled with the width of the texture
+     * @param height filled with the height of the texture
+     * @return false when the source image could not be loaded
+     */
+    static bool createTexture(const std::string& sourcePath, GLenum target, const MipGenerationSettings& settings, int* width, int* height);
+
+
+    /**
+     * @brief readTexture read the prepared version of a source image when the context supports it, or compute its mip chain and cache it,
+     *        without uploading it : a loader can check the image before it creates its OpenGL texture
+     * @param sourcePath path of the source image
+     * @param settings filter, color space, addressing and alpha coverage of the texture (when the mip chain is computed)
+     * @param texture filled with the levels of the texture
+     * @return false when the source image could not be loaded
+     */
+    static bool readTexture(const std::string& sourcePath, const MipGenerationSettings& settings, CompressedTexture& texture);
+
+
+    /**
+     * @brief uploadTexture upload a texture given by readTexture in the texture bound to the target, and count its memory
+     * @param texture texture to upload
+     * @param target GL_TEXTURE_2D or a face of the bound cube map
+     */
+    static void uploadTexture(const CompressedTexture& texture, GLenum target);
+
+
+    /**
+     * @brief printStatistics print the memory used by the textures
+     */
+    static void printStatistics();
+
+
+    /**
+     * @brief getBlockSize return the size in bytes of a 4x4 block of a compressed format (0 when the format is unknown)
+     */
+    static size_t getBlockSize(GLenum internalFormat);
+
+
+    /**
+     * @brief getLevelSize return the size in bytes of a level of a texture
+     */
+    static size_t getLevelSize(GLenum internalFormat, GLsizei width, GLsizei height);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief read read a DDS or KTX file, with the data of its levels or only their description
+     */
+    bool read(const std::string& path, bool readData);
+
+
+    /**
+     * @brief loadDDS read the header and the levels of a DDS file (after the magic number)
+     */
+    bool loadDDS(std::ifstream& file, bool readData);
+
+
+    /**
+     * @brief loadKTX read the header and the levels of a KTX file (after the identifier)
+     */
+    bool loadKTX(std::ifstream& file, bool readData);
+
+
+    /**
+     * @brief generateTexture compute the RGBA8 mip chain of a source image
+     * @return false when the source image could not be loaded
+     */
+    static bool generateTexture(const std::string& sourcePath, const MipGenerationSettings& settings, CompressedTexture& texture);
+
+
+    /**
+     * @brief addStatistics count an uploaded texture in the statistics
+     */
+    static void addStatistics(const CompressedTexture& texture);
+};
+
+
+#endif
@@ -0,0 +1,116 @@
+#include "DrawCommandBuffer.h"
+
+
+// Submissions since the last reset
+DrawCommandStatistics DrawCommandBuffer::statistics = { 0, 0 };
+
+
+// ===========
+// Constructor
+
+DrawCommandBuffer::DrawCommandBuffer()
+{
+    this->indirectBuffer = 0;
+    this->indirectBufferCapacity = 0;
+    this->indexType = GL_UNSIGNED_INT;
+}
+
+
+// =======
+// Methods
+
+void DrawCommandBuffer::setIndexType(GLenum indexType)
+{
+    this->indexType = indexType;
+}
+
+
+void DrawCommandBuffer::addCommand(GLuint count, GLuint firstIndex, GLint baseVertex)
+{
+    DrawElementsIndirectCommand command;
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    // Contiguous ranges of the same geometry are drawn by a single command
+    if(!this->commands.empty())
+    {
+        DrawElementsIndirectCommand& previous = this->commands.back();
+        if(previous.baseVertex == baseVertex && previous.firstIndex + previous.count == firstIndex)
+        {
+            previous.count += count;
+            return;
+        }
+    }
+
+    command.count = count;
+    command.instanceCount = 1;
+    command.firstIndex = firstIndex;
+    command.baseVertex = baseVertex;
+    command.baseInstance = 0;
+    this->commands.push_back(command);
+}
+
+
+void DrawCommandBuffer::submit()
+{
+    GLsizei commandCount = static_cast<GLsizei>(this->commands.size());
+
+    if(commandCount == 0)
+    {
+        return;
+    }
+
+    statistics.multiDrawCalls++;
+    statistics.drawCommands += commandCount;
+
+    if(GLEW_ARB_multi_draw_indirect)
+    {
+        // Upload the commands in the indirect buffer (grown when needed)
+        if(this->indirectBuffer == 0)
+        {
+            glGenBuffers(1, &this->indirectBuffer);
+            glCheckError();
+        }
+        RenderState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, this->indirectBuffer);
+        if(this->indirectBufferCapacity < commandCount)
+        {
+            this->indirectBufferCapacity = std::max<GLsizeiptr>(commandCount, this->indirectBufferCapacity * 2);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, this->indirectBufferCapacity * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+            glCheckError();
+        }
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandCount * sizeof(DrawElementsIndirectCommand), this->commands.data());
+        glCheckError();
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, this->indexType, (void*)0, commandCount, 0);
+        glCheckError();
+    }
+    else
+    {
+        size_t indexSize = (this->indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+        this->counts.resize(commandCount);
+        this->offsets.resize(commandCount);
+        this->baseVertices.resize(commandCount);
+        for(GLsizei i=0; i<commandCount; i++)
+        {
+            this->counts[i] = this->commands[i].count;
+            this->offsets[i] = reinterpret_cast<const GLvoid*>(this->commands[i].firstIndex * indexSize);
+            this->baseVertices[i] = this->commands[i].baseVertex;
+        }
+
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, this->counts.data(), this->indexType, this->offsets.data(), commandCount, this->baseVertices.data());
+        glCheckError();
+    }
+
+    this->commands.clear();
+}
+
+
+void DrawCommandBuffer::resetStatistics()
+{
+    statistics.multiDrawCalls = 0;
+    statistics.drawCommands = 0;
+}
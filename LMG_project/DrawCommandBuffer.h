@@ -0,0 +1,117 @@
+#ifndef __DRAWCOMMANDBUFFER_H
+#define __DRAWCOMMANDBUFFER_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <vector>
+#include <algorithm>
+
+// Redundant state filtering
+#include "RenderState.h"
+
+
+/**
+ * @brief The DrawElementsIndirectCommand struct is the layout of a command read by glMultiDrawElementsIndirect
+ */
+struct DrawElementsIndirectCommand
+{
+    /// Number of indices to draw
+    GLuint count;
+    /// Number of instances to draw
+    GLuint instanceCount;
+    /// First index in the index buffer
+    GLuint firstIndex;
+    /// Value added to each index before fetching the vertex
+    GLint baseVertex;
+    /// First instance (for instanced vertex attributes)
+    GLuint baseInstance;
+};
+
+
+/**
+ * @brief The DrawCommandStatistics struct count the draw submissions since the last reset
+ */
+struct DrawCommandStatistics
+{
+    /// Number of multi-draw calls sent to OpenGL
+    unsigned int multiDrawCalls;
+    /// Number of draw commands in these calls
+    unsigned int drawCommands;
+};
+
+
+/**
+ * @brief The DrawCommandBuffer class collect indexed draw commands sharing the same vertex array and uniforms,
+ *        and submit them with a single glMultiDrawElementsIndirect (or glMultiDrawElementsBaseVertex without GL 4.3)
+ */
+class DrawCommandBuffer
+{
+// Attributes
+private:
+    /// Commands waiting for submission
+    std::vector<DrawElementsIndirectCommand> commands;
+    /// Indirect buffer in OpenGL
+    GLuint indirectBuffer;
+    /// Size of the indirect buffer, in commands
+    GLsizeiptr indirectBufferCapacity;
+    /// Type of the indices (GL_UNSIGNED_INT or GL_UNSIGNED_SHORT)
+    GLenum indexType;
+
+    // Fallback arrays for glMultiDrawElementsBaseVertex
+    std::vector<GLsizei> counts;
+    std::vector<const GLvoid*> offsets;
+    std::vector<GLint> baseVertices;
+
+public:
+    /// Submissions since the last call to resetStatistics
+    static DrawCommandStatistics statistics;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief DrawCommandBuffer create an empty command buffer (the indirect buffer is created on first submission)
+     */
+    DrawCommandBuffer();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief setIndexType set the type of the indices read by the commands
+     * @param indexType GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+     */
+    void setIndexType(GLenum indexType);
+
+
+    /**
+     * @brief addCommand add a draw of indexed triangles, merged with the previous command when the ranges are contiguous
+     * @param count number of indices
+     * @param firstIndex first index in the index buffer
+     * @param baseVertex value added to each index
+     */
+    void addCommand(GLuint count, GLuint firstIndex, GLint baseVertex);
+
+
+    /**
+     * @brief submit draw all the waiting commands with the currently bound vertex array, then clear them
+     */
+    void submit();
+
+
+    /**
+     * @brief resetStatistics reset the submission counters (called at the beginning of each frame)
+     */
+    static void resetStatistics();
+
+};
+
+
+#endif
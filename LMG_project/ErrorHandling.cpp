@@ -0,0 +1,203 @@
+#include "ErrorHandling.h"
+
+
+// glGetError is read at each check until a policy is set (before the extensions are known)
+GLErrorPolicy errorHandling::policy = CHECK_ALL_ERROR_POLICY;
+bool errorHandling::checkCalls = true;
+unsigned int errorHandling::frame = 0;
+std::vector<std::string> errorHandling::pendingMessages;
+std::vector<GLuint> errorHandling::printedMessages;
+std::vector<GLErrorSite> errorHandling::sites;
+
+
+// =======
+// Methods
+
+void errorHandling::setPolicy(GLErrorPolicy policy)
+{
+    bool debugOutputSupported = GLEW_KHR_debug || GLEW_VERSION_4_3;
+    GLint contextFlags = 0;
+
+    if(policy == DEBUG_OUTPUT_ERROR_POLICY && !debugOutputSupported)
+    {
+        std::cerr << "[WARNING] in errorHandling::setPolicy, KHR_debug is not supported, glGetError will be read at each check" << std::endl;
+        policy = CHECK_ALL_ERROR_POLICY;
+    }
+
+    // Outside of a debug context, the driver may report no message at all
+    if(policy == DEBUG_OUTPUT_ERROR_POLICY)
+    {
+        glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+        if(!(contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT))
+        {
+            std::cerr << "[WARNING] in errorHandling::setPolicy, the context is not a debug context, glGetError will be read at each check" << std::endl;
+            policy = CHECK_ALL_ERROR_POLICY;
+        }
+    }
+
+    // The errors of the previous policy are not given to the call sites of the new one
+    while(glGetError() != GL_NO_ERROR)
+    {
+    }
+    pendingMessages.clear();
+
+    if(debugOutputSupported)
+    {
+        if(policy == DEBUG_OUTPUT_ERROR_POLICY)
+        {
+            // Synchronous : the callback is called during the faulty call, before the glCheckError following it
+            glEnable(GL_DEBUG_OUTPUT);
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            glDebugMessageCallback(debugMessageCallback, NULL);
+            // Notifications (buffer placements, shader compilations...) are not errors
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+        }
+        else
+        {
+            glDebugMessageCallback(NULL, NULL);
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            glDisable(GL_DEBUG_OUTPUT);
+        }
+    }
+
+    errorHandling::policy = policy;
+    frame = 0;
+    checkCalls = (policy == CHECK_ALL_ERROR_POLICY || policy == SAMPLED_ERROR_POLICY);
+}
+
+
+void errorHandling::beginFrame()
+{
+    GLenum errorCode;
+
+    // Messages of the calls made after the last check of the previous frame
+    for(unsigned int i=0; i<pendingMessages.size(); i++)
+    {
+        reportError("(after the last check of the frame)", 0, pendingMessages[i]);
+    }
+    pendingMessages.clear();
+
+    frame++;
+    if(policy != SAMPLED_ERROR_POLICY)
+    {
+        return;
+    }
+
+    checkCalls = (frame % GL_ERROR_SAMPLING_PERIOD == 0);
+    if(checkCalls)
+    {
+        // The errors of the frames which were not checked are still waiting in glGetError, not to be given to the first check of this frame
+        while((errorCode = glGetError()) != GL_NO_ERROR)
+        {
+            reportError("(frames not checked)", 0, getErrorName(errorCode));
+        }
+    }
+}
+
+
+void errorHandling::printErrors()
+{
+    const char* policyNames[] = { "debug output", "check all", "sampled", "ignore" };
+
+    std::cout << "GL errors (" << policyNames[policy] << " policy) : " << sites.size() << " call sites with errors" << std::endl;
+    for(unsigned int i=0; i<sites.size(); i++)
+    {
+        std::cout << "    " << sites[i].file << " (" << sites[i].line << ") : " << sites[i].count << " errors, last " << sites[i].lastError << std::endl;
+    }
+}
+
+
+std::string errorHandling::getErrorName(GLenum errorCode)
+{
+    switch (errorCode)
+    {
+        case GL_INVALID_ENUM:                  return "INVALID_ENUM";
+        case GL_INVALID_VALUE:                 return "INVALID_VALUE";
+        case GL_INVALID_OPERATION:             return "INVALID_OPERATION";
+        case GL_STACK_OVERFLOW:                return "STACK_OVERFLOW";
+        case GL_STACK_UNDERFLOW:               return "STACK_UNDERFLOW";
+        case GL_OUT_OF_MEMORY:                 return "OUT_OF_MEMORY";
+        case GL_INVALID_FRAMEBUFFER_OPERATION: return "INVALID_FRAMEBUFFER_OPERATION";
+        default:                               return "UNKNOWN_ERROR";
+    }
+}
+
+
+// =================
+// Auxiliary methods
+
+GLenum errorHandling::checkErrors(const char *file, int line)
+{
+    GLenum errorCode;
+    GLenum lastError = GL_NO_ERROR;
+
+    // Messages of the calls made since the previous check
+    for(unsigned int i=0; i<pendingMessages.size(); i++)
+    {
+        reportError(file, line, pendingMessages[i]);
+    }
+    pendingMessages.clear();
+
+    if(checkCalls)
+    {
+        while((errorCode = glGetError()) != GL_NO_ERROR)
+        {
+            reportError(file, line, getErrorName(errorCode));
+            lastError = errorCode;
+        }
+    }
+
+    return lastError;
+}
+
+
+void errorHandling::reportError(const char *file, int line, const std::string& error)
+{
+    GLErrorSite site;
+
+    for(unsigned int i=0; i<sites.size(); i++)
+    {
+        if(sites[i].line == line && sites[i].file == file)
+        {
+            sites[i].count++;
+            sites[i].lastError = error;
+            return;
+        }
+    }
+
+    // Only the first error of a call site is printed, the next ones are counted (see printErrors)
+    std::cerr << error << " | " << file << " (" << line << ")" << std::endl;
+    site.file = file;
+    site.line = line;
+    site.count = 1;
+    site.lastError = error;
+    sites.push_back(site);
+}
+
+
+void GLAPIENTRY errorHandling::debugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+    std::string typeName;
+
+    switch(type)
+    {
+        case GL_DEBUG_TYPE_ERROR:               typeName = "ERROR"; break;
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: typeName = "DEPRECATED_BEHAVIOR"; break;
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  typeName = "UNDEFINED_BEHAVIOR"; break;
+        case GL_DEBUG_TYPE_PORTABILITY:         typeName = "PORTABILITY"; break;
+        case GL_DEBUG_TYPE_PERFORMANCE:         typeName = "PERFORMANCE"; break;
+        default:                                typeName = "OTHER"; break;
+    }
+    std::string text = typeName + " " + std::to_string(id) + " : " + std::string(message, (length >= 0) ? static_cast<size_t>(length) : std::strlen(message));
+
+    // Only the errors are given to the call site of the next check, the hints of the driver are not errors of the call
+    if(type == GL_DEBUG_TYPE_ERROR)
+    {
+        pendingMessages.push_back(text);
+    }
+    else if(std::find(printedMessages.begin(), printedMessages.end(), id) == printedMessages.end())
+    {
+        printedMessages.push_back(id);
+        std::cerr << "[WARNING] in errorHandling, debug output : " << text << std::endl;
+    }
+}
@@ -3,6 +3,10 @@
 
 // STL
 #include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
 
 // Graphics
 // - GLEW (always before "gl.h")
@@ -20,31 +24,151 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+
+// GL error checks compiled in the program (1) or compiled out (0), release builds (NDEBUG) do not check by default
+#ifndef GL_ERROR_CHECKS
+#ifdef NDEBUG
+#define GL_ERROR_CHECKS 0
+#else
+#define GL_ERROR_CHECKS 1
+#endif
+#endif
+// Policy set at startup (see GLErrorPolicy), the debug output is not enabled when the checks are compiled out
+#if GL_ERROR_CHECKS
+#define GL_ERROR_DEFAULT_POLICY DEBUG_OUTPUT_ERROR_POLICY
+#else
+#define GL_ERROR_DEFAULT_POLICY IGNORE_ERROR_POLICY
+#endif
+// With SAMPLED_ERROR_POLICY, number of frames between two checked frames
+#define GL_ERROR_SAMPLING_PERIOD 60
+
+
+/**
+ * @brief The GLErrorPolicy enum list how glCheckError looks for the errors of the previous OpenGL calls
+ */
+enum GLErrorPolicy
+{
+    /// The driver reports the errors to a synchronous KHR_debug callback, glCheckError only gives them its call site (no glGetError)
+    DEBUG_OUTPUT_ERROR_POLICY,
+    /// glCheckError reads glGetError at each call, which can make the driver wait for the GPU
+    CHECK_ALL_ERROR_POLICY,
+    /// glCheckError reads glGetError in one frame every GL_ERROR_SAMPLING_PERIOD frames only
+    SAMPLED_ERROR_POLICY,
+    /// glCheckError does nothing
+    IGNORE_ERROR_POLICY
+};
+
+
+/**
+ * @brief The GLErrorSite struct aggregate the errors found by one glCheckError call site
+ */
+struct GLErrorSite
+{
+    /// Call site
+    std::string file;
+    int line;
+    /// Number of errors found at the call site
+    unsigned int count;
+    /// Description of the last one
+    std::string lastError;
+};
+
+
+/**
+ * @brief The errorHandling struct find the errors of the OpenGL calls with a GLErrorPolicy and aggregate them per glCheckError call site
+ */
 struct errorHandling
 {
+    /// Policy in use
+    static GLErrorPolicy policy;
+    /// glGetError is read by the checks of the current frame
+    static bool checkCalls;
+    /// Frames since the policy was set
+    static unsigned int frame;
+    /// Errors reported by the debug output not given to a call site yet
+    static std::vector<std::string> pendingMessages;
+    /// Identifiers of the other messages of the debug output (performance, portability...), printed once
+    static std::vector<GLuint> printedMessages;
+    /// Errors found since the program started, per call site
+    static std::vector<GLErrorSite> sites;
+
+
+    /**
+     * @brief glCheckError_ look for the errors of the previous OpenGL calls with the current policy (use the glCheckError macro)
+     * @return the last error read with glGetError, GL_NO_ERROR if none was read
+     */
     static GLenum glCheckError_(const char *file, int line)
     {
-        GLenum errorCode;
-        while ((errorCode = glGetError()) != GL_NO_ERROR)
+        // Nothing reported by the debug output and no glGetError in this frame : the driver is not called
+        if(!checkCalls && pendingMessages.empty())
         {
-            std::string error;
-            switch (errorCode)
-            {
-                case GL_INVALID_ENUM:                  error = "INVALID_ENUM"; break;
-                case GL_INVALID_VALUE:                 error = "INVALID_VALUE"; break;
-                case GL_INVALID_OPERATION:             error = "INVALID_OPERATION"; break;
-                case GL_STACK_OVERFLOW:                error = "STACK_OVERFLOW"; break;
-                case GL_STACK_UNDERFLOW:               error = "STACK_UNDERFLOW"; break;
-                case GL_OUT_OF_MEMORY:                 error = "OUT_OF_MEMORY"; break;
-                case GL_INVALID_FRAMEBUFFER_OPERATION: error = "INVALID_FRAMEBUFFER_OPERATION"; break;
-            }
-            std::cerr << error << " | " << file << " (" << line << ")" << std::endl;
+            return GL_NO_ERROR;
         }
-        return errorCode;
+        return checkErrors(file, line);
     }
+
+
+    /**
+     * @brief glNoCheck_ replace glCheckError_ when the checks are compiled out
+     */
+    static GLenum glNoCheck_()
+    {
+        return GL_NO_ERROR;
+    }
+
+
+    /**
+     * @brief setPolicy choose how the errors are found, DEBUG_OUTPUT_ERROR_POLICY falls back to CHECK_ALL_ERROR_POLICY without KHR_debug
+     *        or outside of a debug context (created with the GLUT_DEBUG flag)
+     */
+    static void setPolicy(GLErrorPolicy policy);
+
+
+    /**
+     * @brief beginFrame start a frame, to call before its first OpenGL call
+     */
+    static void beginFrame();
+
+
+    /**
+     * @brief printErrors print the errors found at each call site
+     */
+    static void printErrors();
+
+
+    /**
+     * @brief getErrorName return the name of an error of glGetError
+     */
+    static std::string getErrorName(GLenum errorCode);
+
+
+private:
+
+
+    /**
+     * @brief checkErrors give the pending debug messages to a call site and read glGetError if the policy asks for it
+     */
+    static GLenum checkErrors(const char *file, int line);
+
+
+    /**
+     * @brief reportError count an error at a call site, only its first error is printed
+     */
+    static void reportError(const char *file, int line, const std::string& error);
+
+
+    /**
+     * @brief debugMessageCallback receive the messages of the KHR_debug output, during the OpenGL call which caused them.
+     *        Only the errors are given to the call sites, the other messages are printed once as warnings
+     */
+    static void GLAPIENTRY debugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
 };
 
+#if GL_ERROR_CHECKS
 #define glCheckError() errorHandling::glCheckError_(__FILE__, __LINE__)
+#else
+#define glCheckError() errorHandling::glNoCheck_()
+#endif
 
 
 #endif
@@ -0,0 +1,304 @@
+#include "FrameScheduler.h"
+
+// Swap control of the window system
+#ifdef _WIN32
+#include <GL/wglew.h>
+#else
+#include <GL/glxew.h>
+#endif
+
+
+FrameScheduler* FrameScheduler::scheduler = NULL;
+
+
+// ===========
+// Constructor
+
+FrameScheduler::FrameScheduler() :
+    fences(FRAME_MAX_FRAMES_IN_FLIGHT, static_cast<GLsync>(NULL)),
+    fencesSupported(false),
+    frame(0),
+    frameRateCap(static_cast<float>(FRAME_RATE_CAP)),
+    targetRate(static_cast<float>(FRAME_TARGET_RATE)),
+    continuousRedraw(FRAME_CONTINUOUS_REDRAW != 0),
+    vsync(FRAME_VSYNC != 0),
+    timerPending(false),
+    time(0.0f),
+    deltaTime(0.0f)
+{
+    // The steady clock is monotonic, unlike the system clock and possibly the high resolution one
+    this->startTime = std::chrono::steady_clock::now();
+    this->previousFrameTime = this->startTime;
+    this->frameTime = this->startTime;
+    this->frameWorkTime = this->startTime;
+
+    this->resetStatistics();
+}
+
+
+// =======
+// Methods
+
+FrameScheduler& FrameScheduler::getScheduler()
+{
+    if(scheduler == NULL)
+    {
+        scheduler = new FrameScheduler();
+    }
+
+    return *scheduler;
+}
+
+
+void FrameScheduler::initialize()
+{
+    this->fencesSupported = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+    if(!this->fencesSupported)
+    {
+        std::cerr << "[WARNING] in FrameScheduler::initialize, fences are not supported, the frames in flight are not limited" << std::endl;
+    }
+
+    this->setVSync(this->vsync);
+}
+
+
+void FrameScheduler::beginFrame()
+{
+    std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point fenceStart;
+    unsigned int slot = this->frame % this->fences.size();
+
+    // Frame rate cap, measured between the starts of the frames
+    if(this->frameRateCap > 0.0f && this->frame > 0)
+    {
+        std::chrono::steady_clock::time_point earliestStart = this->frameTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / this->frameRateCap));
+
+        if(waitStart < earliestStart)
+        {
+            std::this_thread::sleep_until(earliestStart);
+        }
+    }
+    fenceStart = std::chrono::steady_clock::now();
+
+    // The slot of this frame holds the fence of the frame submitted FRAME_MAX_FRAMES_IN_FLIGHT frames ago
+    if(this->fences[slot] != NULL)
+    {
+        this->waitFence(this->fences[slot]);
+        this->fences[slot] = NULL;
+    }
+
+    this->previousFrameTime = this->frameTime;
+    this->frameTime = std::chrono::steady_clock::now();
+    this->frameWorkTime = this->frameTime;
+
+    this->time = static_cast<float>(getMilliseconds(this->startTime, this->frameTime));
+    this->deltaTime = std::min(static_cast<float>(getMilliseconds(this->previousFrameTime, this->frameTime)), FRAME_MAX_DELTA_TIME);
+
+    if(this->frame > 0)
+    {
+        this->statistics.frameInterval += getMilliseconds(this->previousFrameTime, this->frameTime);
+    }
+    this->statistics.capWaitTime += getMilliseconds(waitStart, fenceStart);
+    this->statistics.fenceWaitTime += getMilliseconds(fenceStart, this->frameTime);
+}
+
+
+void FrameScheduler::endFrame(bool pendingWork)
+{
+    std::chrono::steady_clock::time_point endTime;
+    unsigned int slot = this->frame % this->fences.size();
+    double cpuTime;
+    double interval;
+    double delay;
+
+    // Inserted after the swap, the fence is passed once the GPU finished the frame
+    if(this->fencesSupported)
+    {
+        this->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glCheckError();
+    }
+    this->frame++;
+
+    endTime = std::chrono::steady_clock::now();
+    cpuTime = getMilliseconds(this->frameWorkTime, endTime);
+    this->statistics.frames++;
+    this->statistics.cpuTime += cpuTime;
+    this->statistics.maxCpuTime = std::max(this->statistics.maxCpuTime, cpuTime);
+
+    // Inputs post their own redisplay, the timer only asks for the frames of a scene changing by itself
+    if((this->continuousRedraw || pendingWork) && !this->timerPending && this->targetRate > 0.0f)
+    {
+        interval = 1000.0 / this->targetRate;
+        delay = std::max(0.0, interval - getMilliseconds(this->frameTime, endTime));
+
+        glutTimerFunc(static_cast<unsigned int>(std::floor(delay)), redrawTimer, 0);
+        this->timerPending = true;
+    }
+}
+
+
+float FrameScheduler::getTime() const
+{
+    return this->time;
+}
+
+
+float FrameScheduler::getDeltaTime() const
+{
+    return this->deltaTime;
+}
+
+
+void FrameScheduler::setMaxFramesInFlight(unsigned int count)
+{
+    count = std::max(1u, std::min(count, static_cast<unsigned int>(FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT)));
+
+    // The slots of the fences change, the frames in flight are finished first
+    for(unsigned int i=0; i<this->fences.size(); i++)
+    {
+        if(this->fences[i] != NULL)
+        {
+            this->waitFence(this->fences[i]);
+        }
+    }
+    this->fences.assign(count, static_cast<GLsync>(NULL));
+}
+
+
+unsigned int FrameScheduler::getMaxFramesInFlight() const
+{
+    return static_cast<unsigned int>(this->fences.size());
+}
+
+
+void FrameScheduler::setFrameRateCap(float framesPerSecond)
+{
+    this->frameRateCap = std::max(0.0f, framesPerSecond);
+}
+
+
+float FrameScheduler::getFrameRateCap() const
+{
+    return this->frameRateCap;
+}
+
+
+void FrameScheduler::setContinuousRedraw(bool continuous)
+{
+    this->continuousRedraw = continuous;
+    if(continuous)
+    {
+        glutPostRedisplay();
+    }
+}
+
+
+bool FrameScheduler::isContinuousRedraw() const
+{
+    return this->continuousRedraw;
+}
+
+
+bool FrameScheduler::setVSync(bool enabled)
+{
+    int interval = enabled ? 1 : 0;
+    bool changed = false;
+
+#ifdef _WIN32
+    if(WGLEW_EXT_swap_control)
+    {
+        changed = (wglSwapIntervalEXT(interval) == TRUE);
+    }
+#else
+    if(GLXEW_EXT_swap_control)
+    {
+        glXSwapIntervalEXT(glXGetCurrentDisplay(), glXGetCurrentDrawable(), interval);
+        changed = true;
+    }
+    else if(GLXEW_MESA_swap_control)
+    {
+        changed = (glXSwapIntervalMESA(static_cast<unsigned int>(interval)) == 0);
+    }
+    // The SGI extension can not disable the synchronization
+    else if(GLXEW_SGI_swap_control && enabled)
+    {
+        changed = (glXSwapIntervalSGI(interval) == 0);
+    }
+#endif
+
+    if(!changed)
+    {
+        std::cerr << "[WARNING] in FrameScheduler::setVSync, the swap interval can not be set to " << interval << std::endl;
+        return false;
+    }
+    this->vsync = enabled;
+
+    return true;
+}
+
+
+bool FrameScheduler::isVSync() const
+{
+    return this->vsync;
+}
+
+
+void FrameScheduler::resetStatistics()
+{
+    this->statistics.frames = 0;
+    this->statistics.frameInterval = 0.0;
+    this->statistics.cpuTime = 0.0;
+    this->statistics.maxCpuTime = 0.0;
+    this->statistics.fenceWaitTime = 0.0;
+    this->statistics.capWaitTime = 0.0;
+}
+
+
+void FrameScheduler::printStatistics() const
+{
+    double frames = static_cast<double>(std::max(1u, this->statistics.frames));
+    double frameInterval = this->statistics.frameInterval / std::max(1.0, frames - 1.0);
+
+    std::cout << "Frame pacing : " << this->statistics.frames << " frames, " << frameInterval << " ms between frames ("
+              << ((frameInterval > 0.0) ? 1000.0 / frameInterval : 0.0) << " fps), CPU " << this->statistics.cpuTime / frames << " ms per frame ("
+              << this->statistics.maxCpuTime << " ms max), " << this->statistics.fenceWaitTime / frames << " ms waiting for the GPU, "
+              << this->statistics.capWaitTime / frames << " ms waiting for the cap" << std::endl;
+    std::cout << "    " << this->fences.size() << " frames in flight" << (this->fencesSupported ? "" : " (not limited)") << ", cap "
+              << this->frameRateCap << " fps, vsync " << (this->vsync ? "on" : "off") << ", redraw "
+              << (this->continuousRedraw ? "continuous" : "on change") << " at " << this->targetRate << " fps" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+void FrameScheduler::waitFence(GLsync fence)
+{
+    GLenum status = GL_TIMEOUT_EXPIRED;
+
+    // The first wait flushes the commands, without which the fence could never be passed
+    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT);
+    while(status == GL_TIMEOUT_EXPIRED)
+    {
+        status = glClientWaitSync(fence, 0, FRAME_FENCE_TIMEOUT);
+    }
+    if(status == GL_WAIT_FAILED)
+    {
+        std::cerr << "[WARNING] in FrameScheduler::waitFence, the wait for the GPU failed" << std::endl;
+    }
+    glDeleteSync(fence);
+    glCheckError();
+}
+
+
+void FrameScheduler::redrawTimer(int value)
+{
+    getScheduler().timerPending = false;
+    glutPostRedisplay();
+}
+
+
+double FrameScheduler::getMilliseconds(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
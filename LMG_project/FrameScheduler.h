@@ -0,0 +1,238 @@
+#ifndef __FRAMESCHEDULER_H
+#define __FRAMESCHEDULER_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+
+// Frames submitted by the CPU before it waits for the GPU to finish the oldest one
+#define FRAME_MAX_FRAMES_IN_FLIGHT 2
+// Largest number of frames in flight accepted by setMaxFramesInFlight
+#define FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT 4
+// Frames per second never exceeded, 0 for no cap (the swap interval already limits the frames to the refresh rate)
+#define FRAME_RATE_CAP 0
+// Frames per second redrawn while the scene changes without input (continuous redraw, levels streaming in)
+#define FRAME_TARGET_RATE 60
+// The frame is redrawn at the target rate even when nothing changes (1), or only on input and pending work (0)
+#define FRAME_CONTINUOUS_REDRAW 0
+// Swap buffers on the vertical blank (1) or at once (0)
+#define FRAME_VSYNC 1
+// Longest time step given to the camera in milliseconds, the first frame after an idle period does not jump
+#define FRAME_MAX_DELTA_TIME 50.0f
+// Time waited on a fence by each call to glClientWaitSync, in nanoseconds
+#define FRAME_FENCE_TIMEOUT 100000000
+
+
+/**
+ * @brief The FramePacingStatistics struct count the frames and the time the CPU waited since the last reset, in milliseconds
+ */
+struct FramePacingStatistics
+{
+    /// Number of frames
+    unsigned int frames;
+    /// Time between the starts of two frames
+    double frameInterval;
+    /// Time spent by the CPU in a frame, waits excluded
+    double cpuTime;
+    double maxCpuTime;
+    /// Time waited for the GPU to finish the oldest frame in flight
+    double fenceWaitTime;
+    /// Time waited to respect the frame rate cap
+    double capWaitTime;
+};
+
+
+/**
+ * @brief The FrameScheduler class pace the frames of the application :
+ *        the CPU is never more than a given number of frames ahead of the GPU (a fence is inserted after each swap and waited for before
+ *        the frame which reuses its slot), the frame rate can be capped, and a frame is only drawn on input or at a target rate while
+ *        the scene changes (GLUT waits for the events between the frames instead of calling an idle function).
+ *        The time of the frames is read from a monotonic clock.
+ */
+class FrameScheduler
+{
+// Attributes
+private:
+    /// Fences of the frames in flight, one slot per frame (NULL for a free slot)
+    std::vector<GLsync> fences;
+    /// Fences are supported by the context (OpenGL 3.2 or ARB_sync)
+    bool fencesSupported;
+    /// Number of the current frame
+    unsigned int frame;
+
+    /// Frames per second never exceeded, 0 for no cap
+    float frameRateCap;
+    /// Frames per second redrawn while the scene changes without input
+    float targetRate;
+    /// The frame is redrawn at the target rate even when nothing changes
+    bool continuousRedraw;
+    /// Swap interval of the buffers
+    bool vsync;
+    /// A timer of GLUT will ask for the next frame
+    bool timerPending;
+
+    /// Start of the application, and of the previous and current frames
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point previousFrameTime;
+    std::chrono::steady_clock::time_point frameTime;
+    /// End of the waits of the current frame
+    std::chrono::steady_clock::time_point frameWorkTime;
+    /// Time of the current frame since the start, and time step since the previous frame, in milliseconds
+    float time;
+    float deltaTime;
+
+    /// The scheduler of the application, created on first use
+    static FrameScheduler* scheduler;
+
+public:
+    /// Frames and waits since the last reset
+    FramePacingStatistics statistics;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief FrameScheduler create a scheduler with the default settings
+     */
+    FrameScheduler();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getScheduler return the scheduler of the application
+     */
+    static FrameScheduler& getScheduler();
+
+
+    /**
+     * @brief initialize check the support of the fences and set the swap interval, once the GL context and GLEW are initialized
+     */
+    void initialize();
+
+
+    /**
+     * @brief beginFrame wait for the frame rate cap and for the GPU to finish the oldest frame in flight, then measure the time of the frame.
+     *        Called at the start of the display callback.
+     */
+    void beginFrame();
+
+
+    /**
+     * @brief endFrame insert the fence of the frame after the swap of the buffers, and ask GLUT for the next frame when the scene changes without input
+     * @param pendingWork work spread over the next frames (levels streaming in) needs another frame
+     */
+    void endFrame(bool pendingWork);
+
+
+    /**
+     * @brief getTime return the time of the current frame since the start, in milliseconds
+     */
+    float getTime() const;
+
+
+    /**
+     * @brief getDeltaTime return the time between the previous frame and the current one, in milliseconds (at most FRAME_MAX_DELTA_TIME)
+     */
+    float getDeltaTime() const;
+
+
+    /**
+     * @brief setMaxFramesInFlight change the number of frames the CPU submits before it waits for the GPU (the frames in flight are finished first)
+     * @param count number of frames, from 1 to FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT
+     */
+    void setMaxFramesInFlight(unsigned int count);
+
+
+    /**
+     * @brief getMaxFramesInFlight return the number of frames the CPU submits before it waits for the GPU
+     */
+    unsigned int getMaxFramesInFlight() const;
+
+
+    /**
+     * @brief setFrameRateCap change the largest number of frames per second, 0 for no cap
+     */
+    void setFrameRateCap(float framesPerSecond);
+
+
+    /**
+     * @brief getFrameRateCap return the largest number of frames per second, 0 for no cap
+     */
+    float getFrameRateCap() const;
+
+
+    /**
+     * @brief setContinuousRedraw choose to redraw the frame at the target rate even when nothing changes, or only on input and pending work
+     */
+    void setContinuousRedraw(bool continuous);
+
+
+    /**
+     * @brief isContinuousRedraw return true when the frame is redrawn at the target rate even when nothing changes
+     */
+    bool isContinuousRedraw() const;
+
+
+    /**
+     * @brief setVSync swap the buffers on the vertical blank or at once, with the swap control extension of the window system
+     * @return false when the swap interval can not be changed
+     */
+    bool setVSync(bool enabled);
+
+
+    /**
+     * @brief isVSync return true when the buffers are swapped on the vertical blank
+     */
+    bool isVSync() const;
+
+
+    /**
+     * @brief resetStatistics set the counters of the frames and the waits to 0
+     */
+    void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the frame interval, the CPU time and the waits of the frames since the last reset, with the settings
+     */
+    void printStatistics() const;
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief waitFence wait for the GPU to pass a fence, then delete it
+     */
+    void waitFence(GLsync fence);
+
+
+    /**
+     * @brief redrawTimer timer callback of GLUT asking for the next frame
+     */
+    static void redrawTimer(int value);
+
+
+    /**
+     * @brief getMilliseconds return the duration between two times in milliseconds
+     */
+    static double getMilliseconds(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end);
+};
+
+
+#endif
@@ -0,0 +1,209 @@
+#include "FrustumCuller.h"
+
+
+// Objects and meshes culled since the last reset (zero-initialized, the counters are atomic)
+FrustumCullingStatistics FrustumCuller::statistics;
+
+
+// ===========
+// Constructor
+
+FrustumCuller::FrustumCuller()
+{
+    for(unsigned int i=0; i<6; i++)
+    {
+        this->planes[i] = glm::vec4(0.0f);
+    }
+    this->boundsCount = 0;
+}
+
+
+// =======
+// Methods
+
+void FrustumCuller::begin(const glm::mat4& viewProjectionMatrix)
+{
+    extractFrustumPlanes(viewProjectionMatrix, this->planes);
+
+    this->boundsCount = 0;
+    this->centerX.clear();
+    this->centerY.clear();
+    this->centerZ.clear();
+    this->extentX.clear();
+    this->extentY.clear();
+    this->extentZ.clear();
+    this->radius.clear();
+    this->visible.clear();
+}
+
+
+unsigned int FrustumCuller::addBounds(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& sphereCenter, float sphereRadius, const glm::mat4& worldMatrix)
+{
+    unsigned int index = this->reserveBounds(1);
+
+    this->setBounds(index, boxMin, boxMax, sphereCenter, sphereRadius, worldMatrix);
+
+    return index;
+}
+
+
+unsigned int FrustumCuller::reserveBounds(unsigned int count)
+{
+    unsigned int first = this->boundsCount;
+
+    this->boundsCount += count;
+    this->centerX.resize(this->boundsCount, 0.0f);
+    this->centerY.resize(this->boundsCount, 0.0f);
+    this->centerZ.resize(this->boundsCount, 0.0f);
+    this->extentX.resize(this->boundsCount, 0.0f);
+    this->extentY.resize(this->boundsCount, 0.0f);
+    this->extentZ.resize(this->boundsCount, 0.0f);
+    this->radius.resize(this->boundsCount, 0.0f);
+    this->visible.resize(this->boundsCount, 1);
+
+    return first;
+}
+
+
+void FrustumCuller::setBounds(unsigned int index, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& sphereCenter, float sphereRadius, const glm::mat4& worldMatrix)
+{
+    glm::vec3 boxCenter = (boxMin + boxMax) * 0.5f;
+    glm::vec3 boxExtent = (boxMax - boxMin) * 0.5f;
+    glm::vec3 worldCenter = glm::vec3(worldMatrix * glm::vec4(boxCenter, 1.0f));
+    glm::vec3 worldExtent(0.0f);
+    glm::vec3 worldSphereCenter = glm::vec3(worldMatrix * glm::vec4(sphereCenter, 1.0f));
+    float worldScale = 0.0f;
+
+    // Box enclosing the transformed box (Arvo) : extents projected with the absolute value of the matrix
+    for(int i=0; i<3; i++)
+    {
+        worldExtent[i] = std::fabs(worldMatrix[0][i]) * boxExtent.x + std::fabs(worldMatrix[1][i]) * boxExtent.y + std::fabs(worldMatrix[2][i]) * boxExtent.z;
+    }
+
+    // The sphere is stored around the box center (its radius grows with the distance between both centers)
+    worldScale = std::max(glm::length(glm::vec3(worldMatrix[0])), std::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+
+    this->centerX[index] = worldCenter.x;
+    this->centerY[index] = worldCenter.y;
+    this->centerZ[index] = worldCenter.z;
+    this->extentX[index] = worldExtent.x;
+    this->extentY[index] = worldExtent.y;
+    this->extentZ[index] = worldExtent.z;
+    this->radius[index] = sphereRadius * worldScale + glm::length(worldSphereCenter - worldCenter);
+}
+
+
+void FrustumCuller::cull()
+{
+    this->cull(0, this->boundsCount);
+}
+
+
+void FrustumCuller::cull(unsigned int first, unsigned int count)
+{
+    size_t last = std::min(first + count, this->boundsCount);
+    size_t i = first;
+
+#ifdef FRUSTUM_CULLING_SSE
+    for(; i+4<=last; i+=4)
+    {
+        __m128 boundsCenterX = _mm_loadu_ps(&this->centerX[i]);
+        __m128 boundsCenterY = _mm_loadu_ps(&this->centerY[i]);
+        __m128 boundsCenterZ = _mm_loadu_ps(&this->centerZ[i]);
+        __m128 boundsExtentX = _mm_loadu_ps(&this->extentX[i]);
+        __m128 boundsExtentY = _mm_loadu_ps(&this->extentY[i]);
+        __m128 boundsExtentZ = _mm_loadu_ps(&this->extentZ[i]);
+        __m128 boundsRadius = _mm_loadu_ps(&this->radius[i]);
+        __m128 outside = _mm_setzero_ps();
+        int outsideMask = 0;
+
+        // Each volume is outside when it is behind one plane, the smallest of both projected radii is used
+        // (same operations and comparison as testBounds, so both paths cull the same volumes)
+        for(unsigned int p=0; p<6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(boundsCenterX, _mm_set1_ps(this->planes[p].x)), _mm_mul_ps(boundsCenterY, _mm_set1_ps(this->planes[p].y))),
+                                         _mm_add_ps(_mm_mul_ps(boundsCenterZ, _mm_set1_ps(this->planes[p].z)), _mm_set1_ps(this->planes[p].w)));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(boundsExtentX, _mm_set1_ps(std::fabs(this->planes[p].x))), _mm_mul_ps(boundsExtentY, _mm_set1_ps(std::fabs(this->planes[p].y)))),
+                                          _mm_mul_ps(boundsExtentZ, _mm_set1_ps(std::fabs(this->planes[p].z))));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, _mm_min_ps(boxRadius, boundsRadius)), _mm_setzero_ps()));
+        }
+        outsideMask = _mm_movemask_ps(outside);
+
+        for(size_t j=0; j<4; j++)
+        {
+            this->visible[i + j] = ((outsideMask >> j) & 1) ^ 1;
+        }
+    }
+#endif
+
+    // Bounds left after the groups of four (all of them without SSE)
+    for(; i<last; i++)
+    {
+        this->visible[i] = this->testBounds(i) ? 1 : 0;
+    }
+}
+
+
+bool FrustumCuller::isVisible(unsigned int index) const
+{
+    // Bounds not tested yet are considered visible
+    return (index >= this->visible.size()) || (this->visible[index] != 0);
+}
+
+
+void FrustumCuller::extractFrustumPlanes(const glm::mat4& clipMatrix, glm::vec4 planes[6])
+{
+    glm::vec4 row0(clipMatrix[0][0], clipMatrix[1][0], clipMatrix[2][0], clipMatrix[3][0]);
+    glm::vec4 row1(clipMatrix[0][1], clipMatrix[1][1], clipMatrix[2][1], clipMatrix[3][1]);
+    glm::vec4 row2(clipMatrix[0][2], clipMatrix[1][2], clipMatrix[2][2], clipMatrix[3][2]);
+    glm::vec4 row3(clipMatrix[0][3], clipMatrix[1][3], clipMatrix[2][3], clipMatrix[3][3]);
+
+    // Left, right, bottom, top, near, far
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    planes[4] = row3 + row2;
+    planes[5] = row3 - row2;
+
+    for(unsigned int i=0; i<6; i++)
+    {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+
+void FrustumCuller::resetStatistics()
+{
+    statistics.testedObjects = 0;
+    statistics.culledObjects = 0;
+    statistics.testedMeshes = 0;
+    statistics.culledMeshes = 0;
+}
+
+
+void FrustumCuller::printStatistics()
+{
+    std::cout << "Frustum culling : " << statistics.culledObjects << "/" << statistics.testedObjects << " objects culled, "
+              << statistics.culledMeshes << "/" << statistics.testedMeshes << " meshes culled" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+bool FrustumCuller::testBounds(size_t index) const
+{
+    bool outside = false;
+
+    // Same order of operations as the SSE path, and the same minimum as _mm_min_ps (the second value unless the first is smaller)
+    for(unsigned int p=0; p<6 && !outside; p++)
+    {
+        float distance = (this->centerX[index] * this->planes[p].x + this->centerY[index] * this->planes[p].y) + (this->centerZ[index] * this->planes[p].z + this->planes[p].w);
+        float boxRadius = (this->extentX[index] * std::fabs(this->planes[p].x) + this->extentY[index] * std::fabs(this->planes[p].y)) + this->extentZ[index] * std::fabs(this->planes[p].z);
+        float radius = (boxRadius < this->radius[index]) ? boxRadius : this->radius[index];
+        outside = (distance + radius < 0.0f);
+    }
+
+    return !outside;
+}
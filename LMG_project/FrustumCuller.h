@@ -0,0 +1,177 @@
+#ifndef __FRUSTUMCULLER_H
+#define __FRUSTUMCULLER_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+
+// SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+// glm
+#include <glm/glm.hpp>
+
+
+/**
+ * @brief The FrustumCullingStatistics struct count the objects (models) and meshes processed by the frustum culling since the last reset
+ *        (counted by the worker threads preparing the frame)
+ */
+struct FrustumCullingStatistics
+{
+    /// Objects tested against the view frustum
+    std::atomic<unsigned int> testedObjects;
+    /// Objects outside of the view frustum
+    std::atomic<unsigned int> culledObjects;
+    /// Meshes tested against the view frustum
+    std::atomic<unsigned int> testedMeshes;
+    /// Meshes not drawn (outside of the view frustum or part of a culled object)
+    std::atomic<unsigned int> culledMeshes;
+};
+
+
+/**
+ * @brief The FrustumCuller class test world space bounding volumes against the view frustum.
+ *        Each frame, the bounds of every object are added, then all of them are tested four at a time.
+ *        Slots can also be reserved on one thread, then filled and tested by range from several threads (one range per thread).
+ */
+class FrustumCuller
+{
+// Attributes
+private:
+    /// Planes of the view frustum in world space
+    glm::vec4 planes[6];
+
+    // World space bounds, one array per component
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+    std::vector<float> radius;
+
+    /// Result of the last test (1 when the bounds intersect the frustum)
+    std::vector<char> visible;
+    /// Number of bounds added or reserved since the last call to begin
+    unsigned int boundsCount;
+
+public:
+    /// Objects and meshes culled since the last call to resetStatistics
+    static FrustumCullingStatistics statistics;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief FrustumCuller create an empty culler
+     */
+    FrustumCuller();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief begin remove the bounds of the previous frame and set the view frustum
+     * @param viewProjectionMatrix projection matrix * view matrix of the camera
+     */
+    void begin(const glm::mat4& viewProjectionMatrix);
+
+
+    /**
+     * @brief addBounds add the bounds of an object, transformed in world space
+     * @param boxMin smallest corner of the bounding box, in object space
+     * @param boxMax largest corner of the bounding box, in object space
+     * @param sphereCenter center of the bounding sphere, in object space
+     * @param sphereRadius radius of the bounding sphere, in object space
+     * @param worldMatrix matrix from object space to world space
+     * @return the index of the bounds, used to retrieve the result of the test
+     */
+    unsigned int addBounds(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& sphereCenter, float sphereRadius, const glm::mat4& worldMatrix);
+
+
+    /**
+     * @brief reserveBounds reserve consecutive slots for bounds set later with setBounds, considered visible until they are tested
+     * @param count number of bounds
+     * @return the index of the first slot
+     */
+    unsigned int reserveBounds(unsigned int count);
+
+
+    /**
+     * @brief setBounds set the bounds of an object in a reserved slot, transformed in world space (threads can set different slots at the same time)
+     * @param index slot returned by reserveBounds
+     * @param boxMin smallest corner of the bounding box, in object space
+     * @param boxMax largest corner of the bounding box, in object space
+     * @param sphereCenter center of the bounding sphere, in object space
+     * @param sphereRadius radius of the bounding sphere, in object space
+     * @param worldMatrix matrix from object space to world space
+     */
+    void setBounds(unsigned int index, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& sphereCenter, float sphereRadius, const glm::mat4& worldMatrix);
+
+
+    /**
+     * @brief cull test all the added bounds against the view frustum
+     */
+    void cull();
+
+
+    /**
+     * @brief cull test a range of bounds against the view frustum (threads can test ranges which do not overlap at the same time)
+     * @param first index of the first bounds
+     * @param count number of bounds
+     */
+    void cull(unsigned int first, unsigned int count);
+
+
+    /**
+     * @brief isVisible return the result of the last test for the given bounds
+     * @param index index returned by addBounds
+     */
+    bool isVisible(unsigned int index) const;
+
+
+    /**
+     * @brief extractFrustumPlanes extract the normalized planes of the view frustum from a clip matrix (Gribb & Hartmann)
+     * @param clipMatrix matrix to clip space
+     * @param planes filled with the 6 planes, in the space of the clip matrix input
+     */
+    static void extractFrustumPlanes(const glm::mat4& clipMatrix, glm::vec4 planes[6]);
+
+
+    /**
+     * @brief resetStatistics reset the culling counters (called at the beginning of each frame)
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the objects and meshes culled since the last reset
+     */
+    static void printStatistics();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief testBounds test one bounds against the view frustum
+     * @return true when the bounds intersect the frustum
+     */
+    bool testBounds(size_t index) const;
+};
+
+
+#endif
@@ -0,0 +1,422 @@
+#include "GeometryArena.h"
+
+
+// One arena per vertex format
+GeometryArena* GeometryArena::arenas[VERTEX_FORMAT_COUNT] = { NULL, NULL, NULL };
+// Vertex array currently bound
+// Vertex array binds since the last reset
+GeometryArenaStatistics GeometryArena::statistics = { 0 };
+
+
+// ===========
+// Constructor
+
+GeometryArena::GeometryArena(VertexFormat format)
+{
+    GeometryBlock block;
+
+    this->format = format;
+    switch(format)
+    {
+        case MESH_VERTEX_FORMAT :
+            this->vertexStride = 8 * sizeof(float);
+            this->indexSize = sizeof(GLuint);
+            break;
+        case COMPRESSED_MESH_VERTEX_FORMAT :
+            this->vertexStride = 4 * sizeof(GLushort) + 2 * sizeof(GLuint);
+            this->indexSize = sizeof(GLushort);
+            break;
+        default :
+            this->vertexStride = 3 * sizeof(float);
+            this->indexSize = sizeof(GLuint);
+            break;
+    }
+    this->commandBuffer.setIndexType((this->indexSize == sizeof(GLushort)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+    this->VAO = 0;
+    this->VBO = 0;
+    this->EBO = 0;
+
+    this->createBuffers(GEOMETRY_ARENA_INITIAL_VERTICES, GEOMETRY_ARENA_INITIAL_INDICES);
+
+    // The whole buffers are free
+    block.offset = 0;
+    block.count = this->vertexCapacity;
+    this->freeVertexBlocks.push_back(block);
+    block.count = this->indexCapacity;
+    this->freeIndexBlocks.push_back(block);
+}
+
+
+// =======
+// Methods
+
+GeometryArena& GeometryArena::getArena(VertexFormat format)
+{
+    if(arenas[format] == NULL)
+    {
+        arenas[format] = new GeometryArena(format);
+    }
+
+    return *arenas[format];
+}
+
+
+GLuint GeometryArena::allocate(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount)
+{
+    GeometryRange range;
+    GLuint vertexOffset = 0;
+    GLuint indexOffset = 0;
+    GLuint handle = 0;
+
+    // Find free blocks, grow the buffers if there is none
+    if(!allocateBlock(this->freeVertexBlocks, vertexCount, &vertexOffset) )
+    {
+        this->grow(vertexCount, 0);
+        allocateBlock(this->freeVertexBlocks, vertexCount, &vertexOffset);
+    }
+    if(!allocateBlock(this->freeIndexBlocks, indexCount, &indexOffset))
+    {
+        this->grow(0, indexCount);
+        allocateBlock(this->freeIndexBlocks, indexCount, &indexOffset);
+    }
+
+    // Upload the data (the element buffer binding is part of the vertex array state)
+    this->bind();
+    RenderState::bindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glCheckError();
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(vertexOffset) * this->vertexStride, static_cast<GLsizeiptr>(vertexCount) * this->vertexStride, vertices);
+    glCheckError();
+    if(indexCount > 0)
+    {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(indexOffset) * this->indexSize, static_cast<GLsizeiptr>(indexCount) * this->indexSize, indices);
+        glCheckError();
+    }
+
+    range.baseVertex = static_cast<GLint>(vertexOffset);
+    range.firstIndex = indexOffset;
+    range.vertexCount = vertexCount;
+    range.indexCount = indexCount;
+
+    // Reuse a released handle when possible
+    if(!this->freeHandles.empty())
+    {
+        handle = this->freeHandles.back();
+        this->freeHandles.pop_back();
+        this->allocations[handle] = range;
+        this->allocationUsed[handle] = 1;
+    }
+    else
+    {
+        handle = static_cast<GLuint>(this->allocations.size());
+        this->allocations.push_back(range);
+        this->allocationUsed.push_back(1);
+    }
+
+    return handle;
+}
+
+
+void GeometryArena::release(GLuint handle)
+{
+    const GeometryRange& range = this->allocations[handle];
+
+    if(!this->allocationUsed[handle])
+    {
+        return;
+    }
+
+    releaseBlock(this->freeVertexBlocks, static_cast<GLuint>(range.baseVertex), range.vertexCount);
+    releaseBlock(this->freeIndexBlocks, range.firstIndex, range.indexCount);
+    this->allocationUsed[handle] = 0;
+    this->freeHandles.push_back(handle);
+}
+
+
+const GeometryRange& GeometryArena::getRange(GLuint handle) const
+{
+    return this->allocations[handle];
+}
+
+
+void GeometryArena::bind()
+{
+    if(RenderState::bindVertexArray(this->VAO))
+    {
+        statistics.vertexArrayBinds++;
+    }
+}
+
+
+void GeometryArena::submit()
+{
+    this->bind();
+    this->commandBuffer.submit();
+}
+
+
+void GeometryArena::compact()
+{
+    GLuint oldVBO = this->VBO;
+    GLuint oldEBO = this->EBO;
+    std::vector<GLuint> order;
+    GLuint vertexOffset = 0;
+    GLuint indexOffset = 0;
+
+    for(GLuint i=0; i<this->allocations.size(); i++)
+    {
+        if(this->allocationUsed[i])
+        {
+            order.push_back(i);
+        }
+    }
+
+    // Copy the allocations one after the other in new buffers
+    glGenBuffers(1, &this->VBO);
+    glGenBuffers(1, &this->EBO);
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(this->vertexCapacity) * this->vertexStride, NULL, GL_STATIC_DRAW);
+    RenderState::bindBuffer(GL_COPY_READ_BUFFER, oldVBO);
+    std::sort(order.begin(), order.end(), [this](GLuint a, GLuint b) { return this->allocations[a].baseVertex < this->allocations[b].baseVertex; });
+    for(size_t i=0; i<order.size(); i++)
+    {
+        GeometryRange& range = this->allocations[order[i]];
+        if(range.vertexCount > 0)
+        {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.baseVertex) * this->vertexStride, static_cast<GLintptr>(vertexOffset) * this->vertexStride, static_cast<GLsizeiptr>(range.vertexCount) * this->vertexStride);
+        }
+        range.baseVertex = static_cast<GLint>(vertexOffset);
+        vertexOffset += range.vertexCount;
+    }
+    glCheckError();
+
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(this->indexCapacity) * this->indexSize, NULL, GL_STATIC_DRAW);
+    RenderState::bindBuffer(GL_COPY_READ_BUFFER, oldEBO);
+    std::sort(order.begin(), order.end(), [this](GLuint a, GLuint b) { return this->allocations[a].firstIndex < this->allocations[b].firstIndex; });
+    for(size_t i=0; i<order.size(); i++)
+    {
+        GeometryRange& range = this->allocations[order[i]];
+        if(range.indexCount > 0)
+        {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.firstIndex) * this->indexSize, static_cast<GLintptr>(indexOffset) * this->indexSize, static_cast<GLsizeiptr>(range.indexCount) * this->indexSize);
+        }
+        range.firstIndex = indexOffset;
+        indexOffset += range.indexCount;
+    }
+    glCheckError();
+
+    RenderState::deleteBuffers(1, &oldVBO);
+    RenderState::deleteBuffers(1, &oldEBO);
+    this->setupVertexFormat();
+
+    // Only the end of the buffers is free
+    this->freeVertexBlocks.clear();
+    this->freeIndexBlocks.clear();
+    releaseBlock(this->freeVertexBlocks, vertexOffset, this->vertexCapacity - vertexOffset);
+    releaseBlock(this->freeIndexBlocks, indexOffset, this->indexCapacity - indexOffset);
+}
+
+
+void GeometryArena::compactAll()
+{
+    for(unsigned int i=0; i<VERTEX_FORMAT_COUNT; i++)
+    {
+        if(arenas[i] != NULL)
+        {
+            arenas[i]->compact();
+        }
+    }
+}
+
+
+void GeometryArena::resetStatistics()
+{
+    statistics.vertexArrayBinds = 0;
+    DrawCommandBuffer::resetStatistics();
+}
+
+
+void GeometryArena::printStatistics()
+{
+    std::cout << "Geometry submission : " << statistics.vertexArrayBinds << " vertex array binds, "
+              << DrawCommandBuffer::statistics.multiDrawCalls << " multi-draw calls, "
+              << DrawCommandBuffer::statistics.drawCommands << " draw commands ("
+              << (GLEW_ARB_multi_draw_indirect ? "indirect" : "base vertex") << ")" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+void GeometryArena::createBuffers(GLuint vertexCapacity, GLuint indexCapacity)
+{
+    this->vertexCapacity = vertexCapacity;
+    this->indexCapacity = indexCapacity;
+
+    if(this->VAO == 0)
+    {
+        glGenVertexArrays(1, &this->VAO);
+        glCheckError();
+    }
+    glGenBuffers(1, &this->VBO);
+    glCheckError();
+    glGenBuffers(1, &this->EBO);
+    glCheckError();
+
+    // Memory allocation of the buffers
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(vertexCapacity) * this->vertexStride, NULL, GL_STATIC_DRAW);
+    glCheckError();
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(indexCapacity) * this->indexSize, NULL, GL_STATIC_DRAW);
+    glCheckError();
+
+    this->setupVertexFormat();
+}
+
+
+void GeometryArena::setupVertexFormat()
+{
+    this->bind();
+
+    // Link the buffers with the vertex array
+    RenderState::bindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glCheckError();
+    RenderState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
+    glCheckError();
+
+    if(this->format == COMPRESSED_MESH_VERTEX_FORMAT)
+    {
+        // Quantized position, decoded with the bounding box of the model in the vertex shader
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, this->vertexStride, (void*)0);
+        glCheckError();
+        glEnableVertexAttribArray(0);
+        glCheckError();
+        // Octahedral normal, decoded in the vertex shader
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, this->vertexStride, (void*)(4 * sizeof(GLushort)));
+        glCheckError();
+        glEnableVertexAttribArray(1);
+        glCheckError();
+        // Texture coordinates
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, this->vertexStride, (void*)(4 * sizeof(GLushort) + sizeof(GLuint)));
+        glCheckError();
+        glEnableVertexAttribArray(2);
+        glCheckError();
+        return;
+    }
+
+    // Tell how to read position of each vertex in the VBO
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, this->vertexStride, (void*)0);
+    glCheckError();
+    glEnableVertexAttribArray(0);
+    glCheckError();
+
+    if(this->format == MESH_VERTEX_FORMAT)
+    {
+        // Tell how to read normal of each vertex in the VBO
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, this->vertexStride, (void*)(3 * sizeof(float)));
+        glCheckError();
+        glEnableVertexAttribArray(1);
+        glCheckError();
+        // Tell how to read texture coordinates of each vertex in the VBO
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, this->vertexStride, (void*)(6 * sizeof(float)));
+        glCheckError();
+        glEnableVertexAttribArray(2);
+        glCheckError();
+    }
+}
+
+
+void GeometryArena::grow(GLuint vertexCount, GLuint indexCount)
+{
+    GLuint oldVBO = this->VBO;
+    GLuint oldEBO = this->EBO;
+    GLuint oldVertexCapacity = this->vertexCapacity;
+    GLuint oldIndexCapacity = this->indexCapacity;
+    GLuint newVertexCapacity = oldVertexCapacity;
+    GLuint newIndexCapacity = oldIndexCapacity;
+
+    if(vertexCount > 0)
+    {
+        newVertexCapacity = std::max(oldVertexCapacity * 2, oldVertexCapacity + vertexCount);
+    }
+    if(indexCount > 0)
+    {
+        newIndexCapacity = std::max(oldIndexCapacity * 2, oldIndexCapacity + indexCount);
+    }
+
+    // New buffers with the content of the old ones at the same place
+    this->createBuffers(newVertexCapacity, newIndexCapacity);
+    RenderState::bindBuffer(GL_COPY_READ_BUFFER, oldVBO);
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->VBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldVertexCapacity) * this->vertexStride);
+    glCheckError();
+    RenderState::bindBuffer(GL_COPY_READ_BUFFER, oldEBO);
+    RenderState::bindBuffer(GL_COPY_WRITE_BUFFER, this->EBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldIndexCapacity) * this->indexSize);
+    glCheckError();
+    RenderState::deleteBuffers(1, &oldVBO);
+    RenderState::deleteBuffers(1, &oldEBO);
+
+    // The new end of the buffers is free
+    releaseBlock(this->freeVertexBlocks, oldVertexCapacity, newVertexCapacity - oldVertexCapacity);
+    releaseBlock(this->freeIndexBlocks, oldIndexCapacity, newIndexCapacity - oldIndexCapacity);
+}
+
+
+bool GeometryArena::allocateBlock(std::vector<GeometryBlock>& freeBlocks, GLuint count, GLuint* offset)
+{
+    *offset = 0;
+    if(count == 0)
+    {
+        return true;
+    }
+
+    for(size_t i=0; i<freeBlocks.size(); i++)
+    {
+        if(freeBlocks[i].count >= count)
+        {
+            *offset = freeBlocks[i].offset;
+            freeBlocks[i].offset += count;
+            freeBlocks[i].count -= count;
+            if(freeBlocks[i].count == 0)
+            {
+                freeBlocks.erase(freeBlocks.begin() + i);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void GeometryArena::releaseBlock(std::vector<GeometryBlock>& freeBlocks, GLuint offset, GLuint count)
+{
+    GeometryBlock block;
+    std::vector<GeometryBlock>::iterator it;
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    // Free blocks are sorted by offset
+    block.offset = offset;
+    block.count = count;
+    it = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), block, [](const GeometryBlock& a, const GeometryBlock& b) { return a.offset < b.offset; });
+    it = freeBlocks.insert(it, block);
+
+    // Merge with the next block
+    if(it + 1 != freeBlocks.end() && it->offset + it->count == (it + 1)->offset)
+    {
+        it->count += (it + 1)->count;
+        freeBlocks.erase(it + 1);
+    }
+    // Merge with the previous block
+    if(it != freeBlocks.begin() && (it - 1)->offset + (it - 1)->count == it->offset)
+    {
+        (it - 1)->count += it->count;
+        freeBlocks.erase(it);
+    }
+}
@@ -0,0 +1,241 @@
+#ifndef __GEOMETRYARENA_H
+#define __GEOMETRYARENA_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// Redundant state filtering
+#include "RenderState.h"
+
+// Draw commands
+#include "DrawCommandBuffer.h"
+
+
+// Initial number of vertices of an arena
+#define GEOMETRY_ARENA_INITIAL_VERTICES 65536
+// Initial number of indices of an arena
+#define GEOMETRY_ARENA_INITIAL_INDICES 262144
+
+
+/**
+ * @brief The VertexFormat enum list the vertex layouts stored in the arenas
+ */
+enum VertexFormat
+{
+    /// position (vec3), normal (vec3), texture coordinates (vec2) : Vertex and hmapVertex
+    MESH_VERTEX_FORMAT,
+    /// position (vec3) : billboards and skybox
+    POSITION_VERTEX_FORMAT,
+    /// quantized position (unorm16 x4), octahedral normal (snorm16 x2), texture coordinates (half x2), 16-bit indices : CompressedVertex
+    COMPRESSED_MESH_VERTEX_FORMAT,
+    /// Number of vertex formats
+    VERTEX_FORMAT_COUNT
+};
+
+
+/**
+ * @brief The GeometryBlock struct describe a range of elements in a buffer of an arena
+ */
+struct GeometryBlock
+{
+    /// First element of the range
+    GLuint offset;
+    /// Number of elements of the range
+    GLuint count;
+};
+
+
+/**
+ * @brief The GeometryRange struct describe where the geometry of an object is stored in an arena
+ */
+struct GeometryRange
+{
+    /// First vertex of the object in the vertex buffer (indices of the object start at 0)
+    GLint baseVertex;
+    /// First index of the object in the index buffer
+    GLuint firstIndex;
+    /// Number of vertices of the object
+    GLuint vertexCount;
+    /// Number of indices of the object
+    GLuint indexCount;
+};
+
+
+/**
+ * @brief The GeometryArenaStatistics struct count the vertex array binds since the last reset
+ */
+struct GeometryArenaStatistics
+{
+    /// Number of glBindVertexArray calls
+    unsigned int vertexArrayBinds;
+};
+
+
+/**
+ * @brief The GeometryArena class store the geometry of all objects sharing a vertex format in one vertex buffer and one index buffer.
+ *        Objects get a handle on a sub-allocation, freed blocks are reused and the arena can be compacted.
+ */
+class GeometryArena
+{
+// Attributes
+private:
+    /// Vertex format of the arena
+    VertexFormat format;
+    /// Size of a vertex, in bytes
+    GLsizei vertexStride;
+    /// Size of an index, in bytes
+    GLsizei indexSize;
+
+    // Buffers
+    GLuint VAO;
+    GLuint VBO;
+    GLuint EBO;
+    GLuint vertexCapacity;
+    GLuint indexCapacity;
+
+    // Sub-allocations
+    std::vector<GeometryBlock> freeVertexBlocks;
+    std::vector<GeometryBlock> freeIndexBlocks;
+    std::vector<GeometryRange> allocations;
+    std::vector<char> allocationUsed;
+    std::vector<GLuint> freeHandles;
+
+    /// One arena per vertex format, created on first use
+    static GeometryArena* arenas[VERTEX_FORMAT_COUNT];
+
+public:
+    /// Draw commands waiting for submission with this arena
+    DrawCommandBuffer commandBuffer;
+    /// Vertex array binds since the last call to resetStatistics
+    static GeometryArenaStatistics statistics;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief GeometryArena create the buffers of an arena
+     * @param format vertex format of the arena
+     */
+    GeometryArena(VertexFormat format);
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getArena return the arena of the given vertex format (the OpenGL context must exist)
+     * @param format vertex format
+     * @return
+     */
+    static GeometryArena& getArena(VertexFormat format);
+
+
+    /**
+     * @brief allocate store the geometry of an object in the arena
+     * @param vertices vertex data, in the format of the arena
+     * @param vertexCount number of vertices
+     * @param indices indices of the object, starting at 0 (can be NULL with indexCount = 0)
+     * @param indexCount number of indices
+     * @return handle of the allocation
+     */
+    GLuint allocate(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount);
+
+
+    /**
+     * @brief release free the geometry of an object
+     * @param handle handle of the allocation
+     */
+    void release(GLuint handle);
+
+
+    /**
+     * @brief getRange return where the geometry of an object is stored (it can move when the arena is compacted)
+     * @param handle handle of the allocation
+     * @return
+     */
+    const GeometryRange& getRange(GLuint handle) const;
+
+
+    /**
+     * @brief bind bind the vertex array of the arena if it is not already bound
+     */
+    void bind();
+
+
+    /**
+     * @brief submit bind the arena and draw its waiting commands
+     */
+    void submit();
+
+
+    /**
+     * @brief compact move the allocations at the beginning of the buffers to merge the free blocks
+     */
+    void compact();
+
+
+    /**
+     * @brief compactAll compact every created arena
+     */
+    static void compactAll();
+
+
+    /**
+     * @brief resetStatistics reset the bind counters (called at the beginning of each frame)
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the vertex array binds and multi-draw submissions of the last frame
+     */
+    static void printStatistics();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief createBuffers create the vertex array and buffers with the given capacities
+     */
+    void createBuffers(GLuint vertexCapacity, GLuint indexCapacity);
+
+
+    /**
+     * @brief setupVertexFormat describe the vertex format of the arena in its vertex array
+     */
+    void setupVertexFormat();
+
+
+    /**
+     * @brief grow reallocate the buffers so that the given number of vertices and indices can be allocated
+     */
+    void grow(GLuint vertexCount, GLuint indexCount);
+
+
+    /**
+     * @brief allocateBlock find a free block of the given size (first fit) and remove it from the free list
+     * @return false if no free block is big enough
+     */
+    static bool allocateBlock(std::vector<GeometryBlock>& freeBlocks, GLuint count, GLuint* offset);
+
+
+    /**
+     * @brief releaseBlock add a block to the free list and merge it with its neighbours
+     */
+    static void releaseBlock(std::vector<GeometryBlock>& freeBlocks, GLuint offset, GLuint count);
+
+};
+
+
+#endif
@@ -0,0 +1,64 @@
+#include "GeometryRetention.h"
+
+
+GeometryRetentionPolicy GeometryRetention::policies[GEOMETRY_CATEGORY_COUNT] = { MODEL_GEOMETRY_RETENTION, HEIGHT_MAP_GEOMETRY_RETENTION, SKYBOX_GEOMETRY_RETENTION, BILLBOARD_GEOMETRY_RETENTION };
+GeometryRetentionStatistics GeometryRetention::statistics[GEOMETRY_CATEGORY_COUNT] = {};
+
+
+// =======
+// Methods
+
+GeometryRetentionPolicy GeometryRetention::getPolicy(GeometryCategory category)
+{
+    return policies[category];
+}
+
+
+void GeometryRetention::setPolicy(GeometryCategory category, GeometryRetentionPolicy policy)
+{
+    policies[category] = policy;
+}
+
+
+void GeometryRetention::addResource(GeometryCategory category, size_t retainedBytes, size_t releasedBytes)
+{
+    statistics[category].resources++;
+    statistics[category].retainedBytes += retainedBytes;
+    statistics[category].releasedBytes += releasedBytes;
+}
+
+
+void GeometryRetention::printStatistics()
+{
+    const char* categoryNames[GEOMETRY_CATEGORY_COUNT] = { "models", "height maps", "skyboxes", "billboards" };
+    size_t retainedBytes = 0;
+    size_t releasedBytes = 0;
+
+    for(unsigned int i=0; i<GEOMETRY_CATEGORY_COUNT; i++)
+    {
+        std::cout << "Geometry retention : " << categoryNames[i] << " (" << getPolicyName(policies[i]) << ") : " << statistics[i].resources << " resources, "
+                  << statistics[i].retainedBytes / 1024 << " KB retained, " << statistics[i].releasedBytes / 1024 << " KB released" << std::endl;
+        retainedBytes += statistics[i].retainedBytes;
+        releasedBytes += statistics[i].releasedBytes;
+    }
+    std::cout << "Geometry retention : " << retainedBytes / 1024 << " KB retained in RAM, " << releasedBytes / 1024 << " KB released" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+const char* GeometryRetention::getPolicyName(GeometryRetentionPolicy policy)
+{
+    switch(policy)
+    {
+        case DISCARD_GEOMETRY :
+            return "discard";
+        case KEEP_POSITIONS :
+            return "positions";
+        case KEEP_GEOMETRY :
+            return "keep";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,141 @@
+#ifndef __GEOMETRYRETENTION_H
+#define __GEOMETRYRETENTION_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+
+
+/**
+ * @brief The GeometryRetentionPolicy enum list what a resource keeps in RAM of its geometry once it is copied in the geometry arena
+ */
+enum GeometryRetentionPolicy
+{
+    /// Nothing is kept, the geometry only lives in video memory
+    DISCARD_GEOMETRY,
+    /// Only the positions and the full resolution indices are kept (picking, collisions)
+    KEEP_POSITIONS,
+    /// Every vertex attribute and every index is kept
+    KEEP_GEOMETRY
+};
+
+
+/**
+ * @brief The GeometryCategory enum list the kinds of resources whose geometry is retained with their own policy
+ */
+enum GeometryCategory
+{
+    MODEL_GEOMETRY,
+    HEIGHT_MAP_GEOMETRY,
+    SKYBOX_GEOMETRY,
+    BILLBOARD_GEOMETRY,
+    GEOMETRY_CATEGORY_COUNT
+};
+
+
+// Default policy of each category (the models are picked with their own triangle hierarchy, so they do not need their geometry)
+#define MODEL_GEOMETRY_RETENTION DISCARD_GEOMETRY
+#define HEIGHT_MAP_GEOMETRY_RETENTION DISCARD_GEOMETRY
+#define SKYBOX_GEOMETRY_RETENTION DISCARD_GEOMETRY
+#define BILLBOARD_GEOMETRY_RETENTION DISCARD_GEOMETRY
+
+
+/**
+ * @brief The GeometryRetentionStatistics struct count the CPU memory of the geometry of the resources of a category, once uploaded
+ */
+struct GeometryRetentionStatistics
+{
+    /// Number of resources uploaded since the start
+    unsigned int resources;
+    /// Memory still used in RAM by their geometry, in bytes
+    size_t retainedBytes;
+    /// Memory freed after their upload, in bytes
+    size_t releasedBytes;
+};
+
+
+/**
+ * @brief The GeometryRetention class hold the retention policy of each category of resources and count the memory they keep.
+ *        Resources apply the policy of their category right after copying their geometry in the geometry arena.
+ */
+class GeometryRetention
+{
+// Attributes
+private:
+    static GeometryRetentionPolicy policies[GEOMETRY_CATEGORY_COUNT];
+
+public:
+    /// Memory retained by each category
+    static GeometryRetentionStatistics statistics[GEOMETRY_CATEGORY_COUNT];
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getPolicy return the retention policy of a category
+     */
+    static GeometryRetentionPolicy getPolicy(GeometryCategory category);
+
+
+    /**
+     * @brief setPolicy change the retention policy of a category (applied to the resources uploaded afterwards)
+     */
+    static void setPolicy(GeometryCategory category, GeometryRetentionPolicy policy);
+
+
+    /**
+     * @brief addResource count the memory kept and freed by a resource after its upload
+     * @param category category of the resource
+     * @param retainedBytes memory still used by its geometry, in bytes
+     * @param releasedBytes memory freed, in bytes
+     */
+    static void addResource(GeometryCategory category, size_t retainedBytes, size_t releasedBytes);
+
+
+    /**
+     * @brief printStatistics print the policy and the retained and released memory of each category
+     */
+    static void printStatistics();
+
+
+    /**
+     * @brief release free the memory of a vector (clear alone keeps its capacity)
+     * @return the memory freed, in bytes
+     */
+    template<typename T>
+    static size_t release(std::vector<T>& data)
+    {
+        size_t bytes = data.capacity() * sizeof(T);
+
+        std::vector<T>().swap(data);
+
+        return bytes;
+    }
+
+
+    /**
+     * @brief getBytes return the memory used by a vector, in bytes
+     */
+    template<typename T>
+    static size_t getBytes(const std::vector<T>& data)
+    {
+        return data.capacity() * sizeof(T);
+    }
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief getPolicyName return the name of a policy
+     */
+    static const char* getPolicyName(GeometryRetentionPolicy policy);
+};
+
+
+#endif
@@ -50,6 +50,13 @@ float HeightMap::getHeightValue(int x, int y)
 void HeightMap::loadHeightMap(std::string texturePath)
 {
     this->heightMapTexture = SOIL_load_image(texturePath.c_str(), &this->hMapWidth, &this->hMapHeight, 0, SOIL_LOAD_L);
+    if(this->heightMapTexture == NULL)
+    {
+        std::cerr << "[WARNING] in HeightMap, could not load height map at path : " << texturePath.c_str() << std::endl;
+        // The map is left without vertices
+        this->hMapWidth = 0;
+        this->hMapHeight = 0;
+    }
 }
 
 
@@ -107,6 +114,7 @@ void HeightMap::verticesNormalGeneration()
 
 void HeightMap::setupMap(int precision)
 {
+    size_t imageBytes = static_cast<size_t>(this->hMapWidth) * this->hMapHeight;
     hmapVertex vertex;
     GLuint vertexTopLeftPosition = 0;
     GLuint vertexTopRightPosition = 0;
@@ -125,6 +133,13 @@ void HeightMap::setupMap(int precision)
         }
     }
 
+    // The heights are in the vertices now
+    if(this->heightMapTexture != NULL)
+    {
+        SOIL_free_image_data(this->heightMapTexture);
+        this->heightMapTexture = NULL;
+    }
+
     this->hMapHeight = this->hMapHeight/precision;
     this->hMapWidth = this->hMapWidth/precision;
 
@@ -153,83 +168,69 @@ void HeightMap::setupMap(int precision)
 
     this->verticesNormalGeneration();
 
-    // Declare VAO, VBO and EBO
-    glGenVertexArrays(1, &this->VAO);
-    glCheckError();
-    glGenBuffers(1, &this->VBO);
-    glCheckError();
-    glGenBuffers(1, &this->EBO);
-    glCheckError();
+    // Copy the vertices and indices in the geometry arena (same layout as the meshes)
+    this->geometryHandle = GeometryArena::getArena(MESH_VERTEX_FORMAT).allocate(this->vertices.data(), static_cast<GLuint>(this->vertices.size()), this->indices.data(), static_cast<GLuint>(this->indices.size()));
 
-    // Memory allocation for VBO and EBO linked with the VAO
-    glBindVertexArray(this->VAO);
-    glCheckError();
-
-    // Link the VBO with the vertices vector
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glCheckError();
-    glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(hmapVertex), this->vertices.data(), GL_STATIC_DRAW);
-    glCheckError();
+    this->releaseGeometry(GeometryRetention::getPolicy(HEIGHT_MAP_GEOMETRY), imageBytes);
+}
 
-    // Link the EBO with the indices vector
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
-    glCheckError();
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), this->indices.data(), GL_STATIC_DRAW);
-    glCheckError();
 
-    // Tell how to read position of each vertex in the VBO
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(hmapVertex), (void*)0);
-    glCheckError();
-    glEnableVertexAttribArray(0);
-    glCheckError();
-    // Tell how to read position of each vertex in the VBO
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(hmapVertex), (void*)offsetof(hmapVertex, normal));
-    glCheckError();
-    glEnableVertexAttribArray(1);
-    glCheckError();
-    // Tell how to read texture coordinates of each vertex in the VBO
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(hmapVertex), (void*)offsetof(hmapVertex, textCoords));
-    glCheckError();
-    glEnableVertexAttribArray(2);
-    glCheckError();
+void HeightMap::releaseGeometry(GeometryRetentionPolicy policy, size_t imageBytes)
+{
+    size_t releasedBytes = imageBytes;
 
+    if(policy == KEEP_POSITIONS)
+    {
+        this->positions.resize(this->vertices.size());
+        for(unsigned int i=0; i<this->vertices.size(); i++)
+        {
+            this->positions[i] = this->vertices[i].position;
+        }
+        releasedBytes += GeometryRetention::release(this->vertices);
+    }
+    else if(policy == DISCARD_GEOMETRY)
+    {
+        releasedBytes += GeometryRetention::release(this->vertices);
+        releasedBytes += GeometryRetention::release(this->indices);
+    }
 
-    glBindVertexArray(0);
-    glCheckError();
+    GeometryRetention::addResource(HEIGHT_MAP_GEOMETRY, GeometryRetention::getBytes(this->vertices) + GeometryRetention::getBytes(this->indices) + GeometryRetention::getBytes(this->positions), releasedBytes);
 }
 
 
 void HeightMap::colorTextureSetUp(std::string texturePath)
 {
-    // Load texture
-    this->colorTexture = SOIL_load_image(texturePath.c_str(), &this->colorTextWidth, &this->colorTextHeight, 0, SOIL_LOAD_RGB);
-    //std::cerr << "SOIL_LOADING error : " << SOIL_last_result() << std::endl;
+    // Repeated color texture
+    MipGenerationSettings mipSettings;
+    CompressedTexture texture;
 
-    // Generate and bind texture
-    if(this->colorTexture != NULL)
-    {
-        // Generate the texture in OpenGL
-        glGenTextures(1, &this->colorTextureID);
-
-        // Bind the texture in OpenGL
-        glBindTexture(GL_TEXTURE_2D, this->colorTextureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, this->colorTextWidth, this->colorTextHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, this->colorTexture);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        this->colorTextureHasBeenSet = true;
-    }
-    else
+    // Compressed or cached version of the texture with its mip levels, computed from the source image the first time.
+    // It is read before the texture is created, so that an image which can not be loaded leaves no empty texture on the map
+    if(!CompressedTexture::readTexture(texturePath, mipSettings, texture))
     {
         std::cerr << "[WARNING] in HeightMap, could not load texture at path : " << texturePath.c_str() << std::endl;
-
+        // The texture coordinates of the map are computed modulo the size of the texture
+        this->colorTextWidth = 1;
+        this->colorTextHeight = 1;
+        return;
     }
 
-    SOIL_free_image_data(this->colorTexture);
+    // Generate the texture in OpenGL
+    glGenTextures(1, &this->colorTextureID);
+
+    // Bind the texture in OpenGL
+    RenderState::bindTexture(GL_TEXTURE_2D, this->colorTextureID);
+    CompressedTexture::uploadTexture(texture, GL_TEXTURE_2D);
+    this->colorTextWidth = texture.width;
+    this->colorTextHeight = texture.height;
+
+    // Set texture parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glCheckError();
+    this->colorTextureHasBeenSet = true;
 }
 
 
@@ -246,20 +247,15 @@ void HeightMap::draw(Shader& shader, std::string UniformaNameInShader, hmapDrawT
         }
         else
         {
-            // Add the map texture
-            glActiveTexture(GL_TEXTURE0);
-
             // Retrieve the uniform
-            uniformColorTextureID = glGetUniformLocation(shader._shaderId, UniformaNameInShader.c_str());
-            glCheckError();
+            uniformColorTextureID = shader.getUniform(UniformaNameInShader);
             // If the uniform eists in the shader
-            if(uniformColorTextureID != -1)
+            if(uniformColorTextureID != SHADER_INVALID_UNIFORM)
             {
                 // Bind the texture
-                glUniform1i(uniformColorTextureID, 0);
-                glCheckError();
-                glBindTexture(GL_TEXTURE_2D, this->colorTextureID);
+                shader.setInt(uniformColorTextureID, 0);
                 glCheckError();
+                RenderState::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, this->colorTextureID);
             }
             else if(!this->messageAlreadySpread) // If not
             {
@@ -271,12 +267,11 @@ void HeightMap::draw(Shader& shader, std::string UniformaNameInShader, hmapDrawT
     else if(drawType == color)
     {
         // Retrieve the uniform
-        uniformColorTextureID = glGetUniformLocation(shader._shaderId, UniformaNameInShader.c_str());
-        glCheckError();
+        uniformColorTextureID = shader.getUniform(UniformaNameInShader);
         // If the uniform eists in the shader
-        if(uniformColorTextureID != -1)
+        if(uniformColorTextureID != SHADER_INVALID_UNIFORM)
         {
-            shader.setVec3(UniformaNameInShader.c_str(), this->defaultColor);
+            shader.setVec3(uniformColorTextureID, this->defaultColor);
         }
         else if(!this->messageAlreadySpread) // If not
         {
@@ -287,12 +282,14 @@ void HeightMap::draw(Shader& shader, std::string UniformaNameInShader, hmapDrawT
 
 
     // draw mesh
-    glBindVertexArray(this->VAO);
-    glCheckError();
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, (void*)0);
-    glCheckError();
-    glBindVertexArray(0);
-
-    glActiveTexture(GL_TEXTURE0);
+    GeometryArena& arena = GeometryArena::getArena(MESH_VERTEX_FORMAT);
+    const GeometryRange& range = arena.getRange(this->geometryHandle);
+    arena.commandBuffer.addCommand(range.indexCount, range.firstIndex, range.baseVertex);
+    arena.submit();
 }
 
+
+GLuint HeightMap::getColorTextureID() const
+{
+    return this->colorTextureHasBeenSet ? this->colorTextureID : 0;
+}
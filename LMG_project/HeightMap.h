@@ -37,6 +37,15 @@
 // Shader
 #include "Shader.h"
 
+// Geometry storage
+#include "GeometryArena.h"
+
+// Compressed textures
+#include "CompressedTexture.h"
+
+// Geometry retention
+#include "GeometryRetention.h"
+
 
 struct hmapVertex
 {
@@ -59,13 +68,12 @@ private:
     // Data
     std::vector<hmapVertex>vertices;
     std::vector<GLuint> indices;
-    GLuint VAO;
-    GLuint VBO;
-    GLuint EBO;
+    // Positions of the vertices, kept instead of the vertices by the KEEP_POSITIONS policy
+    std::vector<glm::vec3> positions;
+    GLuint geometryHandle;
 
-    // Texture and height map
+    // Texture and height map (the height map image is freed once the vertices are created)
     unsigned char* heightMapTexture;
-    unsigned char* colorTexture;
     GLuint colorTextureID;
     bool colorTextureHasBeenSet;
 
@@ -150,6 +158,14 @@ private:
     void setupMap(int precision);
 
 
+    /**
+     * @brief releaseGeometry free the vertices and indices kept in RAM once the map is in the geometry arena
+     * @param policy what to keep of the geometry
+     * @param imageBytes size of the height map image, already freed
+     */
+    void releaseGeometry(GeometryRetentionPolicy policy, size_t imageBytes);
+
+
 // Methods
 public:
 
@@ -161,6 +177,12 @@ public:
     void draw(Shader& shader, std::string UniformaNameInShader, enum hmapDrawType drawType);
 
 
+    /**
+     * @brief getColorTextureID return the id in OpenGL of the color texture (0 when it is not set)
+     */
+    GLuint getColorTextureID() const;
+
+
 };
 
 
@@ -0,0 +1,113 @@
+#include "ImportBenchmark.h"
+
+
+// =======
+// Methods
+
+void ImportBenchmark::run()
+{
+    aiScene* scene = createScene();
+    Model3D model;
+    ModelImport modelImport;
+    AllocationStatistics importStart;
+    AllocationStatistics importEnd;
+    std::chrono::high_resolution_clock::time_point start;
+    double time;
+
+    // Meshes created as from a scene read by assimp, without the reading of the file
+    start = std::chrono::high_resolution_clock::now();
+    importStart = AllocationCounter::getStatistics();
+    model.processScene(scene, modelImport);
+    importEnd = AllocationCounter::getStatistics();
+    time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "ImportBenchmark : " << model.meshes.size() << " meshes (" << IMPORT_BENCHMARK_VERTICES << " vertices, " << IMPORT_BENCHMARK_TRIANGLES
+              << " triangles each) imported in " << time << " ms";
+    if(ALLOCATION_COUNTING)
+    {
+        std::cout << " with " << importEnd.allocations - importStart.allocations << " heap allocations (" << (importEnd.bytes - importStart.bytes) / 1024 << " KB)" << std::endl;
+    }
+    else
+    {
+        std::cout << ", heap allocations not counted (build with the LMG_IMPORT_BENCHMARK option)" << std::endl;
+    }
+
+    delete scene;
+}
+
+
+// =================
+// Auxiliary methods
+
+aiScene* ImportBenchmark::createScene()
+{
+    aiScene* scene = new aiScene();
+    aiNode* child = new aiNode();
+    const unsigned int rootMeshes = IMPORT_BENCHMARK_MESHES / 2;
+
+    // One material without textures, shared by all the meshes
+    scene->mNumMaterials = 1;
+    scene->mMaterials = new aiMaterial*[1];
+    scene->mMaterials[0] = new aiMaterial();
+
+    scene->mNumMeshes = IMPORT_BENCHMARK_MESHES;
+    scene->mMeshes = new aiMesh*[IMPORT_BENCHMARK_MESHES];
+    for(unsigned int i=0; i<IMPORT_BENCHMARK_MESHES; i++)
+    {
+        aiMesh* mesh = new aiMesh();
+
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        mesh->mMaterialIndex = 0;
+        mesh->mNumVertices = IMPORT_BENCHMARK_VERTICES;
+        mesh->mVertices = new aiVector3D[IMPORT_BENCHMARK_VERTICES];
+        mesh->mNormals = new aiVector3D[IMPORT_BENCHMARK_VERTICES];
+        mesh->mTextureCoords[0] = new aiVector3D[IMPORT_BENCHMARK_VERTICES];
+        mesh->mNumUVComponents[0] = 2;
+        for(unsigned int j=0; j<IMPORT_BENCHMARK_VERTICES; j++)
+        {
+            mesh->mVertices[j] = aiVector3D(static_cast<float>(j % 50), static_cast<float>(j / 50), static_cast<float>(j % 7));
+            mesh->mNormals[j] = aiVector3D(0.0f, 1.0f, 0.0f);
+            mesh->mTextureCoords[0][j] = aiVector3D((j % 50) / 50.0f, (j / 50) / 60.0f, 0.0f);
+        }
+
+        mesh->mNumFaces = IMPORT_BENCHMARK_TRIANGLES;
+        mesh->mFaces = new aiFace[IMPORT_BENCHMARK_TRIANGLES];
+        for(unsigned int j=0; j<IMPORT_BENCHMARK_TRIANGLES; j++)
+        {
+            aiFace& face = mesh->mFaces[j];
+
+            face.mNumIndices = 3;
+            face.mIndices = new unsigned int[3];
+            for(unsigned int k=0; k<3; k++)
+            {
+                face.mIndices[k] = ((j * 3 + k) * 7) % IMPORT_BENCHMARK_VERTICES;
+            }
+        }
+
+        scene->mMeshes[i] = mesh;
+    }
+
+    // Half of the meshes in the root, the other half in its child
+    scene->mRootNode = new aiNode();
+    scene->mRootNode->mNumMeshes = rootMeshes;
+    scene->mRootNode->mMeshes = new unsigned int[rootMeshes];
+    child->mNumMeshes = IMPORT_BENCHMARK_MESHES - rootMeshes;
+    child->mMeshes = new unsigned int[IMPORT_BENCHMARK_MESHES - rootMeshes];
+    for(unsigned int i=0; i<IMPORT_BENCHMARK_MESHES; i++)
+    {
+        if(i < rootMeshes)
+        {
+            scene->mRootNode->mMeshes[i] = i;
+        }
+        else
+        {
+            child->mMeshes[i - rootMeshes] = i;
+        }
+    }
+    child->mParent = scene->mRootNode;
+    scene->mRootNode->mNumChildren = 1;
+    scene->mRootNode->mChildren = new aiNode*[1];
+    scene->mRootNode->mChildren[0] = child;
+
+    return scene;
+}
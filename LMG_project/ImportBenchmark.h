@@ -0,0 +1,54 @@
+#ifndef __IMPORTBENCHMARK_H
+#define __IMPORTBENCHMARK_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <chrono>
+
+// Assimp
+#include <assimp/scene.h>
+
+// Models
+#include "Model3D.h"
+#include "AllocationCounter.h"
+
+
+// Meshes of the synthetic scene, half of them in a child node of the root
+#define IMPORT_BENCHMARK_MESHES 40
+// Vertices and triangles of each mesh
+#define IMPORT_BENCHMARK_VERTICES 3000
+#define IMPORT_BENCHMARK_TRIANGLES 5000
+
+
+/**
+ * @brief The ImportBenchmark class measure the creation of the meshes of a model from a synthetic assimp scene built in memory :
+ *        the time and the heap allocations of the import, without the reading of a file, the GPU upload nor the levels of detail.
+ *        The allocations are counted when the program is built with the LMG_IMPORT_BENCHMARK option of CMake (ALLOCATION_COUNTING).
+ */
+class ImportBenchmark
+{
+// Methods
+public:
+
+
+    /**
+     * @brief run import the synthetic scene and print the measures
+     */
+    static void run();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief createScene build the synthetic scene, with the same ownership as a scene read by assimp
+     * @return the scene, to delete after the import
+     */
+    static aiScene* createScene();
+};
+
+
+#endif
@@ -0,0 +1,561 @@
+#include "JobSystem.h"
+
+
+JobSystem* JobSystem::system = NULL;
+thread_local int JobSystem::workerIndex = -1;
+
+
+// ===========
+// Constructor
+
+JobDeque::JobDeque() :
+    top(0),
+    bottom(0)
+{
+    for(unsigned int i=0; i<JOB_SYSTEM_QUEUE_SIZE; i++)
+    {
+        this->jobs[i] = NULL;
+    }
+}
+
+
+JobSystem::JobSystem() :
+    activeWorkers(0),
+    backgroundTaskCount(0),
+    sleepingWorkers(0)
+{
+    unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(unsigned int i=0; i<workerCount; i++)
+    {
+        JobWorker* worker = new JobWorker();
+        worker->jobs = new Job[JOB_SYSTEM_MAX_JOBS];
+        worker->nextJob = 0;
+        worker->randomState = 2463534242u + i;
+        worker->executedJobs = 0;
+        worker->stolenJobs = 0;
+        this->workers.push_back(worker);
+    }
+    this->activeWorkers = workerCount;
+
+    // The job system lives as long as the application, so its threads are never joined
+    workerIndex = 0;
+    for(unsigned int i=1; i<workerCount; i++)
+    {
+        this->threads.push_back(std::thread(&JobSystem::runWorker, this, i));
+        this->threads.back().detach();
+    }
+}
+
+
+// =======
+// Methods
+
+bool JobDeque::push(Job* job)
+{
+    long long b = this->bottom.load(std::memory_order_relaxed);
+    long long t = this->top.load(std::memory_order_acquire);
+
+    if(b - t >= JOB_SYSTEM_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    this->jobs[b & (JOB_SYSTEM_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+    // The job is written before the thieves can see it
+    this->bottom.store(b + 1, std::memory_order_release);
+
+    return true;
+}
+
+
+Job* JobDeque::pop()
+{
+    long long b = this->bottom.load(std::memory_order_relaxed) - 1;
+    long long t = 0;
+    Job* job = NULL;
+
+    // The bottom is reserved before the top is read, a thief reading the top afterwards sees it
+    this->bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    t = this->top.load(std::memory_order_relaxed);
+
+    if(t > b)
+    {
+        // Empty
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    job = this->jobs[b & (JOB_SYSTEM_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+    if(t == b)
+    {
+        // Last job : the owner and the thieves race for it on the top
+        if(!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = NULL;
+        }
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+
+Job* JobDeque::steal()
+{
+    long long t = this->top.load(std::memory_order_acquire);
+    long long b = 0;
+    Job* job = NULL;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    b = this->bottom.load(std::memory_order_acquire);
+
+    if(t >= b)
+    {
+        return NULL;
+    }
+
+    job = this->jobs[t & (JOB_SYSTEM_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+    if(!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        // Taken by the owner or by another thief
+        return NULL;
+    }
+
+    return job;
+}
+
+
+bool JobDeque::isEmpty() const
+{
+    return this->bottom.load(std::memory_order_acquire) <= this->top.load(std::memory_order_acquire);
+}
+
+
+JobSystem& JobSystem::getJobSystem()
+{
+    if(system == NULL)
+    {
+        system = new JobSystem();
+    }
+
+    return *system;
+}
+
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return static_cast<unsigned int>(this->workers.size());
+}
+
+
+int JobSystem::getWorkerIndex()
+{
+    return workerIndex;
+}
+
+
+Job* JobSystem::createJob(JobFunction function, Job* parent)
+{
+    Job* job = NULL;
+
+    if(workerIndex < 0)
+    {
+        std::cerr << "[WARNING] in JobSystem::createJob, the calling thread is not a worker of the job system" << std::endl;
+        return NULL;
+    }
+
+    // JOB_SYSTEM_MAX_JOBS is a power of 2
+    JobWorker& worker = *this->workers[workerIndex];
+    job = &worker.jobs[worker.nextJob++ & (JOB_SYSTEM_MAX_JOBS - 1)];
+
+    // The parent cannot finish before its new child
+    if(parent != NULL)
+    {
+        parent->unfinishedJobs++;
+    }
+    job->function = function;
+    job->parent = parent;
+    job->unfinishedJobs = 1;
+
+    return job;
+}
+
+
+void JobSystem::run(Job* job)
+{
+    if(job == NULL)
+    {
+        return;
+    }
+
+    if(!this->workers[workerIndex]->deque.push(job))
+    {
+        this->execute(job);
+        return;
+    }
+    this->wakeWorkers();
+}
+
+
+void JobSystem::wait(const Job* job)
+{
+    Job* next = NULL;
+
+    if(job == NULL)
+    {
+        return;
+    }
+
+    // The waiting thread helps the workers instead of blocking
+    while(!this->isFinished(job))
+    {
+        next = this->getJob(workerIndex);
+        if(next != NULL)
+        {
+            this->execute(next);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+bool JobSystem::isFinished(const Job* job) const
+{
+    return job->unfinishedJobs.load() == 0;
+}
+
+
+void JobSystem::parallelForRange(unsigned int count, unsigned int minimumGrain, const std::function<void(unsigned int, unsigned int)>& function)
+{
+    JobRange range;
+    Job* job = NULL;
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    // No other worker to share with, or a thread which cannot create jobs
+    if(this->workers.size() == 1 || workerIndex < 0)
+    {
+        function(0, count);
+        return;
+    }
+
+    range.function = &function;
+    range.first = 0;
+    range.last = count;
+    range.grain = std::max(std::max(minimumGrain, 1u), count / (this->activeWorkers.load() * JOB_SYSTEM_RANGES_PER_WORKER));
+
+    // The calling worker starts the loop, the halves it splits off are stolen by the others
+    job = this->createJob(parallelForJob, NULL, range);
+    this->execute(job);
+    this->wait(job);
+}
+
+
+void JobSystem::parallelFor(unsigned int count, unsigned int minimumGrain, const std::function<void(unsigned int)>& function)
+{
+    this->parallelForRange(count, minimumGrain, [&function](unsigned int first, unsigned int last)
+    {
+        for(unsigned int i=first; i<last; i++)
+        {
+            function(i);
+        }
+    });
+}
+
+
+void JobSystem::runInBackground(const std::function<void()>& task)
+{
+    if(this->threads.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->backgroundMutex);
+        this->backgroundTasks.push_back(task);
+        this->backgroundTaskCount++;
+    }
+    this->wakeWorkers();
+}
+
+
+void JobSystem::benchmark()
+{
+    const unsigned int batchCount = 16;
+    const unsigned int batchSize = JOB_SYSTEM_MAX_JOBS / 4;
+    const unsigned int itemCount = 1024;
+    std::vector<float> results(itemCount);
+    std::chrono::high_resolution_clock::time_point start;
+    double time = 0.0;
+    double singleWorkerTime = 0.0;
+    JobFunction emptyJob = [](Job&, const void*) {};
+    Job* root = NULL;
+
+    if(workerIndex < 0)
+    {
+        std::cerr << "[WARNING] in JobSystem::benchmark, the calling thread is not a worker of the job system" << std::endl;
+        return;
+    }
+
+    // Scheduling overhead : empty jobs created, run and waited for, in batches which do not reuse the jobs of the ring while they run
+    start = std::chrono::high_resolution_clock::now();
+    for(unsigned int i=0; i<batchCount; i++)
+    {
+        root = this->createJob(emptyJob, NULL);
+        for(unsigned int j=0; j<batchSize; j++)
+        {
+            this->run(this->createJob(emptyJob, root));
+        }
+        this->execute(root);
+        this->wait(root);
+    }
+    time = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Job system : " << time / (batchCount * batchSize) << " ns per empty job (" << this->workers.size() << " workers)" << std::endl;
+
+    // Scaling : the same loop run by 1 to all the workers
+    for(unsigned int activeWorkers=1; activeWorkers<=this->workers.size(); activeWorkers++)
+    {
+        this->activeWorkers = activeWorkers;
+        this->wakeWorkers();
+
+        start = std::chrono::high_resolution_clock::now();
+        this->parallelFor(itemCount, 1, [&results](unsigned int index)
+        {
+            float value = static_cast<float>(index);
+            for(unsigned int i=0; i<20000; i++)
+            {
+                value = std::sqrt(value + 1.0f);
+            }
+            results[index] = value;
+        });
+        time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        singleWorkerTime = (activeWorkers == 1) ? time : singleWorkerTime;
+        std::cout << "    " << activeWorkers << " workers : " << time << " ms (speedup " << singleWorkerTime / std::max(time, 1e-6) << ")" << std::endl;
+    }
+    this->activeWorkers = static_cast<unsigned int>(this->workers.size());
+    this->wakeWorkers();
+}
+
+
+void JobSystem::resetStatistics()
+{
+    for(unsigned int i=0; i<this->workers.size(); i++)
+    {
+        this->workers[i]->executedJobs.store(0, std::memory_order_relaxed);
+        this->workers[i]->stolenJobs.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void JobSystem::printStatistics() const
+{
+    unsigned int executedJobs = 0;
+    unsigned int stolenJobs = 0;
+
+    for(unsigned int i=0; i<this->workers.size(); i++)
+    {
+        executedJobs += this->workers[i]->executedJobs.load(std::memory_order_relaxed);
+        stolenJobs += this->workers[i]->stolenJobs.load(std::memory_order_relaxed);
+    }
+
+    std::cout << "Job system : " << executedJobs << " jobs executed, " << stolenJobs << " stolen, per worker :";
+    for(unsigned int i=0; i<this->workers.size(); i++)
+    {
+        std::cout << " " << this->workers[i]->executedJobs.load(std::memory_order_relaxed);
+    }
+    std::cout << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+void JobSystem::runWorker(unsigned int worker)
+{
+    std::function<void()> task;
+    unsigned int idleCount = 0;
+    Job* job = NULL;
+
+    workerIndex = static_cast<int>(worker);
+
+    while(true)
+    {
+        if(worker < this->activeWorkers.load())
+        {
+            job = this->getJob(worker);
+            if(job != NULL)
+            {
+                this->execute(job);
+                idleCount = 0;
+                continue;
+            }
+
+            // Background tasks only when there is no job left
+            if(this->takeBackgroundTask(task))
+            {
+                task();
+                task = nullptr;
+                idleCount = 0;
+                continue;
+            }
+        }
+
+        if(++idleCount < JOB_SYSTEM_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // The sleeping workers are counted before the deques are checked again, wakeWorkers sees the count after adding work
+        std::unique_lock<std::mutex> lock(this->sleepMutex);
+        this->sleepingWorkers++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(worker >= this->activeWorkers.load() || !this->hasWork())
+        {
+            this->sleepCondition.wait(lock);
+        }
+        this->sleepingWorkers--;
+        idleCount = 0;
+    }
+}
+
+
+Job* JobSystem::getJob(unsigned int worker)
+{
+    JobWorker& current = *this->workers[worker];
+    unsigned int workerCount = static_cast<unsigned int>(this->workers.size());
+    unsigned int first = 0;
+    unsigned int victim = 0;
+    Job* job = current.deque.pop();
+
+    if(job != NULL || workerCount == 1)
+    {
+        return job;
+    }
+
+    // Steal the oldest job of another worker, starting from a random one (xorshift)
+    current.randomState ^= current.randomState << 13;
+    current.randomState ^= current.randomState >> 17;
+    current.randomState ^= current.randomState << 5;
+    first = current.randomState % workerCount;
+    for(unsigned int i=0; i<workerCount; i++)
+    {
+        victim = (first + i) % workerCount;
+        if(victim == worker)
+        {
+            continue;
+        }
+
+        job = this->workers[victim]->deque.steal();
+        if(job != NULL)
+        {
+            current.stolenJobs.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+
+void JobSystem::execute(Job* job)
+{
+    job->function(*job, job->data);
+    this->workers[workerIndex]->executedJobs.fetch_add(1, std::memory_order_relaxed);
+    this->finish(job);
+}
+
+
+void JobSystem::finish(Job* job)
+{
+    // Read before the job is finished, its slot can be reused by its worker right after
+    Job* parent = job->parent;
+
+    // The last of the job and its children to finish finishes the parent
+    if(job->unfinishedJobs.fetch_sub(1) == 1 && parent != NULL)
+    {
+        this->finish(parent);
+    }
+}
+
+
+bool JobSystem::takeBackgroundTask(std::function<void()>& task)
+{
+    if(this->backgroundTaskCount.load() == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(this->backgroundMutex);
+    if(this->backgroundTasks.empty())
+    {
+        return false;
+    }
+    task = this->backgroundTasks.front();
+    this->backgroundTasks.pop_front();
+    this->backgroundTaskCount--;
+
+    return true;
+}
+
+
+bool JobSystem::hasWork() const
+{
+    if(this->backgroundTaskCount.load() > 0)
+    {
+        return true;
+    }
+
+    for(unsigned int i=0; i<this->workers.size(); i++)
+    {
+        if(!this->workers[i]->deque.isEmpty())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void JobSystem::wakeWorkers()
+{
+    // The work added is seen by a worker counted as sleeping (see runWorker)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(this->sleepingWorkers.load() == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->sleepMutex);
+    this->sleepCondition.notify_all();
+}
+
+
+void JobSystem::parallelForJob(Job& job, const void* data)
+{
+    JobRange range = *static_cast<const JobRange*>(data);
+    JobSystem& jobSystem = getJobSystem();
+    JobRange half;
+
+    // The upper halves are split off as children, to be stolen by the idle workers, until the range is not larger than the grain
+    while(range.last - range.first > range.grain)
+    {
+        half = range;
+        half.first = range.first + (range.last - range.first) / 2;
+        range.last = half.first;
+        jobSystem.run(jobSystem.createJob(parallelForJob, &job, half));
+    }
+
+    (*range.function)(range.first, range.last);
+}
@@ -0,0 +1,360 @@
+#ifndef __JOBSYSTEM_H
+#define __JOBSYSTEM_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+// Capacity of the deque of a worker (power of 2), a job pushed on a full deque is executed at once
+#define JOB_SYSTEM_QUEUE_SIZE 4096
+// Jobs allocated by a worker before its first jobs are reused (a job must be finished and not waited for anymore after as many allocations)
+#define JOB_SYSTEM_MAX_JOBS 4096
+// Bytes of data copied in a job
+#define JOB_DATA_SIZE 40
+// Ranges of parallelForRange split until each worker has this number of them to share (adaptive grain)
+#define JOB_SYSTEM_RANGES_PER_WORKER 8
+// Attempts to find a job before an idle worker thread sleeps
+#define JOB_SYSTEM_SPIN_COUNT 64
+
+
+struct Job;
+
+
+/**
+ * @brief JobFunction execute a job
+ * @param job job executed, parent of the jobs it creates
+ * @param data copy of the data given to createJob
+ */
+typedef void (*JobFunction)(Job& job, const void* data);
+
+
+/**
+ * @brief The Job struct is a function run by the job system, with the data it needs.
+ *        A job is finished once its function and the ones of all its children have returned.
+ */
+struct Job
+{
+    /// Function of the job
+    JobFunction function;
+    /// Job waiting for this one to finish, NULL for none
+    Job* parent;
+    /// The job itself and its children which are not finished
+    std::atomic<unsigned int> unfinishedJobs;
+    /// Data of the function
+    unsigned char data[JOB_DATA_SIZE];
+};
+
+
+/**
+ * @brief The JobRange struct is the data of a job of parallelForRange
+ */
+struct JobRange
+{
+    /// Function of the loop
+    const std::function<void(unsigned int, unsigned int)>* function;
+    /// Indices of the range
+    unsigned int first;
+    unsigned int last;
+    /// Largest range executed without being split
+    unsigned int grain;
+};
+
+
+/**
+ * @brief The JobDeque class is the lock-free work-stealing deque of a worker (Chase-Lev) :
+ *        the worker pushes and pops at the bottom, the other workers steal at the top
+ */
+class JobDeque
+{
+// Attributes
+private:
+    std::atomic<long long> top;
+    std::atomic<long long> bottom;
+    std::atomic<Job*> jobs[JOB_SYSTEM_QUEUE_SIZE];
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief JobDeque create an empty deque
+     */
+    JobDeque();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief push add a job at the bottom, only called by the owner of the deque
+     * @return false when the deque is full
+     */
+    bool push(Job* job);
+
+
+    /**
+     * @brief pop remove the last job pushed, only called by the owner of the deque
+     * @return the job, NULL if the deque is empty
+     */
+    Job* pop();
+
+
+    /**
+     * @brief steal remove the first job pushed, called by the other workers
+     * @return the job, NULL if the deque is empty or if another worker took it first
+     */
+    Job* steal();
+
+
+    /**
+     * @brief isEmpty return true when the deque has no job (an approximation while the other workers use it)
+     */
+    bool isEmpty() const;
+};
+
+
+/**
+ * @brief The JobWorker struct is the state of one worker of the job system
+ */
+struct JobWorker
+{
+    /// Jobs run by the worker, stolen by the others
+    JobDeque deque;
+    /// Ring of the jobs allocated by the worker
+    Job* jobs;
+    unsigned int nextJob;
+    /// State of the random choice of the workers to steal from
+    unsigned int randomState;
+    /// Jobs executed and stolen since the last reset (counted by the worker only)
+    std::atomic<unsigned int> executedJobs;
+    std::atomic<unsigned int> stolenJobs;
+};
+
+
+/**
+ * @brief The JobSystem class run the jobs of the application on one worker per hardware thread.
+ *        The thread which creates the system (the GL thread) is the worker 0, it only executes jobs while it waits for one.
+ *        Each worker pushes its jobs on its own deque, an idle worker steals the oldest jobs of the others.
+ *        Only the workers can create and wait for jobs, the other threads run their parallel loops alone.
+ */
+class JobSystem
+{
+// Attributes
+private:
+    /// Job system of the application
+    static JobSystem* system;
+    /// Index of the worker of the calling thread, -1 for threads which are not workers
+    static thread_local int workerIndex;
+
+    /// Workers, the first one is the thread which created the system
+    std::vector<JobWorker*> workers;
+    std::vector<std::thread> threads;
+    /// Number of workers executing jobs (the benchmark disables the last ones)
+    std::atomic<unsigned int> activeWorkers;
+
+    /// Long tasks (file reads) only executed by the worker threads, never by a waiting GL thread
+    std::deque<std::function<void()>> backgroundTasks;
+    std::mutex backgroundMutex;
+    std::atomic<unsigned int> backgroundTaskCount;
+
+    // Sleep of the idle worker threads
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    std::atomic<unsigned int> sleepingWorkers;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief JobSystem make the calling thread the worker 0 and start one worker thread per other hardware thread
+     */
+    JobSystem();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getJobSystem return the job system of the application, created on first use (by the GL thread)
+     */
+    static JobSystem& getJobSystem();
+
+
+    /**
+     * @brief getWorkerCount return the number of workers, the GL thread included (the bound of the worker indices)
+     */
+    unsigned int getWorkerCount() const;
+
+
+    /**
+     * @brief getWorkerIndex return the index of the worker of the calling thread, -1 if it is not a worker
+     */
+    static int getWorkerIndex();
+
+
+    /**
+     * @brief createJob create a job with a copy of its data, to be run with run
+     * @param function function of the job
+     * @param parent job which is not finished until this one is, NULL for none
+     * @param data data of the job (trivially copyable, at most JOB_DATA_SIZE bytes)
+     */
+    template<typename T>
+    Job* createJob(JobFunction function, Job* parent, const T& data)
+    {
+        static_assert(sizeof(T) <= JOB_DATA_SIZE, "the data of a job must fit in JOB_DATA_SIZE bytes");
+
+        Job* job = this->createJob(function, parent);
+
+        if(job != NULL)
+        {
+            std::memcpy(job->data, &data, sizeof(T));
+        }
+
+        return job;
+    }
+
+
+    /**
+     * @brief createJob create a job without data, to be run with run
+     * @param function function of the job
+     * @param parent job which is not finished until this one is, NULL for none
+     */
+    Job* createJob(JobFunction function, Job* parent);
+
+
+    /**
+     * @brief run give a job to the workers
+     */
+    void run(Job* job);
+
+
+    /**
+     * @brief wait execute jobs until the given one is finished, the calling thread never sleeps
+     */
+    void wait(const Job* job);
+
+
+    /**
+     * @brief isFinished return true when a job and all its children are finished, to wait for a job without executing others
+     */
+    bool isFinished(const Job* job) const;
+
+
+    /**
+     * @brief parallelForRange call a function on ranges of indices executed by all the workers, and wait for them.
+     *        The ranges are split in halves until there are enough for all the workers, the halves are stolen by the idle ones.
+     * @param count number of indices
+     * @param minimumGrain smallest range given to the function (more for cheaper indices)
+     * @param function called with the first index and past the last index of each range
+     */
+    void parallelForRange(unsigned int count, unsigned int minimumGrain, const std::function<void(unsigned int first, unsigned int last)>& function);
+
+
+    /**
+     * @brief parallelFor call a function on each index of a range, executed by all the workers, and wait for them
+     * @param count number of indices
+     * @param minimumGrain smallest number of consecutive indices given to a worker
+     * @param function called with each index
+     */
+    void parallelFor(unsigned int count, unsigned int minimumGrain, const std::function<void(unsigned int index)>& function);
+
+
+    /**
+     * @brief runInBackground run a long task (file read) on a worker thread, with the least priority.
+     *        It is executed at once when there is no worker thread.
+     */
+    void runInBackground(const std::function<void()>& task);
+
+
+    /**
+     * @brief benchmark measure the cost of scheduling a job and the speedup of a parallel loop from 1 to all the workers, then print them
+     */
+    void benchmark();
+
+
+    /**
+     * @brief resetStatistics set the counters of the workers to 0
+     */
+    void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the jobs executed and stolen by each worker since the last reset
+     */
+    void printStatistics() const;
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief runWorker execute the jobs of the workers then sleep until there are new ones, in a worker thread
+     */
+    void runWorker(unsigned int worker);
+
+
+    /**
+     * @brief getJob pop a job of a worker, or steal one from another worker
+     * @return the job, NULL if none was found
+     */
+    Job* getJob(unsigned int worker);
+
+
+    /**
+     * @brief execute call the function of a job, then finish it
+     */
+    void execute(Job* job);
+
+
+    /**
+     * @brief finish end a job whose function returned, its parent is finished with its last child
+     */
+    void finish(Job* job);
+
+
+    /**
+     * @brief takeBackgroundTask remove the oldest background task
+     * @return false when there is none
+     */
+    bool takeBackgroundTask(std::function<void()>& task);
+
+
+    /**
+     * @brief hasWork return true when a deque or the background tasks are not empty
+     */
+    bool hasWork() const;
+
+
+    /**
+     * @brief wakeWorkers wake the sleeping worker threads after jobs or tasks were added
+     */
+    void wakeWorkers();
+
+
+    /**
+     * @brief parallelForJob execute a range of parallelForRange, split in two children while it is larger than the grain
+     */
+    static void parallelForJob(Job& job, const void* data);
+};
+
+
+#endif
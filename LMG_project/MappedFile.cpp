@@ -0,0 +1,156 @@
+#include "MappedFile.h"
+
+
+// ===========
+// Constructor
+
+MappedFile::MappedFile()
+{
+    this->data = NULL;
+    this->size = 0;
+#ifdef _WIN32
+    this->file = INVALID_HANDLE_VALUE;
+    this->mapping = NULL;
+#endif
+}
+
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+
+// =======
+// Methods
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    LARGE_INTEGER fileSize;
+
+    this->close();
+
+    this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(this->file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    if(!GetFileSizeEx(this->file, &fileSize))
+    {
+        this->close();
+        return false;
+    }
+    this->size = static_cast<size_t>(fileSize.QuadPart);
+
+    // An empty file can not be mapped
+    if(this->size == 0)
+    {
+        return true;
+    }
+
+    this->mapping = CreateFileMappingA(this->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(this->mapping != NULL)
+    {
+        this->data = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if(this->data == NULL)
+    {
+        this->close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if(this->data != NULL)
+    {
+        UnmapViewOfFile(this->data);
+    }
+    if(this->mapping != NULL)
+    {
+        CloseHandle(this->mapping);
+    }
+    if(this->file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(this->file);
+    }
+    this->data = NULL;
+    this->size = 0;
+    this->file = INVALID_HANDLE_VALUE;
+    this->mapping = NULL;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    struct stat fileStatus;
+    void* mapping;
+    int file;
+
+    this->close();
+
+    file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        return false;
+    }
+    if(fstat(file, &fileStatus) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    // An empty file can not be mapped
+    if(fileStatus.st_size == 0)
+    {
+        ::close(file);
+        return true;
+    }
+
+    // The mapping stays valid once the file is closed
+    mapping = mmap(NULL, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if(mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // The whole file is read right away
+    madvise(mapping, static_cast<size_t>(fileStatus.st_size), MADV_WILLNEED);
+
+    this->data = static_cast<const char*>(mapping);
+    this->size = static_cast<size_t>(fileStatus.st_size);
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if(this->data != NULL)
+    {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+    this->data = NULL;
+    this->size = 0;
+}
+
+#endif
+
+
+const char* MappedFile::getData() const
+{
+    return this->data;
+}
+
+
+size_t MappedFile::getSize() const
+{
+    return this->size;
+}
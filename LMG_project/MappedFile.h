@@ -0,0 +1,87 @@
+#ifndef __MAPPEDFILE_H
+#define __MAPPEDFILE_H
+
+// Includes
+
+// STL
+#include <string>
+
+// System
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * @brief The MappedFile class map a whole file in memory for reading, so that it is parsed in place without being copied.
+ *        The mapping is released with the object, which can not be copied.
+ */
+class MappedFile
+{
+// Attributes
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief MappedFile create an object mapping no file
+     */
+    MappedFile();
+
+
+    /**
+     * @brief ~MappedFile unmap the file
+     */
+    ~MappedFile();
+
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief open map a file (the previous one is unmapped)
+     * @param path path of the file
+     * @return false when the file could not be opened or mapped (an empty file is mapped with no data)
+     */
+    bool open(const std::string& path);
+
+
+    /**
+     * @brief close unmap the file
+     */
+    void close();
+
+
+    /**
+     * @brief getData return the content of the file (NULL when no file or an empty file is mapped)
+     */
+    const char* getData() const;
+
+
+    /**
+     * @brief getSize return the size of the file, in bytes
+     */
+    size_t getSize() const;
+};
+
+
+#endif
@@ -0,0 +1,187 @@
+#include "MaterialLibrary.h"
+
+
+MaterialLibrary* MaterialLibrary::library = NULL;
+
+
+// ===========
+// Constructor
+
+MaterialLibrary::MaterialLibrary()
+{
+}
+
+
+// =======
+// Methods
+
+MaterialLibrary& MaterialLibrary::getLibrary()
+{
+    if(library == NULL)
+    {
+        library = new MaterialLibrary();
+    }
+
+    return *library;
+}
+
+
+unsigned int MaterialLibrary::addMaterial(const std::vector<Texture>& textures)
+{
+    // Meshes sharing their textures share their material (and their bindings)
+    for(unsigned int i=0; i<this->materials.size(); i++)
+    {
+        if(this->materials[i].size() != textures.size())
+        {
+            continue;
+        }
+
+        bool sameTextures = true;
+        for(unsigned int j=0; j<textures.size() && sameTextures; j++)
+        {
+            sameTextures = (this->materials[i][j].id == textures[j].id && this->materials[i][j].type == textures[j].type);
+        }
+        if(sameTextures)
+        {
+            return i;
+        }
+    }
+
+    this->materials.push_back(textures);
+
+    return static_cast<unsigned int>(this->materials.size() - 1);
+}
+
+
+void MaterialLibrary::bindMaterial(unsigned int material, const Shader& shader, bool report)
+{
+    MaterialProgram& program = this->getProgram(shader);
+
+    if(material >= program.bindings.size() || !program.bindings[material].resolved)
+    {
+        this->resolveBinding(material, program, report);
+    }
+
+    const std::vector<TextureBinding>& textures = program.bindings[material].textures;
+    for(unsigned int i=0; i<textures.size(); i++)
+    {
+        RenderState::bindTexture(textures[i].unit, GL_TEXTURE_2D, textures[i].id);
+    }
+}
+
+
+void MaterialLibrary::bindEnvironment(const Shader& shader, GLuint cubeMap, bool report)
+{
+    MaterialProgram& program = this->getProgram(shader);
+
+    if(program.environmentUnit >= 0)
+    {
+        RenderState::bindTexture(GL_TEXTURE0 + program.environmentUnit, GL_TEXTURE_CUBE_MAP, cubeMap);
+    }
+    else if(report && !program.environmentReported)
+    {
+        std::cerr << "[WARNING]: the uniform '" << MATERIAL_ENVIRONMENT_SAMPLER << "' was not declared in the shader " << shader._shaderId << ". It will not be used." << std::endl;
+        program.environmentReported = true;
+    }
+}
+
+
+// =================
+// Auxiliary methods
+
+MaterialProgram& MaterialLibrary::getProgram(const Shader& shader)
+{
+    MaterialProgram materialProgram;
+    GLuint program = static_cast<GLuint>(shader._shaderId);
+
+    for(unsigned int i=0; i<this->programs.size(); i++)
+    {
+        if(this->programs[i].program == program)
+        {
+            return this->programs[i];
+        }
+    }
+
+    // Give a texture unit to each active sampler, in the order of the uniforms reflected by the shader
+    materialProgram.program = program;
+    materialProgram.environmentUnit = -1;
+    materialProgram.environmentReported = false;
+    // The materials are bound by the draws, the program is already in use and stays in use
+    RenderState::useProgram(program);
+    const std::vector<ShaderUniform>& uniforms = shader.getUniforms();
+    for(unsigned int i=0; i<uniforms.size(); i++)
+    {
+        if(uniforms[i].type != GL_SAMPLER_2D && uniforms[i].type != GL_SAMPLER_CUBE)
+        {
+            continue;
+        }
+
+        materialProgram.samplerNames.push_back(uniforms[i].name);
+        materialProgram.samplerUnits.push_back(static_cast<GLint>(materialProgram.samplerUnits.size()));
+        shader.setInt(static_cast<GLint>(i), materialProgram.samplerUnits.back());
+        if(uniforms[i].name == MATERIAL_ENVIRONMENT_SAMPLER)
+        {
+            materialProgram.environmentUnit = materialProgram.samplerUnits.back();
+        }
+    }
+    glCheckError();
+
+    this->programs.push_back(materialProgram);
+
+    return this->programs.back();
+}
+
+
+void MaterialLibrary::resolveBinding(unsigned int material, MaterialProgram& program, bool report)
+{
+    // Each texture in the shader has to be of the form :
+    //      - texture_diffuseN
+    //      - texture_specularN
+    // Where N is the texture number
+    unsigned int diffuseNr  = 1;
+    unsigned int specularNr = 1;
+    std::string name;
+    TextureBinding binding;
+    bool found;
+
+    if(material >= program.bindings.size())
+    {
+        MaterialBinding unresolved;
+        unresolved.resolved = false;
+        program.bindings.resize(this->materials.size(), unresolved);
+    }
+
+    MaterialBinding& materialBinding = program.bindings[material];
+    const std::vector<Texture>& textures = this->materials[material];
+    materialBinding.textures.clear();
+    for(unsigned int i=0; i<textures.size(); i++)
+    {
+        name = textures[i].type;
+        if(name == "texture_diffuse")
+        {
+            name += std::to_string(diffuseNr++);
+        }
+        else if(name == "texture_specular")
+        {
+            name += std::to_string(specularNr++);
+        }
+
+        found = false;
+        for(unsigned int j=0; j<program.samplerNames.size() && !found; j++)
+        {
+            if(program.samplerNames[j] == name)
+            {
+                binding.unit = GL_TEXTURE0 + program.samplerUnits[j];
+                binding.id = textures[i].id;
+                materialBinding.textures.push_back(binding);
+                found = true;
+            }
+        }
+
+        if(!found && report)
+        {
+            std::cerr << "[WARNING]: the uniform " << name << " was not declared in the shader " << program.program << ". It will not be used." << std::endl;
+        }
+    }
+    materialBinding.resolved = true;
+}
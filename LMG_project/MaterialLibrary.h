@@ -0,0 +1,160 @@
+#ifndef __MATERIALLIBRARY_H
+#define __MATERIALLIBRARY_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+
+// Shader
+#include "Shader.h"
+
+
+// Name of the cube map sampler of the environment (skybox) in the shaders
+#define MATERIAL_ENVIRONMENT_SAMPLER "skybox"
+
+
+/**
+ * @brief The Texture struct
+ */
+struct Texture
+{
+    /// Id in OpenGL of the texture
+    GLuint id;
+    /// Type of the texture (diffuse or specular)
+    std::string type;
+};
+
+
+/**
+ * @brief The TextureBinding struct is a texture bound to a texture unit when a material is drawn
+ */
+struct TextureBinding
+{
+    /// Texture unit (GL_TEXTURE0 + n)
+    GLenum unit;
+    /// Id in OpenGL of the texture
+    GLuint id;
+};
+
+
+/**
+ * @brief The MaterialBinding struct store the textures of a material to bind for a program, resolved with its first draw
+ */
+struct MaterialBinding
+{
+    /// Textures whose sampler is used by the program
+    std::vector<TextureBinding> textures;
+    /// False until the binding is resolved
+    bool resolved;
+};
+
+
+/**
+ * @brief The MaterialProgram struct store the texture units of the samplers of a program and the binding of each material for it
+ */
+struct MaterialProgram
+{
+    /// Id in OpenGL of the program
+    GLuint program;
+    /// Active samplers of the program, and the texture unit given to each one
+    std::vector<std::string> samplerNames;
+    std::vector<GLint> samplerUnits;
+    /// Texture unit of the environment sampler, -1 when the program does not use it
+    GLint environmentUnit;
+    /// True once the missing environment sampler has been reported
+    bool environmentReported;
+    /// Binding of each material, by material index
+    std::vector<MaterialBinding> bindings;
+};
+
+
+/**
+ * @brief The MaterialLibrary class resolve once per (material, program) pair which texture goes to which texture unit.
+ *        Each sampler of a program gets a fixed texture unit, set when the program is first drawn with a material,
+ *        so that drawing a material only binds its textures, without any uniform, string or allocation.
+ *        The textures of a material are found with the naming convention of the shaders : texture_diffuseN, texture_specularN (N from 1).
+ */
+class MaterialLibrary
+{
+// Attributes
+private:
+    /// Textures of each material
+    std::vector< std::vector<Texture> > materials;
+    /// Programs drawn with a material
+    std::vector<MaterialProgram> programs;
+
+    /// The library of the application, created on first use
+    static MaterialLibrary* library;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief MaterialLibrary create an empty library
+     */
+    MaterialLibrary();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getLibrary return the material library of the application
+     */
+    static MaterialLibrary& getLibrary();
+
+
+    /**
+     * @brief addMaterial return the index of the material with the given textures, created if no material has the same ones
+     * @param textures textures of the material, in the order of the uniform numbers
+     */
+    unsigned int addMaterial(const std::vector<Texture>& textures);
+
+
+    /**
+     * @brief bindMaterial bind the textures of a material to the units of the samplers of a program
+     * @param material index of the material
+     * @param shader shader drawing the material
+     * @param report true to report the textures whose sampler is not used by the program (when the binding is resolved)
+     */
+    void bindMaterial(unsigned int material, const Shader& shader, bool report);
+
+
+    /**
+     * @brief bindEnvironment bind the environment cube map to the unit of the environment sampler of a program
+     * @param shader shader drawing the material
+     * @param cubeMap id in OpenGL of the cube map
+     * @param report true to report once that the program has no environment sampler
+     */
+    void bindEnvironment(const Shader& shader, GLuint cubeMap, bool report);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief getProgram return the samplers and the bindings of the program of a shader, taken from its uniforms the first time
+     */
+    MaterialProgram& getProgram(const Shader& shader);
+
+
+    /**
+     * @brief resolveBinding find the sampler of each texture of a material in a program
+     * @param material index of the material
+     * @param program program and its samplers
+     * @param report true to report the textures whose sampler is not used by the program
+     */
+    void resolveBinding(unsigned int material, MaterialProgram& program, bool report);
+};
+
+
+#endif
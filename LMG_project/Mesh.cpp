@@ -1,4 +1,7 @@
 #include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "MeshletCuller.h"
+#include "VertexCompressor.h"
 
 
 // ========================================
@@ -6,254 +9,320 @@
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    MeshLOD fullResolution;
+
+    // The buffers given by the importer are taken over without copy
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->material = MaterialLibrary::getLibrary().addMaterial(this->textures);
+    this->vertexFormat = MESH_VERTEX_FORMAT;
+    this->geometryHandle = 0;
+    this->geometryAllocated = false;
+
+    // The full resolution mesh is the first level of detail
+    fullResolution.indexOffset = 0;
+    fullResolution.indexCount = static_cast<GLuint>(this->indices.size());
+    fullResolution.error = 0.0f;
+    this->lods.push_back(fullResolution);
+    this->currentLOD = 0;
+    this->meshletsCulled = false;
+    this->visible = true;
+
+    this->computeBounds();
+    this->computeTextureDensity();
+}
+
+
+void Mesh::generateLevelsOfDetail()
+{
+    std::vector<GLuint> previousIndices(this->indices.begin(), this->indices.begin() + this->lods[0].indexCount);
+    std::vector<GLuint> lodIndices;
+    MeshLOD lod;
+    float simplificationError = 0.0f;
+
+    // Keep only the full resolution level
+    this->indices.resize(this->lods[0].indexCount);
+    this->lods.resize(1);
+
+    while(this->lods.size() < MESH_MAX_LOD_COUNT)
+    {
+        // Each level of detail has half the triangles of the previous one
+        size_t targetIndexCount = (previousIndices.size() / 6) * 3;
+
+        lodIndices = MeshSimplifier::simplify(this->vertices, previousIndices, targetIndexCount, &simplificationError);
 
-    this->setupMesh();
+        // Stop when the simplification is blocked (seams, borders, flips)
+        if(lodIndices.empty() || lodIndices.size() > previousIndices.size() * MESH_MIN_LOD_REDUCTION)
+        {
+            break;
+        }
+
+        // Errors of successive simplifications add up
+        lod.indexOffset = static_cast<GLuint>(this->indices.size());
+        lod.indexCount = static_cast<GLuint>(lodIndices.size());
+        lod.error = this->lods.back().error + simplificationError;
+        this->lods.push_back(lod);
+        this->indices.insert(this->indices.end(), lodIndices.begin(), lodIndices.end());
+
+        previousIndices.swap(lodIndices);
+    }
 }
 
 
-void Mesh::setupMesh()
-{   
-    // Declare VAO, VBO and EBO
-    glGenVertexArrays(1, &this->VAO);
-    glCheckError();
-    glGenBuffers(1, &this->VBO);
-    glCheckError();
-    glGenBuffers(1, &this->EBO);
-    glCheckError();
-
-    // Memory allocation for VBO and EBO linked with the VAO
-    glBindVertexArray(this->VAO);
-    glCheckError();
-
-    // Link the VBO with the vertices vector
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glCheckError();
-    glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(Vertex), this->vertices.data(), GL_STATIC_DRAW);
-    glCheckError();
-
-    // Link the EBO with the indices vector
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
-    glCheckError();
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), this->indices.data(), GL_STATIC_DRAW);
-    glCheckError();
-
-    // Tell how to read position of each vertex in the VBO
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glCheckError();
-    glEnableVertexAttribArray(0);
-    glCheckError();
-    // Tell how to read normal of each vertex in the VBO
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, normal)));
-    glCheckError();
-    glEnableVertexAttribArray(1);
-    glCheckError();
-    // Tell how to read texture coordinates of each vertex in the VBO
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, textCoords));
-    glCheckError();
-    glEnableVertexAttribArray(2);
-    glCheckError();
-
-
-    glBindVertexArray(0);
-    glCheckError();
+void Mesh::setLevelsOfDetail(std::vector<MeshLOD> lods, std::vector<GLuint> indices)
+{
+    this->lods = std::move(lods);
+    this->indices = std::move(indices);
+    this->currentLOD = 0;
+}
 
+
+void Mesh::generateMeshlets()
+{
+    MeshletBuilder::build(this->vertices, this->indices, this->lods[0].indexCount, this->meshlets);
+    MeshletBuilder::buildBounds(this->meshlets, this->meshletBounds);
 }
 
 
-// ===========
-// Draw method
+void Mesh::setMeshlets(std::vector<Meshlet> meshlets)
+{
+    this->meshlets = std::move(meshlets);
+    MeshletBuilder::buildBounds(this->meshlets, this->meshletBounds);
+}
 
 
-void Mesh::draw(Shader &shader)
+void Mesh::cullMeshlets(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, bool coneCulling)
 {
-    // Each texture in the shader has to be of the form :
-    //      - texture_diffuseN
-    //      - texture_specularN
-    // Where N is the texture number
-    // This format let us specify as many textures as we want without any problem
-    // bind appropriate textures
-    unsigned int diffuseNr  = 1;
-    unsigned int specularNr = 1;
-    std::string number;
-    std::string name;
-    std::string currentTextureName;
-    GLint textureUniformId;
-
-    for(unsigned int i = 0; i < textures.size(); i++)
+    // Meshlets only exist for the full resolution level of detail
+    this->meshletsCulled = (this->currentLOD == 0) && !this->meshlets.empty();
+
+    if(this->meshletsCulled)
     {
-        // active the good texture
-        glActiveTexture(GL_TEXTURE0 + i);
+        MeshletCuller::cull(this->meshlets, this->meshletBounds, modelViewProjection, cameraPosition, coneCulling, this->meshletDrawCounts, this->meshletDrawFirstIndices);
+    }
+}
 
-        name = textures[i].type;
-        if(name == "texture_diffuse")
-        {
-            number = std::to_string(diffuseNr++);
-        }
-        else if(name == "texture_specular")
-        {
-            number = std::to_string(specularNr++);
-        }
-        currentTextureName = name + number;
 
-        // Retrieve the uniform
-        textureUniformId = glGetUniformLocation(shader._shaderId, (name + number).c_str());
-        // If the uniform eists in the shader
-        if(textureUniformId != -1)
-        {
-            // Bind the texture
-            glUniform1i(textureUniformId, i);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-        }
-        else // If not
+void Mesh::selectLevelOfDetail(float pixelsPerUnit, float pixelErrorThreshold)
+{
+    this->currentLOD = 0;
+
+    // Levels are sorted from the finest to the coarsest one
+    for(unsigned int i=1; i<this->lods.size(); i++)
+    {
+        if(this->lods[i].error * pixelsPerUnit > pixelErrorThreshold)
         {
-            std::cerr << "[WARNING]: the uniform " << currentTextureName << " was not declared in the shader. It will not be used." << std::endl;
+            break;
         }
+        this->currentLOD = i;
     }
+}
 
-    // draw mesh
-    glBindVertexArray(this->VAO);
-    glCheckError();
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, (void*)0);
-    glCheckError();
-    glBindVertexArray(0);
 
-    glActiveTexture(GL_TEXTURE0);
+void Mesh::requestTextures(float pixelsPerUnit)
+{
+    // The streamer was created with the textures, not by the worker threads preparing the frame
+    if(this->textures.empty())
+    {
+        return;
+    }
+    TextureStreamer& streamer = TextureStreamer::getStreamer();
+
+    for(unsigned int i=0; i<this->textures.size(); i++)
+    {
+        streamer.requestTexture(this->textures[i].id, this->textureDensity / pixelsPerUnit);
+    }
 }
 
 
-bool Mesh::draw(Shader& shader, bool messageAlreadySpread)
+void Mesh::computeBounds()
 {
-    // Each texture in the shader has to be of the form :
-    //      - texture_diffuseN
-    //      - texture_specularN
-    // Where N is the texture number
-    // This format let us specify as many textures as we want without any problem
-    // bind appropriate textures
-    unsigned int diffuseNr  = 1;
-    unsigned int specularNr = 1;
-    std::string number;
-    std::string name;
-    std::string currentTextureName;
-    GLint textureUniformId;
-
-    for(unsigned int i = 0; i < textures.size(); i++)
+    glm::vec3 minPosition(0.0f);
+    glm::vec3 maxPosition(0.0f);
+
+    this->boundingBoxMin = glm::vec3(0.0f);
+    this->boundingBoxMax = glm::vec3(0.0f);
+    this->boundingSphereCenter = glm::vec3(0.0f);
+    this->boundingSphereRadius = 0.0f;
+
+    if(this->vertices.empty())
     {
-        // active the good texture
-        glActiveTexture(GL_TEXTURE0 + i);
+        return;
+    }
 
-        name = textures[i].type;
-        if(name == "texture_diffuse")
-        {
-            number = std::to_string(diffuseNr++);
-        }
-        else if(name == "texture_specular")
-        {
-            number = std::to_string(specularNr++);
-        }
-        currentTextureName = name + number;
+    // Center of the bounding box
+    minPosition = maxPosition = this->vertices[0].position;
+    for(unsigned int i=1; i<this->vertices.size(); i++)
+    {
+        minPosition = glm::min(minPosition, this->vertices[i].position);
+        maxPosition = glm::max(maxPosition, this->vertices[i].position);
+    }
+    this->boundingBoxMin = minPosition;
+    this->boundingBoxMax = maxPosition;
+    this->boundingSphereCenter = (minPosition + maxPosition) * 0.5f;
 
-        // Retrieve the uniform
-        textureUniformId = glGetUniformLocation(shader._shaderId, (name + number).c_str());
-        // If the uniform eists in the shader
-        if(textureUniformId != -1)
-        {
-            // Bind the texture
-            glUniform1i(textureUniformId, i);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-        }
-        else if(!messageAlreadySpread) // If not
-        {
-            std::cerr << "[WARNING]: the uniform " << currentTextureName << " was not declared in the shader. It will not be used." << std::endl;
-        }
+    // Farthest vertex from the center
+    for(unsigned int i=0; i<this->vertices.size(); i++)
+    {
+        this->boundingSphereRadius = std::max(this->boundingSphereRadius, glm::length(this->vertices[i].position - this->boundingSphereCenter));
     }
+}
 
-    // draw mesh
-    glBindVertexArray(this->VAO);
-    glCheckError();
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, (void*)0);
-    glCheckError();
-    glBindVertexArray(0);
 
-    glActiveTexture(GL_TEXTURE0);
-    return true;
+void Mesh::setupMesh()
+{
+    this->releaseMesh();
+
+    // Every mesh shares the vertex and index buffers of the arena
+    this->vertexFormat = MESH_VERTEX_FORMAT;
+    this->geometryHandle = GeometryArena::getArena(this->vertexFormat).allocate(this->vertices.data(), static_cast<GLuint>(this->vertices.size()), this->indices.data(), static_cast<GLuint>(this->indices.size()));
+    this->geometryAllocated = true;
 }
 
-bool Mesh::draw(Shader& shader, GLuint skyboxTextureID, bool messageAlreadySpread)
+
+void Mesh::setupMesh(const glm::vec3& positionOffset, const glm::vec3& positionScale)
 {
-    // Each texture in the shader has to be of the form :
-    //      - texture_diffuseN
-    //      - texture_specularN
-    // Where N is the texture number
-    // This format let us specify as many textures as we want without any problem
-    // bind appropriate textures
-    unsigned int diffuseNr  = 1;
-    unsigned int specularNr = 1;
-    unsigned int textureNr = 0;
-    std::string number;
-    std::string name;
-    std::string currentTextureName;
-    GLint textureUniformId;
-
-    for(unsigned int i = 0; i < textures.size(); i++)
+    std::vector<CompressedVertex> compressedVertices;
+    std::vector<GLushort> compressedIndices;
+
+    this->releaseMesh();
+
+    VertexCompressor::compressVertices(this->vertices, positionOffset, positionScale, compressedVertices);
+    VertexCompressor::compressIndices(this->indices, compressedIndices);
+
+    this->vertexFormat = COMPRESSED_MESH_VERTEX_FORMAT;
+    this->geometryHandle = GeometryArena::getArena(this->vertexFormat).allocate(compressedVertices.data(), static_cast<GLuint>(compressedVertices.size()), compressedIndices.data(), static_cast<GLuint>(compressedIndices.size()));
+    this->geometryAllocated = true;
+}
+
+
+void Mesh::releaseMesh()
+{
+    if(this->geometryAllocated)
     {
-        // active the good texture
-        glActiveTexture(GL_TEXTURE0 + i);
-        textureNr++;
+        GeometryArena::getArena(this->vertexFormat).release(this->geometryHandle);
+        this->geometryAllocated = false;
+    }
+}
 
-        name = textures[i].type;
-        if(name == "texture_diffuse")
-        {
-            number = std::to_string(diffuseNr++);
-        }
-        else if(name == "texture_specular")
-        {
-            number = std::to_string(specularNr++);
-        }
-        currentTextureName = name + number;
 
-        // Retrieve the uniform
-        textureUniformId = glGetUniformLocation(shader._shaderId, (name + number).c_str());
-        // If the uniform eists in the shader
-        if(textureUniformId != -1)
-        {
-            // Bind the texture
-            glUniform1i(textureUniformId, i);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-        }
-        else if(!messageAlreadySpread) // If not
+void Mesh::releaseGeometry(GeometryRetentionPolicy policy)
+{
+    size_t releasedBytes = 0;
+
+    if(policy == KEEP_POSITIONS)
+    {
+        this->positions.resize(this->vertices.size());
+        for(unsigned int i=0; i<this->vertices.size(); i++)
         {
-            std::cerr << "[WARNING]: the uniform " << currentTextureName << " was not declared in the shader" << shader._shaderId << ". It will not be used." << std::endl;
+            this->positions[i] = this->vertices[i].position;
         }
+        // The full resolution level of detail is the first range of the indices
+        releasedBytes += GeometryRetention::getBytes(this->indices);
+        this->indices.resize(this->lods[0].indexCount);
+        this->indices.shrink_to_fit();
+        releasedBytes -= GeometryRetention::getBytes(this->indices);
+        releasedBytes += GeometryRetention::release(this->vertices);
+    }
+    else if(policy == DISCARD_GEOMETRY)
+    {
+        releasedBytes += GeometryRetention::release(this->vertices);
+        releasedBytes += GeometryRetention::release(this->indices);
     }
 
-    // Add the skybox texture
-    glActiveTexture(GL_TEXTURE0 + textureNr + 1);
+    GeometryRetention::addResource(MODEL_GEOMETRY, GeometryRetention::getBytes(this->vertices) + GeometryRetention::getBytes(this->indices) + GeometryRetention::getBytes(this->positions), releasedBytes);
+}
+
+
+bool Mesh::hasSameTextures(const Mesh& other) const
+{
+    return this->material == other.material;
+}
+
+
+// ===========
+// Draw method
+
 
-    // Retrieve the uniform
-    textureUniformId = glGetUniformLocation(shader._shaderId, "skybox");
-    // If the uniform eists in the shader
-    if(textureUniformId != -1)
+void Mesh::draw(Shader &shader)
+{
+    // The texture units of the material are resolved with its first draw with the shader
+    MaterialLibrary::getLibrary().bindMaterial(this->material, shader, true);
+
+    // queue the draw commands of the mesh
+    this->drawElements();
+}
+
+
+bool Mesh::draw(Shader& shader, bool messageAlreadySpread)
+{
+    // The texture units of the material are resolved with its first draw with the shader
+    MaterialLibrary::getLibrary().bindMaterial(this->material, shader, !messageAlreadySpread);
+
+    // queue the draw commands of the mesh
+    this->drawElements();
+    return true;
+}
+
+bool Mesh::draw(Shader& shader, GLuint skyboxTextureID, bool messageAlreadySpread)
+{
+    // The texture units of the material and of the skybox are resolved with their first draw with the shader
+    MaterialLibrary::getLibrary().bindMaterial(this->material, shader, !messageAlreadySpread);
+    MaterialLibrary::getLibrary().bindEnvironment(shader, skyboxTextureID, !messageAlreadySpread);
+
+    // queue the draw commands of the mesh
+    this->drawElements();
+    return true;
+}
+
+
+// =================
+// Auxiliary methods
+
+void Mesh::computeTextureDensity()
+{
+    double surfaceArea = 0.0;
+    double textureArea = 0.0;
+
+    this->textureDensity = 0.0f;
+
+    for(unsigned int i=0; i+2<this->lods[0].indexCount; i+=3)
     {
-        // Bind the texture
-        glUniform1i(textureUniformId, textureNr + 1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTextureID);
+        const Vertex& vertex0 = this->vertices[this->indices[i]];
+        const Vertex& vertex1 = this->vertices[this->indices[i + 1]];
+        const Vertex& vertex2 = this->vertices[this->indices[i + 2]];
+        glm::vec2 textureEdge1 = vertex1.textCoords - vertex0.textCoords;
+        glm::vec2 textureEdge2 = vertex2.textCoords - vertex0.textCoords;
+
+        surfaceArea += glm::length(glm::cross(vertex1.position - vertex0.position, vertex2.position - vertex0.position));
+        textureArea += std::fabs(textureEdge1.x * textureEdge2.y - textureEdge1.y * textureEdge2.x);
     }
-    else if(!messageAlreadySpread) // If not
+
+    if(surfaceArea > 0.0)
     {
-        std::cerr << "[WARNING]: the uniform 'skybox' was not declared in the shader. It will not be used." << std::endl;
+        this->textureDensity = static_cast<float>(std::sqrt(textureArea / surfaceArea));
     }
+}
 
 
-    // draw mesh
-    glBindVertexArray(this->VAO);
-    glCheckError();
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, (void*)0);
-    glCheckError();
-    glBindVertexArray(0);
+void Mesh::drawElements()
+{
+    GeometryArena& arena = GeometryArena::getArena(this->vertexFormat);
+    const GeometryRange& range = arena.getRange(this->geometryHandle);
+    const MeshLOD& lod = this->lods[this->currentLOD];
 
-    glActiveTexture(GL_TEXTURE0);
-    return true;
+    if(this->meshletsCulled)
+    {
+        // Only the visible meshlets (nothing when every meshlet was culled)
+        for(unsigned int i=0; i<this->meshletDrawCounts.size(); i++)
+        {
+            arena.commandBuffer.addCommand(this->meshletDrawCounts[i], range.firstIndex + this->meshletDrawFirstIndices[i], range.baseVertex);
+        }
+        this->meshletsCulled = false;
+    }
+    else
+    {
+        arena.commandBuffer.addCommand(lod.indexCount, range.firstIndex + lod.indexOffset, range.baseVertex);
+    }
 }
@@ -33,6 +33,24 @@
 // Shader
 #include "Shader.h"
 
+// Materials
+#include "MaterialLibrary.h"
+
+// Geometry storage
+#include "GeometryArena.h"
+
+// Texture streaming
+#include "TextureStreamer.h"
+
+// Geometry retention
+#include "GeometryRetention.h"
+
+
+// Maximum number of levels of detail of a mesh (including the full resolution one)
+#define MESH_MAX_LOD_COUNT 5
+// Minimal triangle reduction between two levels of detail, under it no more level is generated
+#define MESH_MIN_LOD_REDUCTION 0.85f
+
 
 // structs used to store mesh data
 
@@ -52,14 +70,52 @@ struct Vertex
 
 
 /**
- * @brief The Texture struct
+ * @brief The MeshLOD struct describe a level of detail of a mesh as a range of its index buffer
+ */
+struct MeshLOD
+{
+    /// First index of the level of detail in the index buffer
+    GLuint indexOffset;
+    /// Number of indices of the level of detail
+    GLuint indexCount;
+    /// Geometric error of the level of detail compared to the full resolution mesh, in mesh units
+    float error;
+};
+
+
+/**
+ * @brief The Meshlet struct describe a small cluster of triangles of a mesh, with its bounds used for culling
+ */
+struct Meshlet
+{
+    /// First index of the meshlet in the index buffer of the mesh
+    GLuint indexOffset;
+    /// Number of indices of the meshlet
+    GLuint indexCount;
+    /// Center of the bounding sphere of the meshlet
+    glm::vec3 center;
+    /// Radius of the bounding sphere of the meshlet
+    float radius;
+    /// Average normal of the triangles of the meshlet
+    glm::vec3 coneAxis;
+    /// Sine of the normal cone spread angle (1 when the cone can not be used for culling)
+    float coneCutoff;
+};
+
+
+/**
+ * @brief The MeshletBounds struct store the bounds of the meshlets of a mesh as one array per component, for SIMD culling
  */
-struct Texture
+struct MeshletBounds
 {
-    /// Id in OpenGL of the texture
-    GLuint id;
-    /// Type of the texture (diffuse or specular)
-    std::string type;
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<float> coneAxisX;
+    std::vector<float> coneAxisY;
+    std::vector<float> coneAxisZ;
+    std::vector<float> coneCutoff;
 };
 
 
@@ -67,26 +123,55 @@ class Mesh
 {
 // Attributes
 private:
-    GLuint VBO;
-    GLuint EBO;
+    // Allocation of the mesh in the geometry arena
+    VertexFormat vertexFormat;
+    GLuint geometryHandle;
+    bool geometryAllocated;
 
-public:
-    GLuint VAO;
+    // Meshlet culling
+    MeshletBounds meshletBounds;
+    std::vector<GLuint> meshletDrawCounts;
+    std::vector<GLuint> meshletDrawFirstIndices;
+    bool meshletsCulled;
 
 public:
-    /// Vector of vertices
+    /// Vector of vertices (freed after the upload unless the retention policy of the models keeps them)
     std::vector<Vertex> vertices;
-    /// Vector of indice of the points composing the mesh
+    /// Vector of indice of the points composing the mesh (all levels of detail one after the other)
     std::vector<GLuint> indices;
+    /// Positions of the vertices, kept instead of the vertices after the upload by the KEEP_POSITIONS policy (empty otherwise)
+    std::vector<glm::vec3> positions;
     /// Vector of textures used by the mesh
     std::vector<Texture> textures;
+    /// Index of the textures of the mesh in the material library
+    unsigned int material;
+    /// Levels of detail of the mesh, from the full resolution one to the coarsest one
+    std::vector<MeshLOD> lods;
+    /// Level of detail used by the draw methods
+    unsigned int currentLOD;
+    /// Meshlets of the full resolution level of detail
+    std::vector<Meshlet> meshlets;
+    /// Smallest corner of the bounding box of the mesh
+    glm::vec3 boundingBoxMin;
+    /// Largest corner of the bounding box of the mesh
+    glm::vec3 boundingBoxMax;
+    /// Center of the bounding sphere of the mesh
+    glm::vec3 boundingSphereCenter;
+    /// Radius of the bounding sphere of the mesh
+    float boundingSphereRadius;
+    /// Texture coordinate units per mesh unit (square root of the texture area over the surface area of the triangles)
+    float textureDensity;
+    /// False when the mesh is outside of the view frustum (set by the frustum culling of its model)
+    bool visible;
 
 
 // Construtors
 public:
 
     /**
-     * @brief Mesh Constructor of the mesh object with minimal informations needed for mesh description
+     * @brief Mesh Constructor of the mesh object with minimal informations needed for mesh description.
+     *        The GPU buffers are created by setupMesh, once the levels of detail are known.
+     *        The vectors are moved into the mesh, so passing them with std::move avoids any copy.
      * @param vertices vertices informations
      * @param indices indice of each vertex
      * @param textures textures used by the mesh
@@ -99,7 +184,96 @@ public:
 
 
     /**
-     * @brief draw draw the current mesh with the given shader by passing informations in the uniform of the shader
+     * @brief generateLevelsOfDetail simplify the full resolution triangle list to build the levels of detail of the mesh.
+     *        Does not use OpenGL, so it can be called from any thread.
+     */
+    void generateLevelsOfDetail();
+
+
+    /**
+     * @brief setLevelsOfDetail replace the levels of detail of the mesh with already computed ones
+     * @param lods levels of detail
+     * @param indices index buffer of all levels of detail (the first level must be the full resolution one)
+     */
+    void setLevelsOfDetail(std::vector<MeshLOD> lods, std::vector<GLuint> indices);
+
+
+    /**
+     * @brief generateMeshlets split the full resolution level of detail into meshlets (reorder its triangles).
+     *        Does not use OpenGL, so it can be called from any thread.
+     */
+    void generateMeshlets();
+
+
+    /**
+     * @brief setMeshlets replace the meshlets of the mesh with already computed ones
+     * @param meshlets meshlets of the full resolution level of detail
+     */
+    void setMeshlets(std::vector<Meshlet> meshlets);
+
+
+    /**
+     * @brief cullMeshlets select the meshlets drawn by the next draw call when the full resolution level of detail is used
+     * @param modelViewProjection matrix from mesh space to clip space
+     * @param cameraPosition position of the camera in mesh space
+     * @param coneCulling true to also reject the meshlets facing away from the camera
+     */
+    void cullMeshlets(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, bool coneCulling);
+
+
+    /**
+     * @brief selectLevelOfDetail select the coarsest level of detail whose projected error is under the given threshold
+     * @param pixelsPerUnit size in pixels on the screen of one mesh unit at the mesh position
+     * @param pixelErrorThreshold maximal error allowed, in pixels
+     */
+    void selectLevelOfDetail(float pixelsPerUnit, float pixelErrorThreshold);
+
+
+    /**
+     * @brief requestTextures request to the texture streamer the levels of the textures of the mesh needed at its size on the screen
+     * @param pixelsPerUnit size in pixels on the screen of one mesh unit at the mesh position
+     */
+    void requestTextures(float pixelsPerUnit);
+
+
+    /**
+     * @brief setupMesh copy the vertices and indices of the mesh in the geometry arena
+     */
+    void setupMesh();
+
+
+    /**
+     * @brief setupMesh copy the vertices and indices of the mesh in the geometry arena in the compressed format
+     *        (the mesh must have at most COMPRESSED_MESH_MAX_VERTICES vertices)
+     * @param positionOffset smallest corner of the box in which positions are quantized
+     * @param positionScale size of the box in which positions are quantized
+     */
+    void setupMesh(const glm::vec3& positionOffset, const glm::vec3& positionScale);
+
+
+    /**
+     * @brief releaseMesh free the space used by the mesh in the geometry arena
+     */
+    void releaseMesh();
+
+
+    /**
+     * @brief releaseGeometry free the vertices and indices kept in RAM once the mesh is in the geometry arena.
+     *        KEEP_POSITIONS replaces the vertices with their positions and keeps only the full resolution indices.
+     * @param policy what to keep of the geometry
+     */
+    void releaseGeometry(GeometryRetentionPolicy policy);
+
+
+    /**
+     * @brief hasSameTextures verify if two meshes use the same textures (the same material), so that they can be drawn by the same multi-draw call
+     * @param other the other mesh
+     */
+    bool hasSameTextures(const Mesh& other) const;
+
+
+    /**
+     * @brief draw draw the current mesh with the given shader, its textures are bound to the units of the samplers of the shader
      * @param shader shader object containing vertex and fragment shaders
      */
     void draw(Shader& shader);
@@ -124,10 +298,24 @@ public:
 // Auxiliary methods
 private:
 
+
     /**
-     * @brief setupMesh initialize the VAO, VBO and EBO buffers of the mesh and fill it with the mesh informations
+     * @brief computeBounds compute the bounding box and the bounding sphere of the vertices of the mesh
      */
-    void setupMesh();
+    void computeBounds();
+
+
+    /**
+     * @brief computeTextureDensity compute the average texture coordinate units per mesh unit of the full resolution triangles
+     */
+    void computeTextureDensity();
+
+
+    /**
+     * @brief drawElements add the triangles of the current level of detail to the draw commands of the geometry arena.
+     *        They are drawn when the arena is submitted.
+     */
+    void drawElements();
 
 };
 
@@ -0,0 +1,174 @@
+#include "MeshCache.h"
+
+
+// =======
+// Methods
+
+bool MeshCache::load(const std::string& modelPath, std::vector<Mesh>& meshes)
+{
+    std::ifstream file;
+    unsigned int magic = 0;
+    unsigned int version = 0;
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    unsigned long long cachedSourceSize = 0;
+    long long cachedSourceTime = 0;
+    unsigned int meshCount = 0;
+    std::vector<std::vector<MeshLOD> > lods(meshes.size());
+    std::vector<std::vector<GLuint> > indices(meshes.size());
+    std::vector<std::vector<Meshlet> > meshlets(meshes.size());
+
+    if(!getSourceStamp(modelPath, &sourceSize, &sourceTime))
+    {
+        return false;
+    }
+
+    file.open((modelPath + MESH_CACHE_EXTENSION).c_str(), std::ios::binary);
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    // Header
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&cachedSourceSize), sizeof(cachedSourceSize));
+    file.read(reinterpret_cast<char*>(&cachedSourceTime), sizeof(cachedSourceTime));
+    file.read(reinterpret_cast<char*>(&meshCount), sizeof(meshCount));
+    if(!file || magic != MESH_CACHE_MAGIC || version != MESH_CACHE_VERSION || cachedSourceSize != sourceSize || cachedSourceTime != sourceTime || meshCount != meshes.size())
+    {
+        return false;
+    }
+
+    // Meshes (read everything before modifying the meshes)
+    for(unsigned int i=0; i<meshCount; i++)
+    {
+        unsigned int vertexCount = 0;
+        unsigned int fullResolutionIndexCount = 0;
+        unsigned int lodCount = 0;
+        unsigned int indexCount = 0;
+        unsigned int meshletCount = 0;
+
+        file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+        file.read(reinterpret_cast<char*>(&fullResolutionIndexCount), sizeof(fullResolutionIndexCount));
+        file.read(reinterpret_cast<char*>(&lodCount), sizeof(lodCount));
+        file.read(reinterpret_cast<char*>(&indexCount), sizeof(indexCount));
+        file.read(reinterpret_cast<char*>(&meshletCount), sizeof(meshletCount));
+        if(!file || vertexCount != meshes[i].vertices.size() || fullResolutionIndexCount != meshes[i].lods[0].indexCount || lodCount == 0 || lodCount > MESH_MAX_LOD_COUNT)
+        {
+            return false;
+        }
+
+        lods[i].resize(lodCount);
+        indices[i].resize(indexCount);
+        meshlets[i].resize(meshletCount);
+        file.read(reinterpret_cast<char*>(lods[i].data()), lodCount * sizeof(MeshLOD));
+        file.read(reinterpret_cast<char*>(indices[i].data()), indexCount * sizeof(GLuint));
+        file.read(reinterpret_cast<char*>(meshlets[i].data()), meshletCount * sizeof(Meshlet));
+        if(!file)
+        {
+            return false;
+        }
+
+        // Indices must stay in the vertex buffer, and ranges in the index buffer
+        for(unsigned int j=0; j<indexCount; j++)
+        {
+            if(indices[i][j] >= vertexCount)
+            {
+                return false;
+            }
+        }
+        for(unsigned int j=0; j<lodCount; j++)
+        {
+            if(static_cast<unsigned long long>(lods[i][j].indexOffset) + lods[i][j].indexCount > indexCount)
+            {
+                return false;
+            }
+        }
+        for(unsigned int j=0; j<meshletCount; j++)
+        {
+            if(static_cast<unsigned long long>(meshlets[i][j].indexOffset) + meshlets[i][j].indexCount > lods[i][0].indexCount)
+            {
+                return false;
+            }
+        }
+    }
+
+    for(unsigned int i=0; i<meshCount; i++)
+    {
+        meshes[i].setLevelsOfDetail(std::move(lods[i]), std::move(indices[i]));
+        meshes[i].setMeshlets(std::move(meshlets[i]));
+    }
+
+    return true;
+}
+
+
+bool MeshCache::save(const std::string& modelPath, const std::vector<Mesh>& meshes)
+{
+    std::ofstream file;
+    unsigned int magic = MESH_CACHE_MAGIC;
+    unsigned int version = MESH_CACHE_VERSION;
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    unsigned int meshCount = static_cast<unsigned int>(meshes.size());
+
+    if(!getSourceStamp(modelPath, &sourceSize, &sourceTime))
+    {
+        return false;
+    }
+
+    file.open((modelPath + MESH_CACHE_EXTENSION).c_str(), std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        std::cerr << "[WARNING] in MeshCache, could not write binary mesh file : " << modelPath << MESH_CACHE_EXTENSION << std::endl;
+        return false;
+    }
+
+    // Header
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&sourceSize), sizeof(sourceSize));
+    file.write(reinterpret_cast<const char*>(&sourceTime), sizeof(sourceTime));
+    file.write(reinterpret_cast<const char*>(&meshCount), sizeof(meshCount));
+
+    // Meshes
+    for(unsigned int i=0; i<meshCount; i++)
+    {
+        unsigned int vertexCount = static_cast<unsigned int>(meshes[i].vertices.size());
+        unsigned int fullResolutionIndexCount = meshes[i].lods[0].indexCount;
+        unsigned int lodCount = static_cast<unsigned int>(meshes[i].lods.size());
+        unsigned int indexCount = static_cast<unsigned int>(meshes[i].indices.size());
+        unsigned int meshletCount = static_cast<unsigned int>(meshes[i].meshlets.size());
+
+        file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+        file.write(reinterpret_cast<const char*>(&fullResolutionIndexCount), sizeof(fullResolutionIndexCount));
+        file.write(reinterpret_cast<const char*>(&lodCount), sizeof(lodCount));
+        file.write(reinterpret_cast<const char*>(&indexCount), sizeof(indexCount));
+        file.write(reinterpret_cast<const char*>(&meshletCount), sizeof(meshletCount));
+        file.write(reinterpret_cast<const char*>(meshes[i].lods.data()), lodCount * sizeof(MeshLOD));
+        file.write(reinterpret_cast<const char*>(meshes[i].indices.data()), indexCount * sizeof(GLuint));
+        file.write(reinterpret_cast<const char*>(meshes[i].meshlets.data()), meshletCount * sizeof(Meshlet));
+    }
+
+    return static_cast<bool>(file);
+}
+
+
+// =================
+// Auxiliary methods
+
+bool MeshCache::getSourceStamp(const std::string& modelPath, unsigned long long* size, long long* modificationTime)
+{
+    struct stat fileStatus;
+
+    if(stat(modelPath.c_str(), &fileStatus) != 0)
+    {
+        return false;
+    }
+
+    *size = static_cast<unsigned long long>(fileStatus.st_size);
+    *modificationTime = static_cast<long long>(fileStatus.st_mtime);
+
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef __MESHCACHE_H
+#define __MESHCACHE_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <string>
+#include <fstream>
+
+// System
+#include <sys/stat.h>
+
+// Mesh
+#include "Mesh.h"
+
+
+// Magic number of the binary mesh files ("LMGM")
+#define MESH_CACHE_MAGIC 0x4D474D4Cu
+// Version of the binary mesh format, to increase each time the format changes
+#define MESH_CACHE_VERSION 4u
+// Extension added to the model path to get its binary mesh file
+#define MESH_CACHE_EXTENSION ".lmgmesh"
+
+
+/**
+ * @brief The MeshCache class save and load the data computed at import time (levels of detail, meshlets) in a binary file
+ *        next to the model, so that it is only computed the first time a model is loaded
+ */
+class MeshCache
+{
+// Methods
+public:
+
+
+    /**
+     * @brief load fill the meshes with the data of the binary mesh file of the model
+     * @param modelPath path of the 3D model
+     * @param meshes meshes imported from the model, in import order
+     * @return false if the file does not exist or does not match the model (the meshes are then left untouched)
+     */
+    static bool load(const std::string& modelPath, std::vector<Mesh>& meshes);
+
+
+    /**
+     * @brief save write the binary mesh file of the model
+     * @param modelPath path of the 3D model
+     * @param meshes meshes imported from the model, in import order
+     * @return false if the file could not be written
+     */
+    static bool save(const std::string& modelPath, const std::vector<Mesh>& meshes);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief getSourceStamp retrieve the size and the modification time of the model file, used to invalidate the cache
+     * @param modelPath path of the 3D model
+     * @param size filled with the size of the file
+     * @param modificationTime filled with the last modification time of the file
+     * @return false if the file does not exist
+     */
+    static bool getSourceStamp(const std::string& modelPath, unsigned long long* size, long long* modificationTime);
+
+};
+
+
+#endif
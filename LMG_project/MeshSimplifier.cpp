@@ -0,0 +1,407 @@
+#include "MeshSimplifier.h"
+
+
+// Weight of the normal deviation in the collapse cost
+#define NORMAL_ERROR_WEIGHT 1.0
+// Weight of the texture coordinates deviation in the collapse cost
+#define TEXTCOORDS_ERROR_WEIGHT 1.0
+
+
+/**
+ * @brief The EdgeCollapse struct store a candidate collapse of vertex "from" onto vertex "to"
+ */
+struct EdgeCollapse
+{
+    GLuint from;
+    GLuint to;
+    double cost;
+    /// Squared distance between the moved vertex and the planes of its triangles, without the attribute penalty
+    double error;
+};
+
+
+// =======
+// Methods
+
+std::vector<GLuint> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, size_t targetIndexCount, float* resultError)
+{
+    size_t vertexCount = vertices.size();
+    std::vector<GLuint> result;
+    std::vector<GLuint> attributeRemap;
+    std::vector<GLuint> positionRemap;
+    std::vector<char> locked;
+    std::vector<glm::dvec3> positions(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<GLuint> collapseRemap(vertexCount);
+    std::vector<GLuint> adjacencyOffsets(vertexCount + 1);
+    std::vector<GLuint> adjacency;
+    std::vector<EdgeCollapse> collapses;
+    std::vector<char> touched(vertexCount);
+    glm::dvec3 minPosition(0.0);
+    glm::dvec3 maxPosition(0.0);
+    double scale = 0.0;
+    double maxError = 0.0;
+
+    *resultError = 0.0f;
+    if(vertexCount == 0 || indices.size() <= targetIndexCount)
+    {
+        return indices;
+    }
+
+    // Weld identical vertices so that duplicated vertices do not look like borders
+    computeVertexRemap(vertices, attributeRemap, positionRemap);
+    result.resize(indices.size());
+    for(size_t i=0; i<indices.size(); i++)
+    {
+        result[i] = attributeRemap[indices[i]];
+    }
+    computeLockedVertices(vertexCount, result, attributeRemap, positionRemap, locked);
+
+    // Work in a normalized space so that errors do not depend on the size of the model
+    minPosition = maxPosition = glm::dvec3(vertices[0].position);
+    for(size_t i=1; i<vertexCount; i++)
+    {
+        minPosition = glm::min(minPosition, glm::dvec3(vertices[i].position));
+        maxPosition = glm::max(maxPosition, glm::dvec3(vertices[i].position));
+    }
+    scale = std::max(maxPosition.x - minPosition.x, std::max(maxPosition.y - minPosition.y, maxPosition.z - minPosition.z));
+    scale = (scale > 0.0) ? scale : 1.0;
+    for(size_t i=0; i<vertexCount; i++)
+    {
+        positions[i] = (glm::dvec3(vertices[i].position) - minPosition) / scale;
+    }
+
+    // Initialize the quadric of each vertex with the planes of its triangles
+    std::fill(quadrics.begin(), quadrics.end(), Quadric());
+    for(size_t i=0; i<result.size(); i+=3)
+    {
+        glm::dvec3 p0 = positions[result[i]];
+        glm::dvec3 normal = glm::cross(positions[result[i+1]] - p0, positions[result[i+2]] - p0);
+        double area = glm::length(normal);
+
+        if(area > 0.0)
+        {
+            normal /= area;
+            for(unsigned int j=0; j<3; j++)
+            {
+                addPlane(quadrics[result[i+j]], normal, -glm::dot(normal, p0), area);
+            }
+        }
+    }
+
+    // Collapse edges by passes until the target is reached
+    while(result.size() > targetIndexCount)
+    {
+        size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+
+        // Build vertex -> triangles adjacency
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for(size_t i=0; i<result.size(); i++)
+        {
+            adjacencyOffsets[result[i] + 1]++;
+        }
+        for(size_t i=0; i<vertexCount; i++)
+        {
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<GLuint> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for(size_t i=0; i<result.size(); i++)
+            {
+                adjacency[fill[result[i]]++] = static_cast<GLuint>(i / 3);
+            }
+        }
+
+        // Compute the cost of each directed edge collapse
+        collapses.clear();
+        for(size_t i=0; i<result.size(); i+=3)
+        {
+            for(unsigned int j=0; j<3; j++)
+            {
+                GLuint from = result[i + j];
+                GLuint to = result[i + (j + 1) % 3];
+                double edgeLength2 = 0.0;
+                double attributeError = 0.0;
+                EdgeCollapse collapse;
+
+                if(locked[from] || from == to)
+                {
+                    continue;
+                }
+
+                Quadric quadric = quadrics[from];
+                addQuadric(quadric, quadrics[to]);
+
+                // Attribute-aware penalty: moving a vertex far onto a vertex with other attributes costs more
+                edgeLength2 = glm::dot(positions[from] - positions[to], positions[from] - positions[to]);
+                attributeError = NORMAL_ERROR_WEIGHT * (1.0 - glm::dot(glm::dvec3(vertices[from].normal), glm::dvec3(vertices[to].normal)));
+                attributeError += TEXTCOORDS_ERROR_WEIGHT * glm::dot(glm::dvec2(vertices[from].textCoords - vertices[to].textCoords), glm::dvec2(vertices[from].textCoords - vertices[to].textCoords));
+
+                collapse.from = from;
+                collapse.to = to;
+                collapse.error = std::max(0.0, evaluate(quadric, positions[to]));
+                collapse.cost = collapse.error + edgeLength2 * attributeError;
+                collapses.push_back(collapse);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b) { return a.cost < b.cost; });
+
+        // Apply the cheapest independent collapses
+        for(size_t i=0; i<vertexCount; i++)
+        {
+            collapseRemap[i] = static_cast<GLuint>(i);
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+        for(size_t i=0; i<collapses.size() && removedTriangles < trianglesToRemove; i++)
+        {
+            const EdgeCollapse& collapse = collapses[i];
+
+            if(touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+            if(flipsTriangle(positions, result, adjacencyOffsets, adjacency, collapse.from, collapse.to))
+            {
+                continue;
+            }
+
+            collapseRemap[collapse.from] = collapse.to;
+            addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+            maxError = std::max(maxError, collapse.error);
+            collapseCount++;
+
+            // Triangles around "from" are modified : do not touch their vertices again in this pass
+            for(GLuint k=adjacencyOffsets[collapse.from]; k<adjacencyOffsets[collapse.from + 1]; k++)
+            {
+                GLuint triangle = adjacency[k];
+                bool containsTo = false;
+
+                for(unsigned int j=0; j<3; j++)
+                {
+                    touched[result[triangle*3 + j]] = 1;
+                    containsTo = containsTo || (result[triangle*3 + j] == collapse.to);
+                }
+                removedTriangles += containsTo ? 1 : 0;
+            }
+        }
+
+        if(collapseCount == 0)
+        {
+            break;
+        }
+
+        // Remap indices and remove degenerated triangles
+        size_t writeIndex = 0;
+        for(size_t i=0; i<result.size(); i+=3)
+        {
+            GLuint a = collapseRemap[result[i]];
+            GLuint b = collapseRemap[result[i+1]];
+            GLuint c = collapseRemap[result[i+2]];
+
+            if(a != b && b != c && a != c)
+            {
+                result[writeIndex++] = a;
+                result[writeIndex++] = b;
+                result[writeIndex++] = c;
+            }
+        }
+        result.resize(writeIndex);
+    }
+
+    // Geometric distance only, back in mesh units
+    *resultError = static_cast<float>(std::sqrt(maxError) * scale);
+
+    return result;
+}
+
+
+// =================
+// Auxiliary methods
+
+void MeshSimplifier::computeVertexRemap(const std::vector<Vertex>& vertices, std::vector<GLuint>& attributeRemap, std::vector<GLuint>& positionRemap)
+{
+    std::vector<GLuint> order(vertices.size());
+
+    for(size_t i=0; i<vertices.size(); i++)
+    {
+        order[i] = static_cast<GLuint>(i);
+    }
+
+    // Sort vertices by position, then by normal and texture coordinates
+    std::sort(order.begin(), order.end(), [&vertices](GLuint a, GLuint b)
+    {
+        const float* first = &vertices[a].position.x;
+        const float* second = &vertices[b].position.x;
+        for(unsigned int i=0; i<8; i++)
+        {
+            if(first[i] != second[i])
+            {
+                return first[i] < second[i];
+            }
+        }
+        return a < b;
+    });
+
+    attributeRemap.resize(vertices.size());
+    positionRemap.resize(vertices.size());
+    for(size_t i=0; i<order.size(); i++)
+    {
+        const Vertex& current = vertices[order[i]];
+
+        if(i > 0 && current.position == vertices[order[i-1]].position)
+        {
+            positionRemap[order[i]] = positionRemap[order[i-1]];
+            if(current.normal == vertices[order[i-1]].normal && current.textCoords == vertices[order[i-1]].textCoords)
+            {
+                attributeRemap[order[i]] = attributeRemap[order[i-1]];
+                continue;
+            }
+        }
+        else
+        {
+            positionRemap[order[i]] = order[i];
+        }
+        attributeRemap[order[i]] = order[i];
+    }
+}
+
+
+void MeshSimplifier::computeLockedVertices(size_t vertexCount, const std::vector<GLuint>& indices, const std::vector<GLuint>& attributeRemap, const std::vector<GLuint>& positionRemap, std::vector<char>& locked)
+{
+    std::vector<GLuint> attributeVertexPerPosition(vertexCount, GL_INVALID_INDEX);
+    std::vector<unsigned long long> edges;
+
+    locked.assign(vertexCount, 0);
+
+    // Seams : several distinct vertices at the same position
+    for(size_t i=0; i<vertexCount; i++)
+    {
+        GLuint position = positionRemap[i];
+        GLuint vertex = attributeRemap[i];
+
+        if(attributeVertexPerPosition[position] == GL_INVALID_INDEX)
+        {
+            attributeVertexPerPosition[position] = vertex;
+        }
+        else if(attributeVertexPerPosition[position] != vertex)
+        {
+            locked[position] = 1;
+        }
+    }
+    for(size_t i=0; i<vertexCount; i++)
+    {
+        locked[i] = locked[positionRemap[i]];
+    }
+
+    // Borders : edges (by position) used by only one triangle
+    edges.reserve(indices.size());
+    for(size_t i=0; i<indices.size(); i+=3)
+    {
+        for(unsigned int j=0; j<3; j++)
+        {
+            unsigned long long a = positionRemap[indices[i + j]];
+            unsigned long long b = positionRemap[indices[i + (j + 1) % 3]];
+            edges.push_back((std::min(a, b) << 32) | std::max(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for(size_t i=0; i<edges.size(); )
+    {
+        size_t j = i + 1;
+        while(j < edges.size() && edges[j] == edges[i])
+        {
+            j++;
+        }
+        if(j - i == 1)
+        {
+            locked[static_cast<GLuint>(edges[i] >> 32)] = 1;
+            locked[static_cast<GLuint>(edges[i] & 0xffffffffull)] = 1;
+        }
+        i = j;
+    }
+    for(size_t i=0; i<vertexCount; i++)
+    {
+        locked[i] = locked[i] || locked[positionRemap[i]];
+    }
+}
+
+
+void MeshSimplifier::addPlane(Quadric& quadric, const glm::dvec3& normal, double distance, double weight)
+{
+    quadric.a2 += weight * normal.x * normal.x;
+    quadric.ab += weight * normal.x * normal.y;
+    quadric.ac += weight * normal.x * normal.z;
+    quadric.ad += weight * normal.x * distance;
+    quadric.b2 += weight * normal.y * normal.y;
+    quadric.bc += weight * normal.y * normal.z;
+    quadric.bd += weight * normal.y * distance;
+    quadric.c2 += weight * normal.z * normal.z;
+    quadric.cd += weight * normal.z * distance;
+    quadric.d2 += weight * distance * distance;
+    quadric.weight += weight;
+}
+
+
+void MeshSimplifier::addQuadric(Quadric& destination, const Quadric& source)
+{
+    destination.a2 += source.a2;
+    destination.ab += source.ab;
+    destination.ac += source.ac;
+    destination.ad += source.ad;
+    destination.b2 += source.b2;
+    destination.bc += source.bc;
+    destination.bd += source.bd;
+    destination.c2 += source.c2;
+    destination.cd += source.cd;
+    destination.d2 += source.d2;
+    destination.weight += source.weight;
+}
+
+
+double MeshSimplifier::evaluate(const Quadric& quadric, const glm::dvec3& point)
+{
+    // The planes are weighted by the areas of their triangles, the sum is normalized to stay a squared distance
+    if(quadric.weight <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return (quadric.a2 * point.x * point.x + 2.0 * quadric.ab * point.x * point.y + 2.0 * quadric.ac * point.x * point.z + 2.0 * quadric.ad * point.x
+         + quadric.b2 * point.y * point.y + 2.0 * quadric.bc * point.y * point.z + 2.0 * quadric.bd * point.y
+         + quadric.c2 * point.z * point.z + 2.0 * quadric.cd * point.z
+         + quadric.d2) / quadric.weight;
+}
+
+
+bool MeshSimplifier::flipsTriangle(const std::vector<glm::dvec3>& positions, const std::vector<GLuint>& indices, const std::vector<GLuint>& adjacencyOffsets, const std::vector<GLuint>& adjacency, GLuint from, GLuint to)
+{
+    for(GLuint k=adjacencyOffsets[from]; k<adjacencyOffsets[from + 1]; k++)
+    {
+        GLuint triangle = adjacency[k];
+        GLuint a = indices[triangle*3];
+        GLuint b = indices[triangle*3 + 1];
+        GLuint c = indices[triangle*3 + 2];
+
+        // Triangles containing the collapsed edge disappear
+        if(a == to || b == to || c == to)
+        {
+            continue;
+        }
+
+        glm::dvec3 before = glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+        a = (a == from) ? to : a;
+        b = (b == from) ? to : b;
+        c = (c == from) ? to : c;
+        glm::dvec3 after = glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+
+        if(glm::dot(before, after) <= 0.0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,100 @@
+#ifndef __MESHSIMPLIFIER_H
+#define __MESHSIMPLIFIER_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Mesh
+#include "Mesh.h"
+
+
+/**
+ * @brief The Quadric struct store the symmetric 4x4 error matrix of a vertex (Garland & Heckbert)
+ */
+struct Quadric
+{
+    double a2, ab, ac, ad;
+    double b2, bc, bd;
+    double c2, cd;
+    double d2;
+    /// Sum of the weights (triangle areas) of the planes
+    double weight;
+};
+
+
+/**
+ * @brief The MeshSimplifier class reduce the triangle count of an indexed mesh by quadric edge collapses.
+ *        Collapses only move a vertex onto one of its neighbours so that every level of detail can share the
+ *        vertex buffer of the original mesh.
+ */
+class MeshSimplifier
+{
+// Methods
+public:
+
+
+    /**
+     * @brief simplify collapse edges of the given triangle list until targetIndexCount is reached or no collapse is possible
+     * @param vertices vertex buffer of the mesh (never modified)
+     * @param indices triangle list to simplify
+     * @param targetIndexCount wanted number of indices in the simplified triangle list
+     * @param resultError filled with the geometric error of the simplification, in mesh units
+     * @return the simplified triangle list, indexing the same vertex buffer
+     */
+    static std::vector<GLuint> simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, size_t targetIndexCount, float* resultError);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief computeVertexRemap give each vertex the index of its first identical vertex and of its first vertex at the same position
+     * @param vertices vertex buffer of the mesh
+     * @param attributeRemap filled with the index of the first vertex with the same position, normal and texture coordinates
+     * @param positionRemap filled with the index of the first vertex with the same position
+     */
+    static void computeVertexRemap(const std::vector<Vertex>& vertices, std::vector<GLuint>& attributeRemap, std::vector<GLuint>& positionRemap);
+
+
+    /**
+     * @brief computeLockedVertices lock the vertices lying on a UV/normal seam or on a border of the mesh
+     * @param vertexCount number of vertices
+     * @param indices triangle list
+     * @param attributeRemap vertex remap by attributes
+     * @param positionRemap vertex remap by position
+     * @param locked filled with 1 for each vertex which must not be moved
+     */
+    static void computeLockedVertices(size_t vertexCount, const std::vector<GLuint>& indices, const std::vector<GLuint>& attributeRemap, const std::vector<GLuint>& positionRemap, std::vector<char>& locked);
+
+
+    /**
+     * @brief addPlane accumulate the plane of a triangle in the given quadric
+     */
+    static void addPlane(Quadric& quadric, const glm::dvec3& normal, double distance, double weight);
+
+
+    /**
+     * @brief addQuadric accumulate a quadric in another
+     */
+    static void addQuadric(Quadric& destination, const Quadric& source);
+
+
+    /**
+     * @brief evaluate return the mean squared distance between the point and the planes stored in the quadric, weighted by their areas
+     */
+    static double evaluate(const Quadric& quadric, const glm::dvec3& point);
+
+
+    /**
+     * @brief flipsTriangle verify if moving vertex "from" onto vertex "to" would flip or degenerate one of the triangles of "from"
+     */
+    static bool flipsTriangle(const std::vector<glm::dvec3>& positions, const std::vector<GLuint>& indices, const std::vector<GLuint>& adjacencyOffsets, const std::vector<GLuint>& adjacency, GLuint from, GLuint to);
+};
+
+
+#endif
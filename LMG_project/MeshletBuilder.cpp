@@ -0,0 +1,234 @@
+#include "MeshletBuilder.h"
+
+
+// =======
+// Methods
+
+void MeshletBuilder::build(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, GLuint indexCount, std::vector<Meshlet>& meshlets)
+{
+    size_t triangleCount = indexCount / 3;
+    std::vector<GLuint> adjacencyOffsets(vertices.size() + 1, 0);
+    std::vector<GLuint> adjacency(triangleCount * 3);
+    std::vector<char> usedTriangles(triangleCount, 0);
+    std::vector<GLuint> vertexMeshlet(vertices.size(), GL_INVALID_INDEX);
+    std::vector<GLuint> meshletVertices;
+    std::vector<GLuint> reordered;
+    std::vector<glm::vec3> triangleNormals(triangleCount);
+    glm::vec3 meshletNormal;
+    Meshlet meshlet;
+
+    meshlets.clear();
+    reordered.reserve(triangleCount * 3);
+    meshletVertices.reserve(MESHLET_MAX_VERTICES);
+
+    // Build vertex -> triangles adjacency
+    for(size_t i=0; i<triangleCount * 3; i++)
+    {
+        adjacencyOffsets[indices[i] + 1]++;
+    }
+    for(size_t i=0; i<vertices.size(); i++)
+    {
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    }
+    {
+        std::vector<GLuint> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(size_t i=0; i<triangleCount * 3; i++)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<GLuint>(i / 3);
+        }
+    }
+
+    // Unit normal of each triangle
+    for(size_t i=0; i<triangleCount; i++)
+    {
+        glm::vec3 p0 = vertices[indices[i*3]].position;
+        glm::vec3 normal = glm::cross(vertices[indices[i*3 + 1]].position - p0, vertices[indices[i*3 + 2]].position - p0);
+        float area = glm::length(normal);
+
+        triangleNormals[i] = (area > 0.0f) ? normal / area : glm::vec3(0.0f);
+    }
+
+    // Grow each meshlet from a seed triangle with the neighbouring triangles adding the fewest vertices
+    for(size_t seed=0; seed<triangleCount; seed++)
+    {
+        GLuint meshletId = static_cast<GLuint>(meshlets.size());
+        GLuint candidate = static_cast<GLuint>(seed);
+        GLuint meshletTriangles = 0;
+        size_t nextTriangle = seed + 1;
+
+        if(usedTriangles[seed])
+        {
+            continue;
+        }
+
+        meshletVertices.clear();
+        meshlet.indexOffset = static_cast<GLuint>(reordered.size());
+
+        meshletNormal = glm::vec3(0.0f);
+
+        while(candidate != GL_INVALID_INDEX)
+        {
+            float bestScore = 4.0f + MESHLET_CONE_WEIGHT * 2.0f;
+            glm::vec3 meshletAxis;
+
+            // Add the triangle to the meshlet
+            usedTriangles[candidate] = 1;
+            for(unsigned int j=0; j<3; j++)
+            {
+                GLuint vertex = indices[candidate*3 + j];
+                reordered.push_back(vertex);
+                if(vertexMeshlet[vertex] != meshletId)
+                {
+                    vertexMeshlet[vertex] = meshletId;
+                    meshletVertices.push_back(vertex);
+                }
+            }
+            meshletTriangles++;
+            meshletNormal += triangleNormals[candidate];
+
+            if(meshletTriangles == MESHLET_MAX_TRIANGLES)
+            {
+                break;
+            }
+
+            // Look for the unused triangle around the meshlet adding the fewest vertices and keeping the normal cone tight
+            meshletAxis = (glm::length(meshletNormal) > 0.0f) ? glm::normalize(meshletNormal) : glm::vec3(0.0f);
+            candidate = GL_INVALID_INDEX;
+            for(size_t i=0; i<meshletVertices.size(); i++)
+            {
+                GLuint vertex = meshletVertices[i];
+                for(GLuint k=adjacencyOffsets[vertex]; k<adjacencyOffsets[vertex + 1]; k++)
+                {
+                    GLuint triangle = adjacency[k];
+                    GLuint newVertices = 0;
+                    float score = 0.0f;
+
+                    if(usedTriangles[triangle] || glm::dot(meshletAxis, triangleNormals[triangle]) < MESHLET_MIN_CONE_DOT)
+                    {
+                        continue;
+                    }
+                    for(unsigned int j=0; j<3; j++)
+                    {
+                        newVertices += (vertexMeshlet[indices[triangle*3 + j]] != meshletId) ? 1 : 0;
+                    }
+                    score = static_cast<float>(newVertices) + MESHLET_CONE_WEIGHT * (1.0f - glm::dot(meshletAxis, triangleNormals[triangle]));
+                    if(score < bestScore && meshletVertices.size() + newVertices <= MESHLET_MAX_VERTICES)
+                    {
+                        bestScore = score;
+                        candidate = triangle;
+                    }
+                }
+            }
+
+            // No neighbour left : continue with the next unused triangle, close in the index buffer
+            while(candidate == GL_INVALID_INDEX && nextTriangle < triangleCount)
+            {
+                if(!usedTriangles[nextTriangle])
+                {
+                    if(meshletVertices.size() + 3 <= MESHLET_MAX_VERTICES && glm::dot(meshletAxis, triangleNormals[nextTriangle]) >= MESHLET_MIN_CONE_DOT)
+                    {
+                        candidate = static_cast<GLuint>(nextTriangle);
+                    }
+                    break;
+                }
+                nextTriangle++;
+            }
+        }
+
+        meshlet.indexCount = static_cast<GLuint>(reordered.size()) - meshlet.indexOffset;
+        meshlets.push_back(meshlet);
+    }
+
+    // Write the triangles in meshlet order
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+
+    for(size_t i=0; i<meshlets.size(); i++)
+    {
+        computeMeshletBounds(vertices, indices, meshlets[i]);
+    }
+}
+
+
+void MeshletBuilder::buildBounds(const std::vector<Meshlet>& meshlets, MeshletBounds& bounds)
+{
+    size_t paddedCount = (meshlets.size() + 3) & ~static_cast<size_t>(3);
+
+    bounds.centerX.assign(paddedCount, 0.0f);
+    bounds.centerY.assign(paddedCount, 0.0f);
+    bounds.centerZ.assign(paddedCount, 0.0f);
+    bounds.radius.assign(paddedCount, 0.0f);
+    bounds.coneAxisX.assign(paddedCount, 0.0f);
+    bounds.coneAxisY.assign(paddedCount, 0.0f);
+    bounds.coneAxisZ.assign(paddedCount, 0.0f);
+    bounds.coneCutoff.assign(paddedCount, 1.0f);
+
+    for(size_t i=0; i<meshlets.size(); i++)
+    {
+        bounds.centerX[i] = meshlets[i].center.x;
+        bounds.centerY[i] = meshlets[i].center.y;
+        bounds.centerZ[i] = meshlets[i].center.z;
+        bounds.radius[i] = meshlets[i].radius;
+        bounds.coneAxisX[i] = meshlets[i].coneAxis.x;
+        bounds.coneAxisY[i] = meshlets[i].coneAxis.y;
+        bounds.coneAxisZ[i] = meshlets[i].coneAxis.z;
+        bounds.coneCutoff[i] = meshlets[i].coneCutoff;
+    }
+}
+
+
+// =================
+// Auxiliary methods
+
+void MeshletBuilder::computeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, Meshlet& meshlet)
+{
+    glm::vec3 minPosition = vertices[indices[meshlet.indexOffset]].position;
+    glm::vec3 maxPosition = minPosition;
+    glm::vec3 normalSum(0.0f);
+    std::vector<glm::vec3> normals;
+    float minDot = 1.0f;
+
+    // Bounding sphere centered on the bounding box
+    for(GLuint i=meshlet.indexOffset; i<meshlet.indexOffset + meshlet.indexCount; i++)
+    {
+        minPosition = glm::min(minPosition, vertices[indices[i]].position);
+        maxPosition = glm::max(maxPosition, vertices[indices[i]].position);
+    }
+    meshlet.center = (minPosition + maxPosition) * 0.5f;
+    meshlet.radius = 0.0f;
+    for(GLuint i=meshlet.indexOffset; i<meshlet.indexOffset + meshlet.indexCount; i++)
+    {
+        meshlet.radius = std::max(meshlet.radius, glm::length(vertices[indices[i]].position - meshlet.center));
+    }
+
+    // Normal cone of the triangles
+    for(GLuint i=meshlet.indexOffset; i<meshlet.indexOffset + meshlet.indexCount; i+=3)
+    {
+        glm::vec3 p0 = vertices[indices[i]].position;
+        glm::vec3 normal = glm::cross(vertices[indices[i+1]].position - p0, vertices[indices[i+2]].position - p0);
+        float area = glm::length(normal);
+
+        if(area > 0.0f)
+        {
+            normalSum += normal;
+            normals.push_back(normal / area);
+        }
+    }
+
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneCutoff = 1.0f;
+    if(glm::length(normalSum) <= 0.0f)
+    {
+        return;
+    }
+    meshlet.coneAxis = glm::normalize(normalSum);
+    for(size_t i=0; i<normals.size(); i++)
+    {
+        minDot = std::min(minDot, glm::dot(meshlet.coneAxis, normals[i]));
+    }
+
+    // The cone is widened by 90 degrees to get the view directions seeing only back faces
+    if(minDot > 0.0f)
+    {
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef __MESHLETBUILDER_H
+#define __MESHLETBUILDER_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Mesh
+#include "Mesh.h"
+
+
+// Maximal number of vertices of a meshlet
+#define MESHLET_MAX_VERTICES 64
+// Maximal number of triangles of a meshlet
+#define MESHLET_MAX_TRIANGLES 124
+// Weight of the normal deviation when choosing the next triangle of a meshlet (in number of added vertices)
+#define MESHLET_CONE_WEIGHT 2.0f
+// Minimal cosine between the average normal of a meshlet and the normal of a triangle added to it
+#define MESHLET_MIN_CONE_DOT 0.3f
+
+
+/**
+ * @brief The MeshletBuilder class split a triangle list into meshlets of neighbouring triangles
+ */
+class MeshletBuilder
+{
+// Methods
+public:
+
+
+    /**
+     * @brief build group the triangles of the index range [0, indexCount) into meshlets and reorder the range so that each meshlet is contiguous
+     * @param vertices vertex buffer of the mesh
+     * @param indices index buffer of the mesh, reordered in place
+     * @param indexCount number of indices to split (the full resolution level of detail)
+     * @param meshlets filled with the meshlets
+     */
+    static void build(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, GLuint indexCount, std::vector<Meshlet>& meshlets);
+
+
+    /**
+     * @brief buildBounds copy the bounds of the meshlets in the structure of arrays used for culling
+     * @param meshlets meshlets of the mesh
+     * @param bounds filled with the bounds, padded to a multiple of 4 meshlets
+     */
+    static void buildBounds(const std::vector<Meshlet>& meshlets, MeshletBounds& bounds);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief computeMeshletBounds compute the bounding sphere and the normal cone of a meshlet
+     * @param vertices vertex buffer of the mesh
+     * @param indices index buffer of the mesh
+     * @param meshlet meshlet with its index range set, its bounds are filled
+     */
+    static void computeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, Meshlet& meshlet);
+
+};
+
+
+#endif
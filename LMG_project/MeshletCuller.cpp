@@ -0,0 +1,135 @@
+#include "MeshletCuller.h"
+
+
+// Triangles culled since the last reset (zero-initialized, the counters are atomic)
+MeshletCullingStatistics MeshletCuller::statistics;
+
+
+// =======
+// Methods
+
+void MeshletCuller::cull(const std::vector<Meshlet>& meshlets, const MeshletBounds& bounds, const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, bool coneCulling, std::vector<GLuint>& drawCounts, std::vector<GLuint>& drawFirstIndices)
+{
+    glm::vec4 planes[6];
+    size_t meshletCount = meshlets.size();
+    unsigned long long testedTriangles = 0;
+    unsigned long long frustumCulledTriangles = 0;
+    unsigned long long backfaceCulledTriangles = 0;
+
+    drawCounts.clear();
+    drawFirstIndices.clear();
+    FrustumCuller::extractFrustumPlanes(modelViewProjection, planes);
+
+    for(size_t i=0; i<meshletCount; i+=4)
+    {
+        int insideMask = 0;
+        int frontMask = 0;
+
+#ifdef MESHLET_CULLING_SSE
+        __m128 centerX = _mm_loadu_ps(&bounds.centerX[i]);
+        __m128 centerY = _mm_loadu_ps(&bounds.centerY[i]);
+        __m128 centerZ = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 radius = _mm_loadu_ps(&bounds.radius[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+        __m128 inside = _mm_cmpeq_ps(radius, radius);
+
+        // Bounding sphere against each frustum plane
+        for(unsigned int p=0; p<6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(planes[p].x)), _mm_mul_ps(centerY, _mm_set1_ps(planes[p].y))),
+                                         _mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(distance, negativeRadius));
+        }
+        insideMask = _mm_movemask_ps(inside);
+
+        // Normal cone against the view direction : dot(center - camera, axis) >= cutoff * |center - camera| + radius means back facing
+        __m128 viewX = _mm_sub_ps(centerX, _mm_set1_ps(cameraPosition.x));
+        __m128 viewY = _mm_sub_ps(centerY, _mm_set1_ps(cameraPosition.y));
+        __m128 viewZ = _mm_sub_ps(centerZ, _mm_set1_ps(cameraPosition.z));
+        __m128 viewLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(viewX, viewX), _mm_mul_ps(viewY, viewY)), _mm_mul_ps(viewZ, viewZ)));
+        __m128 viewDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(viewX, _mm_loadu_ps(&bounds.coneAxisX[i])), _mm_mul_ps(viewY, _mm_loadu_ps(&bounds.coneAxisY[i]))),
+                                    _mm_mul_ps(viewZ, _mm_loadu_ps(&bounds.coneAxisZ[i])));
+        __m128 backLimit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&bounds.coneCutoff[i]), viewLength), radius);
+        frontMask = _mm_movemask_ps(_mm_cmplt_ps(viewDot, backLimit));
+#else
+        for(unsigned int j=0; j<4; j++)
+        {
+            glm::vec3 center(bounds.centerX[i + j], bounds.centerY[i + j], bounds.centerZ[i + j]);
+            glm::vec3 axis(bounds.coneAxisX[i + j], bounds.coneAxisY[i + j], bounds.coneAxisZ[i + j]);
+            bool inside = true;
+
+            for(unsigned int p=0; p<6; p++)
+            {
+                inside = inside && (glm::dot(glm::vec3(planes[p]), center) + planes[p].w > -bounds.radius[i + j]);
+            }
+            insideMask |= inside ? (1 << j) : 0;
+            frontMask |= (glm::dot(center - cameraPosition, axis) < bounds.coneCutoff[i + j] * glm::length(center - cameraPosition) + bounds.radius[i + j]) ? (1 << j) : 0;
+        }
+#endif
+
+        if(!coneCulling)
+        {
+            frontMask = 0xf;
+        }
+
+        for(unsigned int j=0; j<4 && i + j<meshletCount; j++)
+        {
+            const Meshlet& meshlet = meshlets[i + j];
+
+            testedTriangles += meshlet.indexCount / 3;
+            if(!(insideMask & (1 << j)))
+            {
+                frustumCulledTriangles += meshlet.indexCount / 3;
+            }
+            else if(!(frontMask & (1 << j)))
+            {
+                backfaceCulledTriangles += meshlet.indexCount / 3;
+            }
+            else
+            {
+                addRange(meshlet, drawCounts, drawFirstIndices);
+            }
+        }
+    }
+
+    // Meshes are culled by several threads, the shared counters are updated once per mesh
+    statistics.testedTriangles += testedTriangles;
+    statistics.frustumCulledTriangles += frustumCulledTriangles;
+    statistics.backfaceCulledTriangles += backfaceCulledTriangles;
+}
+
+
+void MeshletCuller::resetStatistics()
+{
+    statistics.testedTriangles = 0;
+    statistics.frustumCulledTriangles = 0;
+    statistics.backfaceCulledTriangles = 0;
+}
+
+
+void MeshletCuller::printStatistics()
+{
+    double tested = static_cast<double>(std::max(statistics.testedTriangles.load(), 1ull));
+
+    std::cout << "Meshlet culling : " << statistics.testedTriangles << " triangles tested, "
+              << 100.0 * (statistics.frustumCulledTriangles + statistics.backfaceCulledTriangles) / tested << "% culled ("
+              << 100.0 * statistics.frustumCulledTriangles / tested << "% frustum, "
+              << 100.0 * statistics.backfaceCulledTriangles / tested << "% back facing)" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+void MeshletCuller::addRange(const Meshlet& meshlet, std::vector<GLuint>& drawCounts, std::vector<GLuint>& drawFirstIndices)
+{
+    // Meshlets are contiguous in the index buffer : extend the previous range when possible
+    if(!drawCounts.empty() && drawFirstIndices.back() + drawCounts.back() == meshlet.indexOffset)
+    {
+        drawCounts.back() += meshlet.indexCount;
+        return;
+    }
+
+    drawCounts.push_back(meshlet.indexCount);
+    drawFirstIndices.push_back(meshlet.indexOffset);
+}
@@ -0,0 +1,92 @@
+#ifndef __MESHLETCULLER_H
+#define __MESHLETCULLER_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <cmath>
+#include <atomic>
+
+// SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MESHLET_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+// Meshlets
+#include "MeshletBuilder.h"
+
+// Frustum planes
+#include "FrustumCuller.h"
+
+
+/**
+ * @brief The MeshletCullingStatistics struct count the triangles processed by the meshlet culling since the last reset
+ *        (counted by the worker threads preparing the frame)
+ */
+struct MeshletCullingStatistics
+{
+    /// Triangles of the tested meshlets
+    std::atomic<unsigned long long> testedTriangles;
+    /// Triangles of the meshlets outside of the view frustum
+    std::atomic<unsigned long long> frustumCulledTriangles;
+    /// Triangles of the meshlets only facing away from the camera
+    std::atomic<unsigned long long> backfaceCulledTriangles;
+};
+
+
+/**
+ * @brief The MeshletCuller class reject the meshlets outside of the view or facing away from the camera,
+ *        four meshlets at a time, and build the multi-draw ranges of the remaining ones
+ */
+class MeshletCuller
+{
+// Attributes
+public:
+    /// Triangles culled since the last call to resetStatistics
+    static MeshletCullingStatistics statistics;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief cull test the meshlets of a mesh against the camera
+     * @param meshlets meshlets of the mesh
+     * @param bounds bounds of the meshlets as one array per component
+     * @param modelViewProjection matrix from mesh space to clip space
+     * @param cameraPosition position of the camera in mesh space
+     * @param coneCulling true to also reject the meshlets facing away from the camera
+     * @param drawCounts filled with the index count of each range to draw
+     * @param drawFirstIndices filled with the first index in the index buffer of the mesh of each range to draw
+     */
+    static void cull(const std::vector<Meshlet>& meshlets, const MeshletBounds& bounds, const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, bool coneCulling, std::vector<GLuint>& drawCounts, std::vector<GLuint>& drawFirstIndices);
+
+
+    /**
+     * @brief resetStatistics reset the culling counters (called at the beginning of each frame)
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the fraction of triangles culled since the last reset
+     */
+    static void printStatistics();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief addRange add the index range of a visible meshlet to the draw ranges, merged with the previous one when contiguous
+     */
+    static void addRange(const Meshlet& meshlet, std::vector<GLuint>& drawCounts, std::vector<GLuint>& drawFirstIndices);
+
+};
+
+
+#endif
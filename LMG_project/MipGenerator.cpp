@@ -0,0 +1,324 @@
+#include "MipGenerator.h"
+
+
+// =======
+// Methods
+
+void MipGenerator::generateMipChain(const unsigned char* texels, int width, int height, const MipGenerationSettings& settings, std::vector<MipLevel>& levels)
+{
+    std::vector<float> linear(static_cast<size_t>(width) * height * 4);
+    std::vector<float> next;
+    float coverage = 0.0f;
+    bool preserveCoverage = false;
+
+    levels.resize(1);
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].texels.assign(texels, texels + static_cast<size_t>(width) * height * 4);
+
+    parallelFor(height, [&](int first, int last)
+    {
+        size_t offset = static_cast<size_t>(first) * width;
+        toLinear(texels + offset * 4, static_cast<size_t>(last - first) * width, settings.sRGB, linear.data() + offset * 4);
+    });
+
+    // Coverage of the first level, kept by the next ones (a texture without alpha test or fully covered keeps its alpha)
+    if(settings.alphaCoverageThreshold > 0.0f)
+    {
+        coverage = computeAlphaCoverage(linear.data(), linear.size() / 4, settings.alphaCoverageThreshold, 1.0f);
+        preserveCoverage = (coverage > 0.0f && coverage < 1.0f);
+    }
+
+    // Each level is filtered from the floating point version of the previous one
+    while(width > 1 || height > 1)
+    {
+        MipLevel level;
+        float alphaScale = 1.0f;
+
+        reduce(linear, width, height, settings, next, &level.width, &level.height);
+        if(preserveCoverage)
+        {
+            alphaScale = findAlphaScale(next.data(), next.size() / 4, settings.alphaCoverageThreshold, coverage);
+        }
+
+        level.texels.resize(static_cast<size_t>(level.width) * level.height * 4);
+        parallelFor(level.height, [&](int first, int last)
+        {
+            size_t offset = static_cast<size_t>(first) * level.width;
+            toRGBA8(next.data() + offset * 4, static_cast<size_t>(last - first) * level.width, settings.sRGB, alphaScale, level.texels.data() + offset * 4);
+        });
+
+        levels.push_back(level);
+        linear.swap(next);
+        width = level.width;
+        height = level.height;
+    }
+}
+
+
+float MipGenerator::computeAlphaCoverage(const float* texels, size_t count, float threshold, float scale)
+{
+    size_t covered = 0;
+
+    for(size_t i=0; i<count; i++)
+    {
+        covered += (texels[4 * i + 3] * scale > threshold) ? 1 : 0;
+    }
+
+    return (count > 0) ? static_cast<float>(covered) / count : 0.0f;
+}
+
+
+// =================
+// Auxiliary methods
+
+void MipGenerator::toLinear(const unsigned char* texels, size_t count, bool sRGB, float* result)
+{
+    // sRGB to linear conversion of each 8-bit value
+    static const std::vector<float> sRGBToLinear = []()
+    {
+        std::vector<float> table(256);
+        for(int i=0; i<256; i++)
+        {
+            float value = i / 255.0f;
+            table[i] = (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+
+    for(size_t i=0; i<count; i++)
+    {
+        float alpha = texels[4 * i + 3] / 255.0f;
+
+        // Premultiplied so that the colors of transparent texels do not count
+        for(int c=0; c<3; c++)
+        {
+            float value = sRGB ? sRGBToLinear[texels[4 * i + c]] : texels[4 * i + c] / 255.0f;
+            result[4 * i + c] = value * alpha;
+        }
+        result[4 * i + 3] = alpha;
+    }
+}
+
+
+void MipGenerator::toRGBA8(const float* texels, size_t count, bool sRGB, float alphaScale, unsigned char* result)
+{
+    // Linear to sRGB conversion of 4096 linear values
+    static const std::vector<unsigned char> linearToSRGB = []()
+    {
+        std::vector<unsigned char> table(4096);
+        for(int i=0; i<4096; i++)
+        {
+            float value = i / 4095.0f;
+            value = (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            table[i] = static_cast<unsigned char>(std::floor(value * 255.0f + 0.5f));
+        }
+        return table;
+    }();
+
+    for(size_t i=0; i<count; i++)
+    {
+        // The negative lobes of the Kaiser filter can leave the [0, 1] range
+        float alpha = std::min(std::max(texels[4 * i + 3], 0.0f), 1.0f);
+        float inverseAlpha = (alpha > 0.0f) ? 1.0f / alpha : 0.0f;
+
+        for(int c=0; c<3; c++)
+        {
+            float value = std::min(std::max(texels[4 * i + c] * inverseAlpha, 0.0f), 1.0f);
+            result[4 * i + c] = sRGB ? linearToSRGB[static_cast<int>(value * 4095.0f + 0.5f)] : static_cast<unsigned char>(value * 255.0f + 0.5f);
+        }
+        result[4 * i + 3] = static_cast<unsigned char>(std::min(alpha * alphaScale, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+
+void MipGenerator::reduce(const std::vector<float>& texels, int width, int height, const MipGenerationSettings& settings, std::vector<float>& result, int* resultWidth, int* resultHeight)
+{
+    MipFilterKernel horizontalKernel = createKernel(settings.filter, width);
+    MipFilterKernel verticalKernel = createKernel(settings.filter, height);
+    std::vector<float> rows;
+
+    *resultWidth = std::max(width / 2, 1);
+    *resultHeight = std::max(height / 2, 1);
+
+    // Rows first (every source row), then columns (every result row)
+    rows.resize(static_cast<size_t>(*resultWidth) * height * 4);
+    parallelFor(height, [&](int first, int last)
+    {
+        filterHorizontal(texels.data(), width, horizontalKernel, settings.wrap, rows.data(), *resultWidth, first, last);
+    });
+
+    result.resize(static_cast<size_t>(*resultWidth) * (*resultHeight) * 4);
+    parallelFor(*resultHeight, [&](int first, int last)
+    {
+        filterVertical(rows.data(), *resultWidth, height, verticalKernel, settings.wrap, result.data(), first, last);
+    });
+}
+
+
+void MipGenerator::filterHorizontal(const float* texels, int width, const MipFilterKernel& kernel, bool wrap, float* result, int resultWidth, int first, int last)
+{
+    int taps[2 * MIP_KAISER_RADIUS];
+
+    for(int y=first; y<last; y++)
+    {
+        const float* row = texels + static_cast<size_t>(y) * width * 4;
+        float* resultRow = result + static_cast<size_t>(y) * resultWidth * 4;
+
+        for(int x=0; x<resultWidth; x++)
+        {
+            for(int k=0; k<kernel.tapCount; k++)
+            {
+                int position = kernel.step * x + kernel.offset + k;
+                taps[k] = wrap ? ((position % width) + width) % width : std::min(std::max(position, 0), width - 1);
+            }
+
+#ifdef MIP_GENERATION_SSE
+            // The 4 channels of a texel in one register
+            __m128 sum = _mm_setzero_ps();
+            for(int k=0; k<kernel.tapCount; k++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(row + taps[k] * 4)));
+            }
+            _mm_storeu_ps(resultRow + x * 4, sum);
+#else
+            for(int c=0; c<4; c++)
+            {
+                float sum = 0.0f;
+                for(int k=0; k<kernel.tapCount; k++)
+                {
+                    sum += kernel.weights[k] * row[taps[k] * 4 + c];
+                }
+                resultRow[x * 4 + c] = sum;
+            }
+#endif
+        }
+    }
+}
+
+
+void MipGenerator::filterVertical(const float* texels, int width, int height, const MipFilterKernel& kernel, bool wrap, float* result, int first, int last)
+{
+    size_t rowLength = static_cast<size_t>(width) * 4;
+
+    for(int y=first; y<last; y++)
+    {
+        float* resultRow = result + static_cast<size_t>(y) * rowLength;
+
+        std::fill(resultRow, resultRow + rowLength, 0.0f);
+
+        // Whole source rows are accumulated, so that the texels are read in order
+        for(int k=0; k<kernel.tapCount; k++)
+        {
+            int position = kernel.step * y + kernel.offset + k;
+            int sourceY = wrap ? ((position % height) + height) % height : std::min(std::max(position, 0), height - 1);
+            const float* row = texels + static_cast<size_t>(sourceY) * rowLength;
+
+#ifdef MIP_GENERATION_SSE
+            __m128 weight = _mm_set1_ps(kernel.weights[k]);
+            for(size_t i=0; i<rowLength; i+=4)
+            {
+                _mm_storeu_ps(resultRow + i, _mm_add_ps(_mm_loadu_ps(resultRow + i), _mm_mul_ps(weight, _mm_loadu_ps(row + i))));
+            }
+#else
+            for(size_t i=0; i<rowLength; i++)
+            {
+                resultRow[i] += kernel.weights[k] * row[i];
+            }
+#endif
+        }
+    }
+}
+
+
+float MipGenerator::findAlphaScale(const float* texels, size_t count, float threshold, float coverage)
+{
+    float low = 0.0f;
+    float high = 4.0f;
+
+    // The coverage grows with the scale
+    for(int i=0; i<MIP_ALPHA_COVERAGE_STEPS; i++)
+    {
+        float middle = 0.5f * (low + high);
+
+        if(computeAlphaCoverage(texels, count, threshold, middle) < coverage)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return 0.5f * (low + high);
+}
+
+
+void MipGenerator::parallelFor(int rowCount, const std::function<void(int, int)>& function)
+{
+    // Tiles of at least MIP_TILE_ROWS rows, larger ones for the large levels
+    JobSystem::getJobSystem().parallelForRange(static_cast<unsigned int>(std::max(rowCount, 0)), MIP_TILE_ROWS, [&function](unsigned int first, unsigned int last)
+    {
+        function(static_cast<int>(first), static_cast<int>(last));
+    });
+}
+
+
+MipFilterKernel MipGenerator::createKernel(MipFilter filter, int length)
+{
+    MipFilterKernel kernel;
+
+    if(length <= 1)
+    {
+        // Nothing to reduce in this direction
+        kernel.weights[0] = 1.0f;
+        kernel.tapCount = 1;
+        kernel.offset = 0;
+        kernel.step = 1;
+        return kernel;
+    }
+
+    kernel.step = 2;
+    if(filter == BOX_MIP_FILTER)
+    {
+        kernel.weights[0] = kernel.weights[1] = 0.5f;
+        kernel.tapCount = 2;
+        kernel.offset = 0;
+        return kernel;
+    }
+
+    // Half band sinc windowed by a Kaiser window, the result texel being between the source texels 2x and 2x+1
+    auto besselI0 = [](float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        for(int k=1; k<20; k++)
+        {
+            term *= (0.5f * x / k) * (0.5f * x / k);
+            sum += term;
+        }
+        return sum;
+    };
+    float weightSum = 0.0f;
+
+    kernel.tapCount = 2 * MIP_KAISER_RADIUS;
+    kernel.offset = 1 - MIP_KAISER_RADIUS;
+    for(int k=0; k<kernel.tapCount; k++)
+    {
+        float distance = k + kernel.offset - 0.5f;
+        float x = 0.5f * distance * static_cast<float>(M_PI);
+        float sinc = (std::fabs(x) > 1e-6f) ? std::sin(x) / x : 1.0f;
+        float windowPosition = distance / MIP_KAISER_RADIUS;
+        float window = besselI0(MIP_KAISER_ALPHA * std::sqrt(std::max(1.0f - windowPosition * windowPosition, 0.0f))) / besselI0(MIP_KAISER_ALPHA);
+
+        kernel.weights[k] = sinc * window;
+        weightSum += kernel.weights[k];
+    }
+    for(int k=0; k<kernel.tapCount; k++)
+    {
+        kernel.weights[k] /= weightSum;
+    }
+
+    return kernel;
+}
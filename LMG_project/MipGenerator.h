@@ -0,0 +1,187 @@
+#ifndef __MIPGENERATOR_H
+#define __MIPGENERATOR_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+// SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MIP_GENERATION_SSE
+#include <xmmintrin.h>
+#endif
+
+// Jobs
+#include "JobSystem.h"
+
+
+// Number of source texels on each side of the center of the Kaiser filter
+#define MIP_KAISER_RADIUS 3
+// Shape parameter of the Kaiser window (larger is smoother, smaller is sharper)
+#define MIP_KAISER_ALPHA 4.0f
+// Smallest number of rows of a level given to a worker
+#define MIP_TILE_ROWS 16
+// Number of steps of the search of the alpha scale preserving the coverage
+#define MIP_ALPHA_COVERAGE_STEPS 12
+
+
+/**
+ * @brief The MipFilter enum list the filters used to reduce a level to the next one
+ */
+enum MipFilter
+{
+    /// Average of 2x2 texels
+    BOX_MIP_FILTER,
+    /// Windowed sinc over 6x6 texels : sharper at a distance, without the aliasing of the box filter
+    KAISER_MIP_FILTER
+};
+
+
+/**
+ * @brief The MipGenerationSettings struct describe how the levels of a texture are computed
+ */
+struct MipGenerationSettings
+{
+    /// Filter reducing each level to the next one
+    MipFilter filter;
+    /// True when the colors are gamma encoded (sRGB) : they are filtered in linear space
+    bool sRGB;
+    /// True when the texture is repeated : the filter wraps around the borders instead of clamping
+    bool wrap;
+    /// Alpha reference of alpha tested (or cut out) textures, the alpha of each level is scaled to keep the same coverage (0 to keep the alpha)
+    float alphaCoverageThreshold;
+
+    MipGenerationSettings() :
+        filter(KAISER_MIP_FILTER),
+        sRGB(true),
+        wrap(true),
+        alphaCoverageThreshold(0.0f)
+    {
+    }
+};
+
+
+/**
+ * @brief The MipFilterKernel struct is the filter along one direction : result[x] = sum of weights[k] * source[step * x + offset + k]
+ */
+struct MipFilterKernel
+{
+    /// Weights of the taps
+    float weights[2 * MIP_KAISER_RADIUS];
+    /// Number of taps
+    int tapCount;
+    /// Position of the first tap relative to step * x
+    int offset;
+    /// 2 to reduce, 1 to copy a direction which is already 1 texel long
+    int step;
+};
+
+
+/**
+ * @brief The MipLevel struct store an RGBA8 level of a mip chain
+ */
+struct MipLevel
+{
+    /// Size of the level in texels
+    int width;
+    int height;
+    /// RGBA8 texels, row after row
+    std::vector<unsigned char> texels;
+};
+
+
+/**
+ * @brief The MipGenerator class compute the full mip chain of an RGBA8 image on the CPU.
+ *        Levels are filtered in linear space with premultiplied alpha (transparent texels do not bleed into their neighbours),
+ *        each one from the floating point version of the previous one. The rows of each level are shared by the workers of the job system
+ *        and the 4 channels of a texel are filtered together with SSE when available.
+ */
+class MipGenerator
+{
+// Methods
+public:
+
+
+    /**
+     * @brief generateMipChain compute every level of an image down to 1x1
+     * @param texels RGBA8 texels of the image
+     * @param width width of the image
+     * @param height height of the image
+     * @param settings filter, color space, addressing and alpha coverage of the texture
+     * @param levels filled with the levels, the first one being a copy of the image
+     */
+    static void generateMipChain(const unsigned char* texels, int width, int height, const MipGenerationSettings& settings, std::vector<MipLevel>& levels);
+
+
+    /**
+     * @brief computeAlphaCoverage compute the part of the texels of a level whose scaled alpha is above the threshold
+     * @param texels RGBA float texels (premultiplied)
+     * @param count number of texels
+     * @param threshold alpha reference
+     * @param scale scale applied to the alpha
+     */
+    static float computeAlphaCoverage(const float* texels, size_t count, float threshold, float scale);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief toLinear convert RGBA8 texels into premultiplied linear floats
+     */
+    static void toLinear(const unsigned char* texels, size_t count, bool sRGB, float* result);
+
+
+    /**
+     * @brief toRGBA8 convert premultiplied linear float texels back into RGBA8, with the alpha scaled
+     */
+    static void toRGBA8(const float* texels, size_t count, bool sRGB, float alphaScale, unsigned char* result);
+
+
+    /**
+     * @brief reduce compute the next level (half the size in each direction larger than 1) with the two passes of a separable filter
+     */
+    static void reduce(const std::vector<float>& texels, int width, int height, const MipGenerationSettings& settings, std::vector<float>& result, int* resultWidth, int* resultHeight);
+
+
+    /**
+     * @brief filterHorizontal filter the rows of an image from first to last (excluded)
+     */
+    static void filterHorizontal(const float* texels, int width, const MipFilterKernel& kernel, bool wrap, float* result, int resultWidth, int first, int last);
+
+
+    /**
+     * @brief filterVertical filter the columns of an image for the result rows from first to last (excluded)
+     */
+    static void filterVertical(const float* texels, int width, int height, const MipFilterKernel& kernel, bool wrap, float* result, int first, int last);
+
+
+    /**
+     * @brief findAlphaScale search the scale of the alpha of a level giving the coverage of the first level
+     */
+    static float findAlphaScale(const float* texels, size_t count, float threshold, float coverage);
+
+
+    /**
+     * @brief parallelFor call a function on tiles of rows shared by the workers of the job system
+     * @param rowCount number of rows
+     * @param function called with the first row and past the last row of each tile
+     */
+    static void parallelFor(int rowCount, const std::function<void(int, int)>& function);
+
+
+    /**
+     * @brief createKernel create the filter of a direction
+     * @param filter filter of the texture
+     * @param length number of texels of the source along the direction
+     */
+    static MipFilterKernel createKernel(MipFilter filter, int length);
+};
+
+
+#endif
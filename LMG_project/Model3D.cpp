@@ -1,21 +1,39 @@
 #include "Model3D.h"
 
 
+// Camera informations shared by all models (full resolution and no culling until the first call to setViewParameters)
+ViewParameters Model3D::viewParameters = { glm::vec3(0.0f), glm::mat4(1.0f), glm::mat4(1.0f), 0.0f, LOD_PIXEL_ERROR_THRESHOLD, true, true };
+
+
 // ===========
 // Constructor
 
-Model3D::Model3D(std::string path)
+Model3D::Model3D(std::string path) :
+    Model3D()
+{
+    this->loadModel(path);
+}
+
+
+Model3D::Model3D()
 {
     this->WarningMessageForShaderAlreadyShown = false;
     this->localTransformationMatrix = glm::mat4(1.0f);
-    this->loadModel(path);
+    this->vertexFormat = MESH_VERTEX_FORMAT;
+    this->positionDecodeOffset = glm::vec3(0.0f);
+    this->positionDecodeScale = glm::vec3(1.0f);
+    this->cullingIndex = 0;
+    this->boundingBoxMin = glm::vec3(0.0f);
+    this->boundingBoxMax = glm::vec3(0.0f);
+    this->boundingSphereCenter = glm::vec3(0.0f);
+    this->boundingSphereRadius = 0.0f;
 }
 
 
 // ===================
 // Getters and setters
 
-glm::mat4 Model3D::getLocalTransformationMatrix()
+glm::mat4 Model3D::getLocalTransformationMatrix() const
 {
     return this->localTransformationMatrix;
 }
@@ -37,27 +55,130 @@ void Model3D::transformLocalMatrix(glm::mat4 matrix){
     this->localTransformationMatrix = matrix * this->localTransformationMatrix;
 }
 
+void Model3D::setViewParameters(glm::vec3 cameraPosition, glm::mat4 viewMatrix, glm::mat4 sceneMatrix, glm::mat4 projectionMatrix, int viewportHeight)
+{
+    viewParameters.cameraPosition = cameraPosition;
+    viewParameters.sceneMatrix = sceneMatrix;
+    viewParameters.viewProjectionMatrix = projectionMatrix * viewMatrix;
+    viewParameters.projectionScale = projectionMatrix[1][1] * static_cast<float>(viewportHeight) * 0.5f;
+}
+
 // =======
 // Methods
 
 
 void Model3D::draw(Shader &shader)
 {
+    GeometryArena& arena = GeometryArena::getArena(this->vertexFormat);
+
+    this->setVertexDecoding(shader);
+
     for(unsigned int i = 0; i<this->meshes.size(); i++)
     {
-        this->WarningMessageForShaderAlreadyShown = this->meshes[i].draw(shader, this->WarningMessageForShaderAlreadyShown);
+        if(this->meshes[i].visible)
+        {
+            this->WarningMessageForShaderAlreadyShown = this->meshes[i].draw(shader, this->WarningMessageForShaderAlreadyShown);
+        }
+
+        // Consecutive meshes with the same textures are drawn by a single multi-draw call
+        if(i + 1 == this->meshes.size() || !this->meshes[i].hasSameTextures(this->meshes[i + 1]))
+        {
+            arena.submit();
+        }
     }
 }
 
 void Model3D::draw(Shader& shader, GLuint skyboxTextureID)
 {
+    GeometryArena& arena = GeometryArena::getArena(this->vertexFormat);
+
+    this->setVertexDecoding(shader);
+
     for(unsigned int i = 0; i<this->meshes.size(); i++)
     {
-        this->WarningMessageForShaderAlreadyShown = this->meshes[i].draw(shader, skyboxTextureID, this->WarningMessageForShaderAlreadyShown);
+        if(this->meshes[i].visible)
+        {
+            this->WarningMessageForShaderAlreadyShown = this->meshes[i].draw(shader, skyboxTextureID, this->WarningMessageForShaderAlreadyShown);
+        }
+
+        // Consecutive meshes with the same textures are drawn by a single multi-draw call
+        if(i + 1 == this->meshes.size() || !this->meshes[i].hasSameTextures(this->meshes[i + 1]))
+        {
+            arena.submit();
+        }
     }
 }
 
 
+unsigned int Model3D::getShaderFeatures() const
+{
+    return (this->vertexFormat == COMPRESSED_MESH_VERTEX_FORMAT) ? COMPRESSED_VERTICES_FEATURE : 0;
+}
+
+
+VertexFormat Model3D::getVertexFormat() const
+{
+    return this->vertexFormat;
+}
+
+
+unsigned int Model3D::getMaterialKey() const
+{
+    return this->meshes.empty() ? 0 : this->meshes[0].material;
+}
+
+
+void Model3D::reserveBounds(FrustumCuller& culler)
+{
+    this->cullingIndex = culler.reserveBounds(1 + static_cast<unsigned int>(this->meshes.size()));
+}
+
+
+bool Model3D::cull(FrustumCuller& culler)
+{
+    glm::mat4 worldMatrix = viewParameters.sceneMatrix * this->localTransformationMatrix;
+
+    culler.setBounds(this->cullingIndex, this->boundingBoxMin, this->boundingBoxMax, this->boundingSphereCenter, this->boundingSphereRadius, worldMatrix);
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        culler.setBounds(this->cullingIndex + 1 + i, this->meshes[i].boundingBoxMin, this->meshes[i].boundingBoxMax, this->meshes[i].boundingSphereCenter, this->meshes[i].boundingSphereRadius, worldMatrix);
+    }
+    culler.cull(this->cullingIndex, 1 + static_cast<unsigned int>(this->meshes.size()));
+
+    return this->updateVisibility(culler);
+}
+
+
+bool Model3D::updateVisibility(const FrustumCuller& culler)
+{
+    bool modelVisible = culler.isVisible(this->cullingIndex);
+    unsigned int culledMeshes = 0;
+
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        this->meshes[i].visible = modelVisible && culler.isVisible(this->cullingIndex + 1 + i);
+        if(!this->meshes[i].visible)
+        {
+            culledMeshes++;
+        }
+    }
+
+    // Models are culled by several threads, the shared counters are updated once per model
+    FrustumCuller::statistics.testedObjects++;
+    FrustumCuller::statistics.testedMeshes += static_cast<unsigned int>(this->meshes.size());
+    FrustumCuller::statistics.culledObjects += modelVisible ? 0 : 1;
+    FrustumCuller::statistics.culledMeshes += culledMeshes;
+
+    return modelVisible;
+}
+
+
+bool Model3D::intersect(const Ray& ray, RayHit& hit) const
+{
+    return this->triangleBVH.intersect(ray, hit);
+}
+
+
 unsigned int Model3D::textureFromFile(const std::string path, const std::string &directory)
 {
     // Get full path of the texture
@@ -66,26 +187,28 @@ unsigned int Model3D::textureFromFile(const std::string path, const std::string
     //std::cout << "textureFromFile : " << fileName << std::endl;
     // Texture ID in OpenGL environment
     GLuint textureID;
-    // Texture's data
+    // Texture's size
     int width = 0;
     int height = 0;
-    unsigned char* textureData;
+    bool textureLoaded = true;
+    // Repeated color texture
+    MipGenerationSettings mipSettings;
 
 
-    // Generate the texture in OpenGL
-    glGenTextures(1, &textureID);
+    // Streamed texture : only its coarse levels are loaded now, the finer ones when the meshes get close enough to need them
+    textureID = TextureStreamer::getStreamer().addTexture(fileName, mipSettings);
+    if(textureID == 0)
+    {
+        // Generate the texture in OpenGL
+        glGenTextures(1, &textureID);
+        RenderState::bindTexture(GL_TEXTURE_2D, textureID);
 
-    // Retrieve texture data
-    textureData = SOIL_load_image(fileName.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
-    //std::cerr << "SOIL_LOADING error : " << SOIL_last_result() << std::endl;
+        // Compressed or cached version of the texture with all its mip levels, computed from the source image the first time
+        textureLoaded = CompressedTexture::loadTexture(fileName, GL_TEXTURE_2D, &width, &height) || CompressedTexture::createTexture(fileName, GL_TEXTURE_2D, mipSettings, &width, &height);
+    }
 
-    if(textureData != NULL)
+    if(textureLoaded)
     {
-        // Bind the texture in OpenGL
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
         // Set texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -98,8 +221,6 @@ unsigned int Model3D::textureFromFile(const std::string path, const std::string
 
     }
 
-    SOIL_free_image_data(textureData);
-
     return textureID;
 }
 
@@ -108,46 +229,149 @@ unsigned int Model3D::textureFromFile(const std::string path, const std::string
 // Auxiliary methods
 
 void Model3D::loadModel(std::string path)
+{
+    ModelImport modelImport;
+    AllocationStatistics importStart;
+    AllocationStatistics importEnd;
+    std::chrono::high_resolution_clock::time_point importTime;
+
+    this->directory = path.substr(0, path.find_last_of('/'));
+
+    // Text OBJ files are imported by the OBJ loader, the other formats (and the OBJ files it can not read) by assimp
+    importTime = std::chrono::high_resolution_clock::now();
+    importStart = AllocationCounter::getStatistics();
+    if(!(ObjLoader::isObjFile(path) && this->importObj(path, modelImport)) && !this->importScene(path, modelImport))
+    {
+        return;
+    }
+    importEnd = AllocationCounter::getStatistics();
+    std::cout << "Model3D " << this->directory << " : " << this->meshes.size() << " meshes imported in "
+              << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - importTime).count() << " ms";
+    if(ALLOCATION_COUNTING)
+    {
+        std::cout << " with " << importEnd.allocations - importStart.allocations << " heap allocations (" << (importEnd.bytes - importStart.bytes) / 1024 << " KB)";
+    }
+    std::cout << std::endl;
+
+    // Retrieve the levels of detail and the meshlets from the binary mesh file, or generate them
+    if(!MeshCache::load(path, this->meshes))
+    {
+        this->optimizeMeshes();
+        MeshCache::save(path, this->meshes);
+    }
+
+    // Send meshes to the GPU
+    this->computeBounds();
+    this->uploadMeshes();
+
+    // Triangle hierarchy for picking
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    this->triangleBVH.build(this->meshes);
+    std::cout << "Model3D " << this->directory << " : BVH of " << this->triangleBVH.getTriangleCount() << " triangles (" << this->triangleBVH.getNodeCount() << " nodes) built in "
+              << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() << " ms" << std::endl;
+
+    // The meshes are in the geometry arena and the hierarchy has its own triangles, only keep the geometry the policy asks for
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        this->meshes[i].releaseGeometry(GeometryRetention::getPolicy(MODEL_GEOMETRY));
+    }
+}
+
+
+bool Model3D::importObj(const std::string& path, ModelImport& modelImport)
+{
+    ObjModel objModel;
+
+    if(!ObjLoader::load(path, objModel) || objModel.meshes.empty())
+    {
+        std::cerr << "[WARNING] in Model3D, the OBJ loader could not import " << path << ", assimp is used" << std::endl;
+        return false;
+    }
+
+    // The textures of a material are loaded by the first mesh using it
+    modelImport.scene = NULL;
+    modelImport.materialTextures.resize(objModel.materials.size());
+    modelImport.materialLoaded.assign(objModel.materials.size(), 0);
+    this->meshes.reserve(this->meshes.size() + objModel.meshes.size());
+    for(unsigned int i = 0; i<objModel.meshes.size(); i++)
+    {
+        ObjMesh& objMesh = objModel.meshes[i];
+        std::vector<Texture> textures;
+
+        if(objMesh.material >= 0)
+        {
+            if(!modelImport.materialLoaded[objMesh.material])
+            {
+                const ObjMaterial& material = objModel.materials[objMesh.material];
+                if(!material.diffuseMap.empty())
+                {
+                    this->loadMaterialTexture(material.diffuseMap, "texture_diffuse", modelImport.materialTextures[objMesh.material]);
+                }
+                if(!material.specularMap.empty())
+                {
+                    this->loadMaterialTexture(material.specularMap, "texture_specular", modelImport.materialTextures[objMesh.material]);
+                }
+                modelImport.materialLoaded[objMesh.material] = 1;
+            }
+            textures = modelImport.materialTextures[objMesh.material];
+        }
+
+        this->meshes.emplace_back(std::move(objMesh.vertices), std::move(objMesh.indices), std::move(textures));
+    }
+
+    return true;
+}
+
+
+bool Model3D::importScene(const std::string& path, ModelImport& modelImport)
 {
     Assimp::Importer import;
 
     // Load the model
-    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals | aiProcess_JoinIdenticalVertices);
 
 
     // Check loaded model validity
     if((scene == NULL) || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode)
     {
         std::cerr << "[ERROR] in Model3D : " << import.GetErrorString() << std::endl;
-        return;
+        return false;
     }
-    this->directory = path.substr(0, path.find_last_of('/'));
 
-    // travel through nodes to create each meshes of the model
-    processNode(scene->mRootNode, scene);
+    this->processScene(scene, modelImport);
+
+    return true;
 }
 
 
-void Model3D::processNode(aiNode* node, const aiScene* scene)
+void Model3D::processScene(const aiScene* scene, ModelImport& modelImport)
 {
-    aiMesh* mesh;
+    // travel through nodes to create each meshes of the model, in place in the array of meshes
+    modelImport.scene = scene;
+    modelImport.materialTextures.resize(scene->mNumMaterials);
+    modelImport.materialLoaded.assign(scene->mNumMaterials, 0);
+    this->meshes.reserve(this->meshes.size() + countMeshes(scene->mRootNode));
+    this->processNode(scene->mRootNode, modelImport);
+}
+
 
+void Model3D::processNode(aiNode* node, ModelImport& modelImport)
+{
     // Get mesh's data for all meshes of the node
     for(unsigned int i = 0; i<node->mNumMeshes; i++)
     {
-        mesh = scene->mMeshes[node->mMeshes[i]];
-        this->meshes.push_back(this->processMesh(mesh, scene));
+        this->processMesh(modelImport.scene->mMeshes[node->mMeshes[i]], modelImport);
     }
 
     // Do the same for all children of the node
     for(unsigned int i = 0; i<node->mNumChildren; i++)
     {
-        this->processNode(node->mChildren[i], scene);
+        this->processNode(node->mChildren[i], modelImport);
     }
 }
 
 
-Mesh Model3D::processMesh(aiMesh *mesh, const aiScene *scene)
+void Model3D::processMesh(aiMesh *mesh, ModelImport& modelImport)
 {
     std::vector<Vertex> vertices;
     std::vector<GLuint> indices;
@@ -156,109 +380,221 @@ Mesh Model3D::processMesh(aiMesh *mesh, const aiScene *scene)
     // For data retrieving
         // Vertices
     Vertex currentVertex;
-    glm::vec3 currentVertexPosition;
-    glm::vec3 currentVertexNormal;
-    glm::vec2 currentVertexTextureCoordinate;
-        // Indices
-    aiFace face;
+    const aiVector3D* textureCoordinates = mesh->mTextureCoords[0];
         // Material
     aiMaterial *material;
-    std::vector<Texture> diffuseMaps;
-    std::vector<Texture> specularMaps;
 
     // Retrieve vertices data
+    vertices.reserve(mesh->mNumVertices);
+    currentVertex.textCoords = glm::vec2(0.0f, 0.0f);
     for(unsigned int i=0; i<mesh->mNumVertices; i++)
     {
-        // Retrieve vertex position
-        currentVertexPosition.x = mesh->mVertices[i].x;
-        currentVertexPosition.y = mesh->mVertices[i].y;
-        currentVertexPosition.z = mesh->mVertices[i].z;
-        currentVertex.position = currentVertexPosition;
-
-        // Retrive vertex normal
-        currentVertexNormal.x = mesh->mNormals[i].x;
-        currentVertexNormal.y = mesh->mNormals[i].y;
-        currentVertexNormal.z = mesh->mNormals[i].z;
-        currentVertex.normal = currentVertexNormal;
+        // Retrieve vertex position and normal
+        currentVertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        currentVertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
 
         // Verify if the vertex has texture coordinates
-        if(mesh->mTextureCoords[0] != NULL)
-        {
-            // Retrive texture coordinate
-            currentVertexTextureCoordinate.x = mesh->mTextureCoords[0][i].x;
-            currentVertexTextureCoordinate.y = mesh->mTextureCoords[0][i].y;
-            currentVertex.textCoords = currentVertexTextureCoordinate;
-        }
-        else
+        if(textureCoordinates != NULL)
         {
-            currentVertex.textCoords = glm::vec2(0.0f, 0.0f);
+            currentVertex.textCoords = glm::vec2(textureCoordinates[i].x, textureCoordinates[i].y);
         }
         vertices.push_back(currentVertex);
     }
 
-    // Retrive vertices indice
+    // Retrive vertices indice (the faces are triangulated, and read in place as copying an aiFace copies its indices)
+    indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
     for(unsigned int i=0; i<mesh->mNumFaces; i++)
     {
-        face = mesh->mFaces[i];
-        for(unsigned int j=0; j<face.mNumIndices; j++)
+        const aiFace& face = mesh->mFaces[i];
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+
+    // Retrieve material (the textures of a material are looked up by the first mesh using it)
+    if(mesh->mMaterialIndex < modelImport.materialTextures.size())
+    {
+        if(!modelImport.materialLoaded[mesh->mMaterialIndex])
         {
-            indices.push_back(face.mIndices[j]);
+            material = modelImport.scene->mMaterials[mesh->mMaterialIndex];
+            this->loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", modelImport.materialTextures[mesh->mMaterialIndex]);
+            this->loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", modelImport.materialTextures[mesh->mMaterialIndex]);
+            modelImport.materialLoaded[mesh->mMaterialIndex] = 1;
         }
+        textures = modelImport.materialTextures[mesh->mMaterialIndex];
     }
 
-    // Retrieve material
-    if(mesh->mMaterialIndex >= 0)
+    this->meshes.emplace_back(std::move(vertices), std::move(indices), std::move(textures));
+}
+
+
+unsigned int Model3D::countMeshes(const aiNode* node)
+{
+    unsigned int meshCount = node->mNumMeshes;
+
+    for(unsigned int i = 0; i<node->mNumChildren; i++)
     {
-        // Retrieve diffuse material
-        material = scene->mMaterials[mesh->mMaterialIndex];
-        diffuseMaps = this->loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-        // Retrieve specular material
-        specularMaps = this->loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        meshCount += countMeshes(node->mChildren[i]);
     }
 
-    return Mesh(vertices, indices, textures);
+    return meshCount;
 }
 
 
-std::vector<Texture> Model3D::loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName)
+void Model3D::optimizeMeshes()
 {
-    // Store textures
-    std::vector<Texture> textures;
-    // Retrive texture's data
-    aiString textureString;
-    Texture currentTexture;
-    // Used to know if the texture was already loaded
-    bool isAlreadyLoaded = false;
-    std::map<std::string, Texture, classComp>::const_iterator it;
+    // One mesh per job, the workers done with theirs steal the remaining meshes
+    JobSystem::getJobSystem().parallelFor(static_cast<unsigned int>(this->meshes.size()), 1, [this](unsigned int meshIndex)
+    {
+        this->meshes[meshIndex].generateLevelsOfDetail();
+        this->meshes[meshIndex].generateMeshlets();
+    });
+}
 
-    for(unsigned int i=0; i<mat->GetTextureCount(type); i++)
+
+void Model3D::computeBounds()
+{
+    this->boundingSphereRadius = 0.0f;
+
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
     {
-        mat->GetTexture(type, i, &textureString);
-        isAlreadyLoaded = false;
+        this->boundingBoxMin = (i == 0) ? this->meshes[i].boundingBoxMin : glm::min(this->boundingBoxMin, this->meshes[i].boundingBoxMin);
+        this->boundingBoxMax = (i == 0) ? this->meshes[i].boundingBoxMax : glm::max(this->boundingBoxMax, this->meshes[i].boundingBoxMax);
+    }
+    this->boundingSphereCenter = (this->boundingBoxMin + this->boundingBoxMax) * 0.5f;
 
-        // If the texture was alredy loaded
-        if((it = this->loadedTextures.find(textureString.C_Str())) != this->loadedTextures.end())
+    // Sphere around the box center enclosing the sphere of each mesh
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        this->boundingSphereRadius = std::max(this->boundingSphereRadius, glm::length(this->meshes[i].boundingSphereCenter - this->boundingSphereCenter) + this->meshes[i].boundingSphereRadius);
+    }
+}
+
+
+void Model3D::uploadMeshes()
+{
+    bool compressible = MODEL_VERTEX_COMPRESSION && !this->meshes.empty();
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t uncompressedSize = 0;
+    size_t storedSize = 0;
+
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        compressible = compressible && (this->meshes[i].vertices.size() <= COMPRESSED_MESH_MAX_VERTICES);
+        vertexCount += this->meshes[i].vertices.size();
+        indexCount += this->meshes[i].indices.size();
+    }
+
+    // Positions are quantized in the bounding box of the whole model, so that its meshes share the decoding uniforms
+    this->positionDecodeOffset = this->boundingBoxMin;
+    this->positionDecodeScale = this->boundingBoxMax - this->boundingBoxMin;
+    this->vertexFormat = compressible ? COMPRESSED_MESH_VERTEX_FORMAT : MESH_VERTEX_FORMAT;
+
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        if(compressible)
+        {
+            this->meshes[i].setupMesh(this->positionDecodeOffset, this->positionDecodeScale);
+        }
+        else
         {
+            this->meshes[i].setupMesh();
+        }
+    }
+
+    // Memory used by the geometry (all levels of detail)
+    uncompressedSize = vertexCount * sizeof(Vertex) + indexCount * sizeof(GLuint);
+    storedSize = compressible ? vertexCount * sizeof(CompressedVertex) + indexCount * sizeof(GLushort) : uncompressedSize;
+    std::cout << "Model3D " << this->directory << " : " << vertexCount << " vertices, " << indexCount << " indices, "
+              << uncompressedSize / 1024 << " KB -> " << storedSize / 1024 << " KB";
+    if(compressible)
+    {
+        std::cout << " (" << 100.0 * (1.0 - static_cast<double>(storedSize) / std::max<size_t>(uncompressedSize, 1)) << "% saved)" << std::endl;
+    }
+    else
+    {
+        std::cout << " (not compressed)" << std::endl;
+    }
+}
 
-            textures.push_back(it->second);
-            isAlreadyLoaded = true;
+
+void Model3D::setVertexDecoding(Shader& shader)
+{
+    shader.setVec3("positionDecodeOffset", this->positionDecodeOffset);
+    shader.setVec3("positionDecodeScale", this->positionDecodeScale);
+}
+
+
+void Model3D::prepareMeshes()
+{
+    glm::mat4 worldMatrix = viewParameters.sceneMatrix * this->localTransformationMatrix;
+    glm::mat4 modelViewProjection = viewParameters.viewProjectionMatrix * worldMatrix;
+    glm::vec3 cameraPositionInModel = glm::vec3(glm::inverse(worldMatrix) * glm::vec4(viewParameters.cameraPosition, 1.0f));
+    glm::vec3 meshCenter;
+    float worldScale = 0.0f;
+    float distance = 0.0f;
+    float pixelsPerUnit = 0.0f;
+
+    if(viewParameters.projectionScale <= 0.0f)
+    {
+        return;
+    }
+
+    // Biggest scale factor of the model
+    worldScale = std::max(glm::length(glm::vec3(worldMatrix[0])), std::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+
+    for(unsigned int i = 0; i<this->meshes.size(); i++)
+    {
+        if(!this->meshes[i].visible)
+        {
+            continue;
         }
 
-        // If the texture was not loaded
-        if(!isAlreadyLoaded)
+        meshCenter = glm::vec3(worldMatrix * glm::vec4(this->meshes[i].boundingSphereCenter, 1.0f));
+        distance = glm::length(meshCenter - viewParameters.cameraPosition) - this->meshes[i].boundingSphereRadius * worldScale;
+        distance = std::max(distance, LOD_MIN_DISTANCE);
+        pixelsPerUnit = worldScale * viewParameters.projectionScale / distance;
+
+        this->meshes[i].selectLevelOfDetail(pixelsPerUnit, viewParameters.pixelErrorThreshold);
+        this->meshes[i].requestTextures(pixelsPerUnit);
+
+        if(viewParameters.meshletCulling)
         {
-            // Load the texture in OpenGL and retrieve its id
-            currentTexture.id = this->textureFromFile(textureString.C_Str(), this->directory);
-            currentTexture.type = typeName;
-            // Add the texture to the mesh's textures
-            textures.push_back(currentTexture);
-            // Add the texture to the already loaded textures
-            this->loadedTextures[textureString.C_Str()] = currentTexture;
+            this->meshes[i].cullMeshlets(modelViewProjection, cameraPositionInModel, viewParameters.meshletConeCulling);
         }
     }
+}
+
+
+void Model3D::loadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string& typeName, std::vector<Texture>& textures)
+{
+    // Retrive texture's data
+    aiString textureString;
+
+    for(unsigned int i=0; i<mat->GetTextureCount(type); i++)
+    {
+        mat->GetTexture(type, i, &textureString);
+        this->loadMaterialTexture(textureString.C_Str(), typeName, textures);
+    }
+}
+
+
+void Model3D::loadMaterialTexture(const std::string& path, const std::string& typeName, std::vector<Texture>& textures)
+{
+    Texture currentTexture;
+    std::map<std::string, Texture, classComp>::const_iterator it;
+
+    // If the texture was alredy loaded
+    if((it = this->loadedTextures.find(path)) != this->loadedTextures.end())
+    {
+        textures.push_back(it->second);
+        return;
+    }
 
-    return textures;
+    // Load the texture in OpenGL and retrieve its id
+    currentTexture.id = this->textureFromFile(path, this->directory);
+    currentTexture.type = typeName;
+    // Add the texture to the mesh's textures
+    textures.push_back(currentTexture);
+    // Add the texture to the already loaded textures
+    this->loadedTextures[path] = currentTexture;
 }
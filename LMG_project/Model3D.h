@@ -2,8 +2,18 @@
 #define __MODEL3D_H
 
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "VertexCompressor.h"
+#include "FrustumCuller.h"
+#include "TriangleBVH.h"
+#include "CompressedTexture.h"
+#include "AllocationCounter.h"
+#include "ObjLoader.h"
+#include "ShaderVariants.h"
+#include "JobSystem.h"
 // Standard library
 #include <map>
+#include <chrono>
 // Assimp
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -15,6 +25,14 @@
 #include <SOIL/SOIL.h>
 
 
+/// Default maximal error of a level of detail on the screen, in pixels
+#define LOD_PIXEL_ERROR_THRESHOLD 1.0f
+/// Distance under which a mesh is considered as being at the camera position
+#define LOD_MIN_DISTANCE 0.1f
+/// Store the meshes in the compressed vertex format when they are small enough for 16-bit indices (0 to keep 32-bit floats)
+#define MODEL_VERTEX_COMPRESSION 1
+
+
 struct classComp
 {
     bool operator() (const std::string& path1, const std::string& path2) const
@@ -22,6 +40,42 @@ struct classComp
 };
 
 
+/**
+ * @brief The ViewParameters struct store the camera informations needed to select the levels of detail and cull the meshlets
+ */
+struct ViewParameters
+{
+    /// Position of the camera in world space
+    glm::vec3 cameraPosition;
+    /// Scene transformation matrix applied to every model
+    glm::mat4 sceneMatrix;
+    /// Projection matrix * view matrix of the camera
+    glm::mat4 viewProjectionMatrix;
+    /// Size in pixels of one unit at a distance of one unit from the camera (0 to always draw the full resolution)
+    float projectionScale;
+    /// Maximal error of a level of detail on the screen, in pixels
+    float pixelErrorThreshold;
+    /// True to reject the meshlets outside of the view frustum
+    bool meshletCulling;
+    /// True to also reject the meshlets facing away from the camera
+    bool meshletConeCulling;
+};
+
+
+/**
+ * @brief The ModelImport struct store what the meshes of one import share, so that each material is resolved once
+ */
+struct ModelImport
+{
+    /// Assimp scene being imported (NULL when the model is imported by the OBJ loader)
+    const aiScene* scene;
+    /// Textures of each material of the scene, loaded by the first mesh using the material
+    std::vector< std::vector<Texture> > materialTextures;
+    /// True for the materials whose textures are loaded
+    std::vector<char> materialLoaded;
+};
+
+
 class Model3D
 {
 // Attributes
@@ -36,6 +90,27 @@ private:
     bool WarningMessageForShaderAlreadyShown;
     /// local transformation matrix
     glm::mat4 localTransformationMatrix;
+    /// Vertex format of the meshes in the geometry arena
+    VertexFormat vertexFormat;
+    /// Smallest corner of the box in which compressed positions are quantized
+    glm::vec3 positionDecodeOffset;
+    /// Size of the box in which compressed positions are quantized
+    glm::vec3 positionDecodeScale;
+    /// Index of the model bounds in the frustum culler (followed by the bounds of each mesh)
+    unsigned int cullingIndex;
+    /// Triangles of the model for ray queries (picking)
+    TriangleBVH triangleBVH;
+public:
+    /// Smallest corner of the bounding box of the model
+    glm::vec3 boundingBoxMin;
+    /// Largest corner of the bounding box of the model
+    glm::vec3 boundingBoxMax;
+    /// Center of the bounding sphere of the model
+    glm::vec3 boundingSphereCenter;
+    /// Radius of the bounding sphere of the model
+    float boundingSphereRadius;
+    /// Camera informations shared by all models to select the levels of detail and cull the meshlets
+    static ViewParameters viewParameters;
 
 
 
@@ -49,6 +124,16 @@ public:
      */
     Model3D(std::string path);
 
+private:
+    /// The import benchmark fills a model from a scene in memory
+    friend class ImportBenchmark;
+
+
+    /**
+     * @brief Model3D create a model without meshes, filled by the import benchmark
+     */
+    Model3D();
+
 
 // Getters and setters
 public:
@@ -58,7 +143,7 @@ public:
      * @brief getLocalTransformationMatrix return the local transformation matrix of the model
      * @return
      */
-    glm::mat4 getLocalTransformationMatrix();
+    glm::mat4 getLocalTransformationMatrix() const;
 
 
     /**
@@ -82,24 +167,93 @@ public:
      */
     void transformLocalMatrix(glm::mat4 matrix);
 
+
+    /**
+     * @brief setViewParameters set the camera informations used by prepareMeshes to select the level of detail of each mesh and cull its meshlets
+     * @param cameraPosition position of the camera in world space
+     * @param viewMatrix view matrix of the camera
+     * @param sceneMatrix scene transformation matrix applied to every model
+     * @param projectionMatrix projection matrix of the camera
+     * @param viewportHeight height of the viewport in pixels
+     */
+    static void setViewParameters(glm::vec3 cameraPosition, glm::mat4 viewMatrix, glm::mat4 sceneMatrix, glm::mat4 projectionMatrix, int viewportHeight);
+
 // Methods
 public:
 
 
     /**
-     * @brief draw draw all meshes of the 3D model with the given shader object
+     * @brief draw draw all meshes of the 3D model with the given shader object, as selected by prepareMeshes
      * @param shader
      */
     void draw(Shader& shader);
 
 
     /**
-     * @brief draw draw all meshes of the 3D model with the given shader object and the given skybox texture
+     * @brief draw draw all meshes of the 3D model with the given shader object and the given skybox texture, as selected by prepareMeshes
      * @param shader
      */
     void draw(Shader& shader, GLuint skyboxTextureID);
 
 
+    /**
+     * @brief prepareMeshes select the level of detail of each visible mesh with its projected size on the screen, request its textures and cull its meshlets.
+     *        It makes no OpenGL call and can run on a worker thread, once per frame before draw.
+     */
+    void prepareMeshes();
+
+
+    /**
+     * @brief getShaderFeatures return the shader features needed by the vertices of the model (COMPRESSED_VERTICES_FEATURE when they are compressed)
+     */
+    unsigned int getShaderFeatures() const;
+
+
+    /**
+     * @brief getVertexFormat return the vertex format of the meshes, which gives the vertex array they are drawn with
+     */
+    VertexFormat getVertexFormat() const;
+
+
+    /**
+     * @brief getMaterialKey return the material of the first mesh, used to group the draws of models sharing their textures
+     */
+    unsigned int getMaterialKey() const;
+
+
+    /**
+     * @brief reserveBounds reserve the slots of the bounds of the model and of each of its meshes in the frustum culler
+     * @param culler frustum culler of the frame
+     */
+    void reserveBounds(FrustumCuller& culler);
+
+
+    /**
+     * @brief cull set the bounds of the model and of its meshes in world space in their reserved slots, test them and update the visibility.
+     *        Different models can be culled by different threads at the same time.
+     * @param culler frustum culler of the frame, after reserveBounds
+     * @return false when the whole model is outside of the view frustum
+     */
+    bool cull(FrustumCuller& culler);
+
+
+    /**
+     * @brief updateVisibility retrieve the result of the frustum culling for the model and its meshes (culled meshes are not drawn)
+     * @param culler frustum culler of the frame, after the test
+     * @return false when the whole model is outside of the view frustum
+     */
+    bool updateVisibility(const FrustumCuller& culler);
+
+
+    /**
+     * @brief intersect find the closest triangle of the model hit by a ray
+     * @param ray ray in model space
+     * @param hit updated with the closest hit when it is closer than hit.t
+     * @return true when a closer hit was found
+     */
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+
     /**
      * @brief textureFromFile load and link to OpenGL a texture from a file
      * @param path file path
@@ -114,27 +268,85 @@ private:
 
 
     /**
-     * @brief loadModel call the assimp loader and create meshes from the loaded data
+     * @brief loadModel import the model (with the OBJ loader for OBJ files, with assimp for the other formats) and create meshes from the loaded data
      * @param path path of the 3D model
      */
     void loadModel(std::string path);
 
 
+    /**
+     * @brief importObj create the meshes of an OBJ file read by the OBJ loader
+     * @param path path of the OBJ file
+     * @param modelImport materials of the import
+     * @return false when the OBJ loader could not read the file or found no mesh in it (no mesh is created)
+     */
+    bool importObj(const std::string& path, ModelImport& modelImport);
+
+
+    /**
+     * @brief importScene create the meshes of a file read by assimp
+     * @param path path of the 3D model
+     * @param modelImport scene and materials of the import
+     * @return false when assimp could not read the file
+     */
+    bool importScene(const std::string& path, ModelImport& modelImport);
+
+
+    /**
+     * @brief processScene create the meshes of an assimp scene, in place in the array of meshes
+     * @param scene scene read by assimp
+     * @param modelImport filled with the scene and the textures of its materials
+     */
+    void processScene(const aiScene* scene, ModelImport& modelImport);
+
+
     /**
      * @brief processNode extract each meshes of each nodes of the assimp scene from teh root node to the last one
      * @param node current node of the scene
-     * @param scene assimp scene
+     * @param modelImport scene and materials of the import
      */
-    void processNode(aiNode* node, const aiScene* scene);
+    void processNode(aiNode* node, ModelImport& modelImport);
 
 
     /**
-     * @brief processMesh extract the mesh datas and create the mesh object
+     * @brief processMesh extract the mesh datas and create the mesh object at the end of the meshes of the model.
+     *        Vertices and indices are written once in buffers of the right size, then moved into the mesh.
      * @param mesh assimp mesh
-     * @param scene assimp scene
-     * @return
+     * @param modelImport scene and materials of the import
+     */
+    void processMesh(aiMesh* mesh, ModelImport& modelImport);
+
+
+    /**
+     * @brief countMeshes count the meshes of a node and of its children
+     * @param node node of the scene
+     */
+    static unsigned int countMeshes(const aiNode* node);
+
+
+    /**
+     * @brief optimizeMeshes generate the levels of detail and the meshlets of all meshes, one mesh per job
+     */
+    void optimizeMeshes();
+
+
+    /**
+     * @brief computeBounds compute the bounding box and the bounding sphere of the model from the bounds of its meshes
      */
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene);
+    void computeBounds();
+
+
+    /**
+     * @brief uploadMeshes send the meshes to the geometry arena, compressed when possible, and print the memory used
+     */
+    void uploadMeshes();
+
+
+    /**
+     * @brief setVertexDecoding set the uniforms used by the vertex shader to decode compressed vertices (only used by the COMPRESSED_VERTICES variants)
+     * @param shader shader used to draw the model
+     */
+    void setVertexDecoding(Shader& shader);
 
 
     /**
@@ -142,9 +354,18 @@ private:
      * @param mat assimp material
      * @param type assimp texture type
      * @param typeName name of the type based on naming convention
-     * @return
+     * @param textures the textures of the material are added at its end
+     */
+    void loadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string& typeName, std::vector<Texture>& textures);
+
+
+    /**
+     * @brief loadMaterialTexture load a texture of a material if it has not already been loaded
+     * @param path path of the texture, relative to the directory of the model
+     * @param typeName name of the type based on naming convention
+     * @param textures the texture is added at its end
      */
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
+    void loadMaterialTexture(const std::string& path, const std::string& typeName, std::vector<Texture>& textures);
 
 };
 
@@ -0,0 +1,694 @@
+#include "ObjLoader.h"
+
+
+// =======
+// Methods
+
+bool ObjLoader::load(const std::string& path, ObjModel& model)
+{
+    JobSystem& jobSystem = JobSystem::getJobSystem();
+    MappedFile file;
+    std::vector<ObjChunk> chunks;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<glm::vec3> normals;
+    std::vector< std::vector<ObjFaceRange> > meshRanges;
+    std::vector<int> meshMaterials;
+    std::vector<unsigned int> invalidCorners;
+    unsigned int attributeCounts[3] = { 0, 0, 0 };
+    unsigned int invalidLines = 0;
+    unsigned int skippedCorners = 0;
+    std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    const char* begin;
+    const char* end;
+    const char* fileEnd;
+    size_t chunkCount;
+
+    model.meshes.clear();
+    model.materials.clear();
+
+    if(!file.open(path))
+    {
+        return false;
+    }
+
+    // Line aligned chunks of about the same size, one per worker of the job system
+    chunkCount = std::max<size_t>(1, std::min<size_t>(jobSystem.getWorkerCount(), file.getSize() / OBJ_MIN_CHUNK_SIZE));
+    chunks.resize(chunkCount);
+    begin = file.getData();
+    fileEnd = file.getData() + file.getSize();
+    for(size_t i=0; i<chunkCount; i++)
+    {
+        end = (i + 1 == chunkCount) ? fileEnd : std::max(begin, file.getData() + file.getSize() / chunkCount * (i + 1));
+        end = std::find(end, fileEnd, '\n');
+        end = (end == fileEnd) ? fileEnd : end + 1;
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        begin = end;
+    }
+
+    // Read the lines
+    jobSystem.parallelFor(static_cast<unsigned int>(chunks.size()), 1, [&chunks](unsigned int chunk)
+    {
+        parseChunk(chunks[chunk]);
+    });
+
+    // Gather the attributes of the chunks and resolve the indices of the faces from the beginning of the file
+    for(unsigned int i=0; i<chunks.size(); i++)
+    {
+        chunks[i].attributeOffsets[0] = attributeCounts[0];
+        chunks[i].attributeOffsets[1] = attributeCounts[1];
+        chunks[i].attributeOffsets[2] = attributeCounts[2];
+        attributeCounts[0] += static_cast<unsigned int>(chunks[i].positions.size());
+        attributeCounts[1] += static_cast<unsigned int>(chunks[i].textureCoordinates.size());
+        attributeCounts[2] += static_cast<unsigned int>(chunks[i].normals.size());
+        invalidLines += chunks[i].invalidLines;
+    }
+    positions.resize(attributeCounts[0]);
+    textureCoordinates.resize(attributeCounts[1]);
+    normals.resize(attributeCounts[2]);
+    invalidCorners.assign(chunks.size(), 0);
+    jobSystem.parallelFor(static_cast<unsigned int>(chunks.size()), 1, [&](unsigned int chunk)
+    {
+        std::copy(chunks[chunk].positions.begin(), chunks[chunk].positions.end(), positions.begin() + chunks[chunk].attributeOffsets[0]);
+        std::copy(chunks[chunk].textureCoordinates.begin(), chunks[chunk].textureCoordinates.end(), textureCoordinates.begin() + chunks[chunk].attributeOffsets[1]);
+        std::copy(chunks[chunk].normals.begin(), chunks[chunk].normals.end(), normals.begin() + chunks[chunk].attributeOffsets[2]);
+        std::vector<glm::vec3>().swap(chunks[chunk].positions);
+        std::vector<glm::vec2>().swap(chunks[chunk].textureCoordinates);
+        std::vector<glm::vec3>().swap(chunks[chunk].normals);
+        invalidCorners[chunk] = resolveIndices(chunks[chunk], attributeCounts);
+    });
+    for(unsigned int i=0; i<chunks.size(); i++)
+    {
+        skippedCorners += invalidCorners[i];
+    }
+
+    // Materials, in the order of the mtllib statements
+    for(unsigned int i=0; i<chunks.size(); i++)
+    {
+        for(unsigned int j=0; j<chunks[i].materialLibraries.size(); j++)
+        {
+            if(!loadMaterials(directory + chunks[i].materialLibraries[j], model.materials))
+            {
+                std::cerr << "[WARNING] in ObjLoader, could not read the material file " << directory + chunks[i].materialLibraries[j] << std::endl;
+            }
+        }
+    }
+
+    // Triangulate and weld the meshes
+    splitMeshes(chunks, model.materials, meshRanges, meshMaterials);
+    model.meshes.resize(meshRanges.size());
+    jobSystem.parallelFor(static_cast<unsigned int>(meshRanges.size()), 1, [&](unsigned int mesh)
+    {
+        buildMesh(meshRanges[mesh], chunks, positions, textureCoordinates, normals, model.meshes[mesh]);
+        model.meshes[mesh].material = meshMaterials[mesh];
+    });
+
+    // Meshes whose faces were all skipped
+    model.meshes.erase(std::remove_if(model.meshes.begin(), model.meshes.end(), [](const ObjMesh& mesh) { return mesh.indices.empty(); }), model.meshes.end());
+
+    if(invalidLines > 0 || skippedCorners > 0)
+    {
+        std::cerr << "[WARNING] in ObjLoader, " << path << " : " << invalidLines << " lines could not be read, " << skippedCorners << " face corners are out of range" << std::endl;
+    }
+
+    return true;
+}
+
+
+bool ObjLoader::isObjFile(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    std::string extension;
+
+    if(dot == std::string::npos)
+    {
+        return false;
+    }
+    extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    return extension == "obj";
+}
+
+
+bool ObjLoader::parseFloat(const char*& current, const char* end, float& value)
+{
+    // Powers of ten exactly represented by a double
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* position = current;
+    const char* exponentPosition;
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int explicitExponent = 0;
+    bool negative = false;
+    bool negativeExponent = false;
+    bool digits = false;
+    double result;
+
+    if(position < end && (*position == '-' || *position == '+'))
+    {
+        negative = (*position == '-');
+        position++;
+    }
+
+    // Digits past the precision of the mantissa only change the exponent
+    for(; position < end && *position >= '0' && *position <= '9'; position++)
+    {
+        if(mantissa < 100000000000000000ull)
+        {
+            mantissa = mantissa * 10 + static_cast<unsigned int>(*position - '0');
+        }
+        else
+        {
+            exponent++;
+        }
+        digits = true;
+    }
+    if(position < end && *position == '.')
+    {
+        for(position++; position < end && *position >= '0' && *position <= '9'; position++)
+        {
+            if(mantissa < 100000000000000000ull)
+            {
+                mantissa = mantissa * 10 + static_cast<unsigned int>(*position - '0');
+                exponent--;
+            }
+            digits = true;
+        }
+    }
+    if(!digits)
+    {
+        return false;
+    }
+
+    // The exponent is only part of the number when it has digits
+    if(position < end && (*position == 'e' || *position == 'E'))
+    {
+        exponentPosition = position + 1;
+        if(exponentPosition < end && (*exponentPosition == '-' || *exponentPosition == '+'))
+        {
+            negativeExponent = (*exponentPosition == '-');
+            exponentPosition++;
+        }
+        if(exponentPosition < end && *exponentPosition >= '0' && *exponentPosition <= '9')
+        {
+            for(; exponentPosition < end && *exponentPosition >= '0' && *exponentPosition <= '9'; exponentPosition++)
+            {
+                explicitExponent = std::min(explicitExponent * 10 + (*exponentPosition - '0'), 1000);
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            position = exponentPosition;
+        }
+    }
+
+    result = static_cast<double>(mantissa);
+    if(mantissa != 0)
+    {
+        for(; exponent > 22; exponent -= 22)
+        {
+            result *= powers[22];
+        }
+        for(; exponent < -22; exponent += 22)
+        {
+            result /= powers[22];
+        }
+        result = (exponent >= 0) ? result * powers[exponent] : result / powers[-exponent];
+    }
+
+    value = static_cast<float>(negative ? -result : result);
+    current = position;
+
+    return true;
+}
+
+
+// =================
+// Auxiliary methods
+
+void ObjLoader::parseChunk(ObjChunk& chunk)
+{
+    const char* current = chunk.begin;
+    const char* lineEnd;
+    const char* next;
+    ObjStatement statement;
+    glm::vec3 vector;
+    bool valid;
+
+    chunk.invalidLines = 0;
+
+    while(current < chunk.end)
+    {
+        lineEnd = static_cast<const char*>(std::memchr(current, '\n', chunk.end - current));
+        lineEnd = (lineEnd == NULL) ? chunk.end : lineEnd;
+        next = (lineEnd == chunk.end) ? chunk.end : lineEnd + 1;
+        current = skipSpaces(current, lineEnd);
+        valid = true;
+
+        if(isKeyword(current, lineEnd, "v"))
+        {
+            // Missing components are 0, so that the following vertices keep their index
+            vector = glm::vec3(0.0f);
+            current += 1;
+            valid = parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.x)
+                 && parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.y)
+                 && parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.z);
+            chunk.positions.push_back(vector);
+        }
+        else if(isKeyword(current, lineEnd, "vt"))
+        {
+            // The second coordinate is optional
+            vector = glm::vec3(0.0f);
+            current += 2;
+            valid = parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.x);
+            parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.y);
+            chunk.textureCoordinates.push_back(glm::vec2(vector));
+        }
+        else if(isKeyword(current, lineEnd, "vn"))
+        {
+            vector = glm::vec3(0.0f);
+            current += 2;
+            valid = parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.x)
+                 && parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.y)
+                 && parseFloat(current = skipSpaces(current, lineEnd), lineEnd, vector.z);
+            chunk.normals.push_back(vector);
+        }
+        else if(isKeyword(current, lineEnd, "f"))
+        {
+            valid = parseFace(current + 1, lineEnd, chunk);
+        }
+        else if(isKeyword(current, lineEnd, "o") || isKeyword(current, lineEnd, "g"))
+        {
+            statement.face = static_cast<unsigned int>(chunk.faces.size());
+            statement.material = false;
+            statement.name = readName(current + 1, lineEnd);
+            chunk.statements.push_back(statement);
+        }
+        else if(isKeyword(current, lineEnd, "usemtl"))
+        {
+            statement.face = static_cast<unsigned int>(chunk.faces.size());
+            statement.material = true;
+            statement.name = readName(current + 6, lineEnd);
+            chunk.statements.push_back(statement);
+        }
+        else if(isKeyword(current, lineEnd, "mtllib"))
+        {
+            chunk.materialLibraries.push_back(readName(current + 6, lineEnd));
+        }
+
+        // Comments, smoothing groups, lines, points, ... are ignored
+        if(!valid)
+        {
+            chunk.invalidLines++;
+        }
+        current = next;
+    }
+}
+
+
+bool ObjLoader::parseFace(const char* current, const char* end, ObjChunk& chunk)
+{
+    size_t firstCorner = chunk.corners.size();
+    int attributeCounts[3] = { static_cast<int>(chunk.positions.size()), static_cast<int>(chunk.textureCoordinates.size()), static_cast<int>(chunk.normals.size()) };
+    ObjCorner corner;
+    int index;
+    bool valid = true;
+
+    // Corners : v, v/vt, v//vn or v/vt/vn
+    while(valid && (current = skipSpaces(current, end)) < end)
+    {
+        corner.attributes[0] = corner.attributes[1] = corner.attributes[2] = OBJ_MISSING_INDEX;
+        corner.relative = 0;
+
+        for(int i=0; i<3 && valid; i++)
+        {
+            if(i > 0)
+            {
+                if(current >= end || *current != '/')
+                {
+                    break;
+                }
+                current++;
+                if(current >= end || *current == '/' || *current == ' ' || *current == '\t' || *current == '\r')
+                {
+                    continue;
+                }
+            }
+
+            // Indices start at 1, negative ones count back from the last attribute read
+            index = 0;
+            valid = parseInteger(current, end, index) && index != 0;
+            if(index > 0)
+            {
+                corner.attributes[i] = index - 1;
+            }
+            else
+            {
+                corner.attributes[i] = attributeCounts[i] + index;
+                corner.relative |= static_cast<unsigned char>(1 << i);
+            }
+        }
+        valid = valid && (current >= end || *current == ' ' || *current == '\t' || *current == '\r');
+        chunk.corners.push_back(corner);
+    }
+
+    if(!valid || chunk.corners.size() - firstCorner < 3)
+    {
+        chunk.corners.resize(firstCorner);
+        return false;
+    }
+    chunk.faces.push_back(static_cast<unsigned int>(firstCorner));
+
+    return true;
+}
+
+
+unsigned int ObjLoader::resolveIndices(ObjChunk& chunk, const unsigned int* attributeCounts)
+{
+    unsigned int invalidCorners = 0;
+
+    for(unsigned int i=0; i<chunk.corners.size(); i++)
+    {
+        ObjCorner& corner = chunk.corners[i];
+
+        for(int j=0; j<3; j++)
+        {
+            if(corner.relative & (1 << j))
+            {
+                corner.attributes[j] += static_cast<int>(chunk.attributeOffsets[j]);
+            }
+
+            // A corner without a valid position makes its face skipped, the other attributes are just ignored
+            if(corner.attributes[j] < 0 || corner.attributes[j] >= static_cast<int>(attributeCounts[j]))
+            {
+                invalidCorners += (j == 0 || corner.attributes[j] != OBJ_MISSING_INDEX) ? 1 : 0;
+                corner.attributes[j] = OBJ_MISSING_INDEX;
+            }
+        }
+    }
+
+    return invalidCorners;
+}
+
+
+void ObjLoader::splitMeshes(const std::vector<ObjChunk>& chunks, const std::vector<ObjMaterial>& materials, std::vector< std::vector<ObjFaceRange> >& meshRanges, std::vector<int>& meshMaterials)
+{
+    int material = -1;
+    ObjFaceRange range;
+
+    meshRanges.assign(1, std::vector<ObjFaceRange>());
+    meshMaterials.assign(1, material);
+
+    for(unsigned int i=0; i<chunks.size(); i++)
+    {
+        range.chunk = i;
+        range.firstFace = 0;
+
+        for(unsigned int j=0; j<chunks[i].statements.size(); j++)
+        {
+            const ObjStatement& statement = chunks[i].statements[j];
+
+            // Faces before the statement
+            if(statement.face > range.firstFace)
+            {
+                range.lastFace = statement.face;
+                meshRanges.back().push_back(range);
+                range.firstFace = statement.face;
+            }
+
+            if(statement.material)
+            {
+                material = -1;
+                for(unsigned int k=0; k<materials.size() && material < 0; k++)
+                {
+                    material = (materials[k].name == statement.name) ? static_cast<int>(k) : -1;
+                }
+            }
+
+            // Each statement starts a new mesh, unless the current one has no face yet
+            if(!meshRanges.back().empty())
+            {
+                meshRanges.push_back(std::vector<ObjFaceRange>());
+                meshMaterials.push_back(material);
+            }
+            meshMaterials.back() = material;
+        }
+
+        if(chunks[i].faces.size() > range.firstFace)
+        {
+            range.lastFace = static_cast<unsigned int>(chunks[i].faces.size());
+            meshRanges.back().push_back(range);
+        }
+    }
+
+    if(meshRanges.back().empty())
+    {
+        meshRanges.pop_back();
+        meshMaterials.pop_back();
+    }
+}
+
+
+void ObjLoader::buildMesh(const std::vector<ObjFaceRange>& ranges, const std::vector<ObjChunk>& chunks, const std::vector<glm::vec3>& positions,
+                          const std::vector<glm::vec2>& textureCoordinates, const std::vector<glm::vec3>& normals, ObjMesh& mesh)
+{
+    std::vector<GLuint> table;
+    std::vector<glm::ivec3> keys;
+    std::vector<GLuint> faceVertices;
+    size_t cornerCount = 0;
+    size_t triangleCount = 0;
+    size_t tableSize = 16;
+    int faceNumber = 0;
+    const GLuint emptySlot = 0xFFFFFFFFu;
+
+    // Size of the mesh
+    for(unsigned int i=0; i<ranges.size(); i++)
+    {
+        const ObjChunk& chunk = chunks[ranges[i].chunk];
+        size_t first = chunk.faces[ranges[i].firstFace];
+        size_t last = (ranges[i].lastFace < chunk.faces.size()) ? chunk.faces[ranges[i].lastFace] : chunk.corners.size();
+
+        cornerCount += last - first;
+        triangleCount += (last - first) - 2 * (ranges[i].lastFace - ranges[i].firstFace);
+    }
+
+    // Open addressing table of the vertices, from their attribute indices
+    while(tableSize < 2 * cornerCount)
+    {
+        tableSize *= 2;
+    }
+    table.assign(tableSize, emptySlot);
+    keys.reserve(cornerCount / 2);
+    mesh.vertices.reserve(cornerCount / 2);
+    mesh.indices.reserve(triangleCount * 3);
+
+    for(unsigned int i=0; i<ranges.size(); i++)
+    {
+        const ObjChunk& chunk = chunks[ranges[i].chunk];
+
+        for(unsigned int face=ranges[i].firstFace; face<ranges[i].lastFace; face++, faceNumber++)
+        {
+            unsigned int first = chunk.faces[face];
+            unsigned int last = (face + 1 < chunk.faces.size()) ? chunk.faces[face + 1] : static_cast<unsigned int>(chunk.corners.size());
+            bool skipped = false;
+            bool flat = false;
+            glm::vec3 faceNormal(0.0f);
+
+            for(unsigned int corner=first; corner<last; corner++)
+            {
+                skipped = skipped || (chunk.corners[corner].attributes[0] == OBJ_MISSING_INDEX);
+                flat = flat || (chunk.corners[corner].attributes[2] == OBJ_MISSING_INDEX);
+            }
+            if(skipped)
+            {
+                continue;
+            }
+
+            // Newell normal of the polygon, for the faces without normals (their vertices are not shared with other faces)
+            if(flat)
+            {
+                for(unsigned int corner=first; corner<last; corner++)
+                {
+                    const glm::vec3& current = positions[chunk.corners[corner].attributes[0]];
+                    const glm::vec3& next = positions[chunk.corners[(corner + 1 < last) ? corner + 1 : first].attributes[0]];
+
+                    faceNormal += glm::vec3((current.y - next.y) * (current.z + next.z), (current.z - next.z) * (current.x + next.x), (current.x - next.x) * (current.y + next.y));
+                }
+                faceNormal = (glm::length(faceNormal) > 0.0f) ? glm::normalize(faceNormal) : faceNormal;
+            }
+
+            // Weld the corners
+            faceVertices.clear();
+            for(unsigned int corner=first; corner<last; corner++)
+            {
+                const ObjCorner& attributes = chunk.corners[corner];
+                glm::ivec3 key(attributes.attributes[0], attributes.attributes[1], flat ? -2 - faceNumber : attributes.attributes[2]);
+                size_t slot = ((static_cast<unsigned int>(key.x) * 73856093u) ^ (static_cast<unsigned int>(key.y) * 19349663u) ^ (static_cast<unsigned int>(key.z) * 83492791u)) & (tableSize - 1);
+                Vertex vertex;
+
+                while(table[slot] != emptySlot && keys[table[slot]] != key)
+                {
+                    slot = (slot + 1) & (tableSize - 1);
+                }
+
+                if(table[slot] == emptySlot)
+                {
+                    vertex.position = positions[key.x];
+                    vertex.normal = flat ? faceNormal : normals[key.z];
+                    vertex.textCoords = (key.y == OBJ_MISSING_INDEX) ? glm::vec2(0.0f) : glm::vec2(textureCoordinates[key.y].x, 1.0f - textureCoordinates[key.y].y);
+                    table[slot] = static_cast<GLuint>(mesh.vertices.size());
+                    keys.push_back(key);
+                    mesh.vertices.push_back(vertex);
+                }
+                faceVertices.push_back(table[slot]);
+            }
+
+            // Triangle fan
+            for(unsigned int corner=1; corner+1<faceVertices.size(); corner++)
+            {
+                mesh.indices.push_back(faceVertices[0]);
+                mesh.indices.push_back(faceVertices[corner]);
+                mesh.indices.push_back(faceVertices[corner + 1]);
+            }
+        }
+    }
+}
+
+
+bool ObjLoader::loadMaterials(const std::string& path, std::vector<ObjMaterial>& materials)
+{
+    MappedFile file;
+    ObjMaterial material;
+    const char* current;
+    const char* end;
+    const char* lineEnd;
+    bool hasMaterial = false;
+
+    if(!file.open(path))
+    {
+        return false;
+    }
+
+    current = file.getData();
+    end = file.getData() + file.getSize();
+    while(current < end)
+    {
+        lineEnd = std::find(current, end, '\n');
+        current = skipSpaces(current, lineEnd);
+
+        if(isKeyword(current, lineEnd, "newmtl"))
+        {
+            material.name = readName(current + 6, lineEnd);
+            materials.push_back(material);
+            hasMaterial = true;
+        }
+        else if(hasMaterial && isKeyword(current, lineEnd, "map_Kd"))
+        {
+            materials.back().diffuseMap = readMapPath(current + 6, lineEnd);
+        }
+        else if(hasMaterial && isKeyword(current, lineEnd, "map_Ks"))
+        {
+            materials.back().specularMap = readMapPath(current + 6, lineEnd);
+        }
+
+        current = (lineEnd == end) ? end : lineEnd + 1;
+    }
+
+    return true;
+}
+
+
+bool ObjLoader::parseInteger(const char*& current, const char* end, int& value)
+{
+    const char* position = current;
+    bool negative = false;
+    int result = 0;
+
+    if(position < end && (*position == '-' || *position == '+'))
+    {
+        negative = (*position == '-');
+        position++;
+    }
+    if(position >= end || *position < '0' || *position > '9')
+    {
+        return false;
+    }
+    for(; position < end && *position >= '0' && *position <= '9'; position++)
+    {
+        result = std::min(result * 10 + (*position - '0'), 1000000000);
+    }
+
+    value = negative ? -result : result;
+    current = position;
+
+    return true;
+}
+
+
+const char* ObjLoader::skipSpaces(const char* current, const char* end)
+{
+    while(current < end && (*current == ' ' || *current == '\t' || *current == '\r'))
+    {
+        current++;
+    }
+
+    return current;
+}
+
+
+bool ObjLoader::isKeyword(const char* current, const char* end, const char* keyword)
+{
+    size_t length = std::strlen(keyword);
+
+    if(static_cast<size_t>(end - current) < length || std::memcmp(current, keyword, length) != 0)
+    {
+        return false;
+    }
+
+    return current + length == end || current[length] == ' ' || current[length] == '\t' || current[length] == '\r';
+}
+
+
+std::string ObjLoader::readName(const char* current, const char* end)
+{
+    current = skipSpaces(current, end);
+    while(end > current && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+    {
+        end--;
+    }
+
+    return std::string(current, end);
+}
+
+
+std::string ObjLoader::readMapPath(const char* current, const char* end)
+{
+    const char* tokenEnd;
+    const char* number;
+    float value;
+    bool option;
+
+    // Options start with '-' and are followed by numbers, on / off, or a single word for -imfchan and -type
+    current = skipSpaces(current, end);
+    while(current < end && *current == '-')
+    {
+        tokenEnd = std::find_if(current, end, [](char character) { return character == ' ' || character == '\t' || character == '\r'; });
+        option = (std::string(current, tokenEnd) == "-imfchan" || std::string(current, tokenEnd) == "-type");
+        current = skipSpaces(tokenEnd, end);
+
+        while(current < end)
+        {
+            tokenEnd = std::find_if(current, end, [](char character) { return character == ' ' || character == '\t' || character == '\r'; });
+            number = current;
+            if(!option && !(parseFloat(number, tokenEnd, value) && number == tokenEnd) && std::string(current, tokenEnd) != "on" && std::string(current, tokenEnd) != "off")
+            {
+                break;
+            }
+            current = skipSpaces(tokenEnd, end);
+            option = false;
+        }
+    }
+
+    return readName(current, end);
+}
+
@@ -0,0 +1,263 @@
+#ifndef __OBJLOADER_H
+#define __OBJLOADER_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+
+// Mesh
+#include "Mesh.h"
+
+// Memory mapped files
+#include "MappedFile.h"
+
+// Jobs
+#include "JobSystem.h"
+
+
+// Minimal size of the part of an OBJ file parsed by each job, in bytes (smaller files are parsed by one job)
+#define OBJ_MIN_CHUNK_SIZE (256 * 1024)
+// Index of the texture coordinates or the normal of a face corner which does not have one
+#define OBJ_MISSING_INDEX (-1)
+
+
+/**
+ * @brief The ObjMaterial struct store the textures of a material of an MTL file
+ */
+struct ObjMaterial
+{
+    /// Name of the material
+    std::string name;
+    /// Diffuse texture (map_Kd), relative to the directory of the model, empty when there is none
+    std::string diffuseMap;
+    /// Specular texture (map_Ks), relative to the directory of the model, empty when there is none
+    std::string specularMap;
+};
+
+
+/**
+ * @brief The ObjMesh struct is a welded indexed triangle mesh of an OBJ file (the faces of an object or group using one material)
+ */
+struct ObjMesh
+{
+    /// Vertices, with the texture coordinates flipped vertically and a face normal when the file has none
+    std::vector<Vertex> vertices;
+    /// Triangles
+    std::vector<GLuint> indices;
+    /// Index of the material of the mesh, -1 when it has none
+    int material;
+};
+
+
+/**
+ * @brief The ObjModel struct store the meshes and the materials of an OBJ file
+ */
+struct ObjModel
+{
+    /// Meshes, in the order of the file
+    std::vector<ObjMesh> meshes;
+    /// Materials of the MTL files of the model
+    std::vector<ObjMaterial> materials;
+};
+
+
+/**
+ * @brief The ObjCorner struct store the indices of a face corner, from the beginning of the file (before resolution, negative indices are relative to the chunk)
+ */
+struct ObjCorner
+{
+    /// Indices of the position, the texture coordinates and the normal
+    int attributes[3];
+    /// Bit i set when the index i is relative to the end of the attributes of the chunk at the corner
+    unsigned char relative;
+};
+
+
+/**
+ * @brief The ObjStatement struct is a statement splitting the faces of a chunk into meshes (o, g or usemtl)
+ */
+struct ObjStatement
+{
+    /// Number of faces of the chunk before the statement
+    unsigned int face;
+    /// True for usemtl
+    bool material;
+    /// Name of the material
+    std::string name;
+};
+
+
+/**
+ * @brief The ObjChunk struct store the data of the lines of a part of an OBJ file
+ */
+struct ObjChunk
+{
+    /// Lines of the chunk
+    const char* begin;
+    const char* end;
+    /// Vertex attributes
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<glm::vec3> normals;
+    /// Corners of the faces
+    std::vector<ObjCorner> corners;
+    /// First corner of each face
+    std::vector<unsigned int> faces;
+    /// Statements starting a new mesh
+    std::vector<ObjStatement> statements;
+    /// MTL files
+    std::vector<std::string> materialLibraries;
+    /// Number of attributes of each kind in the previous chunks
+    unsigned int attributeOffsets[3];
+    /// Number of lines which could not be read
+    unsigned int invalidLines;
+};
+
+
+/**
+ * @brief The ObjFaceRange struct is a range of faces of a chunk belonging to a mesh
+ */
+struct ObjFaceRange
+{
+    unsigned int chunk;
+    unsigned int firstFace;
+    unsigned int lastFace;
+};
+
+
+/**
+ * @brief The ObjLoader class is a fast path to import text OBJ files and their MTL files, without Assimp.
+ *        The file is memory mapped and split into line-aligned chunks parsed by the workers of the job system,
+ *        then the faces of each mesh are triangulated and welded (one vertex per distinct position, texture coordinates and normal) in parallel.
+ *        The meshes are the ones of an Assimp import with aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals | aiProcess_JoinIdenticalVertices
+ *        (polygons are triangulated as fans, so they must be convex, and the faces without normals get a flat normal).
+ */
+class ObjLoader
+{
+// Methods
+public:
+
+
+    /**
+     * @brief load import an OBJ file and its materials
+     * @param path path of the OBJ file
+     * @param model filled with the meshes and the materials
+     * @return false when the file could not be read (the model is then left empty)
+     */
+    static bool load(const std::string& path, ObjModel& model);
+
+
+    /**
+     * @brief isObjFile verify if a file has the .obj extension (any case)
+     */
+    static bool isObjFile(const std::string& path);
+
+
+    /**
+     * @brief parseFloat parse a decimal floating point number, in the format of the C locale (like std::from_chars)
+     * @param current position of the number, moved after it
+     * @param end end of the text
+     * @param value filled with the number
+     * @return false when there is no number at the position
+     */
+    static bool parseFloat(const char*& current, const char* end, float& value);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief parseChunk read the lines of a chunk
+     */
+    static void parseChunk(ObjChunk& chunk);
+
+
+    /**
+     * @brief parseFace read the corners of a face line
+     * @return false when a corner is not valid (the corners already read are removed)
+     */
+    static bool parseFace(const char* current, const char* end, ObjChunk& chunk);
+
+
+    /**
+     * @brief resolveIndices convert the relative indices of the corners of a chunk, then verify all of them
+     * @param attributeCounts number of attributes of each kind in the file
+     * @return the number of corners whose position index is out of range (their faces are skipped)
+     */
+    static unsigned int resolveIndices(ObjChunk& chunk, const unsigned int* attributeCounts);
+
+
+    /**
+     * @brief splitMeshes group the faces of the chunks into meshes, following the o, g and usemtl statements
+     * @param chunks parsed chunks
+     * @param materials materials of the model, to find the index of the material of each mesh
+     * @param meshRanges filled with the face ranges of each mesh
+     * @param meshMaterials filled with the material of each mesh
+     */
+    static void splitMeshes(const std::vector<ObjChunk>& chunks, const std::vector<ObjMaterial>& materials, std::vector< std::vector<ObjFaceRange> >& meshRanges, std::vector<int>& meshMaterials);
+
+
+    /**
+     * @brief buildMesh triangulate and weld the faces of a mesh
+     * @param ranges face ranges of the mesh
+     * @param chunks parsed chunks
+     * @param positions positions of the file
+     * @param textureCoordinates texture coordinates of the file
+     * @param normals normals of the file
+     * @param mesh filled with the vertices and the indices
+     */
+    static void buildMesh(const std::vector<ObjFaceRange>& ranges, const std::vector<ObjChunk>& chunks, const std::vector<glm::vec3>& positions,
+                          const std::vector<glm::vec2>& textureCoordinates, const std::vector<glm::vec3>& normals, ObjMesh& mesh);
+
+
+    /**
+     * @brief loadMaterials read the materials of an MTL file
+     * @param path path of the MTL file
+     * @param materials materials are added to it
+     * @return false when the file could not be read
+     */
+    static bool loadMaterials(const std::string& path, std::vector<ObjMaterial>& materials);
+
+
+    /**
+     * @brief parseInteger parse a decimal integer
+     * @param current position of the number, moved after it
+     * @return false when there is no number at the position
+     */
+    static bool parseInteger(const char*& current, const char* end, int& value);
+
+
+    /**
+     * @brief skipSpaces move after the spaces and tabulations
+     */
+    static const char* skipSpaces(const char* current, const char* end);
+
+
+    /**
+     * @brief isKeyword verify if a line starts with a keyword followed by a space or the end of the line
+     */
+    static bool isKeyword(const char* current, const char* end, const char* keyword);
+
+
+    /**
+     * @brief readName return the rest of a line without the spaces around it (names and paths can contain spaces)
+     */
+    static std::string readName(const char* current, const char* end);
+
+
+    /**
+     * @brief readMapPath return the path of a texture map statement of an MTL file, without its options (-bm 1, -clamp on, ...)
+     */
+    static std::string readMapPath(const char* current, const char* end);
+};
+
+
+#endif
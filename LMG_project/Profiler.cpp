@@ -0,0 +1,452 @@
+#include "Profiler.h"
+
+
+Profiler* Profiler::profiler = NULL;
+thread_local unsigned int Profiler::cpuDepth = 0;
+
+
+// ===========
+// Constructor
+
+Profiler::Profiler() :
+    frame(0),
+    frameActive(false),
+    frameStart(0),
+    resolvedFrame(0),
+    droppedFrames(0),
+    gpuSupported(false),
+    gpuDepth(0),
+    gpuClockOffset(0)
+{
+    this->startTime = std::chrono::steady_clock::now();
+}
+
+
+// =======
+// Methods
+
+Profiler& Profiler::getProfiler()
+{
+    if(profiler == NULL)
+    {
+        profiler = new Profiler();
+    }
+
+    return *profiler;
+}
+
+
+void Profiler::initialize()
+{
+    GLint timestampBits = 0;
+    GLint64 gpuTime = 0;
+
+    this->gpuSupported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if(this->gpuSupported)
+    {
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+        this->gpuSupported = (timestampBits > 0);
+    }
+    if(!this->gpuSupported)
+    {
+        std::cerr << "[WARNING] in Profiler::initialize, timer queries are not supported, only the CPU is measured" << std::endl;
+        return;
+    }
+
+    // The timestamp read now is the time of the GPU when the commands issued before are done, close to the time of the CPU
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    this->gpuClockOffset = this->getTime() - static_cast<long long>(gpuTime);
+
+    this->gpuFrames.resize(PROFILER_QUERY_LATENCY);
+    for(unsigned int i=0; i<this->gpuFrames.size(); i++)
+    {
+        glGenQueries(1, &this->gpuFrames[i].elapsedQuery);
+        this->gpuFrames[i].frame = 0;
+        this->gpuFrames[i].pending = false;
+        this->gpuFrames[i].usedQueries = 0;
+    }
+    glCheckError();
+}
+
+
+void Profiler::beginFrame()
+{
+    this->frame++;
+    this->frameActive = true;
+    this->frameStart = this->getTime();
+
+    if(!this->gpuSupported)
+    {
+        return;
+    }
+
+    // The slot was used PROFILER_QUERY_LATENCY frames ago, its results should be available without waiting
+    GpuProfileFrame& gpuFrame = this->gpuFrames[this->frame % this->gpuFrames.size()];
+    this->resolveFrame(gpuFrame);
+
+    gpuFrame.frame = this->frame;
+    gpuFrame.pending = true;
+    gpuFrame.usedQueries = 0;
+    gpuFrame.scopes.clear();
+    this->gpuDepth = 0;
+
+    glQueryCounter(this->getQuery(gpuFrame), GL_TIMESTAMP);
+    glBeginQuery(GL_TIME_ELAPSED, gpuFrame.elapsedQuery);
+    glCheckError();
+}
+
+
+void Profiler::endFrame()
+{
+    ProfileEvent event;
+
+    if(!this->frameActive)
+    {
+        return;
+    }
+    if(this->gpuSupported)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        glCheckError();
+    }
+    this->frameActive = false;
+
+    event.name = "Frame";
+    event.frame = this->frame;
+    event.thread = JobSystem::getWorkerIndex();
+    event.gpu = false;
+    event.depth = 0;
+    event.start = this->frameStart;
+    event.duration = this->getTime() - this->frameStart;
+    this->addEvent(event);
+
+    {
+        std::lock_guard<std::mutex> lock(this->eventMutex);
+
+        // Only the last frames are kept for the trace (the GPU scopes arrive later, they are forgotten with the frames after them)
+        while(!this->events.empty() && this->events.front().frame + PROFILER_TRACE_FRAMES <= this->frame)
+        {
+            this->events.pop_front();
+        }
+    }
+
+    if(PROFILER_TRACE_DUMP_FRAME > 0 && this->frame == PROFILER_TRACE_DUMP_FRAME)
+    {
+        this->printSummary();
+        this->writeTrace(PROFILER_TRACE_PATH);
+    }
+}
+
+
+long long Profiler::getTime() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->startTime).count();
+}
+
+
+long long Profiler::beginCpuScope()
+{
+    cpuDepth++;
+
+    return this->getTime();
+}
+
+
+void Profiler::endCpuScope(const char* name, long long start)
+{
+    ProfileEvent event;
+
+    cpuDepth--;
+
+    event.name = name;
+    event.frame = this->frame;
+    event.thread = JobSystem::getWorkerIndex();
+    event.gpu = false;
+    event.depth = cpuDepth;
+    event.start = start;
+    event.duration = this->getTime() - start;
+    this->addEvent(event);
+}
+
+
+int Profiler::beginGpuScope(const char* name)
+{
+    GpuProfileScopeQueries scope;
+
+    // Queries are only issued by the thread of the GL context, during a frame
+    if(!this->gpuSupported || !this->frameActive || JobSystem::getWorkerIndex() != 0)
+    {
+        return -1;
+    }
+
+    GpuProfileFrame& gpuFrame = this->gpuFrames[this->frame % this->gpuFrames.size()];
+
+    scope.name = name;
+    scope.depth = this->gpuDepth;
+    scope.beginQuery = gpuFrame.usedQueries;
+    scope.endQuery = 0;
+    glQueryCounter(this->getQuery(gpuFrame), GL_TIMESTAMP);
+    glCheckError();
+    gpuFrame.scopes.push_back(scope);
+    this->gpuDepth++;
+
+    return static_cast<int>(gpuFrame.scopes.size()) - 1;
+}
+
+
+void Profiler::endGpuScope(int scope)
+{
+    if(scope < 0 || !this->frameActive)
+    {
+        return;
+    }
+
+    GpuProfileFrame& gpuFrame = this->gpuFrames[this->frame % this->gpuFrames.size()];
+
+    gpuFrame.scopes[scope].endQuery = gpuFrame.usedQueries;
+    glQueryCounter(this->getQuery(gpuFrame), GL_TIMESTAMP);
+    glCheckError();
+    this->gpuDepth--;
+}
+
+
+void Profiler::printSummary()
+{
+    std::vector<ProfileEvent> frameEvents;
+    std::vector<ProfileSummaryRow> rows;
+    double frameCpuTime = 0.0;
+    double frameGpuTime = 0.0;
+    unsigned int summaryFrame = this->resolvedFrame;
+    size_t row;
+
+    // The last frame whose GPU results were read, or the last finished frame when the GPU is not measured
+    if(summaryFrame == 0)
+    {
+        summaryFrame = (this->frameActive ? this->frame - 1 : this->frame.load());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->eventMutex);
+
+        for(size_t i=0; i<this->events.size(); i++)
+        {
+            if(this->events[i].frame == summaryFrame)
+            {
+                frameEvents.push_back(this->events[i]);
+            }
+        }
+    }
+
+    // One row per name, in the order the CPU scopes started (the events are kept in the order they ended)
+    std::stable_sort(frameEvents.begin(), frameEvents.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+    {
+        return (a.gpu != b.gpu) ? !a.gpu : (!a.gpu && a.start < b.start);
+    });
+    for(size_t i=0; i<frameEvents.size(); i++)
+    {
+        const ProfileEvent& event = frameEvents[i];
+
+        if(std::strcmp(event.name, "Frame") == 0)
+        {
+            (event.gpu ? frameGpuTime : frameCpuTime) += event.duration * 1e-6;
+            continue;
+        }
+        for(row=0; row<rows.size() && std::strcmp(rows[row].name, event.name) != 0; row++);
+        if(row == rows.size())
+        {
+            ProfileSummaryRow summaryRow = { event.name, event.depth, 0, 0, false };
+            rows.push_back(summaryRow);
+        }
+        if(event.gpu)
+        {
+            rows[row].gpuTime += event.duration;
+            rows[row].gpu = true;
+        }
+        else
+        {
+            rows[row].cpuTime += event.duration;
+            rows[row].depth = std::min(rows[row].depth, event.depth);
+        }
+    }
+
+    std::cout << "Profiler : frame " << summaryFrame << ", " << std::fixed << std::setprecision(3) << frameCpuTime << " ms CPU, ";
+    if(this->gpuSupported && summaryFrame == this->resolvedFrame)
+    {
+        std::cout << frameGpuTime << " ms GPU";
+    }
+    else
+    {
+        std::cout << "no GPU time";
+    }
+    std::cout << " (" << this->droppedFrames << " frames without GPU results)" << std::endl;
+
+    for(size_t i=0; i<rows.size(); i++)
+    {
+        std::cout << "    " << std::string(2 * rows[i].depth, ' ') << rows[i].name << " : " << rows[i].cpuTime * 1e-6 << " ms CPU";
+        if(rows[i].gpu)
+        {
+            std::cout << ", " << rows[i].gpuTime * 1e-6 << " ms GPU";
+        }
+        std::cout << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+
+bool Profiler::writeTrace(const std::string& path)
+{
+    std::ofstream file;
+    unsigned int threadCount = JobSystem::getJobSystem().getWorkerCount() + 2;
+    unsigned int eventCount = 0;
+    int thread;
+
+    file.open(path.c_str());
+    if(!file.is_open())
+    {
+        std::cerr << "[WARNING] in Profiler::writeTrace, the trace can not be written : " << path << std::endl;
+        return false;
+    }
+
+    // Tracks : the GPU, then the workers of the job system (the GL thread first), then the other threads
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    for(unsigned int i=0; i<threadCount; i++)
+    {
+        std::string threadName = (i == 0) ? "GPU" : (i == 1) ? "GL thread" : (i + 1 < threadCount) ? "Worker " + std::to_string(i - 1) : "Other threads";
+
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"" << threadName << "\"}},"
+             << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"sort_index\":" << i << "}}," << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->eventMutex);
+
+        // Complete events, in microseconds
+        file << std::fixed << std::setprecision(3);
+        for(size_t i=0; i<this->loadingEvents.size() + this->events.size(); i++)
+        {
+            const ProfileEvent& event = (i < this->loadingEvents.size()) ? this->loadingEvents[i] : this->events[i - this->loadingEvents.size()];
+
+            thread = event.gpu ? 0 : (event.thread >= 0) ? event.thread + 1 : static_cast<int>(threadCount) - 1;
+            file << (eventCount > 0 ? ",\n" : "") << "{\"name\":";
+            writeString(file, event.name);
+            file << ",\"cat\":\"" << (event.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                 << ",\"ts\":" << event.start * 1e-3 << ",\"dur\":" << event.duration * 1e-3 << ",\"args\":{\"frame\":" << event.frame << "}}";
+            eventCount++;
+        }
+    }
+    file << std::endl << "]}" << std::endl;
+
+    if(!file)
+    {
+        std::cerr << "[WARNING] in Profiler::writeTrace, the trace can not be written : " << path << std::endl;
+        return false;
+    }
+    std::cout << "Profiler : trace of " << eventCount << " scopes written to " << path << std::endl;
+
+    return true;
+}
+
+
+// =================
+// Auxiliary methods
+
+void Profiler::resolveFrame(GpuProfileFrame& gpuFrame)
+{
+    GLuint available = GL_FALSE;
+    GLuint64 elapsedTime = 0;
+    GLuint64 beginTime = 0;
+    GLuint64 endTime = 0;
+    ProfileEvent event;
+
+    if(!gpuFrame.pending)
+    {
+        return;
+    }
+    gpuFrame.pending = false;
+
+    // A result still not available would make the CPU wait for the GPU, the frame is dropped instead
+    glGetQueryObjectuiv(gpuFrame.elapsedQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    for(unsigned int i=0; i<gpuFrame.usedQueries && available == GL_TRUE; i++)
+    {
+        glGetQueryObjectuiv(gpuFrame.timestampQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if(available != GL_TRUE)
+    {
+        this->droppedFrames++;
+        return;
+    }
+
+    event.frame = gpuFrame.frame;
+    event.thread = 0;
+    event.gpu = true;
+
+    // The whole frame, placed at the timestamp of its start
+    glGetQueryObjectui64v(gpuFrame.elapsedQuery, GL_QUERY_RESULT, &elapsedTime);
+    glGetQueryObjectui64v(gpuFrame.timestampQueries[0], GL_QUERY_RESULT, &beginTime);
+    event.name = "Frame";
+    event.depth = 0;
+    event.start = static_cast<long long>(beginTime) + this->gpuClockOffset;
+    event.duration = static_cast<long long>(elapsedTime);
+    this->addEvent(event);
+
+    for(unsigned int i=0; i<gpuFrame.scopes.size(); i++)
+    {
+        const GpuProfileScopeQueries& scope = gpuFrame.scopes[i];
+
+        glGetQueryObjectui64v(gpuFrame.timestampQueries[scope.beginQuery], GL_QUERY_RESULT, &beginTime);
+        glGetQueryObjectui64v(gpuFrame.timestampQueries[scope.endQuery], GL_QUERY_RESULT, &endTime);
+        event.name = scope.name;
+        event.depth = scope.depth;
+        event.start = static_cast<long long>(beginTime) + this->gpuClockOffset;
+        event.duration = static_cast<long long>(endTime - beginTime);
+        this->addEvent(event);
+    }
+    glCheckError();
+
+    this->resolvedFrame = gpuFrame.frame;
+}
+
+
+void Profiler::addEvent(const ProfileEvent& event)
+{
+    std::lock_guard<std::mutex> lock(this->eventMutex);
+
+    if(event.frame == 0)
+    {
+        this->loadingEvents.push_back(event);
+    }
+    else
+    {
+        this->events.push_back(event);
+    }
+}
+
+
+GLuint Profiler::getQuery(GpuProfileFrame& gpuFrame)
+{
+    GLuint query = 0;
+
+    if(gpuFrame.usedQueries == gpuFrame.timestampQueries.size())
+    {
+        glGenQueries(1, &query);
+        gpuFrame.timestampQueries.push_back(query);
+    }
+
+    return gpuFrame.timestampQueries[gpuFrame.usedQueries++];
+}
+
+
+void Profiler::writeString(std::ofstream& file, const char* text)
+{
+    file << '"';
+    for(const char* character=text; *character != '\0'; character++)
+    {
+        if(*character == '"' || *character == '\\')
+        {
+            file << '\\';
+        }
+        file << *character;
+    }
+    file << '"';
+}
@@ -0,0 +1,354 @@
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+
+// Jobs
+#include "JobSystem.h"
+
+// Frames in flight
+#include "FrameScheduler.h"
+
+
+// Profiling scopes compiled in the program (1) or compiled out (0), the frames are always measured
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+// Frames between the queries of a frame and the read of their results (the ring of query objects), results not available by then are dropped.
+// Larger than the frames in flight, so the frame read is always finished by the GPU
+#define PROFILER_QUERY_LATENCY (FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT + 1)
+// Last frames kept for the trace
+#define PROFILER_TRACE_FRAMES 300
+// Frame after which the trace is written once, 0 to write it only on request
+#define PROFILER_TRACE_DUMP_FRAME 0
+// File of the trace, in the JSON format of chrome://tracing and Perfetto
+#define PROFILER_TRACE_PATH "profile_trace.json"
+
+
+/**
+ * @brief The ProfileEvent struct is a scope measured on the CPU or the GPU, in nanoseconds since the start of the profiler
+ */
+struct ProfileEvent
+{
+    /// Name of the scope (a string literal)
+    const char* name;
+    /// Frame of the scope, 0 while loading
+    unsigned int frame;
+    /// Worker of the job system which ran the scope (-1 for the other threads), ignored for the GPU
+    int thread;
+    /// Scope measured on the GPU
+    bool gpu;
+    /// Number of scopes the scope is nested in
+    unsigned int depth;
+    long long start;
+    long long duration;
+};
+
+
+/**
+ * @brief The ProfileSummaryRow struct is the time of the scopes of a frame with the same name, in nanoseconds
+ */
+struct ProfileSummaryRow
+{
+    const char* name;
+    /// Depth of the outermost CPU scope with the name
+    unsigned int depth;
+    long long cpuTime;
+    long long gpuTime;
+    /// The name has GPU scopes
+    bool gpu;
+};
+
+
+/**
+ * @brief The GpuProfileScopeQueries struct is a scope measured on the GPU with two timestamp queries
+ */
+struct GpuProfileScopeQueries
+{
+    const char* name;
+    unsigned int depth;
+    /// Indices of the queries in the slot of the frame
+    unsigned int beginQuery;
+    unsigned int endQuery;
+};
+
+
+/**
+ * @brief The GpuProfileFrame struct is a slot of the ring of query objects, used by one frame every PROFILER_QUERY_LATENCY frames
+ */
+struct GpuProfileFrame
+{
+    /// Frame which issued the queries
+    unsigned int frame;
+    /// The results were not read yet
+    bool pending;
+    /// Time elapsed on the GPU during the frame
+    GLuint elapsedQuery;
+    /// Timestamp queries of the scopes, the first one is the start of the frame (kept from one use of the slot to the next)
+    std::vector<GLuint> timestampQueries;
+    unsigned int usedQueries;
+    std::vector<GpuProfileScopeQueries> scopes;
+};
+
+
+/**
+ * @brief The Profiler class measure named scopes on the CPU (with the monotonic clock, on any thread) and on the GPU (with timer queries, on the GL thread).
+ *        Each frame measures its GPU time with a GL_TIME_ELAPSED query and its scopes with pairs of GL_TIMESTAMP queries, in a ring of query objects
+ *        read PROFILER_QUERY_LATENCY frames later so the CPU never waits for the results.
+ *        The scopes of the last frames are kept to print a summary of a frame and to write a trace for chrome://tracing or Perfetto.
+ */
+class Profiler
+{
+// Attributes
+private:
+    /// Start of the profiler, origin of the times of the events
+    std::chrono::steady_clock::time_point startTime;
+    /// Current frame, 0 while loading
+    std::atomic<unsigned int> frame;
+    /// A frame is between beginFrame and endFrame
+    bool frameActive;
+    /// Start of the current frame
+    long long frameStart;
+
+    /// Events of the last frames, and events of the loading which are always kept
+    std::deque<ProfileEvent> events;
+    std::vector<ProfileEvent> loadingEvents;
+    std::mutex eventMutex;
+    /// Last frame whose GPU results were read, 0 for none
+    unsigned int resolvedFrame;
+    /// Frames whose GPU results were not available in time
+    unsigned int droppedFrames;
+
+    /// Timer queries are supported by the context (OpenGL 3.3 or ARB_timer_query)
+    bool gpuSupported;
+    /// Ring of query objects
+    std::vector<GpuProfileFrame> gpuFrames;
+    /// Number of GPU scopes open
+    unsigned int gpuDepth;
+    /// Difference between the clock of the profiler and the timestamps of the GPU, in nanoseconds
+    long long gpuClockOffset;
+
+    /// Number of CPU scopes open on the calling thread
+    static thread_local unsigned int cpuDepth;
+    /// The profiler of the application, created on first use
+    static Profiler* profiler;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief Profiler create a profiler measuring the CPU only until initialize is called
+     */
+    Profiler();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getProfiler return the profiler of the application
+     */
+    static Profiler& getProfiler();
+
+
+    /**
+     * @brief initialize check the support of the timer queries and synchronize the clocks of the CPU and the GPU, once the GL context and GLEW are initialized
+     */
+    void initialize();
+
+
+    /**
+     * @brief beginFrame read the GPU results of the frame which used the next slot of the ring, then start the GPU time of the new frame.
+     *        Called at the start of the display callback, after the frame scheduler waited for the oldest frame in flight.
+     */
+    void beginFrame();
+
+
+    /**
+     * @brief endFrame end the GPU time of the frame, forget the frames too old for the trace and write the trace after PROFILER_TRACE_DUMP_FRAME frames.
+     *        Called at the end of the display callback.
+     */
+    void endFrame();
+
+
+    /**
+     * @brief getTime return the time since the start of the profiler, in nanoseconds
+     */
+    long long getTime() const;
+
+
+    /**
+     * @brief beginCpuScope start a CPU scope on the calling thread (use PROFILE_SCOPE)
+     * @return the start of the scope
+     */
+    long long beginCpuScope();
+
+
+    /**
+     * @brief endCpuScope end the last CPU scope of the calling thread and keep it for the trace
+     * @param name name of the scope (a string literal)
+     * @param start start of the scope given by beginCpuScope
+     */
+    void endCpuScope(const char* name, long long start);
+
+
+    /**
+     * @brief beginGpuScope issue the timestamp query of the start of a GPU scope, on the GL thread during a frame (use PROFILE_GPU_SCOPE)
+     * @param name name of the scope (a string literal)
+     * @return index of the scope in its frame, -1 when the scope is not measured
+     */
+    int beginGpuScope(const char* name);
+
+
+    /**
+     * @brief endGpuScope issue the timestamp query of the end of a GPU scope
+     * @param scope index given by beginGpuScope
+     */
+    void endGpuScope(int scope);
+
+
+    /**
+     * @brief printSummary print the CPU and GPU time of each scope of the last frame whose GPU results were read
+     */
+    void printSummary();
+
+
+    /**
+     * @brief writeTrace write the scopes of the loading and of the last frames in the trace event format of chrome://tracing and Perfetto
+     * @param path path of the JSON file
+     * @return false when the file can not be written
+     */
+    bool writeTrace(const std::string& path);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief resolveFrame read the results of the queries of a slot and keep its GPU scopes, the results not available yet are dropped
+     */
+    void resolveFrame(GpuProfileFrame& gpuFrame);
+
+
+    /**
+     * @brief addEvent keep a measured scope for the summary and the trace
+     */
+    void addEvent(const ProfileEvent& event);
+
+
+    /**
+     * @brief getQuery return a free timestamp query of a slot, created when the slot has none left
+     */
+    GLuint getQuery(GpuProfileFrame& gpuFrame);
+
+
+    /**
+     * @brief writeString write a string in a JSON file, with its quotes escaped
+     */
+    static void writeString(std::ofstream& file, const char* text);
+};
+
+
+/**
+ * @brief The CpuProfileScope class measure the CPU time of the block it is declared in
+ */
+class CpuProfileScope
+{
+// Attributes
+private:
+    const char* name;
+    long long start;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief CpuProfileScope start the scope
+     * @param name name of the scope (a string literal)
+     */
+    explicit CpuProfileScope(const char* name) :
+        name(name),
+        start(Profiler::getProfiler().beginCpuScope())
+    {
+    }
+
+
+    /**
+     * @brief ~CpuProfileScope end the scope
+     */
+    ~CpuProfileScope()
+    {
+        Profiler::getProfiler().endCpuScope(this->name, this->start);
+    }
+};
+
+
+/**
+ * @brief The GpuProfileScope class measure the GPU time of the OpenGL commands of the block it is declared in
+ */
+class GpuProfileScope
+{
+// Attributes
+private:
+    int scope;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief GpuProfileScope start the scope
+     * @param name name of the scope (a string literal)
+     */
+    explicit GpuProfileScope(const char* name) :
+        scope(Profiler::getProfiler().beginGpuScope(name))
+    {
+    }
+
+
+    /**
+     * @brief ~GpuProfileScope end the scope
+     */
+    ~GpuProfileScope()
+    {
+        Profiler::getProfiler().endGpuScope(this->scope);
+    }
+};
+
+
+#define PROFILER_CONCATENATE_(a, b) a##b
+#define PROFILER_CONCATENATE(a, b) PROFILER_CONCATENATE_(a, b)
+#if PROFILER_ENABLED
+// Measure the CPU time of the block
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILER_CONCATENATE(cpuProfileScope, __LINE__)(name)
+// Measure the CPU time of the block and the GPU time of its OpenGL commands, under the same name
+#define PROFILE_GPU_SCOPE(name) CpuProfileScope PROFILER_CONCATENATE(cpuProfileScope, __LINE__)(name); GpuProfileScope PROFILER_CONCATENATE(gpuProfileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#endif
+
+
+#endif
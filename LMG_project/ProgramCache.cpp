@@ -0,0 +1,226 @@
+#include "ProgramCache.h"
+
+
+// =======
+// Methods
+
+bool ProgramCache::isSupported()
+{
+    GLint formatCount = 0;
+
+    if(!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+    {
+        return false;
+    }
+
+    // Some drivers expose the functions without any binary format
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+    return formatCount > 0;
+}
+
+
+std::string ProgramCache::getPath(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& defines)
+{
+    size_t separator = fragmentShaderPath.find_last_of("/\\");
+    std::string fragmentShaderName = (separator == std::string::npos) ? fragmentShaderPath : fragmentShaderPath.substr(separator + 1);
+    char definesHash[17];
+
+    // A vertex shader can be linked with several fragment shaders
+    if(defines.empty())
+    {
+        return vertexShaderPath + "." + fragmentShaderName + PROGRAM_CACHE_EXTENSION;
+    }
+
+    // and compiled with several defines
+    std::snprintf(definesHash, sizeof(definesHash), "%016llx", hashBytes(defines.data(), defines.size(), 14695981039346656037ull));
+
+    return vertexShaderPath + "." + fragmentShaderName + "." + definesHash + PROGRAM_CACHE_EXTENSION;
+}
+
+
+unsigned long long ProgramCache::getKey(const std::vector<std::string>& sources, const std::string& defines)
+{
+    const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    unsigned long long key = 14695981039346656037ull;
+    unsigned long long size;
+    const GLubyte* driverString;
+
+    // Sizes are hashed too, so that the same bytes split differently do not give the same key
+    for(unsigned int i=0; i<sources.size(); i++)
+    {
+        size = sources[i].size();
+        key = hashBytes(&size, sizeof(size), key);
+        key = hashBytes(sources[i].data(), sources[i].size(), key);
+    }
+    size = defines.size();
+    key = hashBytes(&size, sizeof(size), key);
+    key = hashBytes(defines.data(), defines.size(), key);
+
+    // Binaries are only valid for the driver which created them
+    for(unsigned int i=0; i<sizeof(driverStrings) / sizeof(driverStrings[0]); i++)
+    {
+        driverString = glGetString(driverStrings[i]);
+        if(driverString != NULL)
+        {
+            key = hashBytes(driverString, std::strlen(reinterpret_cast<const char*>(driverString)) + 1, key);
+        }
+    }
+
+    return key;
+}
+
+
+void ProgramCache::prepare(GLuint program)
+{
+    if(isSupported())
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+
+bool ProgramCache::load(const std::string& path, unsigned long long key, GLuint* program)
+{
+    std::ifstream file;
+    unsigned int magic = 0;
+    unsigned int version = 0;
+    unsigned long long cachedKey = 0;
+    GLenum format = 0;
+    unsigned int length = 0;
+    std::vector<char> binary;
+    std::streamoff fileSize;
+    GLint linkStatus = GL_FALSE;
+
+    if(!isSupported())
+    {
+        return false;
+    }
+
+    file.open(path.c_str(), std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        return false;
+    }
+    fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    // Header
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&cachedKey), sizeof(cachedKey));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if(!file || magic != PROGRAM_CACHE_MAGIC || version != PROGRAM_CACHE_VERSION || cachedKey != key || !isFormatSupported(format)
+       || length == 0 || static_cast<std::streamoff>(length) > fileSize - file.tellg())
+    {
+        return false;
+    }
+
+    // Binary
+    binary.resize(length);
+    file.read(binary.data(), length);
+    if(!file)
+    {
+        return false;
+    }
+
+    // The driver can still reject a binary (after an update keeping the same version string, for example)
+    *program = glCreateProgram();
+    glProgramBinary(*program, format, binary.data(), static_cast<GLsizei>(length));
+    glGetProgramiv(*program, GL_LINK_STATUS, &linkStatus);
+    if(linkStatus == GL_FALSE)
+    {
+        std::cerr << "[WARNING] in ProgramCache, the program binary was rejected by the driver and will be compiled again : " << path << std::endl;
+        glDeleteProgram(*program);
+        *program = 0;
+        return false;
+    }
+    glCheckError();
+
+    return true;
+}
+
+
+bool ProgramCache::save(const std::string& path, unsigned long long key, GLuint program)
+{
+    std::ofstream file;
+    unsigned int magic = PROGRAM_CACHE_MAGIC;
+    unsigned int version = PROGRAM_CACHE_VERSION;
+    GLenum format = 0;
+    GLint length = 0;
+    GLsizei writtenLength = 0;
+    unsigned int binaryLength;
+    std::vector<char> binary;
+
+    if(!isSupported())
+    {
+        return false;
+    }
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0)
+    {
+        return false;
+    }
+    binary.resize(length);
+    glGetProgramBinary(program, length, &writtenLength, &format, binary.data());
+    glCheckError();
+    if(writtenLength <= 0)
+    {
+        return false;
+    }
+    binaryLength = static_cast<unsigned int>(writtenLength);
+
+    file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        std::cerr << "[WARNING] in ProgramCache, could not write program binary file : " << path << std::endl;
+        return false;
+    }
+
+    // Header
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(reinterpret_cast<const char*>(&binaryLength), sizeof(binaryLength));
+
+    // Binary
+    file.write(binary.data(), binaryLength);
+
+    return static_cast<bool>(file);
+}
+
+
+// =================
+// Auxiliary methods
+
+unsigned long long ProgramCache::hashBytes(const void* data, size_t size, unsigned long long hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    for(size_t i=0; i<size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+
+bool ProgramCache::isFormatSupported(GLenum format)
+{
+    GLint formatCount = 0;
+    std::vector<GLint> formats;
+
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if(formatCount <= 0)
+    {
+        return false;
+    }
+    formats.resize(formatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    return std::find(formats.begin(), formats.end(), static_cast<GLint>(format)) != formats.end();
+}
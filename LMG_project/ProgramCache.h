@@ -0,0 +1,109 @@
+#ifndef __PROGRAMCACHE_H
+#define __PROGRAMCACHE_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+
+// Magic number of the program binary files ("LMGP")
+#define PROGRAM_CACHE_MAGIC 0x50474D4Cu
+// Version of the program binary file format, to increase each time the format changes
+#define PROGRAM_CACHE_VERSION 1u
+// Extension of the program binary files, written next to the vertex shader
+#define PROGRAM_CACHE_EXTENSION ".lmgprog"
+
+
+/**
+ * @brief The ProgramCache class save and load linked programs as driver binaries (glGetProgramBinary / glProgramBinary),
+ *        so that the shaders are only compiled the first time they are used.
+ *        A binary is found with a key hashing the sources, the defines and the vendor, renderer and version of the driver :
+ *        a binary of another source or driver is never loaded, and a binary rejected by the driver is compiled again.
+ */
+class ProgramCache
+{
+// Methods
+public:
+
+
+    /**
+     * @brief isSupported verify if the driver can retrieve and load program binaries
+     */
+    static bool isSupported();
+
+
+    /**
+     * @brief getPath return the path of the binary file of a program
+     * @param vertexShaderPath path of the vertex shader
+     * @param fragmentShaderPath path of the fragment shader
+     * @param defines defines added to the sources, each combination gets its own file
+     */
+    static std::string getPath(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& defines);
+
+
+    /**
+     * @brief getKey return the key of a program binary for the current driver
+     * @param sources sources of the shaders of the program
+     * @param defines defines added to the sources
+     */
+    static unsigned long long getKey(const std::vector<std::string>& sources, const std::string& defines);
+
+
+    /**
+     * @brief prepare ask the driver to keep the binary of a program, to call before it is linked
+     * @param program id in OpenGL of the program
+     */
+    static void prepare(GLuint program);
+
+
+    /**
+     * @brief load create a program from its binary file
+     * @param path path of the binary file
+     * @param key key of the program for the current driver
+     * @param program filled with the id in OpenGL of the linked program
+     * @return false if the file does not exist, does not match the key or is rejected by the driver (no program is then created)
+     */
+    static bool load(const std::string& path, unsigned long long key, GLuint* program);
+
+
+    /**
+     * @brief save write the binary file of a linked program
+     * @param path path of the binary file
+     * @param key key of the program for the current driver
+     * @param program id in OpenGL of the program, prepared before it was linked
+     * @return false if the binary could not be retrieved or written
+     */
+    static bool save(const std::string& path, unsigned long long key, GLuint program);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief hashBytes continue a 64-bit FNV-1a hash with some bytes
+     * @param data bytes to hash
+     * @param size number of bytes
+     * @param hash hash of the previous bytes
+     */
+    static unsigned long long hashBytes(const void* data, size_t size, unsigned long long hash);
+
+
+    /**
+     * @brief isFormatSupported verify if the driver can load binaries of a format
+     */
+    static bool isFormatSupported(GLenum format);
+
+};
+
+
+#endif
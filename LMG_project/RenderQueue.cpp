@@ -0,0 +1,210 @@
+#include "RenderQueue.h"
+
+
+RenderQueueStatistics RenderQueue::statistics = { 0, 0, 0 };
+
+
+// =======
+// Methods
+
+void RenderQueue::append(RenderQueue& queue)
+{
+    size_t payloadOffset = 0;
+    size_t packetOffset = this->packets.size();
+
+    if(queue.packets.empty())
+    {
+        return;
+    }
+
+    // The payloads of the other queue keep their alignment after the payloads of this one
+    payloadOffset = this->allocatePayload(queue.payloads.size());
+    if(!queue.payloads.empty())
+    {
+        std::memcpy(&this->payloads[payloadOffset], &queue.payloads[0], queue.payloads.size());
+    }
+
+    this->packets.insert(this->packets.end(), queue.packets.begin(), queue.packets.end());
+    for(size_t i=packetOffset; i<this->packets.size(); i++)
+    {
+        this->packets[i].payloadOffset += payloadOffset;
+    }
+
+    // The buffers keep their memory for the next frame
+    queue.packets.clear();
+    queue.payloads.clear();
+}
+
+
+void RenderQueue::execute()
+{
+    unsigned int passShift = 64 - RENDER_KEY_PASS_BITS;
+    unsigned int previousPass = 0;
+    Shader* previousShader = NULL;
+    int passScope = -1;
+
+    this->sortPackets();
+
+    for(size_t i=0; i<this->packets.size(); i++)
+    {
+        const RenderPacket& packet = this->packets[i];
+        unsigned int pass = static_cast<unsigned int>(packet.key >> passShift);
+
+        if(i == 0 || pass != previousPass)
+        {
+            // Each pass is measured by its own GPU scope
+#if PROFILER_ENABLED
+            Profiler::getProfiler().endGpuScope(passScope);
+            passScope = Profiler::getProfiler().beginGpuScope(getPassName(static_cast<RenderPass>(pass)));
+#endif
+            setPassState(static_cast<RenderPass>(pass));
+            previousPass = pass;
+            statistics.passChanges++;
+        }
+        if(packet.shader != previousShader)
+        {
+            packet.shader->use();
+            previousShader = packet.shader;
+            statistics.programChanges++;
+        }
+
+        packet.function(*packet.shader, &this->payloads[packet.payloadOffset]);
+    }
+#if PROFILER_ENABLED
+    Profiler::getProfiler().endGpuScope(passScope);
+#endif
+    statistics.packets += static_cast<unsigned int>(this->packets.size());
+
+    // The buffers keep their memory for the next frame
+    this->packets.clear();
+    this->payloads.clear();
+}
+
+
+unsigned long long RenderQueue::makeKey(RenderPass pass, GLuint shader, GLuint material, GLuint vertexArray, float depth)
+{
+    const unsigned long long depthMax = (1ull << RENDER_KEY_DEPTH_BITS) - 1;
+    unsigned long long quantizedDepth = static_cast<unsigned long long>(std::max(0.0f, std::min(depth / RENDER_QUEUE_DEPTH_RANGE, 1.0f)) * depthMax);
+    unsigned long long state = 0;
+
+    // Program, then textures, then vertex array
+    state = (state << RENDER_KEY_SHADER_BITS) | (shader & ((1u << RENDER_KEY_SHADER_BITS) - 1));
+    state = (state << RENDER_KEY_MATERIAL_BITS) | (material & ((1u << RENDER_KEY_MATERIAL_BITS) - 1));
+    state = (state << RENDER_KEY_VERTEX_ARRAY_BITS) | (vertexArray & ((1u << RENDER_KEY_VERTEX_ARRAY_BITS) - 1));
+
+    // Blended draws must be drawn back to front whatever their state, the other ones are grouped by state first
+    if(pass == TRANSPARENT_RENDER_PASS)
+    {
+        return (static_cast<unsigned long long>(pass) << (64 - RENDER_KEY_PASS_BITS)) | ((depthMax - quantizedDepth) << (64 - RENDER_KEY_PASS_BITS - RENDER_KEY_DEPTH_BITS)) | state;
+    }
+    return (static_cast<unsigned long long>(pass) << (64 - RENDER_KEY_PASS_BITS)) | (state << RENDER_KEY_DEPTH_BITS) | quantizedDepth;
+}
+
+
+void RenderQueue::resetStatistics()
+{
+    statistics.packets = 0;
+    statistics.passChanges = 0;
+    statistics.programChanges = 0;
+}
+
+
+void RenderQueue::printStatistics()
+{
+    std::cout << "Render queue : " << statistics.packets << " packets, " << statistics.passChanges << " pass changes, " << statistics.programChanges << " program changes" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+size_t RenderQueue::allocatePayload(size_t size)
+{
+    size_t offset = (this->payloads.size() + RENDER_QUEUE_PAYLOAD_ALIGNMENT - 1) / RENDER_QUEUE_PAYLOAD_ALIGNMENT * RENDER_QUEUE_PAYLOAD_ALIGNMENT;
+
+    this->payloads.resize(offset + size);
+
+    return offset;
+}
+
+
+void RenderQueue::sortPackets()
+{
+    const unsigned int bucketCount = 1u << RENDER_QUEUE_RADIX_BITS;
+    std::vector<size_t> counts(bucketCount);
+    size_t offset;
+    size_t count;
+    unsigned int digit;
+
+    this->sortedPackets.resize(this->packets.size());
+
+    for(unsigned int shift=0; shift<64; shift+=RENDER_QUEUE_RADIX_BITS)
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        for(size_t i=0; i<this->packets.size(); i++)
+        {
+            counts[(this->packets[i].key >> shift) & (bucketCount - 1)]++;
+        }
+
+        // All the keys have the same digit, the order does not change
+        digit = static_cast<unsigned int>(this->packets.empty() ? 0 : (this->packets[0].key >> shift) & (bucketCount - 1));
+        if(counts[digit] == this->packets.size())
+        {
+            continue;
+        }
+
+        offset = 0;
+        for(unsigned int i=0; i<bucketCount; i++)
+        {
+            count = counts[i];
+            counts[i] = offset;
+            offset += count;
+        }
+        for(size_t i=0; i<this->packets.size(); i++)
+        {
+            this->sortedPackets[counts[(this->packets[i].key >> shift) & (bucketCount - 1)]++] = this->packets[i];
+        }
+        this->packets.swap(this->sortedPackets);
+    }
+}
+
+
+void RenderQueue::setPassState(RenderPass pass)
+{
+    switch(pass)
+    {
+        case OPAQUE_RENDER_PASS :
+            RenderState::enable(GL_DEPTH_TEST);
+            RenderState::depthFunc(GL_LESS);
+            RenderState::disable(GL_BLEND);
+            break;
+        case SKY_RENDER_PASS :
+            // The skybox is drawn at the far plane, where the depth buffer was cleared
+            RenderState::enable(GL_DEPTH_TEST);
+            RenderState::depthFunc(GL_LEQUAL);
+            RenderState::disable(GL_BLEND);
+            break;
+        case TRANSPARENT_RENDER_PASS :
+            RenderState::enable(GL_DEPTH_TEST);
+            RenderState::depthFunc(GL_LESS);
+            RenderState::enable(GL_BLEND);
+            RenderState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+    }
+}
+
+
+const char* RenderQueue::getPassName(RenderPass pass)
+{
+    switch(pass)
+    {
+        case OPAQUE_RENDER_PASS :
+            return "Opaque pass";
+        case SKY_RENDER_PASS :
+            return "Sky pass";
+        case TRANSPARENT_RENDER_PASS :
+            return "Transparent pass";
+    }
+
+    return "Unknown pass";
+}
@@ -0,0 +1,208 @@
+#ifndef __RENDERQUEUE_H
+#define __RENDERQUEUE_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+// Shader
+#include "Shader.h"
+
+// Redundant state filtering
+#include "RenderState.h"
+
+// GPU time of the passes
+#include "Profiler.h"
+
+
+// Bits of the fields of a sort key, from the most significant one (64 bits in total)
+#define RENDER_KEY_PASS_BITS 2
+#define RENDER_KEY_SHADER_BITS 12
+#define RENDER_KEY_MATERIAL_BITS 16
+#define RENDER_KEY_VERTEX_ARRAY_BITS 10
+#define RENDER_KEY_DEPTH_BITS 24
+// Distance to the camera mapped on the depth bits of the keys (the far plane of the camera), farther draws share the last value
+#define RENDER_QUEUE_DEPTH_RANGE 100.0f
+// Bits of the keys sorted by each pass of the radix sort
+#define RENDER_QUEUE_RADIX_BITS 8
+// Alignment of the payloads in the arena of the frame
+#define RENDER_QUEUE_PAYLOAD_ALIGNMENT 16
+
+
+/**
+ * @brief The RenderPass enum list the passes of a frame, in the order they are drawn
+ */
+enum RenderPass
+{
+    /// Opaque draws, sorted by state then front to back for the early depth test
+    OPAQUE_RENDER_PASS,
+    /// Skybox, drawn at the far plane behind the opaque draws
+    SKY_RENDER_PASS,
+    /// Blended draws, sorted back to front
+    TRANSPARENT_RENDER_PASS
+};
+
+
+/**
+ * @brief RenderFunction draw a packet of the render queue, called with the program of the packet in use and the state of its pass set
+ * @param shader program of the packet
+ * @param payload copy of the payload given with the packet
+ */
+typedef void (*RenderFunction)(Shader& shader, const void* payload);
+
+
+/**
+ * @brief The RenderPacket struct is a draw waiting in the render queue
+ */
+struct RenderPacket
+{
+    /// Sort key (see RenderQueue::makeKey)
+    unsigned long long key;
+    /// Program of the draw
+    Shader* shader;
+    /// Function drawing the packet
+    RenderFunction function;
+    /// Offset of the payload in the arena of the frame
+    size_t payloadOffset;
+};
+
+
+/**
+ * @brief The RenderQueueStatistics struct count the packets drawn by the render queue since the last reset
+ */
+struct RenderQueueStatistics
+{
+    /// Number of packets drawn
+    unsigned int packets;
+    /// Number of times the state of a pass was set
+    unsigned int passChanges;
+    /// Number of times a program was put in use
+    unsigned int programChanges;
+};
+
+
+/**
+ * @brief The RenderQueue class collect the draws of a frame as packets with a 64-bit sort key and a payload copied in a per-frame arena.
+ *        The packets are radix sorted and drawn in the order of their keys, the state of a pass and the program only change on key transitions :
+ *        the opaque draws are grouped by program, material and vertex array then drawn front to back, the transparent ones are drawn back to front.
+ *        A queue is filled by one thread at a time, each worker thread has its own queue and they are appended to the one executed.
+ */
+class RenderQueue
+{
+// Attributes
+private:
+    /// Packets of the frame
+    std::vector<RenderPacket> packets;
+    /// Second buffer of the radix sort
+    std::vector<RenderPacket> sortedPackets;
+    /// Payloads of the packets, kept allocated from one frame to the next
+    std::vector<unsigned char> payloads;
+
+public:
+    /// Packets drawn since the last call to resetStatistics
+    static RenderQueueStatistics statistics;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief submit add a draw to the queue
+     * @param key sort key of the draw (see makeKey)
+     * @param shader program of the draw, which must stay valid until the queue is executed
+     * @param function function drawing the packet
+     * @param payload data of the draw, copied in the arena of the frame (it must be trivially copyable)
+     */
+    template<typename T>
+    void submit(unsigned long long key, Shader& shader, RenderFunction function, const T& payload)
+    {
+        // The payload is copied as bytes and read back by the function, it can not own memory or need a copy constructor
+        static_assert(std::is_trivially_copyable<T>::value, "the payload of a render packet must be trivially copyable");
+
+        RenderPacket packet;
+
+        packet.key = key;
+        packet.shader = &shader;
+        packet.function = function;
+        packet.payloadOffset = this->allocatePayload(sizeof(T));
+        std::memcpy(&this->payloads[packet.payloadOffset], &payload, sizeof(T));
+        this->packets.push_back(packet);
+    }
+
+
+    /**
+     * @brief append move the packets of another queue at the end of this one, with their payloads (the other queue is emptied).
+     *        Used to gather the queues filled by the worker threads preparing the frame.
+     * @param queue queue to empty in this one
+     */
+    void append(RenderQueue& queue);
+
+
+    /**
+     * @brief execute sort the packets and draw them, then empty the queue for the next frame
+     */
+    void execute();
+
+
+    /**
+     * @brief makeKey build the sort key of a draw
+     * @param pass pass of the draw
+     * @param shader id in OpenGL of the program
+     * @param material id of the textures of the draw
+     * @param vertexArray id of the vertex array (or vertex format) of the draw
+     * @param depth distance between the draw and the camera
+     */
+    static unsigned long long makeKey(RenderPass pass, GLuint shader, GLuint material, GLuint vertexArray, float depth);
+
+
+    /**
+     * @brief resetStatistics set the counters of the packets to 0
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the packets drawn since the last reset
+     */
+    static void printStatistics();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief allocatePayload reserve aligned bytes in the arena of the frame
+     * @return offset of the bytes in the arena
+     */
+    size_t allocatePayload(size_t size);
+
+
+    /**
+     * @brief sortPackets sort the packets by key with a least significant digit radix sort, the digits shared by all keys are skipped
+     */
+    void sortPackets();
+
+
+    /**
+     * @brief setPassState set the depth test and the blending of a pass
+     */
+    static void setPassState(RenderPass pass);
+
+
+    /**
+     * @brief getPassName return the name of a pass, used by its GPU profiling scope
+     */
+    static const char* getPassName(RenderPass pass);
+};
+
+
+#endif
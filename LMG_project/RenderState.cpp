@@ -0,0 +1,279 @@
+#include "RenderState.h"
+
+
+GLuint RenderState::program = RENDER_STATE_UNKNOWN;
+GLuint RenderState::vertexArray = RENDER_STATE_UNKNOWN;
+GLenum RenderState::activeUnit = RENDER_STATE_UNKNOWN;
+// No texture is bound to the units of a new context
+GLuint RenderState::textures2D[RENDER_STATE_TEXTURE_UNITS];
+GLuint RenderState::texturesCubeMap[RENDER_STATE_TEXTURE_UNITS];
+GLuint RenderState::arrayBuffer = RENDER_STATE_UNKNOWN;
+GLuint RenderState::uniformBuffer = RENDER_STATE_UNKNOWN;
+GLuint RenderState::drawIndirectBuffer = RENDER_STATE_UNKNOWN;
+GLuint RenderState::copyReadBuffer = RENDER_STATE_UNKNOWN;
+GLuint RenderState::copyWriteBuffer = RENDER_STATE_UNKNOWN;
+GLuint RenderState::blend = RENDER_STATE_UNKNOWN;
+GLuint RenderState::depthTest = RENDER_STATE_UNKNOWN;
+GLenum RenderState::blendSource = RENDER_STATE_UNKNOWN;
+GLenum RenderState::blendDestination = RENDER_STATE_UNKNOWN;
+GLenum RenderState::depthFunction = RENDER_STATE_UNKNOWN;
+RenderStateStatistics RenderState::statistics = { 0, 0 };
+
+
+// =======
+// Methods
+
+void RenderState::useProgram(GLuint program)
+{
+    if(setShadow(RenderState::program, program))
+    {
+        glUseProgram(program);
+        glCheckError();
+    }
+}
+
+
+bool RenderState::bindVertexArray(GLuint vertexArray)
+{
+    if(setShadow(RenderState::vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+        glCheckError();
+        return true;
+    }
+    return false;
+}
+
+
+void RenderState::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* shadow = getBufferShadow(target);
+
+    if(shadow == NULL)
+    {
+        glBindBuffer(target, buffer);
+        statistics.issuedCalls++;
+    }
+    else if(setShadow(*shadow, buffer))
+    {
+        glBindBuffer(target, buffer);
+    }
+    glCheckError();
+}
+
+
+void RenderState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    GLuint* shadow = getBufferShadow(target);
+
+    // The indexed binding points are not shadowed, the call is always sent
+    glBindBufferBase(target, index, buffer);
+    glCheckError();
+    statistics.issuedCalls++;
+    if(shadow != NULL)
+    {
+        *shadow = buffer;
+    }
+}
+
+
+void RenderState::activeTexture(GLenum unit)
+{
+    if(setShadow(activeUnit, unit))
+    {
+        glActiveTexture(unit);
+        glCheckError();
+    }
+}
+
+
+void RenderState::bindTexture(GLenum target, GLuint texture)
+{
+    GLuint* shadow = getTextureShadow(activeUnit, target);
+
+    if(shadow == NULL)
+    {
+        glBindTexture(target, texture);
+        statistics.issuedCalls++;
+    }
+    else if(setShadow(*shadow, texture))
+    {
+        glBindTexture(target, texture);
+    }
+    glCheckError();
+}
+
+
+void RenderState::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+    GLuint* shadow = getTextureShadow(unit, target);
+
+    // Nothing to select when the texture is already on the unit
+    if(shadow != NULL && *shadow == texture)
+    {
+        statistics.elidedCalls += 2;
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+
+void RenderState::enable(GLenum capability)
+{
+    GLuint* shadow = (capability == GL_BLEND) ? &blend : (capability == GL_DEPTH_TEST) ? &depthTest : NULL;
+
+    if(shadow == NULL)
+    {
+        glEnable(capability);
+        statistics.issuedCalls++;
+    }
+    else if(setShadow(*shadow, GL_TRUE))
+    {
+        glEnable(capability);
+    }
+    glCheckError();
+}
+
+
+void RenderState::disable(GLenum capability)
+{
+    GLuint* shadow = (capability == GL_BLEND) ? &blend : (capability == GL_DEPTH_TEST) ? &depthTest : NULL;
+
+    if(shadow == NULL)
+    {
+        glDisable(capability);
+        statistics.issuedCalls++;
+    }
+    else if(setShadow(*shadow, GL_FALSE))
+    {
+        glDisable(capability);
+    }
+    glCheckError();
+}
+
+
+void RenderState::blendFunc(GLenum source, GLenum destination)
+{
+    if(blendSource == source && blendDestination == destination)
+    {
+        statistics.elidedCalls++;
+        return;
+    }
+    blendSource = source;
+    blendDestination = destination;
+    glBlendFunc(source, destination);
+    glCheckError();
+    statistics.issuedCalls++;
+}
+
+
+void RenderState::depthFunc(GLenum function)
+{
+    if(setShadow(depthFunction, function))
+    {
+        glDepthFunc(function);
+        glCheckError();
+    }
+}
+
+
+void RenderState::deleteTextures(GLsizei count, const GLuint* textures)
+{
+    // OpenGL unbinds a deleted texture from all units
+    for(GLsizei i=0; i<count; i++)
+    {
+        for(unsigned int unit=0; unit<RENDER_STATE_TEXTURE_UNITS; unit++)
+        {
+            if(textures2D[unit] == textures[i])
+            {
+                textures2D[unit] = 0;
+            }
+            if(texturesCubeMap[unit] == textures[i])
+            {
+                texturesCubeMap[unit] = 0;
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+    glCheckError();
+}
+
+
+void RenderState::deleteBuffers(GLsizei count, const GLuint* buffers)
+{
+    GLuint* shadows[] = { &arrayBuffer, &uniformBuffer, &drawIndirectBuffer, &copyReadBuffer, &copyWriteBuffer };
+
+    // OpenGL unbinds a deleted buffer from the targets
+    for(GLsizei i=0; i<count; i++)
+    {
+        for(unsigned int j=0; j<sizeof(shadows) / sizeof(shadows[0]); j++)
+        {
+            if(*shadows[j] == buffers[i])
+            {
+                *shadows[j] = 0;
+            }
+        }
+    }
+    glDeleteBuffers(count, buffers);
+    glCheckError();
+}
+
+
+void RenderState::resetStatistics()
+{
+    statistics.issuedCalls = 0;
+    statistics.elidedCalls = 0;
+}
+
+
+void RenderState::printStatistics()
+{
+    std::cout << "Render state : " << statistics.issuedCalls << " calls issued, " << statistics.elidedCalls << " redundant calls elided" << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+bool RenderState::setShadow(GLuint& shadow, GLuint value)
+{
+    if(shadow == value)
+    {
+        statistics.elidedCalls++;
+        return false;
+    }
+    shadow = value;
+    statistics.issuedCalls++;
+    return true;
+}
+
+
+GLuint* RenderState::getBufferShadow(GLenum target)
+{
+    switch(target)
+    {
+        case GL_ARRAY_BUFFER:         return &arrayBuffer;
+        case GL_UNIFORM_BUFFER:       return &uniformBuffer;
+        case GL_DRAW_INDIRECT_BUFFER: return &drawIndirectBuffer;
+        case GL_COPY_READ_BUFFER:     return &copyReadBuffer;
+        case GL_COPY_WRITE_BUFFER:    return &copyWriteBuffer;
+        default:                      return NULL;
+    }
+}
+
+
+GLuint* RenderState::getTextureShadow(GLenum unit, GLenum target)
+{
+    if(unit < GL_TEXTURE0 || unit >= GL_TEXTURE0 + RENDER_STATE_TEXTURE_UNITS)
+    {
+        return NULL;
+    }
+
+    switch(target)
+    {
+        case GL_TEXTURE_2D:       return &textures2D[unit - GL_TEXTURE0];
+        case GL_TEXTURE_CUBE_MAP: return &texturesCubeMap[unit - GL_TEXTURE0];
+        default:                  return NULL;
+    }
+}
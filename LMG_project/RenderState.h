@@ -0,0 +1,202 @@
+#ifndef __RENDERSTATE_H
+#define __RENDERSTATE_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+
+
+// Number of texture units whose bindings are shadowed, the calls on the other units are always issued
+#define RENDER_STATE_TEXTURE_UNITS 32
+// Value of a shadowed state which is not known (never set since the context was created)
+#define RENDER_STATE_UNKNOWN 0xFFFFFFFFu
+
+
+/**
+ * @brief The RenderStateStatistics struct count the state changes asked to the render state since the last reset
+ */
+struct RenderStateStatistics
+{
+    /// Number of calls sent to OpenGL
+    unsigned int issuedCalls;
+    /// Number of calls dropped because OpenGL already had the state
+    unsigned int elidedCalls;
+};
+
+
+/**
+ * @brief The RenderState class shadow the OpenGL state set by the draws (program, vertex array, texture units, buffers, blending and depth test)
+ *        and drop the calls which would set a state OpenGL already has.
+ *        All the state changes of the renderer go through it : a call made directly to OpenGL leaves the shadow wrong.
+ */
+class RenderState
+{
+// Attributes
+private:
+    /// Program in use
+    static GLuint program;
+    /// Vertex array bound
+    static GLuint vertexArray;
+    /// Texture unit selected by glActiveTexture (GL_TEXTURE0 + i)
+    static GLenum activeUnit;
+    /// 2D texture and cube map bound to each texture unit
+    static GLuint textures2D[RENDER_STATE_TEXTURE_UNITS];
+    static GLuint texturesCubeMap[RENDER_STATE_TEXTURE_UNITS];
+    /// Buffers bound to the targets which are not part of the vertex array state
+    static GLuint arrayBuffer;
+    static GLuint uniformBuffer;
+    static GLuint drawIndirectBuffer;
+    static GLuint copyReadBuffer;
+    static GLuint copyWriteBuffer;
+    /// GL_BLEND and GL_DEPTH_TEST (GL_TRUE, GL_FALSE or RENDER_STATE_UNKNOWN)
+    static GLuint blend;
+    static GLuint depthTest;
+    /// Factors of glBlendFunc
+    static GLenum blendSource;
+    static GLenum blendDestination;
+    /// Comparison of glDepthFunc
+    static GLenum depthFunction;
+
+public:
+    /// State changes since the last call to resetStatistics
+    static RenderStateStatistics statistics;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief useProgram use a program for the next draws (glUseProgram)
+     * @param program id in OpenGL of the program, 0 for none
+     */
+    static void useProgram(GLuint program);
+
+
+    /**
+     * @brief bindVertexArray bind a vertex array for the next draws (glBindVertexArray)
+     * @param vertexArray id in OpenGL of the vertex array, 0 for none
+     * @return true if the call was sent to OpenGL
+     */
+    static bool bindVertexArray(GLuint vertexArray);
+
+
+    /**
+     * @brief bindBuffer bind a buffer to a target (glBindBuffer). GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state and is never dropped
+     * @param target GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+     * @param buffer id in OpenGL of the buffer, 0 for none
+     */
+    static void bindBuffer(GLenum target, GLuint buffer);
+
+
+    /**
+     * @brief bindBufferBase bind a buffer to an indexed binding point (glBindBufferBase), which also binds it to the target
+     * @param target GL_UNIFORM_BUFFER
+     * @param index binding point
+     * @param buffer id in OpenGL of the buffer
+     */
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+
+    /**
+     * @brief activeTexture select the texture unit of the next bindTexture (glActiveTexture)
+     * @param unit GL_TEXTURE0 + i
+     */
+    static void activeTexture(GLenum unit);
+
+
+    /**
+     * @brief bindTexture bind a texture to the selected texture unit (glBindTexture)
+     * @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+     * @param texture id in OpenGL of the texture, 0 for none
+     */
+    static void bindTexture(GLenum target, GLuint texture);
+
+
+    /**
+     * @brief bindTexture bind a texture to a texture unit, the unit is only selected if the texture is not already bound to it
+     * @param unit GL_TEXTURE0 + i
+     * @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+     * @param texture id in OpenGL of the texture, 0 for none
+     */
+    static void bindTexture(GLenum unit, GLenum target, GLuint texture);
+
+
+    /**
+     * @brief enable enable a capability (glEnable)
+     * @param capability GL_BLEND or GL_DEPTH_TEST, the others are never dropped
+     */
+    static void enable(GLenum capability);
+
+
+    /**
+     * @brief disable disable a capability (glDisable)
+     * @param capability GL_BLEND or GL_DEPTH_TEST, the others are never dropped
+     */
+    static void disable(GLenum capability);
+
+
+    /**
+     * @brief blendFunc set the factors of the blending (glBlendFunc)
+     */
+    static void blendFunc(GLenum source, GLenum destination);
+
+
+    /**
+     * @brief depthFunc set the comparison of the depth test (glDepthFunc)
+     */
+    static void depthFunc(GLenum function);
+
+
+    /**
+     * @brief deleteTextures delete textures (glDeleteTextures) and unbind them from the shadowed units
+     */
+    static void deleteTextures(GLsizei count, const GLuint* textures);
+
+
+    /**
+     * @brief deleteBuffers delete buffers (glDeleteBuffers) and unbind them from the shadowed targets
+     */
+    static void deleteBuffers(GLsizei count, const GLuint* buffers);
+
+
+    /**
+     * @brief resetStatistics set the counters of the state changes to 0
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the state changes since the last reset
+     */
+    static void printStatistics();
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief setShadow update a shadowed value
+     * @return true if the value changed, false if the call can be dropped
+     */
+    static bool setShadow(GLuint& shadow, GLuint value);
+
+
+    /**
+     * @brief getBufferShadow return the shadowed binding of a buffer target, NULL if the target is not shadowed
+     */
+    static GLuint* getBufferShadow(GLenum target);
+
+
+    /**
+     * @brief getTextureShadow return the shadowed binding of a texture target on a unit, NULL if it is not shadowed
+     */
+    static GLuint* getTextureShadow(GLenum unit, GLenum target);
+};
+
+
+#endif
@@ -0,0 +1,147 @@
+#include "ScenePicker.h"
+
+
+// =======
+// Methods
+
+void ScenePicker::build(const std::vector<Model3D*>& models)
+{
+    std::vector<BVHBounds> bounds(models.size());
+
+    this->models = models;
+    this->inverseWorldMatrices.resize(models.size());
+
+    for(unsigned int i=0; i<models.size(); i++)
+    {
+        glm::mat4 worldMatrix = Model3D::viewParameters.sceneMatrix * models[i]->getLocalTransformationMatrix();
+        glm::vec3 center = (models[i]->boundingBoxMin + models[i]->boundingBoxMax) * 0.5f;
+        glm::vec3 extent = (models[i]->boundingBoxMax - models[i]->boundingBoxMin) * 0.5f;
+        glm::vec3 worldExtent(0.0f);
+
+        // Box enclosing the transformed box of the model
+        for(int j=0; j<3; j++)
+        {
+            worldExtent[j] = std::fabs(worldMatrix[0][j]) * extent.x + std::fabs(worldMatrix[1][j]) * extent.y + std::fabs(worldMatrix[2][j]) * extent.z;
+        }
+        center = glm::vec3(worldMatrix * glm::vec4(center, 1.0f));
+        bounds[i].min = center - worldExtent;
+        bounds[i].max = center + worldExtent;
+
+        this->inverseWorldMatrices[i] = glm::inverse(worldMatrix);
+    }
+
+    this->bvh.build(bounds);
+}
+
+
+bool ScenePicker::intersect(const Ray& ray, RayHit& hit) const
+{
+    const std::vector<unsigned int>& order = this->bvh.getPrimitiveIndices();
+    float tMax = ray.tMax;
+
+    hit.t = std::numeric_limits<float>::infinity();
+    hit.u = 0.0f;
+    hit.v = 0.0f;
+    hit.instance = -1;
+    hit.mesh = 0;
+    hit.triangle = 0;
+
+    auto intersectLeaf = [&](unsigned int first, unsigned int count, float& leafTMax)
+    {
+        bool leafHit = false;
+
+        for(unsigned int i=first; i<first+count; i++)
+        {
+            unsigned int instance = order[i];
+            Ray modelRay;
+
+            // The direction is not normalized, so distances are the same in both spaces
+            modelRay.origin = glm::vec3(this->inverseWorldMatrices[instance] * glm::vec4(ray.origin, 1.0f));
+            modelRay.direction = glm::vec3(this->inverseWorldMatrices[instance] * glm::vec4(ray.direction, 0.0f));
+            modelRay.tMax = leafTMax;
+
+            if(this->models[instance]->intersect(modelRay, hit))
+            {
+                leafTMax = hit.t;
+                hit.instance = static_cast<int>(instance);
+                leafHit = true;
+            }
+        }
+
+        return leafHit;
+    };
+
+    return this->bvh.traverse(ray, tMax, intersectLeaf);
+}
+
+
+void ScenePicker::intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const
+{
+    hits.resize(rays.size());
+
+    // The rays are shared by the workers in ranges of at least RAY_BATCH_SIZE rays
+    JobSystem::getJobSystem().parallelForRange(static_cast<unsigned int>(rays.size()), RAY_BATCH_SIZE, [&](unsigned int first, unsigned int last)
+    {
+        for(unsigned int i=first; i<last; i++)
+        {
+            this->intersect(rays[i], hits[i]);
+        }
+    });
+}
+
+
+Model3D* ScenePicker::getModel(int instance) const
+{
+    if(instance < 0 || static_cast<size_t>(instance) >= this->models.size())
+    {
+        return NULL;
+    }
+
+    return this->models[instance];
+}
+
+
+Ray ScenePicker::computeCameraRay(int x, int y, int width, int height, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+    glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    glm::vec2 ndc(2.0f * (static_cast<float>(x) + 0.5f) / width - 1.0f, 1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / height);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+    Ray ray;
+
+    ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+    ray.direction = glm::vec3(farPoint) / farPoint.w - ray.origin;
+    ray.tMax = 1.0f;
+
+    return ray;
+}
+
+
+void ScenePicker::benchmark(int width, int height, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const
+{
+    std::vector<Ray> rays;
+    std::vector<RayHit> hits;
+    size_t hitCount = 0;
+
+    // One ray per pixel
+    rays.reserve(static_cast<size_t>(width) * height);
+    for(int y=0; y<height; y++)
+    {
+        for(int x=0; x<width; x++)
+        {
+            rays.push_back(computeCameraRay(x, y, width, height, viewMatrix, projectionMatrix));
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    this->intersect(rays, hits);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    for(size_t i=0; i<hits.size(); i++)
+    {
+        hitCount += (hits[i].instance >= 0) ? 1 : 0;
+    }
+
+    std::cout << "Ray benchmark : " << rays.size() << " rays (" << hitCount << " hits) in " << seconds * 1000.0 << " ms, "
+              << rays.size() / std::max(seconds, 1e-9) / 1e6 << " Mrays/s" << std::endl;
+}
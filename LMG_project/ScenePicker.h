@@ -0,0 +1,100 @@
+#ifndef __SCENEPICKER_H
+#define __SCENEPICKER_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+// Model
+#include "Model3D.h"
+
+// Bounding volume hierarchy
+#include "BVH.h"
+
+// Jobs
+#include "JobSystem.h"
+
+
+// Smallest number of rays given to a worker by the batched intersection
+#define RAY_BATCH_SIZE 256
+
+
+/**
+ * @brief The ScenePicker class is the top level hierarchy over the models of the scene.
+ *        Rays are transformed in the space of each model they reach and tested against the triangle tree of the model.
+ */
+class ScenePicker
+{
+// Attributes
+private:
+    /// Models of the scene
+    std::vector<Model3D*> models;
+    /// Matrix from world space to the space of each model
+    std::vector<glm::mat4> inverseWorldMatrices;
+    /// Tree over the world space bounds of the models
+    BVH bvh;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief build build the top level tree with the current transformation of the given models (cheap, can be called before each query)
+     * @param models models of the scene
+     */
+    void build(const std::vector<Model3D*>& models);
+
+
+    /**
+     * @brief intersect find the closest triangle of the scene hit by a ray
+     * @param ray ray in world space
+     * @param hit filled with the closest hit, hit.instance is the index of the model in the list given to build (-1 when nothing was hit)
+     * @return true when something was hit
+     */
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+
+    /**
+     * @brief intersect find the closest hit of each ray, the rays are shared by the workers of the job system
+     * @param rays rays in world space
+     * @param hits filled with the closest hit of each ray
+     */
+    void intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const;
+
+
+    /**
+     * @brief getModel return the model of a hit
+     * @param instance hit.instance of a hit
+     */
+    Model3D* getModel(int instance) const;
+
+
+    /**
+     * @brief computeCameraRay compute the world space ray going through a pixel of the screen
+     * @param x horizontal position of the pixel (from the left)
+     * @param y vertical position of the pixel (from the top)
+     * @param width width of the screen
+     * @param height height of the screen
+     * @param viewMatrix view matrix of the camera
+     * @param projectionMatrix projection matrix of the camera
+     * @return the ray from the near plane to the far plane (tMax = 1 reaches the far plane)
+     */
+    static Ray computeCameraRay(int x, int y, int width, int height, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+
+
+    /**
+     * @brief benchmark trace one ray per pixel of the screen with the batched intersection and print the rays per second
+     * @param width width of the screen
+     * @param height height of the screen
+     * @param viewMatrix view matrix of the camera
+     * @param projectionMatrix projection matrix of the camera
+     */
+    void benchmark(int width, int height, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const;
+};
+
+
+#endif
@@ -1,7 +1,11 @@
 #include "Shader.h"
 
 
-Shader::Shader(const std::string VertexShaderFilePath, const std::string FragmentShaderFilePath){
+ShaderStatistics Shader::statistics = { 0, 0, 0 };
+bool Shader::compilerThreadsSet = false;
+
+
+Shader::Shader(const std::string VertexShaderFilePath, const std::string FragmentShaderFilePath, const std::string& defines){
 
     std::string vertexCode;
     std::string fragmentCode;
@@ -36,15 +40,240 @@ Shader::Shader(const std::string VertexShaderFilePath, const std::string Fragmen
     // convert stream to std::string
     vertexCode   = vertexShaderStream.str();
     fragmentCode = fragmentShaderStream.str();
+    // add the features of the variant
+    vertexCode   = addDefines(vertexCode, defines);
+    fragmentCode = addDefines(fragmentCode, defines);
+
+    // The table of the uniforms and the build are shared with the copies made before the program is ready
+    this->uniforms = std::make_shared< std::vector<ShaderUniform> >();
+    this->build = std::make_shared<ShaderBuild>();
+    this->build->pending = true;
+    this->build->vertexShader = 0;
+    this->build->fragmentShader = 0;
+    this->build->name = VertexShaderFilePath + ", " + FragmentShaderFilePath + (defines.empty() ? "" : " (variant)");
+    this->build->start = std::chrono::high_resolution_clock::now();
+
+    // Linked program from the binary cache, or submitted to the compiler (its status is checked when it is first needed)
+    std::vector<std::string> sources;
+    sources.push_back(vertexCode);
+    sources.push_back(fragmentCode);
+    this->build->cachePath = ProgramCache::getPath(VertexShaderFilePath, FragmentShaderFilePath, defines);
+    this->build->cacheKey = ProgramCache::getKey(sources, defines);
+    GLuint program = 0;
+    if(ProgramCache::load(this->build->cachePath, this->build->cacheKey, &program))
+    {
+        _shaderId = static_cast<GLint>(program);
+        std::cout << "Shader program loaded from its binary in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - this->build->start).count() << " ms : " << this->build->cachePath << std::endl;
+    }
+    else
+    {
+        this->submitProgram(vertexCode, fragmentCode);
+    }
+}
+
+
+bool Shader::isReady() const
+{
+    GLint completionStatus = GL_TRUE;
+
+    if(!this->build || !this->build->pending || this->build->vertexShader == 0)
+    {
+        return true;
+    }
+
+    // Without the extension, asking for the status waits for the compiler
+    if(!GLEW_KHR_parallel_shader_compile)
+    {
+        return false;
+    }
+    glGetProgramiv(_shaderId, GL_COMPLETION_STATUS_KHR, &completionStatus);
+
+    return completionStatus == GL_TRUE;
+}
+
+
+void Shader::finish() const
+{
+    if(!this->build || !this->build->pending)
+    {
+        return;
+    }
+    this->build->pending = false;
+
+    // Compiled programs : check the status (waiting for the compiler if needed) and keep the binary
+    if(this->build->vertexShader != 0)
+    {
+        if(this->checkProgram())
+        {
+            ProgramCache::save(this->build->cachePath, this->build->cacheKey, static_cast<GLuint>(_shaderId));
+        }
+        std::cout << "Shader program compiled and linked "
+                  << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - this->build->start).count() << " ms after its submission : " << this->build->name << std::endl;
+    }
+
+    // Locations of the uniforms, retrieved once, and binding points of the uniform blocks
+    this->reflectUniforms();
+    UniformBuffer::bindBlocks(_shaderId);
+}
+
+
+GLint Shader::getUniform(const ShaderUniformName& name) const
+{
+    std::vector<ShaderUniform>::const_iterator uniform;
+
+    this->finish();
+    if(!this->uniforms)
+    {
+        return SHADER_INVALID_UNIFORM;
+    }
+
+    // Uniforms are sorted by hash, names are only compared to tell apart the hash collisions
+    uniform = std::lower_bound(this->uniforms->begin(), this->uniforms->end(), name.hash, [](const ShaderUniform& current, unsigned int hash) { return current.hash < hash; });
+    for(; uniform != this->uniforms->end() && uniform->hash == name.hash; uniform++)
+    {
+        if(uniform->name == name.name)
+        {
+            return static_cast<GLint>(uniform - this->uniforms->begin());
+        }
+    }
+
+    return SHADER_INVALID_UNIFORM;
+}
+
+
+const std::vector<ShaderUniform>& Shader::getUniforms() const
+{
+    static const std::vector<ShaderUniform> noUniforms;
+
+    this->finish();
+    return this->uniforms ? *this->uniforms : noUniforms;
+}
+
+
+void Shader::resetStatistics()
+{
+    statistics.uploads = 0;
+    statistics.skippedUploads = 0;
+    statistics.locationQueries = 0;
+}
+
+
+void Shader::printStatistics()
+{
+    std::cout << "Shader uniforms : " << statistics.uploads << " uploads, " << statistics.skippedUploads << " redundant uploads skipped, "
+              << statistics.locationQueries << " location queries" << std::endl;
+}
+
+
+void Shader::setBool(GLint uniform, bool value) const
+{
+    int integer = value ? 1 : 0;
+    if(this->updateValue(uniform, &integer, sizeof(integer)))
+        glUniform1i((*this->uniforms)[uniform].location, integer);
+}
+// ------------------------------------------------------------------------
+void Shader::setInt(GLint uniform, int value) const
+{
+    if(this->updateValue(uniform, &value, sizeof(value)))
+        glUniform1i((*this->uniforms)[uniform].location, value);
+}
+// ------------------------------------------------------------------------
+void Shader::setFloat(GLint uniform, float value) const
+{
+    if(this->updateValue(uniform, &value, sizeof(value)))
+        glUniform1f((*this->uniforms)[uniform].location, value);
+}
+// ------------------------------------------------------------------------
+void Shader::setVec2(GLint uniform, const glm::vec2 &value) const
+{
+    if(this->updateValue(uniform, &value[0], sizeof(value)))
+        glUniform2fv((*this->uniforms)[uniform].location, 1, &value[0]);
+}
+// ------------------------------------------------------------------------
+void Shader::setVec3(GLint uniform, const glm::vec3 &value) const
+{
+    if(this->updateValue(uniform, &value[0], sizeof(value)))
+        glUniform3fv((*this->uniforms)[uniform].location, 1, &value[0]);
+}
+// ------------------------------------------------------------------------
+void Shader::setVec4(GLint uniform, const glm::vec4 &value) const
+{
+    if(this->updateValue(uniform, &value[0], sizeof(value)))
+        glUniform4fv((*this->uniforms)[uniform].location, 1, &value[0]);
+}
+// ------------------------------------------------------------------------
+void Shader::setMat2(GLint uniform, const glm::mat2 &mat) const
+{
+    if(this->updateValue(uniform, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix2fv((*this->uniforms)[uniform].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+// ------------------------------------------------------------------------
+void Shader::setMat3(GLint uniform, const glm::mat3 &mat) const
+{
+    if(this->updateValue(uniform, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix3fv((*this->uniforms)[uniform].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+// ------------------------------------------------------------------------
+void Shader::setMat4(GLint uniform, const glm::mat4 &mat) const
+{
+    if(this->updateValue(uniform, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix4fv((*this->uniforms)[uniform].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
 
+
+std::string Shader::addDefines(const std::string& code, const std::string& defines)
+{
+    size_t version = 0;
+    size_t lineEnd;
+
+    if(defines.empty())
+    {
+        return code;
+    }
+
+    // The #version line must stay the first one
+    if(code.compare(0, 8, "#version") != 0)
+    {
+        version = code.find("\n#version");
+        if(version == std::string::npos)
+        {
+            return defines + code;
+        }
+        version++;
+    }
+
+    lineEnd = code.find('\n', version);
+    // followed by the #extension lines, which some compilers want before anything else
+    while(lineEnd != std::string::npos && code.compare(lineEnd + 1, 10, "#extension") == 0)
+    {
+        lineEnd = code.find('\n', lineEnd + 1);
+    }
+    if(lineEnd == std::string::npos)
+    {
+        return code + "\n" + defines;
+    }
+
+    return code.substr(0, lineEnd + 1) + defines + code.substr(lineEnd + 1);
+}
+
+
+void Shader::submitProgram(const std::string& vertexCode, const std::string& fragmentCode)
+{
     // Get shaders source code
     const char* vertexShaderCode = vertexCode.c_str();
     const char* fragmentShaderCode = fragmentCode.c_str();
 
+    // The driver may compile on several threads, the first program sets their number
+    if(!compilerThreadsSet && GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(SHADER_COMPILER_THREADS);
+        compilerThreadsSet = true;
+    }
 
     // Shaders creation
     GLuint vertexShader, fragmentShader;
-    std::cout << "Creation of shaders..." << std::endl;
+    std::cout << "Submission of shaders..." << std::endl;
 
         //Vertex shader
     vertexShader = glCreateShader(GL_VERTEX_SHADER);
@@ -55,6 +284,27 @@ Shader::Shader(const std::string VertexShaderFilePath, const std::string Fragmen
     glShaderSource( fragmentShader, 1, &fragmentShaderCode, nullptr );
     glCompileShader(fragmentShader);
 
+    // Shader program creation
+    _shaderId = glCreateProgram();
+        // Linking shaders to the program
+    glAttachShader(_shaderId, vertexShader);
+    glAttachShader(_shaderId, fragmentShader);
+
+    // Binary kept for the program cache
+    ProgramCache::prepare(static_cast<GLuint>(_shaderId));
+    // Linking does not wait for the compilation, errors are checked by checkProgram
+    glLinkProgram(_shaderId);
+
+    this->build->vertexShader = vertexShader;
+    this->build->fragmentShader = fragmentShader;
+}
+
+
+bool Shader::checkProgram() const
+{
+    GLuint vertexShader = this->build->vertexShader;
+    GLuint fragmentShader = this->build->fragmentShader;
+
         // Error check
     GLint compileStatus;
     glGetShaderiv( vertexShader, GL_COMPILE_STATUS, &compileStatus );
@@ -85,14 +335,6 @@ Shader::Shader(const std::string VertexShaderFilePath, const std::string Fragmen
         }
     }
 
-    // Shader program creation
-    _shaderId = glCreateProgram();
-        // Linking shaders to the program
-    glAttachShader(_shaderId, vertexShader);
-    glAttachShader(_shaderId, fragmentShader);
-
-    glLinkProgram(_shaderId);
-
     // Check for linking errors
     GLint linkStatus = 0;
     glGetProgramiv( _shaderId, GL_LINK_STATUS, &linkStatus );
@@ -115,6 +357,71 @@ Shader::Shader(const std::string VertexShaderFilePath, const std::string Fragmen
     // Shaders linked to the program -> deleting them
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
-    std::cout << "Shaders created and linked" << std::endl;
+    this->build->vertexShader = 0;
+    this->build->fragmentShader = 0;
+
+    return linkStatus != GL_FALSE;
+}
+
+
+void Shader::reflectUniforms() const
+{
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    GLint arraySize = 0;
+    std::vector<GLchar> name;
+    ShaderUniform uniform;
+    size_t arrayBracket;
+
+    this->uniforms->clear();
+
+    glGetProgramiv(_shaderId, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(_shaderId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    name.resize(std::max(maxNameLength, 1));
+    for(GLint i=0; i<uniformCount; i++)
+    {
+        glGetActiveUniform(_shaderId, i, static_cast<GLsizei>(name.size()), NULL, &arraySize, &uniform.type, name.data());
+        uniform.name = name.data();
+        uniform.location = glGetUniformLocation(_shaderId, uniform.name.c_str());
+        statistics.locationQueries++;
+
+        // Uniforms of blocks have no location
+        if(uniform.location < 0)
+        {
+            continue;
+        }
+
+        // Arrays are reported as their first element, they are set by their name
+        arrayBracket = uniform.name.find('[');
+        if(arrayBracket != std::string::npos)
+        {
+            uniform.name.erase(arrayBracket);
+        }
+        uniform.hash = ShaderUniformName(uniform.name).hash;
+        uniform.hasValue = false;
+        this->uniforms->push_back(uniform);
+    }
+
+    std::sort(this->uniforms->begin(), this->uniforms->end(), [](const ShaderUniform& first, const ShaderUniform& second) { return first.hash < second.hash; });
+}
+
+
+bool Shader::updateValue(GLint uniform, const void* value, size_t size) const
+{
+    if(uniform < 0 || !this->uniforms || uniform >= static_cast<GLint>(this->uniforms->size()))
+    {
+        return false;
+    }
+
+    ShaderUniform& current = (*this->uniforms)[uniform];
+    if(current.hasValue && std::memcmp(current.value, value, size) == 0)
+    {
+        statistics.skippedUploads++;
+        return false;
+    }
+    std::memcpy(current.value, value, size);
+    current.hasValue = true;
+    statistics.uploads++;
 
+    return true;
 }
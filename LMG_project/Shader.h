@@ -13,6 +13,10 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
 
 // System
 #include <cstdio>
@@ -37,112 +41,235 @@
 // SOIL
 #include <SOIL/SOIL.h>
 
+// Redundant state filtering
+#include "RenderState.h"
+
+// Uniform blocks shared by the programs
+#include "UniformBuffer.h"
+
+// Program binaries
+#include "ProgramCache.h"
+
+
+// Handle of a uniform which is not used by the program
+#define SHADER_INVALID_UNIFORM (-1)
+// Number of threads the driver may use to compile the shaders (KHR_parallel_shader_compile, 0xFFFFFFFF lets the driver choose)
+#define SHADER_COMPILER_THREADS 0xFFFFFFFFu
+
+
+/**
+ * @brief The ShaderUniform struct is an active uniform of a program, found by reflection at link time
+ */
+struct ShaderUniform
+{
+    /// Name of the uniform (without "[0]" for arrays)
+    std::string name;
+    /// Hash of the name (ShaderUniformName::hash)
+    unsigned int hash;
+    /// Location of the uniform in the program
+    GLint location;
+    /// Type of the uniform (GL_FLOAT_MAT4, GL_SAMPLER_2D, ...)
+    GLenum type;
+    /// Last value uploaded, used to skip the uploads which would not change it
+    float value[16];
+    /// False until a value is uploaded
+    bool hasValue;
+};
+
+
+/**
+ * @brief The ShaderUniformName struct is the name of a uniform with its hash, computed at compile time for string literals
+ */
+struct ShaderUniformName
+{
+    /// Name of the uniform
+    const char* name;
+    /// FNV-1a hash of the name
+    unsigned int hash;
+
+    constexpr ShaderUniformName(const char* name) : name(name), hash(hashName(name, 2166136261u)) {}
+    ShaderUniformName(const std::string& name) : name(name.c_str()), hash(hashName(name.c_str(), 2166136261u)) {}
+
+    /**
+     * @brief hashName FNV-1a hash of a string
+     */
+    static constexpr unsigned int hashName(const char* name, unsigned int hash)
+    {
+        return (*name == 0) ? hash : hashName(name + 1, (hash ^ static_cast<unsigned char>(*name)) * 16777619u);
+    }
+};
+
+
+/**
+ * @brief The ShaderStatistics struct count the uniform uploads of all the shaders since the last reset
+ */
+struct ShaderStatistics
+{
+    /// Number of values uploaded
+    unsigned int uploads;
+    /// Number of values equal to the last uploaded one, not uploaded again
+    unsigned int skippedUploads;
+    /// Number of calls to glGetUniformLocation
+    unsigned int locationQueries;
+};
+
+
+/**
+ * @brief The ShaderBuild struct follow the build of a program, from its submission to the compiler to its first use
+ */
+struct ShaderBuild
+{
+    /// True until the status of the program is checked and its uniforms are reflected
+    bool pending;
+    /// Shaders submitted to the compiler, 0 when the program was loaded from its binary or is checked
+    GLuint vertexShader;
+    GLuint fragmentShader;
+    /// Binary file of the program and its key
+    std::string cachePath;
+    unsigned long long cacheKey;
+    /// Shader files, for the logs
+    std::string name;
+    /// Time of the submission
+    std::chrono::high_resolution_clock::time_point start;
+};
+
 
 class Shader{
 
 public:
     GLint _shaderId;
 
+    /// Uploads of all the shaders since the last reset
+    static ShaderStatistics statistics;
+
+private:
+    /// Active uniforms of the program sorted by hash, shared by the copies of the shader (they use the same program)
+    std::shared_ptr< std::vector<ShaderUniform> > uniforms;
+    /// Build of the program, shared by the copies of the shader
+    std::shared_ptr<ShaderBuild> build;
+
+    /// True once the number of compiler threads is given to the driver
+    static bool compilerThreadsSet;
+
+public:
     // Constructors
-    Shader(){}
+    Shader() : _shaderId(0) {}
 
     /**
      * @brief Shader                    Constructor of the Shader object : open & read shader files / input variables management / binding to program / etc
+     *                                  The program is only submitted to the compiler : other programs and assets can be loaded while it is compiled,
+     *                                  it is checked when it is first used (see finish)
      * @param VertexShaderFilePath      Path to the vertex shader text file
      * @param FragmentShaderFilePath    Path to the fragment shader text file
+     * @param defines                   #define lines added to both sources after their #version line (see ShaderVariants)
      *
      */
-    Shader(const std::string VertexShaderFilePath, const std::string FragmentShaderFilePath);
+    Shader(const std::string VertexShaderFilePath, const std::string FragmentShaderFilePath, const std::string& defines = std::string());
 
 
     // Other Functions
     /**
-     * @brief use   Activate the current shader
+     * @brief use   Activate the current shader, checked by finish the first time
+     *              (which waits for the compiler unless isReady is true, see ShaderVariants::getReady)
      */
     void use(){
-        glUseProgram(_shaderId);
-    }
-        // Setters
-    void setBool(const std::string &name, bool value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform1i(uniformLocation, (int)value);
+        finish();
+        RenderState::useProgram(_shaderId);
     }
+
+    /**
+     * @brief isReady   Return true when the program can be used without waiting for the compiler
+     *                  (always false while it compiles when the driver does not have KHR_parallel_shader_compile)
+     */
+    bool isReady() const;
+
+    /**
+     * @brief finish    Wait for the compilation of the program, check it and reflect its uniforms (done once, by the first use)
+     */
+    void finish() const;
+
+    /**
+     * @brief getUniform    Return the handle of a uniform (SHADER_INVALID_UNIFORM when the program does not use it),
+     *                      to keep and give to the setters instead of the name
+     */
+    GLint getUniform(const ShaderUniformName& name) const;
+
+    /**
+     * @brief getUniforms   Return the active uniforms of the program, the handle of a uniform is its index
+     */
+    const std::vector<ShaderUniform>& getUniforms() const;
+
+    /**
+     * @brief resetStatistics   Reset the upload counters (called at the beginning of each frame)
+     */
+    static void resetStatistics();
+
+    /**
+     * @brief printStatistics   Print the uniform uploads since the last reset
+     */
+    static void printStatistics();
+
+        // Setters (by handle, or by name : the name is found in the uniforms of the program without asking OpenGL).
+        // The values are uploaded to the program in use, and skipped when they are equal to the last value of the uniform.
+    void setBool(GLint uniform, bool value) const;
+    void setBool(const ShaderUniformName& name, bool value) const { setBool(getUniform(name), value); }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform1i(uniformLocation, value);
-    }
+    void setInt(GLint uniform, int value) const;
+    void setInt(const ShaderUniformName& name, int value) const { setInt(getUniform(name), value); }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform1f(uniformLocation, value);
-    }
+    void setFloat(GLint uniform, float value) const;
+    void setFloat(const ShaderUniformName& name, float value) const { setFloat(getUniform(name), value); }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform2fv(uniformLocation, 1, &value[0]);
-    }
-    void setVec2(const std::string &name, float x, float y) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform2f(uniformLocation, x, y);
-    }
+    void setVec2(GLint uniform, const glm::vec2 &value) const;
+    void setVec2(const ShaderUniformName& name, const glm::vec2 &value) const { setVec2(getUniform(name), value); }
+    void setVec2(const ShaderUniformName& name, float x, float y) const { setVec2(getUniform(name), glm::vec2(x, y)); }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform3fv(uniformLocation, 1, &value[0]);
-    }
-    void setVec3(const std::string &name, float x, float y, float z) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform3f(uniformLocation, x, y, z);
-    }
+    void setVec3(GLint uniform, const glm::vec3 &value) const;
+    void setVec3(const ShaderUniformName& name, const glm::vec3 &value) const { setVec3(getUniform(name), value); }
+    void setVec3(const ShaderUniformName& name, float x, float y, float z) const { setVec3(getUniform(name), glm::vec3(x, y, z)); }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform4fv(uniformLocation, 1, &value[0]);
-    }
-    void setVec4(const std::string &name, float x, float y, float z, float w)
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniform4f(uniformLocation, x, y, z, w);
-    }
+    void setVec4(GLint uniform, const glm::vec4 &value) const;
+    void setVec4(const ShaderUniformName& name, const glm::vec4 &value) const { setVec4(getUniform(name), value); }
+    void setVec4(const ShaderUniformName& name, float x, float y, float z, float w) const { setVec4(getUniform(name), glm::vec4(x, y, z, w)); }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniformMatrix2fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(mat));
-    }
+    void setMat2(GLint uniform, const glm::mat2 &mat) const;
+    void setMat2(const ShaderUniformName& name, const glm::mat2 &mat) const { setMat2(getUniform(name), mat); }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(mat));
-    }
+    void setMat3(GLint uniform, const glm::mat3 &mat) const;
+    void setMat3(const ShaderUniformName& name, const glm::mat3 &mat) const { setMat3(getUniform(name), mat); }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
-    {
-        GLint uniformLocation = glGetUniformLocation(_shaderId, name.c_str());
-        if(uniformLocation >= 0)
-            glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(mat));
-    }
+    void setMat4(GLint uniform, const glm::mat4 &mat) const;
+    void setMat4(const ShaderUniformName& name, const glm::mat4 &mat) const { setMat4(getUniform(name), mat); }
+
+private:
+    /**
+     * @brief addDefines                Return a source with #define lines inserted after its #version line
+     */
+    static std::string addDefines(const std::string& code, const std::string& defines);
+
+    /**
+     * @brief submitProgram             Compile the shaders and link them into a new program, without waiting for the compiler
+     * @param vertexCode                Source of the vertex shader
+     * @param fragmentCode              Source of the fragment shader
+     */
+    void submitProgram(const std::string& vertexCode, const std::string& fragmentCode);
+
+    /**
+     * @brief checkProgram              Print the errors of the submitted shaders and program, and delete the shaders
+     * @return false if the program could not be linked
+     */
+    bool checkProgram() const;
+
+    /**
+     * @brief reflectUniforms   Fill the uniforms table with the active uniforms of the linked program
+     */
+    void reflectUniforms() const;
+
+    /**
+     * @brief updateValue   Store the new value of a uniform
+     * @return false when the uniform is not used by the program or already has this value (nothing to upload)
+     */
+    bool updateValue(GLint uniform, const void* value, size_t size) const;
 
 };
 
@@ -0,0 +1,142 @@
+#include "ShaderVariants.h"
+
+
+// ===========
+// Constructor
+
+ShaderVariants::ShaderVariants()
+{
+    this->supportedFeatures = 0;
+}
+
+
+ShaderVariants::ShaderVariants(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, unsigned int supportedFeatures)
+{
+    this->vertexShaderPath = vertexShaderPath;
+    this->fragmentShaderPath = fragmentShaderPath;
+    this->supportedFeatures = supportedFeatures;
+
+    // One slot per combination, so that the references returned by get stay valid
+    this->variants.resize(1u << SHADER_FEATURE_COUNT);
+}
+
+
+// =======
+// Methods
+
+Shader& ShaderVariants::get(unsigned int features)
+{
+    unsigned int variant = features & this->supportedFeatures;
+
+    if(this->variants.empty())
+    {
+        std::cerr << "[WARNING] in ShaderVariants::get, the variants have no source" << std::endl;
+        this->variants.resize(1u << SHADER_FEATURE_COUNT);
+    }
+
+    if(this->variants[variant]._shaderId == 0)
+    {
+        this->variants[variant] = Shader(this->vertexShaderPath, this->fragmentShaderPath, getDefines(variant));
+    }
+
+    return this->variants[variant];
+}
+
+
+Shader* ShaderVariants::getReady(unsigned int features, unsigned int requiredFeatures)
+{
+    unsigned int variant = features & this->supportedFeatures;
+    unsigned int required = requiredFeatures & variant;
+    Shader& shader = this->get(variant);
+    Shader* fallback = NULL;
+    size_t fallbackFeatureCount = 0;
+
+    if(shader.isReady() || !GLEW_KHR_parallel_shader_compile)
+    {
+        shader.finish();
+        return &shader;
+    }
+
+    // Ready variant of a part of the features, with all the required ones
+    for(unsigned int i=0; i<this->variants.size(); i++)
+    {
+        size_t featureCount = std::bitset<SHADER_FEATURE_COUNT>(i).count();
+
+        if(this->variants[i]._shaderId == 0 || (i & ~variant) != 0 || (i & required) != required)
+        {
+            continue;
+        }
+        if((fallback == NULL || featureCount > fallbackFeatureCount) && this->variants[i].isReady())
+        {
+            fallback = &this->variants[i];
+            fallbackFeatureCount = featureCount;
+        }
+    }
+    if(fallback != NULL)
+    {
+        fallback->finish();
+    }
+
+    return fallback;
+}
+
+
+unsigned int ShaderVariants::getReadyCount() const
+{
+    unsigned int readyCount = 0;
+
+    for(unsigned int i=0; i<this->variants.size(); i++)
+    {
+        if(this->variants[i]._shaderId != 0 && this->variants[i].isReady())
+        {
+            readyCount++;
+        }
+    }
+
+    return readyCount;
+}
+
+
+unsigned int ShaderVariants::getCount() const
+{
+    unsigned int count = 0;
+
+    for(unsigned int i=0; i<this->variants.size(); i++)
+    {
+        if(this->variants[i]._shaderId != 0)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+void ShaderVariants::finish() const
+{
+    for(unsigned int i=0; i<this->variants.size(); i++)
+    {
+        if(this->variants[i]._shaderId != 0)
+        {
+            this->variants[i].finish();
+        }
+    }
+}
+
+
+std::string ShaderVariants::getDefines(unsigned int features)
+{
+    const char* featureNames[SHADER_FEATURE_COUNT] = { "SKYBOX_REFLECTION", "REFRACTION", "COMPRESSED_VERTICES", "TEXTURED", "FACE_CAMERA" };
+    std::string defines;
+
+    for(unsigned int i=0; i<SHADER_FEATURE_COUNT; i++)
+    {
+        if(features & (1u << i))
+        {
+            defines += std::string("#define ") + featureNames[i] + "\n";
+        }
+    }
+
+    return defines;
+}
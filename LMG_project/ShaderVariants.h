@@ -0,0 +1,120 @@
+#ifndef __SHADERVARIANTS_H
+#define __SHADERVARIANTS_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <bitset>
+
+// Shader
+#include "Shader.h"
+
+
+/**
+ * @brief The ShaderFeature enum list the feature bits of the shader sources, each one compiled as a #define of the GLSL code
+ */
+enum ShaderFeature
+{
+    /// SKYBOX_REFLECTION : the skybox is reflected by the model
+    SKYBOX_REFLECTION_FEATURE = 1 << 0,
+    /// REFRACTION : the model is glass refracting the skybox
+    REFRACTION_FEATURE = 1 << 1,
+    /// COMPRESSED_VERTICES : the vertices are in COMPRESSED_MESH_VERTEX_FORMAT (quantized position, octahedral normal)
+    COMPRESSED_VERTICES_FEATURE = 1 << 2,
+    /// TEXTURED : the terrain color comes from its texture instead of a single color
+    TEXTURED_FEATURE = 1 << 3,
+    /// FACE_CAMERA : the billboard turns to face the camera
+    FACE_CAMERA_FEATURE = 1 << 4,
+    /// Number of feature bits
+    SHADER_FEATURE_COUNT = 5
+};
+
+
+/**
+ * @brief The ShaderVariants class compile the permutations of a shader source, one program per combination of feature bits.
+ *        A variant is submitted to the compiler the first time it is asked for, then kept (and its binary cached on disk by the shader),
+ *        so that each draw uses the program of exactly the features it needs instead of branching in the shaders.
+ */
+class ShaderVariants
+{
+// Attributes
+private:
+    /// Sources of the variants
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    /// Feature bits used by the sources, the others are ignored
+    unsigned int supportedFeatures;
+    /// Program of each combination of features, not created until it is asked for (its id is 0)
+    std::vector<Shader> variants;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief ShaderVariants create an empty set of variants
+     */
+    ShaderVariants();
+
+
+    /**
+     * @brief ShaderVariants create the set of variants of a shader source, without compiling any
+     * @param vertexShaderPath path of the vertex shader
+     * @param fragmentShaderPath path of the fragment shader
+     * @param supportedFeatures feature bits used by the sources (ShaderFeature)
+     */
+    ShaderVariants(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, unsigned int supportedFeatures);
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief get return the program of a combination of features, submitted to the compiler the first time
+     * @param features feature bits (ShaderFeature), the ones the sources do not use are ignored
+     */
+    Shader& get(unsigned int features);
+
+
+    /**
+     * @brief getReady return the program of a combination of features when it can be used without waiting for the compiler (submitted the first time),
+     *        or else the ready variant with the most of these features and all the required ones, used until the compiler finishes.
+     *        Without KHR_parallel_shader_compile the compiler can not be asked, the program is waited for.
+     * @param features feature bits (ShaderFeature)
+     * @param requiredFeatures feature bits the fallback must have (the vertex format)
+     * @return NULL when no variant can be used yet
+     */
+    Shader* getReady(unsigned int features, unsigned int requiredFeatures);
+
+
+    /**
+     * @brief getReadyCount return the number of submitted variants which can be used without waiting for the compiler
+     */
+    unsigned int getReadyCount() const;
+
+
+    /**
+     * @brief getCount return the number of submitted variants
+     */
+    unsigned int getCount() const;
+
+
+    /**
+     * @brief finish wait for the compilation of all the submitted variants
+     */
+    void finish() const;
+
+
+    /**
+     * @brief getDefines return the #define lines of a combination of features
+     */
+    static std::string getDefines(unsigned int features);
+};
+
+
+#endif
@@ -2,7 +2,6 @@
 
 // INPUT
 in vec2 textureCoordinates;
-in vec3 FragPos;
 
 // Uniform
 //uniform vec3 mapColor;
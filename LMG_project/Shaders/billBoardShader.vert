@@ -1,28 +1,40 @@
 //#version 330 core
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 
 // INPUT
 in vec3 position;
 
 // UNIFORM
-  // - camera
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
-  // Scene
-uniform mat4 sceneMatrix;
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
   // - 3D model
 uniform mat4 modelMatrix;
 
 uniform int imgWidth;
 uniform int imgHeight;
 
+// FEATURES (defined by ShaderVariants)
+  // - FACE_CAMERA : the billboard turns around its vertical axis to face the camera (otherwise it stays in its plane, like the billboards of a cloud)
+
 // OUTPUT
-out vec3 FragPos;
 out vec2 textureCoordinates;
 
 // MAIN
 void main( void )
 {
+#ifndef FACE_CAMERA
+    gl_Position = projectionMatrix * viewMatrix * sceneMatrix * modelMatrix * vec4( position, 1.0 );
+    textureCoordinates = vec2(((position.x)/imgWidth) + (imgWidth/2), ((imgHeight - position.y)/imgHeight)) + imgHeight;
+#else
     // Compute fragment position in world space
 
     mat4 modelView = viewMatrix;
@@ -39,6 +51,6 @@ void main( void )
     // Send position to Clip-space
     gl_Position = projectionMatrix * modelView * sceneMatrix * modelMatrix * vec4( position, 1.0 );
     
-    FragPos = position.xyz;
     textureCoordinates = vec2(((imgWidth - position.x)/imgWidth), ((imgHeight - position.y)/imgHeight));
+#endif
 }
@@ -1,19 +1,36 @@
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 
 // INPUT
 in vec2 textureCoordinates;
 in vec3 NormalInWorldSpace;
 in vec3 FragPos;
 
+// FEATURES (defined by ShaderVariants)
+  // - TEXTURED : the color comes from the map texture instead of mapColor
+
 // Uniform
-//uniform vec3 mapColor;
+#ifdef TEXTURED
 uniform sampler2D texture_diffuse;
-  // light color
-uniform vec3 lightColor;
-  // light position
-uniform vec3 lightPosition;
-  // Position of the camera
-uniform vec3 viewPos;
+#else
+uniform vec3 mapColor;
+#endif
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
+  // - light, written once per frame (UniformBuffer.h)
+layout(std140) uniform LightData
+{
+    vec3 lightPosition;
+    vec3 lightColor;
+};
 
 // Output
 out vec4 fragmentColor;
@@ -24,7 +41,11 @@ void main( void )
   vec3 lightDir;
   
   // Get texture color
+#ifdef TEXTURED
   vec4 tempColor = texture(texture_diffuse, textureCoordinates);
+#else
+  vec4 tempColor = vec4(mapColor, 1.0);
+#endif
   
   // Ambient light
   float ambientStrenght = 0.45;
@@ -40,6 +61,4 @@ void main( void )
 
   //fragmentColor = vec4(tempColor.r, tempColor.g, tempColor.b, 1.0);
   fragmentColor = vec4(result.r, result.g, result.b, 1.0);
-  
-  //fragmentColor = vec4(mapColor.r, mapColor.g, mapColor.b, 1.0);
 }
@@ -1,4 +1,5 @@
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 
 // INPUT
 in vec3 position;
@@ -6,11 +7,18 @@ in vec3 normal;
 in vec2 textCoords;
 
 // Uniform
-  // - camera
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
+  // - map
 uniform mat4 mapModelMatrix;
-uniform mat3 normalMatrix;
 
 // Output
 out vec3 FragPos;
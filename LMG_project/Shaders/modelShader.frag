@@ -1,27 +1,49 @@
 //#version 330 core
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 
 // INPUT
 in vec2 textureCoordinates;
 in vec3 NormalInWorldSpace;
 in vec3 FragPos;
 
+// FEATURES (defined by ShaderVariants)
+  // - SKYBOX_REFLECTION : the skybox is reflected by the model
+  // - REFRACTION : the model is glass refracting the skybox, without texture nor light
+
 // UNIFORM
+#ifndef REFRACTION
   // Diffuse textures
 uniform sampler2D texture_diffuse1;
 uniform sampler2D texture_diffuse2;
   // Specular textures
 uniform sampler2D texture_specular1;
-  // skybox texture
-uniform samplerCube skybox;
   // material coefficient
 uniform vec3 kd;
-  // light color
-uniform vec3 lightColor;
-  // light position
-uniform vec3 lightPosition;
-  // Position of the camera
-uniform vec3 viewPos;
+#else
+  // Type of refraction
+uniform float refractionRatio;
+#endif
+#if defined(SKYBOX_REFLECTION) || defined(REFRACTION)
+  // skybox texture
+uniform samplerCube skybox;
+#endif
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
+  // - light, written once per frame (UniformBuffer.h)
+layout(std140) uniform LightData
+{
+    vec3 lightPosition;
+    vec3 lightColor;
+};
 
 // OUTPUT
 out vec4 fragmentColor;
@@ -29,16 +51,28 @@ out vec4 fragmentColor;
 // MAIN
 void main( void )
 {
+#ifdef REFRACTION
+    float alpha = 1.0f;
+    // Get envMap texture coordinate by refraction
+    vec3 viewDirectionVector = normalize(FragPos - viewPos);
+    vec3 refractionVector = refract(viewDirectionVector, normalize(NormalInWorldSpace), refractionRatio);
+
+    fragmentColor = vec4(texture(skybox, refractionVector).rgb, alpha);
+#else
     vec3 result;
     
+    // Get texture color
+    vec4 diffuseColor = texture(texture_diffuse1, textureCoordinates);
+#ifdef SKYBOX_REFLECTION
     // Get envMap texture coordinate by reflexion
     vec3 viewDirectionVector = normalize(FragPos - viewPos);
     vec3 reflectionVector = reflect(viewDirectionVector, normalize(NormalInWorldSpace));
-    
-    // Get texture color
     float reflectionStrenght = 0.3;
-    vec4 reflectedColor = mix(texture(texture_diffuse1, textureCoordinates), texture(skybox, reflectionVector), reflectionStrenght) ;
-    vec4 tempColor = mix(texture(texture_diffuse1, textureCoordinates), reflectedColor, 0.5);
+    vec4 reflectedColor = mix(diffuseColor, texture(skybox, reflectionVector), reflectionStrenght) ;
+    vec4 tempColor = mix(diffuseColor, reflectedColor, 0.5);
+#else
+    vec4 tempColor = diffuseColor;
+#endif
     // Ambient light
     float ambientStrenght = 0.45;
     vec3 ambient = ambientStrenght * lightColor;
@@ -60,5 +94,6 @@ void main( void )
     
     fragmentColor = vec4(result.r, result.g, result.b, 1.0);
     //fragmentColor = vec4(1.0, 1.0, 1.0, 1.0);
+#endif
 }
             
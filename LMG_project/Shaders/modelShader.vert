@@ -0,0 +1,77 @@
+//#version 330 core
+#version 130
+#extension GL_ARB_uniform_buffer_object : require
+
+// INPUT
+in vec3 position;
+in vec3 normal;
+in vec2 textCoords;
+
+// UNIFORM
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
+  // - 3D model
+uniform mat4 modelMatrix;
+#ifdef COMPRESSED_VERTICES
+  // - compressed vertices (position quantized in the model bounding box, octahedral normal)
+uniform vec3 positionDecodeOffset;
+uniform vec3 positionDecodeScale;
+#endif
+
+
+// OUTPUT
+out vec2 textureCoordinates;
+out vec3 FragPos;
+out vec3 NormalInWorldSpace;
+
+// FUNCTIONS
+vec3 decodePosition()
+{
+#ifdef COMPRESSED_VERTICES
+    return positionDecodeOffset + position * positionDecodeScale;
+#else
+    return position;
+#endif
+}
+
+vec3 decodeNormal()
+{
+#ifndef COMPRESSED_VERTICES
+    return normal;
+#else
+    // Unfold the octahedron stored in normal.xy
+    vec3 octahedral = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    if(octahedral.z < 0.0)
+    {
+        vec2 signs = vec2(octahedral.x >= 0.0 ? 1.0 : -1.0, octahedral.y >= 0.0 ? 1.0 : -1.0);
+        octahedral.xy = (1.0 - abs(octahedral.yx)) * signs;
+    }
+    return normalize(octahedral);
+#endif
+}
+
+// MAIN
+void main( void )
+{
+    vec3 vertexPosition = decodePosition();
+
+    // Send position to Clip-space
+    gl_Position = projectionMatrix * viewMatrix * sceneMatrix * modelMatrix * vec4( vertexPosition, 1.0 );
+    
+    // Compute normal position in world space
+    NormalInWorldSpace = normalMatrix * decodeNormal();
+    
+    // Compute fragment position in world space
+    FragPos = vec3(modelMatrix * vec4(vertexPosition, 1.0));
+
+    // Send texture coordinates to the fragment shader
+    textureCoordinates = textCoords;
+}
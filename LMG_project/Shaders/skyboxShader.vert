@@ -1,12 +1,21 @@
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 
 // INPUT
 in vec3 position;
 
 // Uniform
-  // - camera
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+  // - camera and scene, written once per frame (UniformBuffer.h)
+layout(std140) uniform FrameData
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 sceneMatrix;
+    mat3 normalMatrix;
+    vec3 viewPos;
+    float time;
+};
+  // - cube
 uniform mat4 cubeModelMatrix;
 
 // Output
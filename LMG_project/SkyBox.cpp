@@ -3,7 +3,7 @@
 // Constructor
 
 
-SkyBox::SkyBox(std::vector<std::__cxx11::string> faces)
+SkyBox::SkyBox(std::vector<std::string> faces)
 {
 
     float skyboxVertices[] = {
@@ -69,33 +69,25 @@ void SkyBox::loadCubeMap(std::vector<std::string> faces)
 {
     int width = 0;
     int height = 0;
-    unsigned char* data = NULL;
+    // Faces are not repeated
+    MipGenerationSettings mipSettings;
+    mipSettings.wrap = false;
 
     // Initialize the texture of the skybox
     glGenTextures(1, &this->textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, this->textureID);
+    RenderState::bindTexture(GL_TEXTURE_CUBE_MAP, this->textureID);
 
-    // Load and bind textures
+    // Load and bind textures (compressed or cached version of each face with its mip levels)
     for(unsigned int i = 0; i < faces.size(); i++)
     {
-        // Load texture from file
-        data = SOIL_load_image(faces[i].c_str(), &width, &height, 0, SOIL_LOAD_RGB);
-        //std::cerr << "SOIL_LOADING error : " << SOIL_last_result() << std::endl;
-
-        // Bind texture to cube map
-        if(data != NULL)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        else
+        if(!CompressedTexture::loadTexture(faces[i], GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, &width, &height)
+        && !CompressedTexture::createTexture(faces[i], GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mipSettings, &width, &height))
         {
             std::cerr << "[WARNING] in SkyBox, could not load texture at path : " << faces[i].c_str() << std::endl;
         }
-
-        SOIL_free_image_data(data);
     }
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -107,59 +99,35 @@ void SkyBox::loadCubeMap(std::vector<std::string> faces)
 void SkyBox::setupSkyBox()
 {
 
-    // Declare VAO, VBO
-    glGenVertexArrays(1, &this->VAO);
-    glCheckError();
-    glGenBuffers(1, &this->VBO);
-    glCheckError();
-
-    // Memory allocation for VBO and EBO linked with the VAO
-    glBindVertexArray(this->VAO);
-    glCheckError();
-
-    // Link the VBO with the vertices vector
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glCheckError();
-    glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(float), this->vertices.data(), GL_STATIC_DRAW);
-    glCheckError();
-
-    // Tell how to read position of each vertex in the VBO
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), (void*)0);
-    glCheckError();
-    glEnableVertexAttribArray(0);
-    glCheckError();
-
-    glBindVertexArray(0);
-    glCheckError();
+    // Copy the vertices in the geometry arena (drawn without indices)
+    this->geometryHandle = GeometryArena::getArena(POSITION_VERTEX_FORMAT).allocate(this->vertices.data(), static_cast<GLuint>(this->vertices.size() / 3), NULL, 0);
+
+    // The vertices are only positions, so KEEP_POSITIONS keeps them all
+    size_t releasedBytes = 0;
+    if(GeometryRetention::getPolicy(SKYBOX_GEOMETRY) == DISCARD_GEOMETRY)
+    {
+        releasedBytes = GeometryRetention::release(this->vertices);
+    }
+    GeometryRetention::addResource(SKYBOX_GEOMETRY, GeometryRetention::getBytes(this->vertices), releasedBytes);
 }
 
 
 
 // Methods
 
-void SkyBox::draw(Shader &shader, glm::mat4 viewMatrix, glm::mat4 projectionMatrix, glm::mat4 cubeTransformationMatrix)
+void SkyBox::draw(Shader &shader, glm::mat4 cubeTransformationMatrix)
 {
-    // Change depth test function
-    glDepthFunc(GL_LEQUAL);
-
     // Use shader and set uniform
     shader.use();
-    shader.setMat4("viewMatrix", viewMatrix);
-    shader.setMat4("projectionMatrix", projectionMatrix);
     shader.setMat4("cubeModelMatrix", cubeTransformationMatrix);
 
     // bind texture for shader usage
-    glBindVertexArray(this->VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, this->textureID);
+    GeometryArena& arena = GeometryArena::getArena(POSITION_VERTEX_FORMAT);
+    arena.bind();
+    RenderState::bindTexture(GL_TEXTURE0, GL_TEXTURE_CUBE_MAP, this->textureID);
 
     // draw skybox
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-
-    glBindVertexArray(0);
-
-    // Set depth test function back to default
-    glDepthFunc(GL_LESS);
+    glDrawArrays(GL_TRIANGLES, arena.getRange(this->geometryHandle).baseVertex, 36);
 }
 
 
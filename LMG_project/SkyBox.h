@@ -33,12 +33,20 @@
 // Shader
 #include "Shader.h"
 
+// Geometry storage
+#include "GeometryArena.h"
+
+// Compressed textures
+#include "CompressedTexture.h"
+
+// Geometry retention
+#include "GeometryRetention.h"
+
 class SkyBox
 {
 // Attributes
 private:
-    GLuint VAO;
-    GLuint VBO;
+    GLuint geometryHandle;
     std::vector<float> vertices;
 
 public:
@@ -75,10 +83,11 @@ public:
 
 
     /**
-     * @brief draw draw the skybox
-     * @param shader used shader
+     * @brief draw draw the skybox, with the depth test set by the sky pass of the render queue
+     * @param shader used shader (the camera comes from the FrameData uniform block)
+     * @param cubeTransformationMatrix transformation of the cube
      */
-    void draw(Shader& shader, glm::mat4 viewMatrix, glm::mat4 projectionMatrix, glm::mat4 cubeTransformationMatrix);
+    void draw(Shader& shader, glm::mat4 cubeTransformationMatrix);
 
 };
 
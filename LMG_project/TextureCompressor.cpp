@@ -0,0 +1,678 @@
+#include "TextureCompressor.h"
+
+
+// Interpolation weights of the 4-bit BC7 indices (out of 64)
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+// =======
+// Methods
+
+int TextureCompressor::compressFiles(const std::vector<std::string>& sourcePaths, TextureCompressionFormat format)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    size_t totalSourceBytes = 0;
+    size_t totalCompressedBytes = 0;
+    int failures = 0;
+
+    for(unsigned int i=0; i<sourcePaths.size(); i++)
+    {
+        size_t sourceBytes = 0;
+        size_t compressedBytes = 0;
+
+        if(!compressFile(sourcePaths[i], format, &sourceBytes, &compressedBytes))
+        {
+            failures++;
+            continue;
+        }
+        totalSourceBytes += sourceBytes;
+        totalCompressedBytes += compressedBytes;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "TextureCompressor : " << sourcePaths.size() - failures << " images, " << totalSourceBytes / 1024 << " KB -> " << totalCompressedBytes / 1024
+              << " KB in " << seconds << " s (" << failures << " failed)" << std::endl;
+
+    return failures;
+}
+
+
+bool TextureCompressor::compressFile(const std::string& sourcePath, TextureCompressionFormat format, size_t* sourceBytes, size_t* compressedBytes)
+{
+    CompressedTexture texture;
+    std::vector<MipLevel> levels;
+    MipGenerationSettings settings;
+    int width = 0;
+    int height = 0;
+    size_t slash = sourcePath.find_last_of("/\\");
+    size_t dot = sourcePath.find_last_of('.');
+    std::string path = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? sourcePath.substr(0, dot) : sourcePath;
+    unsigned char* texels = SOIL_load_image(sourcePath.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
+    bool transparent = false;
+
+    if(texels == NULL)
+    {
+        std::cerr << "[WARNING] in TextureCompressor, could not load texture at path : " << sourcePath << std::endl;
+        return false;
+    }
+
+    for(size_t i=3; i<static_cast<size_t>(width) * height * 4; i+=4)
+    {
+        transparent = transparent || (texels[i] < 255);
+    }
+    if(format == AUTO_TEXTURE_FORMAT)
+    {
+        format = selectFormat(sourcePath, transparent);
+    }
+
+    // Normal maps are not colors, and cut out images keep their coverage at a distance
+    settings.sRGB = (format != BC5_TEXTURE_FORMAT);
+    settings.alphaCoverageThreshold = (transparent && format != BC5_TEXTURE_FORMAT) ? TEXTURE_COMPRESSION_ALPHA_REFERENCE : 0.0f;
+    MipGenerator::generateMipChain(texels, width, height, settings, levels);
+    SOIL_free_image_data(texels);
+
+    texture.internalFormat = getInternalFormat(format);
+    texture.width = width;
+    texture.height = height;
+    texture.data.resize(texture.computeLevels(static_cast<unsigned int>(levels.size())));
+    *sourceBytes = 0;
+    for(unsigned int i=0; i<levels.size(); i++)
+    {
+        compressLevel(levels[i].texels.data(), levels[i].width, levels[i].height, format, texture.data.data() + texture.levels[i].offset);
+        *sourceBytes += levels[i].texels.size();
+    }
+    *compressedBytes = texture.data.size();
+
+    path += COMPRESSED_TEXTURE_DDS_EXTENSION;
+    if(!texture.save(path))
+    {
+        std::cerr << "[WARNING] in TextureCompressor, could not write : " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "TextureCompressor : " << path << " (" << getFormatName(format) << ", " << width << "x" << height << ", " << levels.size() << " levels) "
+              << *sourceBytes / 1024 << " KB -> " << *compressedBytes / 1024 << " KB" << std::endl;
+
+    return true;
+}
+
+
+void TextureCompressor::compressLevel(const unsigned char* texels, int width, int height, TextureCompressionFormat format, unsigned char* blocks)
+{
+    int blockColumns = (width + 3) / 4;
+    int blockRows = (height + 3) / 4;
+    size_t blockSize = (format == BC1_TEXTURE_FORMAT) ? 8 : 16;
+
+    // The rows of blocks are shared by the workers
+    JobSystem::getJobSystem().parallelForRange(static_cast<unsigned int>(blockRows), 1, [&](unsigned int firstRow, unsigned int lastRow)
+    {
+        unsigned char block[64];
+
+        for(int row=static_cast<int>(firstRow); row<static_cast<int>(lastRow); row++)
+        {
+            for(int column=0; column<blockColumns; column++)
+            {
+                unsigned char* output = blocks + (static_cast<size_t>(row) * blockColumns + column) * blockSize;
+
+                readBlock(texels, width, height, column, row, block);
+                switch(format)
+                {
+                case BC1_TEXTURE_FORMAT:
+                    encodeBC1Block(block, output);
+                    break;
+                case BC3_TEXTURE_FORMAT:
+                    encodeBC4Block(block, 3, output);
+                    encodeBC1Block(block, output + 8);
+                    break;
+                case BC5_TEXTURE_FORMAT:
+                    encodeBC4Block(block, 0, output);
+                    encodeBC4Block(block, 1, output + 8);
+                    break;
+                default:
+                    encodeBC7Block(block, output);
+                    break;
+                }
+            }
+        }
+    });
+}
+
+
+bool TextureCompressor::parseFormat(const std::string& name, TextureCompressionFormat* format)
+{
+    const TextureCompressionFormat formats[5] = { BC1_TEXTURE_FORMAT, BC3_TEXTURE_FORMAT, BC5_TEXTURE_FORMAT, BC7_TEXTURE_FORMAT, AUTO_TEXTURE_FORMAT };
+
+    for(int i=0; i<5; i++)
+    {
+        if(name == getFormatName(formats[i]))
+        {
+            *format = formats[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+GLenum TextureCompressor::getInternalFormat(TextureCompressionFormat format)
+{
+    switch(format)
+    {
+    case BC1_TEXTURE_FORMAT: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case BC3_TEXTURE_FORMAT: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BC5_TEXTURE_FORMAT: return GL_COMPRESSED_RG_RGTC2;
+    default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+}
+
+
+const char* TextureCompressor::getFormatName(TextureCompressionFormat format)
+{
+    switch(format)
+    {
+    case BC1_TEXTURE_FORMAT: return "bc1";
+    case BC3_TEXTURE_FORMAT: return "bc3";
+    case BC5_TEXTURE_FORMAT: return "bc5";
+    case BC7_TEXTURE_FORMAT: return "bc7";
+    default: return "auto";
+    }
+}
+
+
+void TextureCompressor::encodeBC1Block(const unsigned char* texels, unsigned char* block)
+{
+    float endpoint0[4];
+    float endpoint1[4];
+    unsigned char indices[16];
+    unsigned char bestIndices[16];
+    unsigned short bestColor0 = 0;
+    unsigned short bestColor1 = 0;
+    unsigned int bestError = 0;
+    unsigned int indexBits = 0;
+    // Interpolation weight of each index toward color1
+    const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    auto packColor = [](const float* color)
+    {
+        int red = static_cast<int>(std::floor(glm::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f));
+        int green = static_cast<int>(std::floor(glm::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f));
+        int blue = static_cast<int>(std::floor(glm::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f));
+        return static_cast<unsigned short>((red << 11) | (green << 5) | blue);
+    };
+
+    computeEndpoints(texels, 3, endpoint0, endpoint1);
+    bestColor0 = packColor(endpoint0);
+    bestColor1 = packColor(endpoint1);
+    bestError = selectBC1Indices(texels, bestColor0, bestColor1, bestIndices);
+
+    // Refine the endpoints with the chosen indices while the error decreases
+    for(int iteration=0; iteration<2 && bestError > 0; iteration++)
+    {
+        float texelWeights[16];
+        unsigned short color0 = 0;
+        unsigned short color1 = 0;
+        unsigned int error = 0;
+
+        for(int i=0; i<16; i++)
+        {
+            texelWeights[i] = weights[bestIndices[i]];
+        }
+        if(!fitEndpoints(texels, 3, texelWeights, endpoint0, endpoint1))
+        {
+            break;
+        }
+
+        color0 = packColor(endpoint0);
+        color1 = packColor(endpoint1);
+        error = selectBC1Indices(texels, color0, color1, indices);
+        if(error >= bestError)
+        {
+            break;
+        }
+        bestError = error;
+        bestColor0 = color0;
+        bestColor1 = color1;
+        std::copy(indices, indices + 16, bestIndices);
+    }
+
+    for(int i=0; i<16; i++)
+    {
+        indexBits |= static_cast<unsigned int>(bestIndices[i]) << (2 * i);
+    }
+    block[0] = static_cast<unsigned char>(bestColor0 & 0xFF);
+    block[1] = static_cast<unsigned char>(bestColor0 >> 8);
+    block[2] = static_cast<unsigned char>(bestColor1 & 0xFF);
+    block[3] = static_cast<unsigned char>(bestColor1 >> 8);
+    for(int i=0; i<4; i++)
+    {
+        block[4 + i] = static_cast<unsigned char>((indexBits >> (8 * i)) & 0xFF);
+    }
+}
+
+
+void TextureCompressor::encodeBC4Block(const unsigned char* texels, int channel, unsigned char* block)
+{
+    int minimum = 255;
+    int maximum = 0;
+    float palette[8];
+    unsigned long long indexBits = 0;
+
+    for(int i=0; i<16; i++)
+    {
+        minimum = std::min(minimum, static_cast<int>(texels[4 * i + channel]));
+        maximum = std::max(maximum, static_cast<int>(texels[4 * i + channel]));
+    }
+
+    // value0 > value1 : the 8 values mode, 6 of them interpolated
+    block[0] = static_cast<unsigned char>(maximum);
+    block[1] = static_cast<unsigned char>(minimum);
+    palette[0] = static_cast<float>(maximum);
+    palette[1] = static_cast<float>(minimum);
+    for(int i=2; i<8; i++)
+    {
+        palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7.0f;
+    }
+
+    if(maximum > minimum)
+    {
+        for(int i=0; i<16; i++)
+        {
+            float value = static_cast<float>(texels[4 * i + channel]);
+            unsigned long long bestIndex = 0;
+            float bestDistance = std::fabs(value - palette[0]);
+
+            for(int j=1; j<8; j++)
+            {
+                if(std::fabs(value - palette[j]) < bestDistance)
+                {
+                    bestDistance = std::fabs(value - palette[j]);
+                    bestIndex = static_cast<unsigned long long>(j);
+                }
+            }
+            indexBits |= bestIndex << (3 * i);
+        }
+    }
+
+    for(int i=0; i<6; i++)
+    {
+        block[2 + i] = static_cast<unsigned char>((indexBits >> (8 * i)) & 0xFF);
+    }
+}
+
+
+void TextureCompressor::encodeBC7Block(const unsigned char* texels, unsigned char* block)
+{
+    float endpoints[2][4];
+    int quantized[2][4];
+    int pBits[2];
+    unsigned char indices[16];
+    int bestQuantized[2][4];
+    int bestPBits[2];
+    unsigned char bestIndices[16];
+    unsigned int bestError = 0;
+
+    computeEndpoints(texels, 4, endpoints[0], endpoints[1]);
+    for(int e=0; e<2; e++)
+    {
+        quantizeBC7Endpoint(endpoints[e], bestQuantized[e], &bestPBits[e]);
+    }
+    bestError = selectBC7Indices(texels, bestQuantized, bestPBits, bestIndices);
+
+    // Refine the endpoints with the chosen indices while the error decreases
+    for(int iteration=0; iteration<2 && bestError > 0; iteration++)
+    {
+        float texelWeights[16];
+        unsigned int error = 0;
+
+        for(int i=0; i<16; i++)
+        {
+            texelWeights[i] = BC7_WEIGHTS[bestIndices[i]] / 64.0f;
+        }
+        if(!fitEndpoints(texels, 4, texelWeights, endpoints[0], endpoints[1]))
+        {
+            break;
+        }
+
+        for(int e=0; e<2; e++)
+        {
+            quantizeBC7Endpoint(endpoints[e], quantized[e], &pBits[e]);
+        }
+        error = selectBC7Indices(texels, quantized, pBits, indices);
+        if(error >= bestError)
+        {
+            break;
+        }
+        bestError = error;
+        std::copy(&quantized[0][0], &quantized[0][0] + 8, &bestQuantized[0][0]);
+        std::copy(pBits, pBits + 2, bestPBits);
+        std::copy(indices, indices + 16, bestIndices);
+    }
+
+    // The first index is stored without its highest bit : swap the endpoints when it is set
+    if(bestIndices[0] & 8)
+    {
+        for(int c=0; c<4; c++)
+        {
+            std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+        }
+        std::swap(bestPBits[0], bestPBits[1]);
+        for(int i=0; i<16; i++)
+        {
+            bestIndices[i] = static_cast<unsigned char>(15 - bestIndices[i]);
+        }
+    }
+
+    // Bits from the lowest : mode (7 bits, 1 << 6), R0 R1 G0 G1 B0 B1 A0 A1 (7 bits each), P0 P1, 3 + 15 * 4 index bits
+    unsigned long long low = 1ull << 6;
+    unsigned long long high = 0;
+    int bit = 7;
+    auto write = [&](unsigned long long value, int count)
+    {
+        for(int i=0; i<count; i++, bit++)
+        {
+            unsigned long long valueBit = (value >> i) & 1ull;
+            if(bit < 64)
+            {
+                low |= valueBit << bit;
+            }
+            else
+            {
+                high |= valueBit << (bit - 64);
+            }
+        }
+    };
+
+    for(int c=0; c<4; c++)
+    {
+        write(static_cast<unsigned long long>(bestQuantized[0][c]), 7);
+        write(static_cast<unsigned long long>(bestQuantized[1][c]), 7);
+    }
+    write(static_cast<unsigned long long>(bestPBits[0]), 1);
+    write(static_cast<unsigned long long>(bestPBits[1]), 1);
+    write(bestIndices[0], 3);
+    for(int i=1; i<16; i++)
+    {
+        write(bestIndices[i], 4);
+    }
+
+    for(int i=0; i<8; i++)
+    {
+        block[i] = static_cast<unsigned char>((low >> (8 * i)) & 0xFF);
+        block[8 + i] = static_cast<unsigned char>((high >> (8 * i)) & 0xFF);
+    }
+}
+
+
+// =================
+// Auxiliary methods
+
+TextureCompressionFormat TextureCompressor::selectFormat(const std::string& sourcePath, bool transparent)
+{
+    std::string name = sourcePath.substr(sourcePath.find_last_of("/\\") + 1);
+
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if(name.find("_ddn") != std::string::npos || name.find("_nrm") != std::string::npos || name.find("normal") != std::string::npos)
+    {
+        return BC5_TEXTURE_FORMAT;
+    }
+
+    return transparent ? BC3_TEXTURE_FORMAT : BC1_TEXTURE_FORMAT;
+}
+
+
+void TextureCompressor::readBlock(const unsigned char* texels, int width, int height, int blockX, int blockY, unsigned char* result)
+{
+    for(int y=0; y<4; y++)
+    {
+        int row = std::min(blockY * 4 + y, height - 1);
+
+        for(int x=0; x<4; x++)
+        {
+            int column = std::min(blockX * 4 + x, width - 1);
+            const unsigned char* texel = texels + (static_cast<size_t>(row) * width + column) * 4;
+
+            std::copy(texel, texel + 4, result + (y * 4 + x) * 4);
+        }
+    }
+}
+
+
+void TextureCompressor::computeEndpoints(const unsigned char* texels, int channels, float* endpoint0, float* endpoint1)
+{
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float covariance[4][4] = { { 0.0f } };
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float minimum = std::numeric_limits<float>::max();
+    float maximum = -std::numeric_limits<float>::max();
+
+    for(int i=0; i<16; i++)
+    {
+        for(int c=0; c<channels; c++)
+        {
+            mean[c] += texels[4 * i + c] / 16.0f;
+        }
+    }
+    for(int i=0; i<16; i++)
+    {
+        for(int c=0; c<channels; c++)
+        {
+            for(int d=0; d<channels; d++)
+            {
+                covariance[c][d] += (texels[4 * i + c] - mean[c]) * (texels[4 * i + d] - mean[d]);
+            }
+        }
+    }
+
+    // Power iterations converge to the direction of largest variance
+    for(int iteration=0; iteration<8; iteration++)
+    {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float length = 0.0f;
+
+        for(int c=0; c<channels; c++)
+        {
+            for(int d=0; d<channels; d++)
+            {
+                next[c] += covariance[c][d] * axis[d];
+            }
+            length = std::max(length, std::fabs(next[c]));
+        }
+        if(length <= 0.0f)
+        {
+            break;
+        }
+        for(int c=0; c<channels; c++)
+        {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float squaredLength = 0.0f;
+    for(int c=0; c<channels; c++)
+    {
+        squaredLength += axis[c] * axis[c];
+    }
+    for(int i=0; i<16; i++)
+    {
+        float projection = 0.0f;
+
+        for(int c=0; c<channels; c++)
+        {
+            projection += (texels[4 * i + c] - mean[c]) * axis[c];
+        }
+        minimum = std::min(minimum, projection);
+        maximum = std::max(maximum, projection);
+    }
+
+    for(int c=0; c<4; c++)
+    {
+        float direction = (c < channels && squaredLength > 0.0f) ? axis[c] / squaredLength : 0.0f;
+        float value = (c < channels) ? mean[c] : 255.0f;
+
+        endpoint0[c] = glm::clamp(value + direction * minimum, 0.0f, 255.0f);
+        endpoint1[c] = glm::clamp(value + direction * maximum, 0.0f, 255.0f);
+    }
+}
+
+
+bool TextureCompressor::fitEndpoints(const unsigned char* texels, int channels, const float* weights, float* endpoint0, float* endpoint1)
+{
+    // Minimize the sum of (texel - (1 - w) * endpoint0 - w * endpoint1)^2 for each channel
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float right0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float right1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for(int i=0; i<16; i++)
+    {
+        float weight = weights[i];
+
+        a += (1.0f - weight) * (1.0f - weight);
+        b += (1.0f - weight) * weight;
+        c += weight * weight;
+        for(int d=0; d<channels; d++)
+        {
+            right0[d] += (1.0f - weight) * texels[4 * i + d];
+            right1[d] += weight * texels[4 * i + d];
+        }
+    }
+
+    float determinant = a * c - b * b;
+    if(std::fabs(determinant) < 1e-6f)
+    {
+        return false;
+    }
+
+    for(int d=0; d<channels; d++)
+    {
+        endpoint0[d] = glm::clamp((c * right0[d] - b * right1[d]) / determinant, 0.0f, 255.0f);
+        endpoint1[d] = glm::clamp((a * right1[d] - b * right0[d]) / determinant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+
+unsigned int TextureCompressor::selectBC1Indices(const unsigned char* texels, unsigned short& color0, unsigned short& color1, unsigned char* indices)
+{
+    int palette[4][3];
+    unsigned int error = 0;
+
+    // color0 > color1 selects the 4 colors mode (the same colors give a uniform block)
+    if(color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    unsigned short colors[2] = { color0, color1 };
+    for(int e=0; e<2; e++)
+    {
+        int red = (colors[e] >> 11) & 31;
+        int green = (colors[e] >> 5) & 63;
+        int blue = colors[e] & 31;
+
+        palette[e][0] = (red << 3) | (red >> 2);
+        palette[e][1] = (green << 2) | (green >> 4);
+        palette[e][2] = (blue << 3) | (blue >> 2);
+    }
+    for(int c=0; c<3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for(int i=0; i<16; i++)
+    {
+        unsigned int bestDistance = std::numeric_limits<unsigned int>::max();
+        int candidates = (color0 == color1) ? 1 : 4;
+
+        for(int j=0; j<candidates; j++)
+        {
+            unsigned int distance = 0;
+
+            for(int c=0; c<3; c++)
+            {
+                int difference = static_cast<int>(texels[4 * i + c]) - palette[j][c];
+                distance += static_cast<unsigned int>(difference * difference);
+            }
+            if(distance < bestDistance)
+            {
+                bestDistance = distance;
+                indices[i] = static_cast<unsigned char>(j);
+            }
+        }
+        error += bestDistance;
+    }
+
+    return error;
+}
+
+
+unsigned int TextureCompressor::selectBC7Indices(const unsigned char* texels, const int endpoints[2][4], const int pBits[2], unsigned char* indices)
+{
+    int palette[16][4];
+    unsigned int error = 0;
+
+    for(int c=0; c<4; c++)
+    {
+        int value0 = (endpoints[0][c] << 1) | pBits[0];
+        int value1 = (endpoints[1][c] << 1) | pBits[1];
+
+        for(int j=0; j<16; j++)
+        {
+            palette[j][c] = ((64 - BC7_WEIGHTS[j]) * value0 + BC7_WEIGHTS[j] * value1 + 32) >> 6;
+        }
+    }
+
+    for(int i=0; i<16; i++)
+    {
+        unsigned int bestDistance = std::numeric_limits<unsigned int>::max();
+
+        for(int j=0; j<16; j++)
+        {
+            unsigned int distance = 0;
+
+            for(int c=0; c<4; c++)
+            {
+                int difference = static_cast<int>(texels[4 * i + c]) - palette[j][c];
+                distance += static_cast<unsigned int>(difference * difference);
+            }
+            if(distance < bestDistance)
+            {
+                bestDistance = distance;
+                indices[i] = static_cast<unsigned char>(j);
+            }
+        }
+        error += bestDistance;
+    }
+
+    return error;
+}
+
+
+void TextureCompressor::quantizeBC7Endpoint(const float* endpoint, int* quantized, int* pBit)
+{
+    float bestError = std::numeric_limits<float>::max();
+
+    // Each channel is (7 bits << 1) | p-bit, the p-bit is shared by the 4 channels
+    for(int p=0; p<2; p++)
+    {
+        int candidate[4];
+        float error = 0.0f;
+
+        for(int c=0; c<4; c++)
+        {
+            candidate[c] = glm::clamp(static_cast<int>(std::floor((endpoint[c] - p) / 2.0f + 0.5f)), 0, 127);
+            float difference = static_cast<float>((candidate[c] << 1) | p) - endpoint[c];
+            error += difference * difference;
+        }
+        if(error < bestError)
+        {
+            bestError = error;
+            std::copy(candidate, candidate + 4, quantized);
+            *pBit = p;
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#ifndef __TEXTURECOMPRESSOR_H
+#define __TEXTURECOMPRESSOR_H
+
+// Includes
+
+// STL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <chrono>
+
+// glm
+#include <glm/glm.hpp>
+
+// SOIL
+#include <SOIL/SOIL.h>
+
+// Compressed textures
+#include "CompressedTexture.h"
+
+// Jobs
+#include "JobSystem.h"
+
+
+// Alpha reference whose coverage is kept by the mip levels of the images with transparency
+#define TEXTURE_COMPRESSION_ALPHA_REFERENCE 0.5f
+
+
+/**
+ * @brief The TextureCompressionFormat enum list the block compressed formats written by the texture compressor
+ */
+enum TextureCompressionFormat
+{
+    /// 5:6:5 colors, 4 bits per texel : opaque images
+    BC1_TEXTURE_FORMAT,
+    /// BC1 colors with interpolated alpha, 8 bits per texel : images with transparency
+    BC3_TEXTURE_FORMAT,
+    /// Two independent channels (red and green), 8 bits per texel : tangent space normal maps (z is rebuilt in the shader)
+    BC5_TEXTURE_FORMAT,
+    /// RGBA with 7-bit endpoints and 16 levels (mode 6), 8 bits per texel : higher quality color images
+    BC7_TEXTURE_FORMAT,
+    /// BC5 for the normal maps, BC3 for the images with transparency and BC1 for the others
+    AUTO_TEXTURE_FORMAT
+};
+
+
+/**
+ * @brief The TextureCompressor class is the offline encoder converting source images (PNG, JPG, ...) into DDS files
+ *        with their full mip chain (computed by MipGenerator), loaded afterwards by CompressedTexture. The blocks of each level are shared by the workers of the job system.
+ */
+class TextureCompressor
+{
+// Methods
+public:
+
+
+    /**
+     * @brief compressFiles compress a list of images and print the size and the time of each one
+     * @param sourcePaths paths of the images
+     * @param format format of the blocks
+     * @return the number of images which could not be compressed
+     */
+    static int compressFiles(const std::vector<std::string>& sourcePaths, TextureCompressionFormat format);
+
+
+    /**
+     * @brief compressFile compress an image and its mip chain in a DDS file next to it (same path with the .dds extension)
+     * @param sourcePath path of the image
+     * @param format format of the blocks
+     * @param sourceBytes filled with the size of the uncompressed RGBA levels
+     * @param compressedBytes filled with the size of the compressed levels
+     * @return false when the image could not be read or the DDS file written
+     */
+    static bool compressFile(const std::string& sourcePath, TextureCompressionFormat format, size_t* sourceBytes, size_t* compressedBytes);
+
+
+    /**
+     * @brief compressLevel encode an RGBA8 image into blocks (the texels outside of the image repeat the border)
+     * @param texels RGBA8 texels of the image
+     * @param width width of the image
+     * @param height height of the image
+     * @param format format of the blocks (not AUTO_TEXTURE_FORMAT)
+     * @param blocks filled with the blocks, row after row
+     */
+    static void compressLevel(const unsigned char* texels, int width, int height, TextureCompressionFormat format, unsigned char* blocks);
+
+
+    /**
+     * @brief parseFormat read the name of a format ("bc1", "bc3", "bc5", "bc7" or "auto")
+     * @return false when the name is unknown
+     */
+    static bool parseFormat(const std::string& name, TextureCompressionFormat* format);
+
+
+    /**
+     * @brief getInternalFormat return the OpenGL format of the blocks of a format (not AUTO_TEXTURE_FORMAT)
+     */
+    static GLenum getInternalFormat(TextureCompressionFormat format);
+
+
+    /**
+     * @brief getFormatName return the name of a format
+     */
+    static const char* getFormatName(TextureCompressionFormat format);
+
+
+    /**
+     * @brief encodeBC1Block encode the colors of 4x4 RGBA8 texels (opaque, always in the 4 colors mode)
+     * @param texels 16 RGBA8 texels, row after row
+     * @param block filled with the 8 bytes of the block
+     */
+    static void encodeBC1Block(const unsigned char* texels, unsigned char* block);
+
+
+    /**
+     * @brief encodeBC4Block encode one channel of 4x4 RGBA8 texels
+     * @param texels 16 RGBA8 texels, row after row
+     * @param channel channel to encode (0 to 3)
+     * @param block filled with the 8 bytes of the block
+     */
+    static void encodeBC4Block(const unsigned char* texels, int channel, unsigned char* block);
+
+
+    /**
+     * @brief encodeBC7Block encode 4x4 RGBA8 texels with the mode 6 of BC7 (one subset, RGBA endpoints with a p-bit each, 4-bit indices)
+     * @param texels 16 RGBA8 texels, row after row
+     * @param block filled with the 16 bytes of the block
+     */
+    static void encodeBC7Block(const unsigned char* texels, unsigned char* block);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief selectFormat choose the format of an image for AUTO_TEXTURE_FORMAT
+     * @param sourcePath path of the image (normal maps are found with their name)
+     * @param transparent true when a texel of the image is not opaque
+     */
+    static TextureCompressionFormat selectFormat(const std::string& sourcePath, bool transparent);
+
+
+    /**
+     * @brief readBlock copy 4x4 texels of an image, repeating the last row and column past the border
+     */
+    static void readBlock(const unsigned char* texels, int width, int height, int blockX, int blockY, unsigned char* result);
+
+
+    /**
+     * @brief computeEndpoints find the line fitting the texels best (principal axis) and the extreme texels along it
+     * @param texels 16 RGBA8 texels
+     * @param channels number of channels used (3 or 4)
+     * @param endpoint0 filled with the first end of the line
+     * @param endpoint1 filled with the second end of the line
+     */
+    static void computeEndpoints(const unsigned char* texels, int channels, float* endpoint0, float* endpoint1);
+
+
+    /**
+     * @brief fitEndpoints least squares endpoints for the given interpolation weights of the texels
+     * @return false when every weight is the same
+     */
+    static bool fitEndpoints(const unsigned char* texels, int channels, const float* weights, float* endpoint0, float* endpoint1);
+
+
+    /**
+     * @brief selectBC1Indices choose the closest color of the palette for each texel
+     * @param color0 first endpoint (5:6:5), swapped with color1 when it is smaller
+     * @param color1 second endpoint (5:6:5)
+     * @param indices filled with the index of each texel
+     * @return the squared error of the block
+     */
+    static unsigned int selectBC1Indices(const unsigned char* texels, unsigned short& color0, unsigned short& color1, unsigned char* indices);
+
+
+    /**
+     * @brief selectBC7Indices choose the closest interpolated color for each texel
+     * @param endpoints two quantized endpoints (7 bits per channel)
+     * @param pBits p-bit of each endpoint
+     * @param indices filled with the index of each texel
+     * @return the squared error of the block
+     */
+    static unsigned int selectBC7Indices(const unsigned char* texels, const int endpoints[2][4], const int pBits[2], unsigned char* indices);
+
+
+    /**
+     * @brief quantizeBC7Endpoint quantize an endpoint to 7 bits per channel and the p-bit giving the smallest error
+     */
+    static void quantizeBC7Endpoint(const float* endpoint, int* quantized, int* pBit);
+};
+
+
+#endif
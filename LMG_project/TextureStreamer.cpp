@@ -0,0 +1,363 @@
+#include "TextureStreamer.h"
+
+
+TextureStreamer* TextureStreamer::streamer = NULL;
+
+
+// ===========
+// Constructor
+
+TextureStreamer::TextureStreamer() :
+    budget(TEXTURE_STREAMING_BUDGET),
+    frame(0)
+{
+    this->statistics.residentBytes = 0;
+    this->statistics.requiredBytes = 0;
+    this->statistics.totalBytes = 0;
+    this->statistics.pendingBytes = 0;
+    this->statistics.uploadedBytes = 0;
+    this->statistics.streamedLevels = 0;
+    this->statistics.evictedLevels = 0;
+    this->statistics.failedLevels = 0;
+}
+
+
+// =======
+// Methods
+
+TextureStreamer& TextureStreamer::getStreamer()
+{
+    if(streamer == NULL)
+    {
+        streamer = new TextureStreamer();
+    }
+
+    return *streamer;
+}
+
+
+GLuint TextureStreamer::addTexture(const std::string& sourcePath, const MipGenerationSettings& settings)
+{
+    std::string path = CompressedTexture::prepareFile(sourcePath, settings);
+    CompressedTexture header;
+    StreamedTexture texture;
+    std::vector<unsigned char> levelData;
+
+    if(path.empty() || !header.loadHeader(path) || !header.isSupported())
+    {
+        return 0;
+    }
+
+    texture.path = path;
+    texture.internalFormat = header.internalFormat;
+    texture.levels = header.levels;
+    texture.loading = false;
+    texture.residentBytes = 0;
+    texture.finestLevel = 0;
+    texture.lastUsedFrame = this->frame;
+
+    // Coarse levels, small enough to stay resident
+    texture.minimumLevel = static_cast<unsigned int>(texture.levels.size()) - 1;
+    while(texture.minimumLevel > 0 && std::max(texture.levels[texture.minimumLevel - 1].width, texture.levels[texture.minimumLevel - 1].height) <= TEXTURE_STREAMING_RESIDENT_SIZE)
+    {
+        texture.minimumLevel--;
+    }
+    texture.residentLevel = texture.minimumLevel;
+    texture.requestedLevel = texture.minimumLevel;
+
+    glGenTextures(1, &texture.id);
+    RenderState::bindTexture(GL_TEXTURE_2D, texture.id);
+    for(unsigned int i=texture.minimumLevel; i<texture.levels.size(); i++)
+    {
+        if(!CompressedTexture::readLevel(path, texture.levels[i], levelData))
+        {
+            RenderState::deleteTextures(1, &texture.id);
+            return 0;
+        }
+        CompressedTexture::uploadLevel(GL_TEXTURE_2D, i, texture.internalFormat, texture.levels[i], levelData.data());
+        texture.residentBytes += texture.levels[i].size;
+    }
+
+    // Only the resident levels are sampled
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(texture.residentLevel));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size()) - 1);
+    glCheckError();
+
+    this->statistics.residentBytes += texture.residentBytes;
+    for(unsigned int i=0; i<texture.levels.size(); i++)
+    {
+        this->statistics.totalBytes += texture.levels[i].size;
+    }
+    this->textureIndices[texture.id] = static_cast<unsigned int>(this->textures.size());
+    this->textures.push_back(texture);
+
+    return texture.id;
+}
+
+
+void TextureStreamer::requestTexture(GLuint id, float coordinatesPerPixel)
+{
+    std::map<GLuint, unsigned int>::const_iterator it = this->textureIndices.find(id);
+    float texelsPerPixel = 0.0f;
+    unsigned int level = 0;
+
+    if(it == this->textureIndices.end())
+    {
+        return;
+    }
+    StreamedTexture& texture = this->textures[it->second];
+
+    // Each level has half the texels per pixel of the previous one (a mesh without texture coordinates only needs the coarse levels)
+    texelsPerPixel = coordinatesPerPixel * static_cast<float>(std::max(texture.levels[0].width, texture.levels[0].height));
+    if(texelsPerPixel <= 0.0f)
+    {
+        level = texture.minimumLevel;
+    }
+    else if(texelsPerPixel > 1.0f)
+    {
+        level = std::min(static_cast<unsigned int>(std::log2(texelsPerPixel)), texture.minimumLevel);
+    }
+
+    // Finest level of all the meshes using the texture during the frame
+    std::lock_guard<std::mutex> lock(this->requestMutex);
+    if(texture.lastUsedFrame != this->frame)
+    {
+        texture.lastUsedFrame = this->frame;
+        texture.requestedLevel = level;
+    }
+    else
+    {
+        texture.requestedLevel = std::min(texture.requestedLevel, level);
+    }
+}
+
+
+void TextureStreamer::update()
+{
+    this->statistics.uploadedBytes = 0;
+
+    this->uploadLevels();
+    this->evictLevels(0);
+    this->requestLevels();
+
+    this->statistics.requiredBytes = 0;
+    for(unsigned int i=0; i<this->textures.size(); i++)
+    {
+        for(unsigned int j=this->getTargetLevel(this->textures[i]); j<this->textures[i].levels.size(); j++)
+        {
+            this->statistics.requiredBytes += this->textures[i].levels[j].size;
+        }
+    }
+
+    this->frame++;
+}
+
+
+void TextureStreamer::setBudget(size_t bytes)
+{
+    this->budget = bytes;
+}
+
+
+size_t TextureStreamer::getBudget() const
+{
+    return this->budget;
+}
+
+
+void TextureStreamer::printStatistics() const
+{
+    std::cout << "Texture streaming : " << this->textures.size() << " textures, " << this->statistics.residentBytes / 1024 << " KB resident / "
+              << this->budget / 1024 << " KB budget, " << this->statistics.requiredBytes / 1024 << " KB needed by the last frame ("
+              << this->statistics.totalBytes / 1024 << " KB with every level), " << this->statistics.pendingBytes / 1024 << " KB in flight, "
+              << this->statistics.uploadedBytes / 1024 << " KB uploaded last frame, " << this->statistics.streamedLevels << " levels streamed in, "
+              << this->statistics.evictedLevels << " evicted";
+    if(this->statistics.failedLevels > 0)
+    {
+        std::cout << ", " << this->statistics.failedLevels << " unreadable";
+    }
+    std::cout << std::endl;
+}
+
+
+// =================
+// Auxiliary methods
+
+void TextureStreamer::uploadLevels()
+{
+    std::deque<TextureStreamRequest*> completed;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        completed.swap(this->completedRequests);
+    }
+
+    while(!completed.empty())
+    {
+        TextureStreamRequest* request = completed.front();
+
+        // The rest waits for the next frames
+        if(this->statistics.uploadedBytes > 0 && this->statistics.uploadedBytes + request->data.size() > TEXTURE_STREAMING_UPLOAD_BYTES)
+        {
+            break;
+        }
+        completed.pop_front();
+
+        StreamedTexture& texture = this->textures[request->texture];
+        texture.loading = false;
+        this->statistics.pendingBytes -= request->description.size;
+
+        if(request->succeeded)
+        {
+            // A texture is not evicted while it is loading, so the level is still the next finer one
+            RenderState::bindTexture(GL_TEXTURE_2D, texture.id);
+            CompressedTexture::uploadLevel(GL_TEXTURE_2D, request->level, texture.internalFormat, request->description, request->data.data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(request->level));
+            glCheckError();
+
+            texture.residentLevel = request->level;
+            texture.residentBytes += request->description.size;
+            this->statistics.residentBytes += request->description.size;
+            this->statistics.uploadedBytes += request->description.size;
+            this->statistics.streamedLevels++;
+        }
+        else
+        {
+            std::cerr << "[WARNING] in TextureStreamer, could not read the level " << request->level << " of : " << request->path << std::endl;
+            texture.finestLevel = request->level + 1;
+            this->statistics.failedLevels++;
+        }
+
+        delete request;
+    }
+
+    if(!completed.empty())
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->completedRequests.insert(this->completedRequests.begin(), completed.begin(), completed.end());
+    }
+}
+
+
+bool TextureStreamer::evictLevels(size_t bytes)
+{
+    std::vector<unsigned int> candidates;
+
+    if(this->statistics.residentBytes + this->statistics.pendingBytes + bytes <= this->budget)
+    {
+        return true;
+    }
+
+    for(unsigned int i=0; i<this->textures.size(); i++)
+    {
+        if(!this->textures[i].loading && this->textures[i].residentLevel < this->getTargetLevel(this->textures[i]))
+        {
+            candidates.push_back(i);
+        }
+    }
+
+    // Least recently used first, the largest first among the textures used during the same frame
+    std::sort(candidates.begin(), candidates.end(), [this](unsigned int a, unsigned int b)
+    {
+        if(this->textures[a].lastUsedFrame != this->textures[b].lastUsedFrame)
+        {
+            return this->textures[a].lastUsedFrame < this->textures[b].lastUsedFrame;
+        }
+        return this->textures[a].residentBytes > this->textures[b].residentBytes;
+    });
+
+    for(unsigned int i=0; i<candidates.size() && this->statistics.residentBytes + this->statistics.pendingBytes + bytes > this->budget; i++)
+    {
+        StreamedTexture& texture = this->textures[candidates[i]];
+        unsigned int targetLevel = this->getTargetLevel(texture);
+
+        // The base level moves before the finest levels are released, so that the texture stays complete
+        RenderState::bindTexture(GL_TEXTURE_2D, texture.id);
+        while(texture.residentLevel < targetLevel && this->statistics.residentBytes + this->statistics.pendingBytes + bytes > this->budget)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(texture.residentLevel) + 1);
+            // An empty image frees the level (levels below the base level are ignored by the sampling)
+            glTexImage2D(GL_TEXTURE_2D, texture.residentLevel, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+            texture.residentBytes -= texture.levels[texture.residentLevel].size;
+            this->statistics.residentBytes -= texture.levels[texture.residentLevel].size;
+            this->statistics.evictedLevels++;
+            texture.residentLevel++;
+        }
+        glCheckError();
+    }
+
+    return this->statistics.residentBytes + this->statistics.pendingBytes + bytes <= this->budget;
+}
+
+
+void TextureStreamer::requestLevels()
+{
+    std::vector<unsigned int> candidates;
+
+    for(unsigned int i=0; i<this->textures.size(); i++)
+    {
+        const StreamedTexture& texture = this->textures[i];
+
+        if(!texture.loading && this->getTargetLevel(texture) < texture.residentLevel)
+        {
+            candidates.push_back(i);
+        }
+    }
+
+    // Textures the furthest from the level they need first
+    std::sort(candidates.begin(), candidates.end(), [this](unsigned int a, unsigned int b)
+    {
+        return this->textures[a].residentLevel - this->getTargetLevel(this->textures[a]) > this->textures[b].residentLevel - this->getTargetLevel(this->textures[b]);
+    });
+
+    // One level at a time, so that the textures get finer progressively and the budget is checked for each level
+    for(unsigned int i=0; i<candidates.size(); i++)
+    {
+        StreamedTexture& texture = this->textures[candidates[i]];
+        unsigned int level = texture.residentLevel - 1;
+
+        if(!this->evictLevels(texture.levels[level].size))
+        {
+            // A smaller level of another texture may still fit
+            continue;
+        }
+
+        TextureStreamRequest* request = new TextureStreamRequest();
+        request->texture = candidates[i];
+        request->level = level;
+        request->path = texture.path;
+        request->description = texture.levels[level];
+        request->succeeded = false;
+
+        texture.loading = true;
+        this->statistics.pendingBytes += texture.levels[level].size;
+
+        // Read by an idle worker thread, never by the GL thread waiting for the jobs of a frame
+        JobSystem::getJobSystem().runInBackground([this, request]()
+        {
+            this->readLevel(request);
+        });
+    }
+}
+
+
+unsigned int TextureStreamer::getTargetLevel(const StreamedTexture& texture) const
+{
+    // Textures not used by the current frame only keep their coarse levels
+    if(texture.lastUsedFrame != this->frame)
+    {
+        return texture.minimumLevel;
+    }
+
+    return std::max(texture.requestedLevel, texture.finestLevel);
+}
+
+
+void TextureStreamer::readLevel(TextureStreamRequest* request)
+{
+    request->succeeded = CompressedTexture::readLevel(request->path, request->description, request->data);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->completedRequests.push_back(request);
+}
@@ -0,0 +1,245 @@
+#ifndef __TEXTURESTREAMER_H
+#define __TEXTURESTREAMER_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+
+// Compressed textures
+#include "CompressedTexture.h"
+
+// Jobs
+#include "JobSystem.h"
+
+// Redundant state filtering
+#include "RenderState.h"
+
+
+// Default video memory budget of the streamed textures, in bytes
+#define TEXTURE_STREAMING_BUDGET (128 * 1024 * 1024)
+// Levels of this size (in texels, along the largest side) and smaller are loaded with the texture and never evicted
+#define TEXTURE_STREAMING_RESIDENT_SIZE 64
+// Maximal size of the levels uploaded during a frame, in bytes (a level larger than it is uploaded alone)
+#define TEXTURE_STREAMING_UPLOAD_BYTES (8 * 1024 * 1024)
+
+
+/**
+ * @brief The StreamedTexture struct store the residency of a streamed texture
+ */
+struct StreamedTexture
+{
+    /// Id in OpenGL of the texture
+    GLuint id;
+    /// DDS or KTX file the levels are read from
+    std::string path;
+    /// OpenGL format of the texture
+    GLenum internalFormat;
+    /// Levels of the file, from the largest
+    std::vector<CompressedTextureLevel> levels;
+    /// First of the levels always resident
+    unsigned int minimumLevel;
+    /// Finest level which can be streamed in (a level which could not be read is not requested again)
+    unsigned int finestLevel;
+    /// Finest level in video memory (the base level of the texture)
+    unsigned int residentLevel;
+    /// Finest level needed by the meshes drawn during the current frame
+    unsigned int requestedLevel;
+    /// Last frame during which a mesh needed the texture
+    unsigned int lastUsedFrame;
+    /// True while a level is read by a background task
+    bool loading;
+    /// Video memory of the resident levels, in bytes
+    size_t residentBytes;
+};
+
+
+/**
+ * @brief The TextureStreamRequest struct is a level read by a background task of the job system, then uploaded by the main thread
+ */
+struct TextureStreamRequest
+{
+    /// Index of the texture in the streamer
+    unsigned int texture;
+    /// Index of the level
+    unsigned int level;
+    /// File and position of the level
+    std::string path;
+    CompressedTextureLevel description;
+    /// Data of the level, once read
+    std::vector<unsigned char> data;
+    /// False when the level could not be read
+    bool succeeded;
+};
+
+
+/**
+ * @brief The TextureStreamingStatistics struct count the activity of the texture streaming
+ */
+struct TextureStreamingStatistics
+{
+    /// Video memory of the resident levels, in bytes
+    size_t residentBytes;
+    /// Video memory of the levels needed by the last frame, in bytes (the budget needed to never evict a visible level)
+    size_t requiredBytes;
+    /// Video memory of every level of every streamed texture, in bytes
+    size_t totalBytes;
+    /// Size of the levels read by the background tasks and not uploaded yet, in bytes
+    size_t pendingBytes;
+    /// Size of the levels uploaded during the last frame, in bytes
+    size_t uploadedBytes;
+    /// Number of levels streamed in since the start
+    unsigned int streamedLevels;
+    /// Number of levels evicted since the start
+    unsigned int evictedLevels;
+    /// Number of levels which could not be read
+    unsigned int failedLevels;
+};
+
+
+/**
+ * @brief The TextureStreamer class keep only the mip levels needed on the screen in video memory.
+ *        Textures start with their coarse levels, the meshes request each frame the finest level their texel density on the screen needs,
+ *        and the finer levels are read from the DDS or KTX files by background tasks of the job system, then uploaded at the end of a frame.
+ *        When the resident levels exceed the budget, the levels not needed by the last frame are evicted, least recently used texture first.
+ */
+class TextureStreamer
+{
+// Attributes
+private:
+    /// Streamed textures
+    std::vector<StreamedTexture> textures;
+    /// Index of each streamed texture from its OpenGL id
+    std::map<GLuint, unsigned int> textureIndices;
+    /// Video memory budget of the resident levels, in bytes
+    size_t budget;
+    /// Number of the current frame
+    unsigned int frame;
+    /// Requests of the levels needed by the frame, made by the threads preparing it
+    std::mutex requestMutex;
+
+    // Levels read by the background tasks
+    std::mutex mutex;
+    std::deque<TextureStreamRequest*> completedRequests;
+
+    /// The streamer of the application, created on first use
+    static TextureStreamer* streamer;
+
+public:
+    /// Streaming activity
+    TextureStreamingStatistics statistics;
+
+
+// Constructor
+private:
+
+
+    /**
+     * @brief TextureStreamer create a streamer without texture
+     */
+    TextureStreamer();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief getStreamer return the streamer of the application
+     */
+    static TextureStreamer& getStreamer();
+
+
+    /**
+     * @brief addTexture create a streamed texture from a source image, with only its coarse levels resident.
+     *        The texture is left bound to GL_TEXTURE_2D.
+     * @param sourcePath path of the source image (its DDS or KTX version is streamed, the RGBA8 mip chain is cached when there is none)
+     * @param settings filter, color space, addressing and alpha coverage of the texture (when the mip chain is computed)
+     * @return the id in OpenGL of the texture, 0 when the texture can not be streamed
+     */
+    GLuint addTexture(const std::string& sourcePath, const MipGenerationSettings& settings);
+
+
+    /**
+     * @brief requestTexture request the level of a texture needed by a mesh drawn during the current frame (textures which are not streamed are ignored).
+     *        It can be called by the worker threads preparing the frame, but not while update runs.
+     * @param id id in OpenGL of the texture
+     * @param coordinatesPerPixel texture coordinate units per pixel on the screen (the finest level needed is the one with about one texel per pixel)
+     */
+    void requestTexture(GLuint id, float coordinatesPerPixel);
+
+
+    /**
+     * @brief update upload the levels read since the last frame, evict levels above the budget and request the missing ones.
+     *        Called once at the end of each frame.
+     */
+    void update();
+
+
+    /**
+     * @brief setBudget change the video memory budget of the resident levels (levels are evicted at the next update)
+     * @param bytes budget in bytes
+     */
+    void setBudget(size_t bytes);
+
+
+    /**
+     * @brief getBudget return the video memory budget of the resident levels, in bytes
+     */
+    size_t getBudget() const;
+
+
+    /**
+     * @brief printStatistics print the resident memory, the memory needed by the last frame and the streaming activity
+     */
+    void printStatistics() const;
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief uploadLevels upload the levels read by the background tasks, within the upload limit of a frame
+     */
+    void uploadLevels();
+
+
+    /**
+     * @brief evictLevels evict the levels not needed by the current frame, least recently used texture first,
+     *        until the resident levels and the given size fit in the budget
+     * @param bytes size to make room for
+     * @return false when the levels needed by the current frame do not leave enough room
+     */
+    bool evictLevels(size_t bytes);
+
+
+    /**
+     * @brief requestLevels request the next finer level of each texture below the level needed by the current frame
+     */
+    void requestLevels();
+
+
+    /**
+     * @brief getTargetLevel return the finest level of a texture to keep resident for the current frame
+     */
+    unsigned int getTargetLevel(const StreamedTexture& texture) const;
+
+
+    /**
+     * @brief readLevel read a requested level from its file (body of a background task)
+     */
+    void readLevel(TextureStreamRequest* request);
+};
+
+
+#endif
@@ -0,0 +1,167 @@
+#include "TriangleBVH.h"
+
+
+// =======
+// Methods
+
+void TriangleBVH::build(const std::vector<Mesh>& meshes)
+{
+    std::vector<BVHTriangle> meshTriangles;
+    std::vector<BVHBounds> bounds;
+
+    for(unsigned int m=0; m<meshes.size(); m++)
+    {
+        const Mesh& mesh = meshes[m];
+        const MeshLOD& lod = mesh.lods[0];
+
+        for(unsigned int i=0; i+2<lod.indexCount; i+=3)
+        {
+            BVHTriangle triangle;
+            BVHBounds triangleBounds;
+
+            triangle.vertex0 = mesh.vertices[mesh.indices[lod.indexOffset + i]].position;
+            triangle.vertex1 = mesh.vertices[mesh.indices[lod.indexOffset + i + 1]].position;
+            triangle.vertex2 = mesh.vertices[mesh.indices[lod.indexOffset + i + 2]].position;
+            triangle.mesh = m;
+            triangle.triangle = i / 3;
+            triangleBounds.min = glm::min(triangle.vertex0, glm::min(triangle.vertex1, triangle.vertex2));
+            triangleBounds.max = glm::max(triangle.vertex0, glm::max(triangle.vertex1, triangle.vertex2));
+
+            meshTriangles.push_back(triangle);
+            bounds.push_back(triangleBounds);
+        }
+    }
+
+    this->bvh.build(bounds);
+
+    // Store the triangles in the order of the leaves
+    const std::vector<unsigned int>& order = this->bvh.getPrimitiveIndices();
+    this->triangles.resize(order.size());
+    for(size_t i=0; i<order.size(); i++)
+    {
+        this->triangles[i] = meshTriangles[order[i]];
+    }
+}
+
+
+bool TriangleBVH::intersect(const Ray& ray, RayHit& hit) const
+{
+    RayShear shear = computeRayShear(ray);
+    float tMax = std::min(ray.tMax, hit.t);
+
+    auto intersectLeaf = [&](unsigned int first, unsigned int count, float& leafTMax)
+    {
+        bool leafHit = false;
+        float t = 0.0f;
+        float u = 0.0f;
+        float v = 0.0f;
+
+        for(unsigned int i=first; i<first+count; i++)
+        {
+            if(intersectTriangle(ray, shear, this->triangles[i], leafTMax, &t, &u, &v))
+            {
+                leafTMax = t;
+                hit.t = t;
+                hit.u = u;
+                hit.v = v;
+                hit.mesh = this->triangles[i].mesh;
+                hit.triangle = this->triangles[i].triangle;
+                leafHit = true;
+            }
+        }
+
+        return leafHit;
+    };
+
+    return this->bvh.traverse(ray, tMax, intersectLeaf);
+}
+
+
+size_t TriangleBVH::getTriangleCount() const
+{
+    return this->triangles.size();
+}
+
+
+size_t TriangleBVH::getNodeCount() const
+{
+    return this->bvh.getNodeCount();
+}
+
+
+RayShear TriangleBVH::computeRayShear(const Ray& ray)
+{
+    RayShear shear;
+    glm::vec3 absoluteDirection = glm::abs(ray.direction);
+
+    // Largest component of the direction becomes z
+    shear.kz = (absoluteDirection.x > absoluteDirection.y) ? ((absoluteDirection.x > absoluteDirection.z) ? 0 : 2) : ((absoluteDirection.y > absoluteDirection.z) ? 1 : 2);
+    shear.kx = (shear.kz + 1) % 3;
+    shear.ky = (shear.kx + 1) % 3;
+
+    // Keep the winding of the triangles
+    if(ray.direction[shear.kz] < 0.0f)
+    {
+        std::swap(shear.kx, shear.ky);
+    }
+
+    shear.shearX = ray.direction[shear.kx] / ray.direction[shear.kz];
+    shear.shearY = ray.direction[shear.ky] / ray.direction[shear.kz];
+    shear.shearZ = 1.0f / ray.direction[shear.kz];
+
+    return shear;
+}
+
+
+bool TriangleBVH::intersectTriangle(const Ray& ray, const RayShear& shear, const BVHTriangle& triangle, float tMax, float* t, float* u, float* v)
+{
+    glm::vec3 a = triangle.vertex0 - ray.origin;
+    glm::vec3 b = triangle.vertex1 - ray.origin;
+    glm::vec3 c = triangle.vertex2 - ray.origin;
+
+    // Vertices in the space where the ray is the z axis
+    float ax = a[shear.kx] - shear.shearX * a[shear.kz];
+    float ay = a[shear.ky] - shear.shearY * a[shear.kz];
+    float bx = b[shear.kx] - shear.shearX * b[shear.kz];
+    float by = b[shear.ky] - shear.shearY * b[shear.kz];
+    float cx = c[shear.kx] - shear.shearX * c[shear.kz];
+    float cy = c[shear.ky] - shear.shearY * c[shear.kz];
+
+    // Scaled barycentric coordinates
+    float edgeU = cx * by - cy * bx;
+    float edgeV = ax * cy - ay * cx;
+    float edgeW = bx * ay - by * ax;
+
+    // On an edge : recompute in double precision so that neighbouring triangles agree
+    if(edgeU == 0.0f || edgeV == 0.0f || edgeW == 0.0f)
+    {
+        edgeU = static_cast<float>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+        edgeV = static_cast<float>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+        edgeW = static_cast<float>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+    }
+
+    if((edgeU < 0.0f || edgeV < 0.0f || edgeW < 0.0f) && (edgeU > 0.0f || edgeV > 0.0f || edgeW > 0.0f))
+    {
+        return false;
+    }
+
+    float determinant = edgeU + edgeV + edgeW;
+    if(determinant == 0.0f)
+    {
+        return false;
+    }
+
+    // Scaled distance, compared without division
+    float scaledT = edgeU * shear.shearZ * a[shear.kz] + edgeV * shear.shearZ * b[shear.kz] + edgeW * shear.shearZ * c[shear.kz];
+    if(determinant < 0.0f ? (scaledT > 0.0f || scaledT < tMax * determinant) : (scaledT < 0.0f || scaledT > tMax * determinant))
+    {
+        return false;
+    }
+
+    float inverseDeterminant = 1.0f / determinant;
+    *t = scaledT * inverseDeterminant;
+    *u = edgeV * inverseDeterminant;
+    *v = edgeW * inverseDeterminant;
+
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef __TRIANGLEBVH_H
+#define __TRIANGLEBVH_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <cmath>
+
+// Mesh
+#include "Mesh.h"
+
+// Bounding volume hierarchy
+#include "BVH.h"
+
+
+/**
+ * @brief The BVHTriangle struct store a triangle of a mesh for ray intersection
+ */
+struct BVHTriangle
+{
+    /// Vertices of the triangle
+    glm::vec3 vertex0;
+    glm::vec3 vertex1;
+    glm::vec3 vertex2;
+    /// Index of the mesh of the triangle
+    unsigned int mesh;
+    /// Index of the triangle in the mesh
+    unsigned int triangle;
+};
+
+
+/**
+ * @brief The RayShear struct is the per ray transformation used by the watertight triangle test
+ */
+struct RayShear
+{
+    /// Axes permuted so that kz is the largest component of the direction
+    int kx;
+    int ky;
+    int kz;
+    /// Shear constants
+    float shearX;
+    float shearY;
+    float shearZ;
+};
+
+
+/**
+ * @brief The TriangleBVH class is the bounding volume hierarchy of the full resolution triangles of a model, in model space
+ */
+class TriangleBVH
+{
+// Attributes
+private:
+    /// Triangles in the order of the leaves of the tree
+    std::vector<BVHTriangle> triangles;
+    /// Tree over the triangles
+    BVH bvh;
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief build build the tree over the full resolution level of detail of the given meshes
+     * @param meshes meshes of the model
+     */
+    void build(const std::vector<Mesh>& meshes);
+
+
+    /**
+     * @brief intersect find the closest triangle hit by the ray
+     * @param ray ray in model space
+     * @param hit updated with the closest hit when it is closer than hit.t (hit.instance is not modified)
+     * @return true when a closer hit was found
+     */
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+
+    /**
+     * @brief getTriangleCount return the number of triangles in the tree
+     */
+    size_t getTriangleCount() const;
+
+
+    /**
+     * @brief getNodeCount return the number of 4-wide nodes of the tree
+     */
+    size_t getNodeCount() const;
+
+
+    /**
+     * @brief computeRayShear compute the shear transformation of a ray used by intersectTriangle
+     */
+    static RayShear computeRayShear(const Ray& ray);
+
+
+    /**
+     * @brief intersectTriangle watertight ray/triangle intersection (Woop, Benthin & Wald)
+     * @param ray ray to test
+     * @param shear shear transformation of the ray
+     * @param triangle triangle to test
+     * @param tMax largest distance of interest
+     * @param t filled with the distance of the hit
+     * @param u filled with the barycentric coordinate of vertex1
+     * @param v filled with the barycentric coordinate of vertex2
+     * @return true when the ray hits the triangle between 0 and tMax
+     */
+    static bool intersectTriangle(const Ray& ray, const RayShear& shear, const BVHTriangle& triangle, float tMax, float* t, float* u, float* v);
+};
+
+
+#endif
@@ -0,0 +1,91 @@
+#include "UniformBuffer.h"
+
+
+UniformBufferStatistics UniformBuffer::statistics = { 0, 0 };
+
+
+// ===========
+// Constructor
+
+UniformBuffer::UniformBuffer()
+{
+    this->buffer = 0;
+    this->binding = 0;
+    this->size = 0;
+}
+
+
+// =======
+// Methods
+
+void UniformBuffer::create(GLuint binding, size_t size)
+{
+    this->binding = binding;
+    this->size = size;
+    this->data.clear();
+
+    glGenBuffers(1, &this->buffer);
+    RenderState::bindBuffer(GL_UNIFORM_BUFFER, this->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), NULL, GL_DYNAMIC_DRAW);
+
+    // The buffer stays bound to its binding point, the programs only read it
+    RenderState::bindBufferBase(GL_UNIFORM_BUFFER, this->binding, this->buffer);
+    glCheckError();
+}
+
+
+void UniformBuffer::update(const void* data)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    if(this->buffer == 0)
+    {
+        std::cerr << "[WARNING] in UniformBuffer::update, the buffer of the binding point " << this->binding << " was not created" << std::endl;
+        return;
+    }
+
+    // Frames without camera or light changes leave the buffer as it is
+    if(this->data.size() == this->size && std::memcmp(this->data.data(), bytes, this->size) == 0)
+    {
+        statistics.skippedUpdates++;
+        return;
+    }
+    this->data.assign(bytes, bytes + this->size);
+
+    RenderState::bindBuffer(GL_UNIFORM_BUFFER, this->buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(this->size), bytes);
+    glCheckError();
+    statistics.updates++;
+}
+
+
+void UniformBuffer::bindBlocks(GLuint program)
+{
+    const char* blockNames[] = { FRAME_UNIFORM_BLOCK, LIGHT_UNIFORM_BLOCK };
+    const GLuint blockBindings[] = { FRAME_UNIFORM_BINDING, LIGHT_UNIFORM_BINDING };
+    GLuint blockIndex;
+
+    for(unsigned int i=0; i<sizeof(blockBindings) / sizeof(blockBindings[0]); i++)
+    {
+        // Programs only declare the blocks they use
+        blockIndex = glGetUniformBlockIndex(program, blockNames[i]);
+        if(blockIndex != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(program, blockIndex, blockBindings[i]);
+        }
+    }
+    glCheckError();
+}
+
+
+void UniformBuffer::resetStatistics()
+{
+    statistics.updates = 0;
+    statistics.skippedUpdates = 0;
+}
+
+
+void UniformBuffer::printStatistics()
+{
+    std::cout << "Uniform buffers : " << statistics.updates << " updates, " << statistics.skippedUpdates << " unchanged updates skipped" << std::endl;
+}
@@ -0,0 +1,139 @@
+#ifndef __UNIFORMBUFFER_H
+#define __UNIFORMBUFFER_H
+
+// Includes
+
+#include "ErrorHandling.h"
+
+// STL
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+// Redundant state filtering
+#include "RenderState.h"
+
+// GLM
+#include <glm/glm.hpp>
+
+
+// Name of the uniform block of the camera in the shaders, and its binding point
+#define FRAME_UNIFORM_BLOCK "FrameData"
+#define FRAME_UNIFORM_BINDING 0
+// Name of the uniform block of the light in the shaders, and its binding point
+#define LIGHT_UNIFORM_BLOCK "LightData"
+#define LIGHT_UNIFORM_BINDING 1
+
+
+/**
+ * @brief The FrameUniformData struct is the FrameData uniform block of the shaders (std140 layout), written once per frame
+ */
+struct FrameUniformData
+{
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+    glm::mat4 sceneMatrix;
+    /// mat3 of the shaders, each column is padded to a vec4
+    glm::vec4 normalMatrix[3];
+    /// Position of the camera
+    glm::vec3 viewPos;
+    /// Time of the frame, in the padding of viewPos
+    float time;
+};
+
+
+/**
+ * @brief The LightUniformData struct is the LightData uniform block of the shaders (std140 layout)
+ */
+struct LightUniformData
+{
+    glm::vec3 lightPosition;
+    float lightPositionPadding;
+    glm::vec3 lightColor;
+    float lightColorPadding;
+};
+
+
+/**
+ * @brief The UniformBufferStatistics struct count the writes of the uniform buffers since the last reset
+ */
+struct UniformBufferStatistics
+{
+    /// Number of glBufferSubData calls
+    unsigned int updates;
+    /// Number of writes skipped because the buffer already had the data
+    unsigned int skippedUpdates;
+};
+
+
+/**
+ * @brief The UniformBuffer class store a uniform block shared by all programs, bound at a fixed binding point.
+ *        The programs are linked to the binding points of the blocks when they are built (see bindBlocks).
+ */
+class UniformBuffer
+{
+// Attributes
+private:
+    /// Id in OpenGL of the buffer
+    GLuint buffer;
+    /// Binding point of the block
+    GLuint binding;
+    /// Size of the block, in bytes
+    size_t size;
+    /// Last data written in the buffer
+    std::vector<unsigned char> data;
+
+    /// Writes since the last reset
+    static UniformBufferStatistics statistics;
+
+
+// Constructor
+public:
+
+
+    /**
+     * @brief UniformBuffer create a buffer without storage (see create)
+     */
+    UniformBuffer();
+
+
+// Methods
+public:
+
+
+    /**
+     * @brief create allocate the buffer and bind it to its binding point
+     * @param binding binding point of the block
+     * @param size size of the block, in bytes
+     */
+    void create(GLuint binding, size_t size);
+
+
+    /**
+     * @brief update write the data of the block, skipped when it did not change since the last write
+     * @param data data of the block, of the size given to create
+     */
+    void update(const void* data);
+
+
+    /**
+     * @brief bindBlocks link the uniform blocks used by a program to their binding points
+     * @param program id in OpenGL of the linked program
+     */
+    static void bindBlocks(GLuint program);
+
+
+    /**
+     * @brief resetStatistics set the counters of the writes to 0
+     */
+    static void resetStatistics();
+
+
+    /**
+     * @brief printStatistics print the writes since the last reset
+     */
+    static void printStatistics();
+};
+
+
+#endif
@@ -0,0 +1,176 @@
+#include "VertexCompressor.h"
+
+
+// =======
+// Methods
+
+void VertexCompressor::compressVertices(const std::vector<Vertex>& vertices, const glm::vec3& positionOffset, const glm::vec3& positionScale, std::vector<CompressedVertex>& result)
+{
+    result.resize(vertices.size());
+
+    if(vertices.empty())
+    {
+        return;
+    }
+
+    // One pass per attribute so that each one can be converted 4 at a time
+    compressPositions(vertices.data(), vertices.size(), positionOffset, positionScale, result.data());
+    compressNormals(vertices.data(), vertices.size(), result.data());
+    compressTextureCoordinates(vertices.data(), vertices.size(), result.data());
+}
+
+
+void VertexCompressor::compressIndices(const std::vector<GLuint>& indices, std::vector<GLushort>& result)
+{
+    result.resize(indices.size());
+
+    for(size_t i=0; i<indices.size(); i++)
+    {
+        result[i] = static_cast<GLushort>(indices[i]);
+    }
+}
+
+
+glm::vec2 VertexCompressor::encodeOctahedral(const glm::vec3& normal)
+{
+    float l1Norm = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    glm::vec2 result(0.0f);
+
+    if(l1Norm <= 0.0f)
+    {
+        return result;
+    }
+
+    // Projection on the octahedron |x| + |y| + |z| = 1
+    result = glm::vec2(normal.x, normal.y) / l1Norm;
+
+    // The lower half is folded over the diagonals
+    if(normal.z < 0.0f)
+    {
+        glm::vec2 folded(1.0f - std::fabs(result.y), 1.0f - std::fabs(result.x));
+        result.x = (result.x >= 0.0f) ? folded.x : -folded.x;
+        result.y = (result.y >= 0.0f) ? folded.y : -folded.y;
+    }
+
+    return result;
+}
+
+
+// =================
+// Auxiliary methods
+
+void VertexCompressor::compressPositions(const Vertex* vertices, size_t count, const glm::vec3& positionOffset, const glm::vec3& positionScale, CompressedVertex* result)
+{
+    glm::vec3 inverseScale(0.0f);
+
+    for(int i=0; i<3; i++)
+    {
+        inverseScale[i] = (positionScale[i] > 0.0f) ? 1.0f / positionScale[i] : 0.0f;
+    }
+
+#ifdef VERTEX_COMPRESSION_SSE
+    // x, y, z of one vertex per register (the fourth lane reads normal.x and is multiplied by 0)
+    const __m128 offset = _mm_setr_ps(positionOffset.x, positionOffset.y, positionOffset.z, 0.0f);
+    const __m128 scale = _mm_setr_ps(inverseScale.x * 65535.0f, inverseScale.y * 65535.0f, inverseScale.z * 65535.0f, 0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maximum = _mm_set1_ps(65535.0f);
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    for(size_t i=0; i<count; i++)
+    {
+        __m128 position = _mm_loadu_ps(&vertices[i].position.x);
+        __m128 unorm = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(position, offset), scale), zero), maximum);
+        // Signed saturation only : pack around 0 and flip the sign bit back
+        __m128i quantized = _mm_sub_epi32(_mm_cvtps_epi32(unorm), bias);
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(quantized, quantized), signBit);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(result[i].position), packed);
+    }
+#else
+    for(size_t i=0; i<count; i++)
+    {
+        glm::vec3 unorm = (vertices[i].position - positionOffset) * inverseScale;
+        glm::uint64 packed = glm::packUnorm4x16(glm::vec4(unorm, 0.0f));
+        for(int j=0; j<4; j++)
+        {
+            result[i].position[j] = static_cast<GLushort>(packed >> (16 * j));
+        }
+    }
+#endif
+}
+
+
+void VertexCompressor::compressNormals(const Vertex* vertices, size_t count, CompressedVertex* result)
+{
+    size_t i = 0;
+
+#ifdef VERTEX_COMPRESSION_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minimum = _mm_set1_ps(-1.0f);
+    const __m128 snormScale = _mm_set1_ps(32767.0f);
+    const __m128 epsilon = _mm_set1_ps(1e-20f);
+    GLuint packed[4];
+
+    // 4 normals at a time, one component per register
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_setr_ps(vertices[i].normal.x, vertices[i + 1].normal.x, vertices[i + 2].normal.x, vertices[i + 3].normal.x);
+        __m128 y = _mm_setr_ps(vertices[i].normal.y, vertices[i + 1].normal.y, vertices[i + 2].normal.y, vertices[i + 3].normal.y);
+        __m128 z = _mm_setr_ps(vertices[i].normal.z, vertices[i + 1].normal.z, vertices[i + 2].normal.z, vertices[i + 3].normal.z);
+
+        // Projection on the octahedron
+        __m128 l1Norm = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+        __m128 inverseNorm = _mm_div_ps(one, _mm_max_ps(l1Norm, epsilon));
+        __m128 octX = _mm_mul_ps(x, inverseNorm);
+        __m128 octY = _mm_mul_ps(y, inverseNorm);
+
+        // Fold the lower half (sign of 0 is +1 like in encodeOctahedral)
+        __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+        __m128 foldedX = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, octY)), _mm_and_ps(octX, signMask));
+        __m128 foldedY = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, octX)), _mm_and_ps(octY, signMask));
+        octX = _mm_or_ps(_mm_and_ps(lower, foldedX), _mm_andnot_ps(lower, octX));
+        octY = _mm_or_ps(_mm_and_ps(lower, foldedY), _mm_andnot_ps(lower, octY));
+
+        // 16-bit snorm, x and y interleaved
+        __m128i snormX = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(octX, minimum), one), snormScale));
+        __m128i snormY = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(octY, minimum), one), snormScale));
+        __m128i interleaved = _mm_unpacklo_epi16(_mm_packs_epi32(snormX, snormX), _mm_packs_epi32(snormY, snormY));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packed), interleaved);
+
+        for(int j=0; j<4; j++)
+        {
+            result[i + j].normal = packed[j];
+        }
+    }
+#endif
+
+    for(; i<count; i++)
+    {
+        result[i].normal = glm::packSnorm2x16(encodeOctahedral(vertices[i].normal));
+    }
+}
+
+
+void VertexCompressor::compressTextureCoordinates(const Vertex* vertices, size_t count, CompressedVertex* result)
+{
+    size_t i = 0;
+
+#ifdef VERTEX_COMPRESSION_F16C
+    GLuint packed[2];
+
+    // 2 vertices (4 floats) at a time
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128 textCoords = _mm_setr_ps(vertices[i].textCoords.x, vertices[i].textCoords.y, vertices[i + 1].textCoords.x, vertices[i + 1].textCoords.y);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(packed), _mm_cvtps_ph(textCoords, 0));
+        result[i].textCoords = packed[0];
+        result[i + 1].textCoords = packed[1];
+    }
+#endif
+
+    for(; i<count; i++)
+    {
+        result[i].textCoords = glm::packHalf2x16(vertices[i].textCoords);
+    }
+}
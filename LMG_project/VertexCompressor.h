@@ -0,0 +1,106 @@
+#ifndef __VERTEXCOMPRESSOR_H
+#define __VERTEXCOMPRESSOR_H
+
+// Includes
+
+// STL
+#include <vector>
+#include <cmath>
+
+// SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_COMPRESSION_SSE
+#include <emmintrin.h>
+#endif
+#if defined(__F16C__)
+#define VERTEX_COMPRESSION_F16C
+#include <immintrin.h>
+#endif
+
+// glm
+#include <glm/packing.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Mesh
+#include "Mesh.h"
+
+
+// Largest number of vertices which can be indexed with 16-bit indices
+#define COMPRESSED_MESH_MAX_VERTICES 65536
+
+
+/**
+ * @brief The CompressedVertex struct is the 16 bytes version of Vertex read by the compressed vertex format of the geometry arena
+ */
+struct CompressedVertex
+{
+    /// Position quantized in the bounding box of the model (16-bit unorm x, y, z and padding)
+    GLushort position[4];
+    /// Octahedral encoded normal (two 16-bit snorm)
+    GLuint normal;
+    /// Texture coordinates (two half floats)
+    GLuint textCoords;
+};
+
+
+/**
+ * @brief The VertexCompressor class convert vertices and indices of a mesh into their compressed format.
+ *        Each attribute is converted for the whole vertex buffer at once, 4 values at a time when SSE2 (or F16C) is available,
+ *        the scalar paths use the glm packing functions.
+ */
+class VertexCompressor
+{
+// Methods
+public:
+
+
+    /**
+     * @brief compressVertices convert a vertex buffer into compressed vertices
+     * @param vertices vertex buffer of the mesh
+     * @param positionOffset smallest corner of the box in which positions are quantized
+     * @param positionScale size of the box in which positions are quantized
+     * @param result filled with the compressed vertices
+     */
+    static void compressVertices(const std::vector<Vertex>& vertices, const glm::vec3& positionOffset, const glm::vec3& positionScale, std::vector<CompressedVertex>& result);
+
+
+    /**
+     * @brief compressIndices convert an index buffer into 16-bit indices (every index must be under COMPRESSED_MESH_MAX_VERTICES)
+     * @param indices index buffer of the mesh
+     * @param result filled with the 16-bit indices
+     */
+    static void compressIndices(const std::vector<GLuint>& indices, std::vector<GLushort>& result);
+
+
+    /**
+     * @brief encodeOctahedral project a unit vector on the octahedron and unfold it in the [-1, 1] square
+     * @param normal unit vector
+     * @return the coordinates of the vector in the square
+     */
+    static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+
+
+// Auxiliary methods
+private:
+
+
+    /**
+     * @brief compressPositions quantize the positions of the vertices in 16-bit unorm
+     */
+    static void compressPositions(const Vertex* vertices, size_t count, const glm::vec3& positionOffset, const glm::vec3& positionScale, CompressedVertex* result);
+
+
+    /**
+     * @brief compressNormals encode the normals of the vertices in octahedral 16-bit snorm
+     */
+    static void compressNormals(const Vertex* vertices, size_t count, CompressedVertex* result);
+
+
+    /**
+     * @brief compressTextureCoordinates convert the texture coordinates of the vertices in half floats
+     */
+    static void compressTextureCoordinates(const Vertex* vertices, size_t count, CompressedVertex* result);
+};
+
+
+#endif
@@ -5,14 +5,31 @@
 
 
 #include "Shader.h"
+#include "ShaderVariants.h"
 #include "Model3D.h"
+#include "ImportBenchmark.h"
 #include "Camera.h"
 #include "SkyBox.h"
 #include "HeightMap.h"
 #include "BillBoard.h"
 #include "BillBoardCloud.h"
+#include "MeshletCuller.h"
+#include "GeometryArena.h"
+#include "FrustumCuller.h"
+#include "ScenePicker.h"
+#include "TextureCompressor.h"
+#include "TextureStreamer.h"
+#include "GeometryRetention.h"
+#include "UniformBuffer.h"
+#include "RenderState.h"
+#include "RenderQueue.h"
+#include "JobSystem.h"
+#include "FrameScheduler.h"
+#include "Profiler.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
+// freeglut extensions (context flags)
+#include <GL/freeglut_ext.h>
 
 
 /******************************************************************************
@@ -23,6 +40,9 @@
  ************************* DEFINE AND CONSTANT SECTION ************************
  ******************************************************************************/
 
+// Smallest number of drawables prepared by a job (models and billboards of the cloud)
+#define FRAME_PREPARE_BATCH_SIZE 4
+
 // Screen properties
 int SCR_WIDTH = 1300;
 int SCR_HEIGHT = 1024;
@@ -44,12 +64,15 @@ std::string pathToTextures = pathToSrc + "Textures/";
 
 
 // Shader programs
-Shader shaderProgram;
-Shader glassShader;
+    // - variants of the models (glass is the REFRACTION variant), the terrain and the billboards
+ShaderVariants modelShaders;
+ShaderVariants mapShaders;
+ShaderVariants billBoardShaders;
 Shader skyboxShader;
-Shader mapShader;
-Shader bBoardShader;
-Shader bBoardClourdShader;
+
+// Uniform blocks shared by the shader programs
+UniformBuffer frameUniforms;
+UniformBuffer lightUniforms;
 
 
 // Camera object
@@ -77,6 +100,19 @@ std::vector<Model3D> modelsWithGlassShader;
 Model3D* currentModel;
 int modelIdx = -1;
 bool isModelWithProgramShader = true;
+// Models outside of the view are not drawn
+FrustumCuller frustumCuller;
+// Ray queries on the models (picking)
+ScenePicker scenePicker;
+// Draws of the frame, sorted by state and depth
+RenderQueue renderQueue;
+// Draws prepared by each worker of the job system, appended to the render queue
+std::vector<RenderQueue> workerQueues;
+// Program of each model in the frame (NULL while no variant of its vertex format is compiled)
+std::vector<Shader*> programModelShaders;
+std::vector<Shader*> glassModelShaders;
+// A model of the frame waits for the compiler, the next frame is asked for
+bool shadersPending = false;
 
 // BillBoards
 std::vector<std::string> bbCloudTextures = {
@@ -96,10 +132,9 @@ glm::vec3 lightPosition;
 glm::vec3 lightColor;
 glm::vec3 kd;
 
-// Animation parameters
+// Animation parameters (in milliseconds, from the frame scheduler)
 float deltaTime = 0.0f;
 float currentFrameTime = 0.0f;
-float lastFrameTime = 0.0f;
 
 // Camera dependant matrices & vectors
 glm::mat4 viewMatrix;
@@ -114,6 +149,39 @@ glm::mat4 SceneTransformationMatrix;
  ***************************** TYPE DEFINITION ********************************
  ******************************************************************************/
 
+/**
+ * @brief The ModelDrawData struct is the payload of the draw of a model in the render queue
+ */
+struct ModelDrawData
+{
+    Model3D* model;
+};
+
+/**
+ * @brief The MapDrawData struct is the payload of the draw of the map in the render queue
+ */
+struct MapDrawData
+{
+    glm::mat4 modelMatrix;
+};
+
+/**
+ * @brief The BillBoardDrawData struct is the payload of the draw of a billboard in the render queue
+ */
+struct BillBoardDrawData
+{
+    BillBoard* billBoard;
+    glm::mat4 modelMatrix;
+};
+
+/**
+ * @brief The SkyBoxDrawData struct is the payload of the draw of the skybox in the render queue
+ */
+struct SkyBoxDrawData
+{
+    glm::mat4 modelMatrix;
+};
+
 /******************************************************************************
 ***************************** METHOD DEFINITION ******************************
 ******************************************************************************/
@@ -123,7 +191,6 @@ glm::mat4 SceneTransformationMatrix;
  ******************************************************************************/
 
 void display();
-void idle( void );
 void mousePassiveEventWithRedisplay(int x, int y);
 bool initialize();
 bool checkExtensions();
@@ -131,6 +198,17 @@ bool finalize();
 void mousePressedEvent(int button, int state, int x, int y);
 void mousePassiveEvent(int mousePositionX, int mousePositionY);
 void keyPressedEvent(unsigned char key, int x, int y);
+float getViewDepth(const glm::mat4& modelMatrix, const glm::vec3& position);
+unsigned long long getModelKey(const Model3D& model, const Shader& shader);
+unsigned long long getBillBoardKey(const BillBoard& billBoard, const Shader& shader, const glm::mat4& modelMatrix);
+void drawMap(Shader& shader, const void* payload);
+void drawModel(Shader& shader, const void* payload);
+void drawGlassModel(Shader& shader, const void* payload);
+void drawBillBoard(Shader& shader, const void* payload);
+void drawSkyBox(Shader& shader, const void* payload);
+void prepareFrame(const glm::mat4& billBoardModelMatrix);
+void prepareModel(RenderQueue& queue, Model3D& model, Shader* shader, RenderFunction function);
+void prepareBillBoard(RenderQueue& queue, BillBoard& billBoard, Shader& shader, const glm::mat4& modelMatrix);
 
 
 /******************************************************************************
@@ -216,6 +294,46 @@ void currentModelUpdate(){
 }
 
 
+//--------------------------------------------
+
+void updateScenePicker(){
+
+    std::vector<Model3D*> models;
+
+    // Models with the program shader first, then models with the glass shader
+    for(unsigned int i=0; i<modelsWithProgrammShader.size(); i++){
+        models.push_back(&modelsWithProgrammShader[i]);
+    }
+    for(unsigned int i=0; i<modelsWithGlassShader.size(); i++){
+        models.push_back(&modelsWithGlassShader[i]);
+    }
+    scenePicker.build(models);
+}
+
+//--------------------------------------------
+
+void pickModel(int x, int y){
+
+    Ray ray = ScenePicker::computeCameraRay(x, y, SCR_WIDTH, SCR_HEIGHT, viewMatrix, projectionMatrix);
+    RayHit hit;
+
+    ray_origin = ray.origin;
+    ray_direction = glm::normalize(ray.direction);
+
+    updateScenePicker();
+    if(!scenePicker.intersect(ray, hit)){
+        return;
+    }
+
+    // Select the model under the cursor
+    currentModel = scenePicker.getModel(hit.instance);
+    isModelWithProgramShader = (hit.instance < static_cast<int>(modelsWithProgrammShader.size()));
+    modelIdx = isModelWithProgramShader ? hit.instance : hit.instance - static_cast<int>(modelsWithProgrammShader.size());
+    std::cout << " PICKED : " << isModelWithProgramShader << " ID " << modelIdx << " mesh " << hit.mesh << " triangle " << hit.triangle
+              << " at " << glm::length(ray.direction) * hit.t << std::endl;
+}
+
+
 /******************************************************************************
  * Callback to retrieve user's inputs
  ******************************************************************************/
@@ -233,6 +351,7 @@ void mousePressedEvent(int button, int state, int x, int y)
                         leftMouseButtonDown = true;
                         lastMousePositionX = x;
                         lastMousePositionY = y;
+                        pickModel(x, y);
                     }
 
                 }
@@ -285,6 +404,7 @@ void mousePressedEvent(int button, int state, int x, int y)
                 break;
         }
 
+        glutPostRedisplay();
 }
 
 //--------------------------------------------
@@ -335,6 +455,11 @@ void mousePassiveEvent(int mousePositionX, int mousePositionY)
         }
     }
 
+    // The camera moved
+    if(rightMouseButtonDown || middleMouseButtonDown)
+    {
+        glutPostRedisplay();
+    }
 }
 
 //--------------------------------------------
@@ -355,6 +480,109 @@ void keyPressedEvent(unsigned char key, int x, int y)
         case 'd' :
             camera.processKeyboard(RIGHT, deltaTime);
             break;
+        case 'c' :
+            // Print the meshlet culling of the last frame
+            MeshletCuller::printStatistics();
+            break;
+        case 'v' :
+            // Toggle back facing meshlets culling
+            Model3D::viewParameters.meshletConeCulling = !Model3D::viewParameters.meshletConeCulling;
+            break;
+        case 'g' :
+            // Print the geometry submissions of the last frame
+            GeometryArena::printStatistics();
+            break;
+        case 'f' :
+            // Print the frustum culling of the last frame
+            FrustumCuller::printStatistics();
+            break;
+        case 't' :
+            // Print the resident texture levels and the streaming activity
+            TextureStreamer::getStreamer().printStatistics();
+            break;
+        case '+' :
+            // Double the video memory budget of the streamed textures
+            TextureStreamer::getStreamer().setBudget(TextureStreamer::getStreamer().getBudget() * 2);
+            TextureStreamer::getStreamer().printStatistics();
+            break;
+        case '-' :
+            // Halve the video memory budget of the streamed textures
+            TextureStreamer::getStreamer().setBudget(TextureStreamer::getStreamer().getBudget() / 2);
+            TextureStreamer::getStreamer().printStatistics();
+            break;
+        case 'r' :
+            // Print the geometry kept in RAM after the upload
+            GeometryRetention::printStatistics();
+            break;
+        case 'u' :
+            // Print the uniform uploads of the last frame
+            Shader::printStatistics();
+            UniformBuffer::printStatistics();
+            break;
+        case 'e' :
+            // Print the state changes of the last frame sent to OpenGL and elided
+            RenderState::printStatistics();
+            break;
+        case 'n' :
+            // Print the packets of the render queue of the last frame
+            RenderQueue::printStatistics();
+            break;
+        case 'x' :
+            // Print the GL errors of each call site
+            errorHandling::printErrors();
+            break;
+        case 'k' :
+            // Use the next GL error policy (debug output, check all, sampled, ignore)
+            errorHandling::setPolicy(static_cast<GLErrorPolicy>((errorHandling::policy + 1) % (IGNORE_ERROR_POLICY + 1)));
+            errorHandling::printErrors();
+            break;
+        case 'b' :
+            // Trace one ray per pixel against the models
+            updateScenePicker();
+            scenePicker.benchmark(SCR_WIDTH, SCR_HEIGHT, viewMatrix, projectionMatrix);
+            break;
+        case 'j' :
+            // Print the jobs executed and stolen by each worker during the last frame
+            JobSystem::getJobSystem().printStatistics();
+            break;
+        case 'h' :
+            // Measure the cost of a job and the scaling of a parallel loop from 1 to all the workers
+            JobSystem::getJobSystem().benchmark();
+            break;
+        case 'p' :
+            // Print the frame interval, the CPU time and the waits since the last print
+            FrameScheduler::getScheduler().printStatistics();
+            FrameScheduler::getScheduler().resetStatistics();
+            break;
+        case 'o' :
+            // Use the next frame rate cap (none, 30, 60, 120 frames per second)
+            FrameScheduler::getScheduler().setFrameRateCap((FrameScheduler::getScheduler().getFrameRateCap() == 0.0f) ? 30.0f :
+                (FrameScheduler::getScheduler().getFrameRateCap() >= 120.0f) ? 0.0f : FrameScheduler::getScheduler().getFrameRateCap() * 2.0f);
+            FrameScheduler::getScheduler().printStatistics();
+            break;
+        case 'i' :
+            // Use the next number of frames in flight (1 to FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT)
+            FrameScheduler::getScheduler().setMaxFramesInFlight(FrameScheduler::getScheduler().getMaxFramesInFlight() % FRAME_MAX_FRAMES_IN_FLIGHT_LIMIT + 1);
+            FrameScheduler::getScheduler().printStatistics();
+            break;
+        case 'y' :
+            // Toggle the synchronization of the swap with the vertical blank
+            FrameScheduler::getScheduler().setVSync(!FrameScheduler::getScheduler().isVSync());
+            FrameScheduler::getScheduler().printStatistics();
+            break;
+        case 'a' :
+            // Toggle the redraw at the target rate when nothing changes
+            FrameScheduler::getScheduler().setContinuousRedraw(!FrameScheduler::getScheduler().isContinuousRedraw());
+            FrameScheduler::getScheduler().printStatistics();
+            break;
+        case 'w' :
+            // Print the CPU and GPU time of each profiled scope of the last measured frame
+            Profiler::getProfiler().printSummary();
+            break;
+        case 'm' :
+            // Write the profiled scopes of the loading and of the last frames for chrome://tracing or Perfetto
+            Profiler::getProfiler().writeTrace(PROFILER_TRACE_PATH);
+            break;
     }
 
     glutPostRedisplay();
@@ -429,295 +657,368 @@ void specialKeyPressedEvent(int key, int x, int y){
         break;
         default : break;
     }
+
+    glutPostRedisplay();
 }
 
 
 /******************************************************************************
- * Callback to display the scene
+ * Sort keys and draw functions of the render queue
  ******************************************************************************/
-void display( void )
+float getViewDepth(const glm::mat4& modelMatrix, const glm::vec3& position)
 {
-    glEnable(GL_DEPTH_TEST);
-    // Timer info
-    currentFrameTime = static_cast<float>(glutGet( GLUT_ELAPSED_TIME ));
-    // Get delta time
-    deltaTime = currentFrameTime - lastFrameTime;
-    lastFrameTime = currentFrameTime;
+    return -(viewMatrix * SceneTransformationMatrix * modelMatrix * glm::vec4(position, 1.0f)).z;
+}
 
-    //--------------------
-    // START frame
-    //--------------------
-    // Clear the color buffer (of the main framebuffer)
-    // - color used to clear
-    glClearColor( 0.f, 0.f, 0.f, 0.f );
-    glClearDepth( 1.f );
-    // - clear the "color" framebuffer
-    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
+unsigned long long getModelKey(const Model3D& model, const Shader& shader)
+{
+    // Meshes of the same vertex format share the vertex array of their geometry arena
+    float depth = getViewDepth(model.getLocalTransformationMatrix(), model.boundingSphereCenter);
 
-    //--------------------
-    // Send uniforms to GPU
-    //--------------------
+    return RenderQueue::makeKey(OPAQUE_RENDER_PASS, shader._shaderId, model.getMaterialKey(), model.getVertexFormat(), depth);
+}
 
 
+unsigned long long getBillBoardKey(const BillBoard& billBoard, const Shader& shader, const glm::mat4& modelMatrix)
+{
+    return RenderQueue::makeKey(TRANSPARENT_RENDER_PASS, shader._shaderId, billBoard.getTextureID(), POSITION_VERTEX_FORMAT, getViewDepth(modelMatrix, billBoard.getCenter()));
+}
 
-    // Retrieve camera parameters
-    viewMatrix = camera.getViewMatrix();
-    projectionMatrix = glm::perspective( glm::radians(45.0f), static_cast<float>(SCR_WIDTH/SCR_HEIGHT), 0.1f, 100.0f );
 
-//    modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f));
-//    modelMatrix = glm::rotate(modelMatrix, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-//    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 1.0f, 0.0f));
+void drawMap(Shader& shader, const void* payload)
+{
+    const MapDrawData& data = *static_cast<const MapDrawData*>(payload);
 
+    shader.setMat4("mapModelMatrix", data.modelMatrix);
+    map.draw(shader, "texture_diffuse", texture);
+}
 
 
+void drawModel(Shader& shader, const void* payload)
+{
+    const ModelDrawData& data = *static_cast<const ModelDrawData*>(payload);
 
-//    const bool useMeshAnimation = true; // TODO: use keyboard to activate/deactivate
-//    if ( useMeshAnimation )
-//    {
-//        modelMatrix = glm::rotate( modelMatrix, static_cast< float >( currentFrameTime ) * 0.001f, glm::vec3( 0.0f, 1.f, 0.f ) );
-//    }
+    // - material
+    shader.setVec3("kd", kd);
+    // - model matrix
+    shader.setMat4("modelMatrix", data.model->getLocalTransformationMatrix());
+    if(isSkyboxActive)
+    {
+        data.model->draw(shader, skybox.textureID);
+    }
+    else
+    {
+        data.model->draw(shader);
+    }
+}
 
 
+void drawGlassModel(Shader& shader, const void* payload)
+{
+    const ModelDrawData& data = *static_cast<const ModelDrawData*>(payload);
 
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f));
-    modelMatrix = glm::rotate(modelMatrix, 1.8f, glm::vec3(0.0f, 1.0f, 0.0f));
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(8.0f, 1.0f, 0.0f));
-    // Lighting
-    // - normalMatrix
-    normalMatrix = glm::transpose(glm::inverse(viewMatrix*modelMatrix));
-    // - Material
-    kd = glm::vec3(1.0, 0.0, 0.0);
-    // - lightColor
-    lightColor = glm::vec3(1.0, 1.0, 1.0);
-    // - lightPosition
-    lightPosition = glm::vec3(1.0, 350.0, 0.0);
-    // Mesh color
-    _meshColor = glm::vec3( 0.f, 1.f, 0.f );
+    // - refraction ratio
+    shader.setFloat("refractionRatio", (1.0f/2.42f));
+    // - model matrix
+    shader.setMat4("modelMatrix", data.model->getLocalTransformationMatrix());
+    if(isSkyboxActive)
+    {
+        data.model->draw(shader, skybox.textureID);
+    }
+    else
+    {
+        data.model->draw(shader);
+    }
+}
 
 
-    //--------------------
-    // Activate map shader program
-    //--------------------
-    mapShader.use();
-    // Camera
-    // - view matrix
-    mapShader.setMat4("viewMatrix", viewMatrix);
-    // - projection matrix
-    mapShader.setMat4("projectionMatrix", projectionMatrix);
-    // - scene transformation matrix
-    mapShader.setMat4("sceneMatrix", SceneTransformationMatrix);
-    // - cameraPosition
-    mapShader.setVec3("viewPos", camera.cameraPosition);
-
-    // Lighting
-    // - normalMatrix
-    mapShader.setMat3("normalMatrix", normalMatrix);
-    // - lightPosition
-    mapShader.setVec3("lightPosition", lightPosition);
-    // - lightColor
-    mapShader.setVec3("lightColor", lightColor);
-
-    // Scale map
-    modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 0.1f, 1.0f));
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(-100.0f, -180.0f, -100.0f));
+void drawBillBoard(Shader& shader, const void* payload)
+{
+    const BillBoardDrawData& data = *static_cast<const BillBoardDrawData*>(payload);
 
-    mapShader.setMat4("mapModelMatrix", modelMatrix);
+    shader.setMat4("modelMatrix", data.modelMatrix);
+    data.billBoard->draw(shader, "texture_diffuse");
+}
 
-    //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
-    map.draw(mapShader, "texture_diffuse", texture);
+void drawSkyBox(Shader& shader, const void* payload)
+{
+    const SkyBoxDrawData& data = *static_cast<const SkyBoxDrawData*>(payload);
 
-    //glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+    skybox.draw(shader, data.modelMatrix);
+}
 
 
+/******************************************************************************
+ * Prepare phase of the frame : the workers of the job system cull the models, select their
+ * meshes and build the packets of the models and of the billboards of the cloud,
+ * each one in its own render queue (no OpenGL call)
+ ******************************************************************************/
+void prepareFrame(const glm::mat4& billBoardModelMatrix)
+{
+    JobSystem& jobSystem = JobSystem::getJobSystem();
+    unsigned int environmentFeatures = isSkyboxActive ? SKYBOX_REFLECTION_FEATURE : 0;
+    unsigned int programModelCount = static_cast<unsigned int>(modelsWithProgrammShader.size());
+    unsigned int glassModelCount = static_cast<unsigned int>(modelsWithGlassShader.size());
+    std::vector<BillBoard>& cloudBillBoards = bBcloud.getBillBoards();
+
+    // The slots of the bounds and the programs of the variants are chosen by the GL thread, the workers only fill and read them.
+    // A variant still compiling (the skybox was toggled) is replaced by a ready one of the same vertex format, the first use never waits for the compiler
+    frustumCuller.begin(projectionMatrix * viewMatrix);
+    shadersPending = false;
+    programModelShaders.resize(programModelCount);
+    glassModelShaders.resize(glassModelCount);
+    for(unsigned int i=0; i<programModelCount; i++)
+    {
+        unsigned int features = modelsWithProgrammShader[i].getShaderFeatures();
 
-    //--------------------
-    // Activate shader program
-    //--------------------
-    shaderProgram.use();
-    // Camera
-    // - view matrix
-    shaderProgram.setMat4("viewMatrix", viewMatrix);
-    // - projection matrix
-    shaderProgram.setMat4("projectionMatrix", projectionMatrix);
-    // - scene transformation matrix
-    shaderProgram.setMat4("sceneMatrix", SceneTransformationMatrix);
-    // - cameraPosition
-    shaderProgram.setVec3("viewPos", camera.cameraPosition);
-
-    // Mesh
-    // Animation
-    shaderProgram.setFloat("time", static_cast< float >( currentFrameTime ) );
-
-    // Lighting
-    // - normalMatrix
-    shaderProgram.setMat3("normalMatrix", normalMatrix);
-    // - Material
-    shaderProgram.setVec3("kd", kd);
-    // - lightPosition
-    shaderProgram.setVec3("lightPosition", lightPosition);
-    // - lightColor
-    shaderProgram.setVec3("lightColor", lightColor);
+        modelsWithProgrammShader[i].reserveBounds(frustumCuller);
+        programModelShaders[i] = modelShaders.getReady(features | environmentFeatures, features);
+        shadersPending = shadersPending || (programModelShaders[i] != &modelShaders.get(features | environmentFeatures));
+    }
+    for(unsigned int i=0; i<glassModelCount; i++)
+    {
+        unsigned int features = modelsWithGlassShader[i].getShaderFeatures();
 
-    //--------------------
-    // Render scene
-    //--------------------
-    // Set GL state(s) (fixed pipeline)
-    //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
+        modelsWithGlassShader[i].reserveBounds(frustumCuller);
+        glassModelShaders[i] = modelShaders.getReady(features | REFRACTION_FEATURE, features);
+        shadersPending = shadersPending || (glassModelShaders[i] != &modelShaders.get(features | REFRACTION_FEATURE));
+    }
+    // - the billboards of the cloud do not face the camera
+    Shader& bBoardCloudShader = billBoardShaders.get(0);
 
-    // Call draw method on each model (with programmShader as shader)
-    if(!isSkyboxActive)
+    workerQueues.resize(jobSystem.getWorkerCount());
+    jobSystem.parallelForRange(programModelCount + glassModelCount + static_cast<unsigned int>(cloudBillBoards.size()), FRAME_PREPARE_BATCH_SIZE,
+                               [&](unsigned int first, unsigned int last)
     {
-        for(unsigned int i=0; i<modelsWithProgrammShader.size(); i++)
+        // Each batch is a scope on the track of the worker which ran it
+        PROFILE_SCOPE("Drawable preparation");
+        unsigned int worker = static_cast<unsigned int>(JobSystem::getWorkerIndex());
+
+        for(unsigned int index=first; index<last; index++)
         {
-            // - model matrix
-            shaderProgram.setMat4("modelMatrix",  modelsWithProgrammShader[i].getLocalTransformationMatrix());
-            modelsWithProgrammShader[i].draw(shaderProgram);
+            // Each model is drawn by the variant of its vertex format, which only samples the skybox when it is shown, glass models refract it
+            if(index < programModelCount)
+            {
+                prepareModel(workerQueues[worker], modelsWithProgrammShader[index], programModelShaders[index], drawModel);
+            }
+            else if(index < programModelCount + glassModelCount)
+            {
+                prepareModel(workerQueues[worker], modelsWithGlassShader[index - programModelCount], glassModelShaders[index - programModelCount], drawGlassModel);
+            }
+            else
+            {
+                prepareBillBoard(workerQueues[worker], cloudBillBoards[index - programModelCount - glassModelCount], bBoardCloudShader, billBoardModelMatrix);
+            }
         }
-    }
-    else
+    });
+}
+
+
+void prepareModel(RenderQueue& queue, Model3D& model, Shader* shader, RenderFunction function)
+{
+    ModelDrawData modelData;
+
+    if(shader == NULL || !model.cull(frustumCuller))
     {
-        for(unsigned int i=0; i<modelsWithProgrammShader.size(); i++)
-        {
-            // - model matrix
-            shaderProgram.setMat4("modelMatrix",  modelsWithProgrammShader[i].getLocalTransformationMatrix());
-            modelsWithProgrammShader[i].draw(shaderProgram, skybox.textureID);
-        }
+        return;
     }
+    model.prepareMeshes();
+
+    modelData.model = &model;
+    queue.submit(getModelKey(model, *shader), *shader, function, modelData);
+}
 
 
+void prepareBillBoard(RenderQueue& queue, BillBoard& billBoard, Shader& shader, const glm::mat4& modelMatrix)
+{
+    BillBoardDrawData billBoardData;
+
+    billBoardData.billBoard = &billBoard;
+    billBoardData.modelMatrix = modelMatrix;
+    queue.submit(getBillBoardKey(billBoard, shader, modelMatrix), shader, drawBillBoard, billBoardData);
+}
+
+
+/******************************************************************************
+ * Callback to display the scene
+ ******************************************************************************/
+void display( void )
+{
+    errorHandling::beginFrame();
+
+    // Wait for the frame rate cap and for the GPU to finish the oldest frame in flight, then read the time of the frame
+    // (the waits are measured by the frame scheduler)
+    FrameScheduler::getScheduler().beginFrame();
+    currentFrameTime = FrameScheduler::getScheduler().getTime();
+    deltaTime = FrameScheduler::getScheduler().getDeltaTime();
+
+    // After the fence wait, the GPU results of the oldest slot of the profiler are available
+    Profiler::getProfiler().beginFrame();
+
     //--------------------
-    // Activate glass shader program
+    // START frame
     //--------------------
-    glassShader.use();
-    // Camera
-    // - view matrix
-    glassShader.setMat4("viewMatrix", viewMatrix);
-    // - projection matrix
-    glassShader.setMat4("projectionMatrix", projectionMatrix);
-    // - scene transformation matrix
-    glassShader.setMat4("sceneMatrix", SceneTransformationMatrix);
-    // - cameraPosition
-    glassShader.setVec3("viewPos", camera.cameraPosition);
-
-    // Lighting
-    // - normalMatrix
-    glassShader.setMat3("normalMatrix", normalMatrix);
-    // - refraction ratio
-    glassShader.setFloat("refractionRatio", (1.0f/2.42f));
+    {
+        PROFILE_GPU_SCOPE("Clear");
+        // Clear the color buffer (of the main framebuffer)
+        // - color used to clear
+        glClearColor( 0.f, 0.f, 0.f, 0.f );
+        glClearDepth( 1.f );
+        // - clear the "color" framebuffer
+        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    }
 
 
     //--------------------
-    // Render scene
+    // Send uniforms to GPU
     //--------------------
-    // Set GL state(s) (fixed pipeline)
-    //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
-    // Call draw method on each model (with programmShader as shader)
-    if(!isSkyboxActive)
-    {
-        for(unsigned int i=0; i<modelsWithGlassShader.size(); i++)
-        {
-            // - model matrix
-            shaderProgram.setMat4("modelMatrix",  modelsWithGlassShader[i].getLocalTransformationMatrix());
-            modelsWithGlassShader[i].draw(glassShader);
-        }
-    }
-    else
+
+
     {
-        for(unsigned int i=0; i<modelsWithGlassShader.size(); i++)
+        PROFILE_GPU_SCOPE("Uniforms");
+        // Retrieve camera parameters
+        viewMatrix = camera.getViewMatrix();
+        projectionMatrix = glm::perspective( glm::radians(45.0f), static_cast<float>(SCR_WIDTH/SCR_HEIGHT), 0.1f, 100.0f );
+        // Levels of detail and meshlets of the models are selected with the camera
+        Model3D::setViewParameters(camera.cameraPosition, viewMatrix, SceneTransformationMatrix, projectionMatrix, SCR_HEIGHT);
+        MeshletCuller::resetStatistics();
+        GeometryArena::resetStatistics();
+        FrustumCuller::resetStatistics();
+        Shader::resetStatistics();
+        UniformBuffer::resetStatistics();
+        RenderState::resetStatistics();
+        RenderQueue::resetStatistics();
+        JobSystem::getJobSystem().resetStatistics();
+
+    //    modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f));
+    //    modelMatrix = glm::rotate(modelMatrix, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    //    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 1.0f, 0.0f));
+
+
+
+
+    //    const bool useMeshAnimation = true; // TODO: use keyboard to activate/deactivate
+    //    if ( useMeshAnimation )
+    //    {
+    //        modelMatrix = glm::rotate( modelMatrix, static_cast< float >( currentFrameTime ) * 0.001f, glm::vec3( 0.0f, 1.f, 0.f ) );
+    //    }
+
+
+
+        glm::mat4 modelMatrix = glm::mat4(1.0f);
+        modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f));
+        modelMatrix = glm::rotate(modelMatrix, 1.8f, glm::vec3(0.0f, 1.0f, 0.0f));
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(8.0f, 1.0f, 0.0f));
+        // Lighting
+        // - normalMatrix
+        normalMatrix = glm::transpose(glm::inverse(viewMatrix*modelMatrix));
+        // - Material
+        kd = glm::vec3(1.0, 0.0, 0.0);
+        // - lightColor
+        lightColor = glm::vec3(1.0, 1.0, 1.0);
+        // - lightPosition
+        lightPosition = glm::vec3(1.0, 350.0, 0.0);
+        // Mesh color
+        _meshColor = glm::vec3( 0.f, 1.f, 0.f );
+
+        // Camera, scene and light of the frame, read by all shader programs from their uniform blocks
+        FrameUniformData frameData;
+        frameData.viewMatrix = viewMatrix;
+        frameData.projectionMatrix = projectionMatrix;
+        frameData.sceneMatrix = SceneTransformationMatrix;
+        for(int i=0; i<3; i++)
         {
-            // - model matrix
-            shaderProgram.setMat4("modelMatrix",  modelsWithGlassShader[i].getLocalTransformationMatrix());
-            modelsWithGlassShader[i].draw(glassShader, skybox.textureID);
+            frameData.normalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
         }
+        frameData.viewPos = camera.cameraPosition;
+        frameData.time = currentFrameTime;
+        frameUniforms.update(&frameData);
+
+        LightUniformData lightData;
+        lightData.lightPosition = lightPosition;
+        lightData.lightPositionPadding = 0.0f;
+        lightData.lightColor = lightColor;
+        lightData.lightColorPadding = 0.0f;
+        lightUniforms.update(&lightData);
     }
 
-    // Draw billboards
-    //--------------------
-    // Activate billboard shader program
-    //--------------------
-    bBoardShader.use();
-    // Camera
-    // - view matrix
-    bBoardShader.setMat4("viewMatrix", viewMatrix);
-    // - projection matrix
-    bBoardShader.setMat4("projectionMatrix", projectionMatrix);
-    // - scene transformation matrix
-    bBoardShader.setMat4("sceneMatrix", SceneTransformationMatrix);
-    // - model matrix
-    modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.015f, 0.015f, 0.015f));
-    //modelMatrix = glm::rotate(modelMatrix, 1.0f, glm::vec3(0.0f, 0.0f, 1.0f));
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-    bBoardShader.setMat4("modelMatrix", modelMatrix);
 
-    bBoard.draw(bBoardShader, "texture_diffuse");
-
-
-    // Draw billboardsCloud
     //--------------------
-    // Activate billboard shader program
+    // Render scene
     //--------------------
-    bBoardClourdShader.use();
-    // Camera
-    // - view matrix
-    bBoardClourdShader.setMat4("viewMatrix", viewMatrix);
-    // - projection matrix
-    bBoardClourdShader.setMat4("projectionMatrix", projectionMatrix);
-    // - scene transformation matrix
-    bBoardClourdShader.setMat4("sceneMatrix", SceneTransformationMatrix);
-    // - model matrix
-    modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.015f, 0.015f, 0.015f));
-    //modelMatrix = glm::rotate(modelMatrix, 1.0f, glm::vec3(0.0f, 0.0f, 1.0f));
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-    bBoardClourdShader.setMat4("modelMatrix", modelMatrix);
-
-
-    bBcloud.draw(bBoardShader, "texture_diffuse");
-
+    // Each drawable submits a packet to the render queue, which draws them sorted by pass, program, textures, vertex array and depth
 
+    {
+        PROFILE_SCOPE("Render queue submission");
+        // Map
+        Shader& mapShader = mapShaders.get(TEXTURED_FEATURE);
+        MapDrawData mapData;
+        mapData.modelMatrix = glm::mat4(1.0f);
+        mapData.modelMatrix = glm::scale(mapData.modelMatrix, glm::vec3(1.0f, 0.1f, 1.0f));
+        mapData.modelMatrix = glm::translate(mapData.modelMatrix, glm::vec3(-100.0f, -180.0f, -100.0f));
+        // - the terrain is a single draw around the camera, it is drawn before the models sharing its state
+        renderQueue.submit(RenderQueue::makeKey(OPAQUE_RENDER_PASS, mapShader._shaderId, map.getColorTextureID(), MESH_VERTEX_FORMAT, 0.0f), mapShader, drawMap, mapData);
+
+        // Billboards, blended back to front
+        BillBoardDrawData billBoardData;
+        billBoardData.modelMatrix = glm::mat4(1.0f);
+        billBoardData.modelMatrix = glm::scale(billBoardData.modelMatrix, glm::vec3(0.015f, 0.015f, 0.015f));
+        billBoardData.modelMatrix = glm::translate(billBoardData.modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
+        // - the billboard faces the camera
+        Shader& bBoardShader = billBoardShaders.get(FACE_CAMERA_FEATURE);
+        billBoardData.billBoard = &bBoard;
+        renderQueue.submit(getBillBoardKey(bBoard, bBoardShader, billBoardData.modelMatrix), bBoardShader, drawBillBoard, billBoardData);
+
+        // Skybox
+        if(isSkyboxActive)
+        {
+            SkyBoxDrawData skyBoxData;
+            skyBoxData.modelMatrix = glm::mat4(1.0f);
+            skyBoxData.modelMatrix = glm::scale(skyBoxData.modelMatrix, glm::vec3(1000.0f, 1000.0f, 1000.0f));
+            skyBoxData.modelMatrix = glm::translate(skyBoxData.modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
+            renderQueue.submit(RenderQueue::makeKey(SKY_RENDER_PASS, skyboxShader._shaderId, skybox.textureID, POSITION_VERTEX_FORMAT, 0.0f), skyboxShader, drawSkyBox, skyBoxData);
+        }
 
-    // Draw skybox
+        // Models and billboards of the cloud, prepared by the workers of the job system, then gathered by the GL thread
+        {
+            PROFILE_SCOPE("Frame preparation");
+            prepareFrame(billBoardData.modelMatrix);
+        }
+        for(unsigned int i=0; i<workerQueues.size(); i++)
+        {
+            renderQueue.append(workerQueues[i]);
+        }
+    }
 
-    if(isSkyboxActive)
     {
-        // Scale skybox
-        modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(1000.0f, 1000.0f, 1000.0f));
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-
-        // draw skybox
-        skybox.draw(skyboxShader, viewMatrix, projectionMatrix, modelMatrix);
+        PROFILE_GPU_SCOPE("Render queue execution");
+        renderQueue.execute();
     }
 
     // Reset GL state(s) (fixed pipeline)
     //glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
 
-    // Deactivate current shader program
-    glUseProgram( 0 );
+    // Upload the texture levels read since the last frame and request the ones needed by this frame
+    {
+        PROFILE_GPU_SCOPE("Texture streaming");
+        TextureStreamer::getStreamer().update();
+    }
 
 
     //--------------------
     // END frame
     //--------------------
-    // OpenGL commands are not synchrone, but asynchrone (stored in a "command buffer")
-    glFlush();
-    // Swap buffers for "double buffering" display mode (=> swap "back" and "front" framebuffers)
-    glutSwapBuffers();
-}
-
-/******************************************************************************
- * Callback continuously called when events are not being received
- ******************************************************************************/
-void idle( void )
-{
-    // Mark current window as needing to be redisplayed
-    glutPostRedisplay();
+    // Swap buffers for "double buffering" display mode (=> swap "back" and "front" framebuffers), which also flushes the commands
+    {
+        PROFILE_GPU_SCOPE("Swap");
+        glutSwapBuffers();
+    }
+    Profiler::getProfiler().endFrame();
+    // Fence of the frame, and next frame while texture levels are streaming in or a model waits for its program
+    FrameScheduler::getScheduler().endFrame(TextureStreamer::getStreamer().statistics.pendingBytes > 0 || shadersPending);
 }
 
 /******************************************************************************
@@ -727,11 +1028,46 @@ int main( int argc, char** argv )
 {
     std::cout << "LMG Project" << std::endl;
 
+    // The main thread, which owns the GL context, is the worker 0 of the job system
+    JobSystem::getJobSystem();
+    // The times of the profiled scopes start here
+    Profiler::getProfiler();
+
+    // Offline texture compression, without window : LMG_project --compress-textures [bc1|bc3|bc5|bc7|auto] image...
+    if(argc > 1 && std::string(argv[1]) == "--compress-textures")
+    {
+        TextureCompressionFormat format = AUTO_TEXTURE_FORMAT;
+        std::vector<std::string> sourcePaths;
+        int first = 2;
+
+        if(argc > 2 && TextureCompressor::parseFormat(argv[2], &format))
+        {
+            first = 3;
+        }
+        for(int i=first; i<argc; i++)
+        {
+            sourcePaths.push_back(argv[i]);
+        }
+
+        return (TextureCompressor::compressFiles(sourcePaths, format) == 0) ? 0 : 1;
+    }
+
+    // Import of a synthetic scene, without window : LMG_project --import-benchmark
+    if(argc > 1 && std::string(argv[1]) == "--import-benchmark")
+    {
+        ImportBenchmark::run();
+        return 0;
+    }
+
     // Initialize the GLUT library
     glutInit( &argc, argv );
 
     //glutInitContextVersion( 3, 3 );
     //glutInitContextProfile( GLUT_COMPATIBILITY_PROFILE );
+#if GL_ERROR_CHECKS
+    // The debug output only reports the errors reliably in a debug context
+    glutInitContextFlags( GLUT_DEBUG );
+#endif
 
     // Grahics window
     // - configure the main framebuffer to store rgba colors,
@@ -746,8 +1082,7 @@ int main( int argc, char** argv )
     // Callbacks
     // - callback called when displaying window (user custom fonction pointer: "void f( void )")
     glutDisplayFunc( display );
-    // - callback continuously called when events are not being received
-    glutIdleFunc( idle );
+    // - no idle callback : GLUT waits for the events between the frames, which are asked for by the inputs and the frame scheduler
     // - get mouse movements
     glutMotionFunc(mousePassiveEvent);
     // - get mouse inputs
@@ -770,31 +1105,63 @@ int main( int argc, char** argv )
         exit( -1 );
     }
 
+    // GL errors are reported by the debug output when available (the checks are compiled out of release builds)
+    errorHandling::setPolicy(GL_ERROR_DEFAULT_POLICY);
+
+    // Fences of the frames in flight and swap interval
+    FrameScheduler::getScheduler().initialize();
+    // Timer queries of the GPU scopes
+    Profiler::getProfiler().initialize();
+
     // Initialize all your resources (graphics, data, etc...)
     checkExtensions();
 
-    // Build shader
-    shaderProgram = Shader(pathToShader+"vertexShader.vert", pathToShader+"fragmentShader.frag");
-    glassShader = Shader(pathToShader+"glassShader.vert", pathToShader+"glassShader.frag");
-    skyboxShader = Shader(pathToShader+"skyboxShader.vert", pathToShader+"skyboxShader.frag");
-    mapShader = Shader(pathToShader+"mapShader.vert", pathToShader+"mapShader.frag");
-    bBoardShader = Shader(pathToShader+"billBoardShader.vert", pathToShader+"billBoardShader.frag");
-    bBoardClourdShader = Shader(pathToShader+"billBoardsCloud.vert", pathToShader+"billBoardsCloud.frag");
+    // Uniform blocks of the camera and the light, bound to their binding points before the programs use them
+    frameUniforms.create(FRAME_UNIFORM_BINDING, sizeof(FrameUniformData));
+    lightUniforms.create(LIGHT_UNIFORM_BINDING, sizeof(LightUniformData));
+
+    // Submit the shader programs to the compiler (they are checked once the assets are loaded)
+    {
+        PROFILE_SCOPE("Shader submission");
+        modelShaders = ShaderVariants(pathToShader+"modelShader.vert", pathToShader+"modelShader.frag", SKYBOX_REFLECTION_FEATURE | REFRACTION_FEATURE | COMPRESSED_VERTICES_FEATURE);
+        mapShaders = ShaderVariants(pathToShader+"mapShader.vert", pathToShader+"mapShader.frag", TEXTURED_FEATURE);
+        billBoardShaders = ShaderVariants(pathToShader+"billBoardShader.vert", pathToShader+"billBoardShader.frag", FACE_CAMERA_FEATURE);
+        skyboxShader = Shader(pathToShader+"skyboxShader.vert", pathToShader+"skyboxShader.frag");
+        // - variants of the first frame (the others are compiled when they are first drawn)
+        unsigned int modelFeatures = MODEL_VERTEX_COMPRESSION ? COMPRESSED_VERTICES_FEATURE : 0;
+        modelShaders.get(modelFeatures | SKYBOX_REFLECTION_FEATURE);
+        modelShaders.get(modelFeatures | REFRACTION_FEATURE);
+        mapShaders.get(TEXTURED_FEATURE);
+        billBoardShaders.get(FACE_CAMERA_FEATURE);
+        billBoardShaders.get(0);
+    }
 
     // Create skybox object
-    skybox = SkyBox(faces);
-    isSkyboxActive = true;
+    {
+        PROFILE_SCOPE("Skybox loading");
+        skybox = SkyBox(faces);
+        isSkyboxActive = true;
+    }
 
     // Create map object
-    map = HeightMap(pathToMaps + "Heightmap2.png", pathToTextures + "terrain_01.jpg", 5);
+    {
+        PROFILE_SCOPE("Heightmap loading");
+        map = HeightMap(pathToMaps + "Heightmap2.png", pathToTextures + "terrain_01.jpg", 5);
+    }
 
     // Load objects
             // "Models/Crate/Crate1.obj"
             // "Models/Falcon/millenium-falcon.obj"
             // "Models/NanoSuit/nanosuit.obj" -> Works !
             // "Models/StarWars/test_obj/Arc170.obj"
-    modelsWithProgrammShader.push_back(Model3D((pathToSrc + "Models/NanoSuit/nanosuit.obj")));
-    modelsWithGlassShader.push_back(Model3D((pathToSrc + "Models/NanoSuit/nanosuit.obj")));
+    {
+        PROFILE_SCOPE("Model loading");
+        modelsWithProgrammShader.push_back(Model3D((pathToSrc + "Models/NanoSuit/nanosuit.obj")));
+    }
+    {
+        PROFILE_SCOPE("Model loading");
+        modelsWithGlassShader.push_back(Model3D((pathToSrc + "Models/NanoSuit/nanosuit.obj")));
+    }
     // Create the local transformation matrix for first model
     glm::mat4 modelMatrix;
     modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f));
@@ -812,9 +1179,57 @@ int main( int argc, char** argv )
     // Init global variable used to pick models on click
     currentModel = NULL;
 
-    bBoard = BillBoard(pathToTextures + "tree01.png");
+    {
+        PROFILE_SCOPE("Billboard loading");
+        bBoard = BillBoard(pathToTextures + "tree01.png");
+    }
+
+    {
+        PROFILE_SCOPE("Billboard cloud loading");
+        bBcloud = BillBoardCloud(bbCloudTextures);
+    }
+
+    // Remove the holes left in the geometry buffers by the loading
+    {
+        PROFILE_SCOPE("Geometry compaction");
+        GeometryArena::compactAll();
+    }
+
+    // Shader programs were compiled by the driver while the assets were loading, the remaining ones are waited for here
+    {
+        PROFILE_SCOPE("Shader compilation");
+        // - every variant a model can be drawn with, with and without the skybox (the vertex format of the models is known once they are loaded)
+        for(unsigned int i=0; i<modelsWithProgrammShader.size(); i++)
+        {
+            modelShaders.get(modelsWithProgrammShader[i].getShaderFeatures() | SKYBOX_REFLECTION_FEATURE);
+            modelShaders.get(modelsWithProgrammShader[i].getShaderFeatures());
+        }
+        for(unsigned int i=0; i<modelsWithGlassShader.size(); i++)
+        {
+            modelShaders.get(modelsWithGlassShader[i].getShaderFeatures() | REFRACTION_FEATURE);
+        }
+        ShaderVariants* shaderVariants[] = { &modelShaders, &mapShaders, &billBoardShaders };
+        unsigned int readyShaders = skyboxShader.isReady() ? 1 : 0;
+        unsigned int submittedShaders = 1;
+        for(unsigned int i=0; i<sizeof(shaderVariants) / sizeof(shaderVariants[0]); i++)
+        {
+            readyShaders += shaderVariants[i]->getReadyCount();
+            submittedShaders += shaderVariants[i]->getCount();
+        }
+        std::cout << "Shader programs ready after loading : " << readyShaders << "/" << submittedShaders << std::endl;
+        for(unsigned int i=0; i<sizeof(shaderVariants) / sizeof(shaderVariants[0]); i++)
+        {
+            shaderVariants[i]->finish();
+        }
+        skyboxShader.finish();
+    }
+
+    // Video memory of the textures (block compressed ones come from the files written by --compress-textures)
+    CompressedTexture::printStatistics();
+    TextureStreamer::getStreamer().printStatistics();
 
-    bBcloud = BillBoardCloud(bbCloudTextures);
+    // CPU memory still used by the geometry of the scene
+    GeometryRetention::printStatistics();
 
 
     // Init view & projection matrices